@@ -1,4 +1,5 @@
 #include "base.h"
+#include "builtins.h"
 
 // ----- TOKENS -----
 
@@ -11,6 +12,10 @@ const char* TokenRepr[] = {
     "INT",
     "FLOAT",
 
+    // Names
+    "IDENTIFIER",
+    "KEYWORD",
+
     // Operators
     "PLUS",
     "MINUS",
@@ -18,36 +23,84 @@ const char* TokenRepr[] = {
     "SLASH",
     "PERCENT",
     "CARET",
+    "EQUALS",
+
+    // Comparison operators
+    "LT",
+    "LE",
+    "GT",
+    "GE",
+    "EQ",
+    "NE",
+
+    // Logical operators
+    "AND",
+    "OR",
+    "NOT",
 
     // Parentheses
     "LPAREN",
     "RPAREN",
+
+    // Separators
+    "COMMA",
+    "SEMICOLON",
 };
 
 const Token* new_token(Position pos, TokenType type, const char* value)
 {
-    Token* t = (Token*) malloc(sizeof(Token));
+    return new_token_len(pos, type, value ? value : "", value ? strlen(value) : 0);
+}
+
+const Token* new_token_len(Position pos, TokenType type, const char* value, size_t len)
+{
+    Token* t = (Token*) malloc(sizeof(Token) + len + 1);
     t->pos = pos;
     t->type = type;
-    strncpy(t->value, value ? value : "", MAX_TOK_VAL_LEN);
+    memcpy(t->value, value, len);
+    t->value[len] = '\0';
     return t;
 }
 
+int format_token(StrBuf* b, const Token* t)
+{
+    int i = str_buf_append_str(b, TokenRepr[t->type]);
+    if (t->value[0])
+    {
+        i += str_buf_append_char(b, ':');
+        i += str_buf_append_str(b, t->value);
+    }
+    return i;
+}
+
 int print_token(const Token* t)
 {
-    int i = printf("%s", TokenRepr[t->type]);
-    if (strlen(t->value))
-        i += printf(":%s", t->value);
+    char storage[PRINT_BUF_LEN];
+    StrBuf b = new_stream_str_buf(stdout, storage, sizeof(storage));
+    int i = format_token(&b, t);
+    flush_str_buf(&b);
     return i;
 }
 
+int is_keyword(const Token* t, const char* keyword)
+{
+    return t->type == TT_KEY && strcmp(t->value, keyword) == 0;
+}
+
+int is_comparison(TokenType type)
+{
+    return type >= TT_LT && type <= TT_NE;
+}
+
 Position get_next_position(const Token* t)
 {
     Position p = t->pos;
-    if (strcmp(t->value, ""))
-        p.col++;
-    else
+    if (t->value[0])
         p.col += strlen(t->value);
+    else if (is_comparison(t->type) && t->type != TT_LT && t->type != TT_GT)
+        p.col += 2;
+    else
+        p.col++;
     return p;
 }
 
@@ -59,7 +112,7 @@ void free_token(Token* t)
 
 // ----- TYPES -----
 
-DataType* new_int(int value)
+DataType* new_int(int64_t value)
 {
     DataType* data = (DataType*) malloc(sizeof(DataType));
     data->type = INT;
@@ -75,14 +128,55 @@ DataType* new_float(double value)
     return data;
 }
 
+DataType* new_none(void)
+{
+    DataType* data = (DataType*) malloc(sizeof(DataType));
+    data->type = NONE;
+    data->value.integer = 0;
+    return data;
+}
+
+DataType* new_bigint(BigInt* value)
+{
+    DataType* data = (DataType*) malloc(sizeof(DataType));
+    data->type = BIGINT;
+    data->value.big = value;
+    return data;
+}
+
+DataType* new_integer(BigInt* value)
+{
+    int64_t small;
+    if (bigint_to_int(value, &small))
+    {
+        bigint_free(value);
+        return new_int(small);
+    }
+    return new_bigint(value);
+}
+
 DataType* promote(DataType* data, TypePriority type)
 {
+    DataType* promoted;
+
     switch (data->type)
     {
     case INT:
+        if (type == BIGINT)
+            promoted = new_bigint(bigint_from_int(data->value.integer));
+        else if (type == FLOAT)
+            promoted = new_float((double) data->value.integer);
+        else
+            return NULL;
+        free_value(data);
+        return promoted;
+
+    case BIGINT:
+        if (type == BIGINT)
+            return data;
         if (type == FLOAT)
         {
-            DataType* promoted = new_float((float) data->value.integer);
+            promoted = new_float(bigint_to_double(data->value.big));
             free_value(data);
             return promoted;
         }
@@ -98,6 +192,22 @@ DataType* promote(DataType* data, TypePriority type)
     }
 }
 
+DataType* copy_value(const DataType* data)
+{
+    switch (data->type)
+    {
+    case BIGINT:
+        return new_bigint(bigint_copy(data->value.big));
+
+    default:
+    {
+        DataType* copy = (DataType*) malloc(sizeof(DataType));
+        *copy = *data;
+        return copy;
+    }
+    }
+}
+
 const char* get_type_representation(TypePriority type)
 {
     switch (type)
@@ -105,31 +215,75 @@ const char* get_type_representation(TypePriority type)
     case INT:
         return "INT";
 
+    case BIGINT:
+        return "BIGINT";
+
     case FLOAT:
         return "FLOAT";
 
+    case NONE:
+        return "NONE";
+
     default:
         return "UNKNOWN";
     }
 }
 
-int print_value(const DataType* data)
+int format_value(StrBuf* b, const DataType* data)
 {
     switch (data->type)
     {
     case INT:
-        return printf("%d", data->value.integer);
+    {
+        char buf[MAX_INT_STR_LEN + 1];
+        return str_buf_append(b, buf, format_int(data->value.integer, buf));
+    }
+
+    case BIGINT:
+    {
+        // Write the digits in place when the buffer has room for them
+        size_t len = bigint_max_str_len(data->value.big);
+        char* p = str_buf_reserve(b, len + 1);
+        if (p)
+        {
+            len = bigint_to_string(data->value.big, p);
+            str_buf_commit(b, len);
+            return (int) len;
+        }
+
+        char* buf = (char*) malloc(len + 1);
+        int i = str_buf_append(b, buf, bigint_to_string(data->value.big, buf));
+        free(buf);
+        return i;
+    }
 
     case FLOAT:
-        return printf("%lf", data->value.decimal);
+    {
+        char buf[MAX_DBL_STR_LEN + 1];
+        return str_buf_append(b, buf, format_double(data->value.decimal, buf));
+    }
+
+    case NONE:
+        return 0;
 
     default:
         return -1;
     }
 }
 
+int print_value(const DataType* data)
+{
+    char storage[PRINT_BUF_LEN];
+    StrBuf b = new_stream_str_buf(stdout, storage, sizeof(storage));
+    int i = format_value(&b, data);
+    flush_str_buf(&b);
+    return i;
+}
+
 void free_value(DataType* data)
 {
+    if (data->type == BIGINT)
+        bigint_free(data->value.big);
     free(data);
 }
 
@@ -138,30 +292,185 @@ TypePriority max_priority(TypePriority type1, TypePriority type2)
     return (type1 >= type2) ? type1 : type2;
 }
 
+int is_integer(TypePriority type)
+{
+    return type == INT || type == BIGINT;
+}
+
 
 // ----- NODES -----
 
 // Auxiliary functions
 
 /**
- * Infers the data type of a binary operation node
+ * Checks whether a node is known to never evaluate to a negative value
  * 
- * @param binary The binary operation node
+ * @param node The node
+ * 
+ * @return Boolean-like value
+ * 
+ * @note A ```0``` result does not imply that the value is negative,
+ * only that it could not be proven otherwise
  */
+int is_non_negative(const ASTNode* node)
+{
+    switch (node->class)
+    {
+    case Number:
+        return 1;
+
+    case UnOp:
+        if (node->data.unary.sign->type == TT_NOT)
+            return 1;
+        return node->data.unary.sign->type == TT_ADD
+            && is_non_negative(node->data.unary.value);
+
+    case BinOp:
+        switch (node->data.binary.op->type)
+        {
+        case TT_ADD:
+        case TT_MUL:
+        case TT_DIV:
+            return is_non_negative(node->data.binary.left)
+                && is_non_negative(node->data.binary.right);
+
+        case TT_MOD:
+            // remainder() may return negative values for floats
+            return is_integer(node->type) 
+                && is_non_negative(node->data.binary.left);
+
+        case TT_POW:
+            return is_non_negative(node->data.binary.left);
+
+        default:
+            // Comparisons evaluate to 0 or 1
+            return is_comparison(node->data.binary.op->type);
+        }
+
+    case VarAssign:
+        return is_non_negative(node->data.assign.value);
+
+    case Convert:
+        return is_non_negative(node->data.convert.value);
+
+    case Sequence:
+        return is_non_negative(
+            node->data.sequence.items[node->data.sequence.count - 1]);
+
+    case Call:
+    {
+        const CallNode* call = &node->data.call;
+        if (call->builtin < 0)
+            return 0;
+        if (Builtins[call->builtin].non_negative)
+            return 1;
+
+        // abs, min, max and floor keep the sign of non-negative arguments
+        if (Builtins[call->builtin].result == RESULT_FLOAT)
+            return 0;
+        for (int k = 0; k < call->n_args; k++)
+        {
+            if (!is_non_negative(call->args[k]))
+                return 0;
+        }
+        return 1;
+    }
+
+    case Logic:
+        return 1;
+
+    case Cond:
+        return is_non_negative(node->data.cond.if_true) 
+            && is_non_negative(node->data.cond.if_false);
+
+    // Loops without iterations evaluate to 0
+    case While:
+        return is_non_negative(node->data.loop.body);
+
+    case For:
+        return is_non_negative(node->data.range.body);
+
+    case Invariant:
+        return is_non_negative(node->data.invariant.value);
+
+    case Fused:
+        switch (node->data.fused.opcode)
+        {
+        case OP_SQUARE_INT:
+        case OP_SQUARE_FLOAT:
+            return 1;
+
+        case OP_CUBE_INT:
+        case OP_CUBE_FLOAT:
+        case OP_SUM_INT:
+        case OP_SUM_FLOAT:
+        case OP_PRODUCT_INT:
+        case OP_PRODUCT_FLOAT:
+            for (int k = 0; k < node->data.fused.count; k++)
+            {
+                if (!is_non_negative(node->data.fused.operands[k]))
+                    return 0;
+            }
+            return 1;
+
+        default:
+            return 0;
+        }
+
+    default:
+        return 0;
+    }
+}
+
+
+// Public functions
+
 void infer_type(ASTNode* binary)
 {
-    if (binary->data.binary.left->type != binary->data.binary.right->type)
-        binary->type = max_priority(binary->data.binary.left->type, 
-                                    binary->data.binary.right->type);
-    if (binary->data.binary.op->type == TT_DIV)
+    binary->type = max_priority(binary->data.binary.left->type, 
+                                binary->data.binary.right->type);
+
+    switch (binary->data.binary.op->type)
+    {
+    case TT_DIV:
         binary->type = FLOAT;
+        break;
+
+    case TT_POW:
+        if (is_integer(binary->type) 
+            && !is_non_negative(binary->data.binary.right))
+            binary->type = FLOAT;
+        break;
+
+    default:
+        if (is_comparison(binary->data.binary.op->type))
+            binary->type = INT;
+        break;
+    }
 }
 
 ASTNode* new_number_node(const Token* number)
 {
     ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
     node->class = Number;
-    node->type = number->type;
+    node->type = FLOAT;
+    size_t len = strlen(number->value);
+
+    // Literals are parsed once, when the node is built
+    if (number->type == TT_INT)
+    {
+        node->type = INT;
+        
+        // Literals that do not fit in 64 bits are arbitrary-precision
+        if (!parse_int(number->value, len, &node->data.number.literal.integer))
+        {
+            node->type = BIGINT;
+            node->data.number.literal.big = bigint_from_string(number->value, len);
+        }
+    }
+    else
+        parse_double(number->value, len, &node->data.number.literal.decimal);
+
     node->pos = number->pos;
     node->data.number.value = number;
     return node;
@@ -171,10 +480,11 @@ ASTNode* new_un_op_node(const Token* sign, ASTNode* value)
 {
     ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
     node->class = UnOp;
-    node->type = value->type;
+    node->type = (sign->type == TT_NOT) ? INT : value->type;
     node->pos = sign->pos;
     node->data.unary.value = value;
     node->data.unary.sign = sign;
+    node->data.unary.opcode = OP_NONE;
     return node;
 }
 
@@ -186,33 +496,507 @@ ASTNode* new_bin_op_node(const Token* op, ASTNode* left, ASTNode* right)
     node->data.binary.op = op;
     node->data.binary.left = left;
     node->data.binary.right = right;
+    node->data.binary.opcode = OP_NONE;
+    node->data.binary.fork = 0;
     infer_type(node);
     return node;
 }
 
-int print_node(const ASTNode* node)
+ASTNode* new_var_access_node(const Token* name, int slot, TypePriority type)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = VarAccess;
+    node->type = type;
+    node->pos = name->pos;
+    node->data.access.name = name;
+    node->data.access.slot = slot;
+    return node;
+}
+
+ASTNode* new_var_assign_node(
+    const Token* name, 
+    int slot, 
+    TypePriority type, 
+    ASTNode* value
+)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = VarAssign;
+    node->type = type;
+    node->pos = name->pos;
+    node->data.assign.name = name;
+    node->data.assign.slot = slot;
+    node->data.assign.value = value;
+    return node;
+}
+
+ASTNode* new_convert_node(ASTNode* value, TypePriority type)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = Convert;
+    node->type = type;
+    node->pos = value->pos;
+    node->data.convert.value = value;
+    return node;
+}
+
+ASTNode* new_func_def_node(
+    const Token* name, 
+    int symbol, 
+    int n_params, 
+    int n_locals, 
+    int memo, 
+    ASTNode* body
+)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = FuncDef;
+    node->type = NONE;
+    node->pos = name->pos;
+    node->data.func_def.name = name;
+    node->data.func_def.symbol = symbol;
+    node->data.func_def.n_params = n_params;
+    node->data.func_def.n_locals = n_locals;
+    node->data.func_def.memo = memo;
+    node->data.func_def.body = body;
+    return node;
+}
+
+ASTNode* new_call_node(const Token* name, int symbol, ASTNode** args, int n_args)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = Call;
+    node->type = INT;
+    node->pos = name->pos;
+    node->data.call.name = name;
+    node->data.call.symbol = symbol;
+    node->data.call.args = args;
+    node->data.call.n_args = n_args;
+    node->data.call.tail = 0;
+    node->data.call.spec = NULL;
+    node->data.call.builtin = -1;
+    return node;
+}
+
+ASTNode* new_sequence_node(ASTNode** items, int count)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = Sequence;
+    node->type = items[count - 1]->type;
+    node->pos = items[0]->pos;
+    node->data.sequence.items = items;
+    node->data.sequence.count = count;
+    return node;
+}
+
+ASTNode* new_logic_node(const Token* op, ASTNode* left, ASTNode* right)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = Logic;
+    node->type = INT;
+    node->pos = left->pos;
+    node->data.logic.op = op;
+    node->data.logic.left = left;
+    node->data.logic.right = right;
+    return node;
+}
+
+ASTNode* new_cond_node(ASTNode* cond, ASTNode* if_true, ASTNode* if_false)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = Cond;
+    node->type = max_priority(if_true->type, if_false->type);
+    node->pos = cond->pos;
+    node->data.cond.cond = cond;
+    node->data.cond.if_true = if_true;
+    node->data.cond.if_false = if_false;
+    node->data.cond.select = 0;
+    return node;
+}
+
+ASTNode* new_while_node(ASTNode* cond, ASTNode* body)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = While;
+    node->type = body->type;
+    node->pos = cond->pos;
+    node->data.loop.cond = cond;
+    node->data.loop.body = body;
+    node->data.loop.n_invariants = 0;
+    return node;
+}
+
+ASTNode* new_for_node(
+    const Token* name, 
+    int slot, 
+    ASTNode* start, 
+    ASTNode* end, 
+    ASTNode* body
+)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = For;
+    node->type = body->type;
+    node->pos = name->pos;
+    node->data.range.name = name;
+    node->data.range.slot = slot;
+    node->data.range.start = start;
+    node->data.range.end = end;
+    node->data.range.body = body;
+    node->data.range.n_invariants = 0;
+    return node;
+}
+
+ASTNode* new_invariant_node(ASTNode* value, int level, int index)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = Invariant;
+    node->type = value->type;
+    node->pos = value->pos;
+    node->data.invariant.value = value;
+    node->data.invariant.level = level;
+    node->data.invariant.index = index;
+    return node;
+}
+
+ASTNode* new_fused_node(
+    const Token* op, 
+    Opcode opcode, 
+    TypePriority type, 
+    ASTNode** operands, 
+    int count
+)
+{
+    ASTNode* node = (ASTNode*) malloc(sizeof(ASTNode));
+    node->class = Fused;
+    node->type = type;
+    node->pos = operands[0]->pos;
+    node->data.fused.op = op;
+    node->data.fused.operands = operands;
+    node->data.fused.count = count;
+    node->data.fused.opcode = opcode;
+    node->data.fused.fork = 0;
+    return node;
+}
+
+/**
+ * Obtains the token to use in a cloned node
+ * 
+ * @param t The original token
+ * @param pool Where to copy the token, or ```NULL``` to share it
+ * 
+ * @return The token
+ */
+const Token* clone_token(const Token* t, TokenPool* pool)
+{
+    if (pool == NULL)
+        return t;
+
+    if (pool->count == pool->capacity)
+    {
+        pool->capacity = (pool->capacity) ? 2 * pool->capacity : 16;
+        pool->tokens = (Token**) realloc(pool->tokens, pool->capacity * sizeof(Token*));
+    }
+
+    Token* copy = (Token*) new_token(t->pos, t->type, t->value);
+    pool->tokens[pool->count++] = copy;
+    return copy;
+}
+
+/**
+ * Copies a list of nodes
+ * 
+ * @param nodes The nodes
+ * @param count The number of nodes
+ * @param pool Where to copy the tokens, or ```NULL``` to share them
+ * 
+ * @return The copy of the list
+ */
+ASTNode** clone_nodes(ASTNode* const* nodes, int count, TokenPool* pool)
+{
+    ASTNode** copy = (ASTNode**) malloc(count * sizeof(ASTNode*));
+    for (int k = 0; k < count; k++)
+        copy[k] = clone_node(nodes[k], pool);
+    return copy;
+}
+
+ASTNode* clone_node(const ASTNode* node, TokenPool* pool)
+{
+    ASTNode* copy = (ASTNode*) malloc(sizeof(ASTNode));
+    *copy = *node;
+    NodeData* data = &copy->data;
+
+    switch (node->class)
+    {
+    case Number:
+        data->number.value = clone_token(data->number.value, pool);
+        if (node->type == BIGINT)
+            data->number.literal.big = bigint_copy(data->number.literal.big);
+        break;
+
+    case UnOp:
+        data->unary.sign = clone_token(data->unary.sign, pool);
+        data->unary.value = clone_node(data->unary.value, pool);
+        break;
+
+    case BinOp:
+        data->binary.op = clone_token(data->binary.op, pool);
+        data->binary.left = clone_node(data->binary.left, pool);
+        data->binary.right = clone_node(data->binary.right, pool);
+        break;
+
+    case VarAccess:
+        data->access.name = clone_token(data->access.name, pool);
+        break;
+
+    case VarAssign:
+        data->assign.name = clone_token(data->assign.name, pool);
+        data->assign.value = clone_node(data->assign.value, pool);
+        break;
+
+    case Convert:
+        data->convert.value = clone_node(data->convert.value, pool);
+        break;
+
+    case FuncDef:
+        data->func_def.name = clone_token(data->func_def.name, pool);
+        data->func_def.body = clone_node(data->func_def.body, pool);
+        break;
+
+    case Call:
+        data->call.name = clone_token(data->call.name, pool);
+        data->call.args = clone_nodes(data->call.args, data->call.n_args, pool);
+        break;
+
+    case Sequence:
+        data->sequence.items = clone_nodes(
+            data->sequence.items, data->sequence.count, pool);
+        break;
+
+    case Logic:
+        data->logic.op = clone_token(data->logic.op, pool);
+        data->logic.left = clone_node(data->logic.left, pool);
+        data->logic.right = clone_node(data->logic.right, pool);
+        break;
+
+    case Cond:
+        data->cond.cond = clone_node(data->cond.cond, pool);
+        data->cond.if_true = clone_node(data->cond.if_true, pool);
+        data->cond.if_false = clone_node(data->cond.if_false, pool);
+        break;
+
+    case While:
+        data->loop.cond = clone_node(data->loop.cond, pool);
+        data->loop.body = clone_node(data->loop.body, pool);
+        break;
+
+    case For:
+        data->range.name = clone_token(data->range.name, pool);
+        data->range.start = clone_node(data->range.start, pool);
+        data->range.end = clone_node(data->range.end, pool);
+        data->range.body = clone_node(data->range.body, pool);
+        break;
+
+    case Invariant:
+        data->invariant.value = clone_node(data->invariant.value, pool);
+        break;
+
+    case Fused:
+        data->fused.op = clone_token(data->fused.op, pool);
+        data->fused.operands = clone_nodes(
+            data->fused.operands, data->fused.count, pool);
+        break;
+
+    default:
+        break;
+    }
+
+    return copy;
+}
+
+void free_token_pool(TokenPool* pool)
+{
+    for (int k = 0; k < pool->count; k++)
+        free_token(pool->tokens[k]);
+    free(pool->tokens);
+    pool->tokens = NULL;
+    pool->count = pool->capacity = 0;
+}
+
+/**
+ * Provides a string representation for each fused operation
+ */
+const char* FusedRepr[] = {
+    [OP_SQUARE_INT - OP_SQUARE_INT]     = "SQUARE",
+    [OP_SQUARE_FLOAT - OP_SQUARE_INT]   = "SQUARE",
+    [OP_CUBE_INT - OP_SQUARE_INT]       = "CUBE",
+    [OP_CUBE_FLOAT - OP_SQUARE_INT]     = "CUBE",
+    [OP_SUM_INT - OP_SQUARE_INT]        = "SUM",
+    [OP_SUM_FLOAT - OP_SQUARE_INT]      = "SUM",
+    [OP_PRODUCT_INT - OP_SQUARE_INT]    = "PRODUCT",
+    [OP_PRODUCT_FLOAT - OP_SQUARE_INT]  = "PRODUCT",
+    [OP_MUL_ADD_FLOAT - OP_SQUARE_INT]  = "MULADD",
+    [OP_MUL_SUB_FLOAT - OP_SQUARE_INT]  = "MULSUB",
+    [OP_ADD_MUL_FLOAT - OP_SQUARE_INT]  = "ADDMUL",
+    [OP_SUB_MUL_FLOAT - OP_SQUARE_INT]  = "SUBMUL",
+    [OP_KERNEL_MUL_ADD_INT - OP_SQUARE_INT]     = "K_MULADD",
+    [OP_KERNEL_MUL_ADD_FLOAT - OP_SQUARE_INT]   = "K_MULADD",
+    [OP_KERNEL_ADD_MUL_INT - OP_SQUARE_INT]     = "K_ADDMUL",
+    [OP_KERNEL_ADD_MUL_FLOAT - OP_SQUARE_INT]   = "K_ADDMUL",
+    [OP_KERNEL_MUL_SUB_INT - OP_SQUARE_INT]     = "K_MULSUB",
+    [OP_KERNEL_MUL_SUB_FLOAT - OP_SQUARE_INT]   = "K_MULSUB",
+    [OP_KERNEL_SUB_MUL_INT - OP_SQUARE_INT]     = "K_SUBMUL",
+    [OP_KERNEL_SUB_MUL_FLOAT - OP_SQUARE_INT]   = "K_SUBMUL",
+    [OP_KERNEL_SUM_MUL_INT - OP_SQUARE_INT]     = "K_SUMMUL",
+    [OP_KERNEL_SUM_MUL_FLOAT - OP_SQUARE_INT]   = "K_SUMMUL",
+    [OP_KERNEL_DIFF_MUL_INT - OP_SQUARE_INT]    = "K_DIFFMUL",
+    [OP_KERNEL_DIFF_MUL_FLOAT - OP_SQUARE_INT]  = "K_DIFFMUL",
+    [OP_KERNEL_DOT_ADD_INT - OP_SQUARE_INT]     = "K_DOTADD",
+    [OP_KERNEL_DOT_ADD_FLOAT - OP_SQUARE_INT]   = "K_DOTADD",
+    [OP_KERNEL_DOT_SUB_INT - OP_SQUARE_INT]     = "K_DOTSUB",
+    [OP_KERNEL_DOT_SUB_FLOAT - OP_SQUARE_INT]   = "K_DOTSUB",
+    [OP_KERNEL_RATIO_FLOAT - OP_SQUARE_INT]             = "K_RATIO",
+    [OP_KERNEL_RATIO_FLOAT_UNCHECKED - OP_SQUARE_INT]   = "K_RATIO",
+};
+
+/**
+ * Writes a list of nodes to a buffer, separated by a delimiter
+ * 
+ * @param b The buffer
+ * @param nodes The nodes
+ * @param count The number of nodes
+ * @param delimiter The delimiter
+ * 
+ * @return The number of characters written
+ */
+int format_nodes(StrBuf* b, ASTNode* const* nodes, int count, const char* delimiter)
+{
+    int i = 0;
+    for (int k = 0; k < count; k++)
+    {
+        if (k > 0)
+            i += str_buf_append_str(b, delimiter);
+        i += format_node(b, nodes[k]);
+    }
+    return i;
+}
+
+int format_node(StrBuf* b, const ASTNode* node)
 {
     int i = 0;
     switch (node->class)
     {
     case Number:
-        return print_token(node->data.number.value);
+        return format_token(b, node->data.number.value);
 
     case UnOp:
-        i += printf("(SIGN:");
-        i += print_token(node->data.unary.sign);
-        i += printf(", ");
-        i += print_node(node->data.unary.value);
-        i += printf(")");
+        i += str_buf_append_str(b, "(SIGN:");
+        i += format_token(b, node->data.unary.sign);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.unary.value);
+        i += str_buf_append_char(b, ')');
         return i;
 
     case BinOp:
-        i += print_token(node->data.binary.op);
-        i += printf("(");
-        i += print_node(node->data.binary.left);
-        i += printf(", ");
-        i += print_node(node->data.binary.right);
-        i += printf(")");
+        i += format_token(b, node->data.binary.op);
+        i += str_buf_append_char(b, '(');
+        i += format_node(b, node->data.binary.left);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.binary.right);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case VarAccess:
+        return format_token(b, node->data.access.name);
+
+    case VarAssign:
+        i += str_buf_append_str(b, "(SET:");
+        i += format_token(b, node->data.assign.name);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.assign.value);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case Convert:
+        i += str_buf_append_str(b, get_type_representation(node->type));
+        i += str_buf_append_char(b, '(');
+        i += format_node(b, node->data.convert.value);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case FuncDef:
+        i += str_buf_append_str(b, (node->data.func_def.memo) ? "(MEMO:" : "(FUN:");
+        i += format_token(b, node->data.func_def.name);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.func_def.body);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case Call:
+        i += format_token(b, node->data.call.name);
+        i += str_buf_append_char(b, '(');
+        i += format_nodes(b, node->data.call.args, node->data.call.n_args, ", ");
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case Sequence:
+        i += str_buf_append_char(b, '{');
+        i += format_nodes(b, node->data.sequence.items, 
+                          node->data.sequence.count, "; ");
+        i += str_buf_append_char(b, '}');
+        return i;
+
+    case Logic:
+        i += format_token(b, node->data.logic.op);
+        i += str_buf_append_char(b, '(');
+        i += format_node(b, node->data.logic.left);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.logic.right);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case Cond:
+        i += str_buf_append_str(b, (node->data.cond.select) ? "(SELECT:" : "(IF:");
+        i += format_node(b, node->data.cond.cond);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.cond.if_true);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.cond.if_false);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case While:
+        i += str_buf_append_str(b, "(WHILE:");
+        i += format_node(b, node->data.loop.cond);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.loop.body);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case For:
+        i += str_buf_append_str(b, "(FOR:");
+        i += format_token(b, node->data.range.name);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.range.start);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.range.end);
+        i += str_buf_append_str(b, ", ");
+        i += format_node(b, node->data.range.body);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case Invariant:
+        i += str_buf_append_str(b, "(INV:");
+        i += format_node(b, node->data.invariant.value);
+        i += str_buf_append_char(b, ')');
+        return i;
+
+    case Fused:
+        i += str_buf_append_str(b, FusedRepr[node->data.fused.opcode - OP_SQUARE_INT]);
+        i += str_buf_append_char(b, '(');
+        i += format_nodes(b, node->data.fused.operands, 
+                          node->data.fused.count, ", ");
+        i += str_buf_append_char(b, ')');
         return i;
     
     default:
@@ -220,11 +1004,22 @@ int print_node(const ASTNode* node)
     }
 }
 
+int print_node(const ASTNode* node)
+{
+    char storage[PRINT_BUF_LEN];
+    StrBuf b = new_stream_str_buf(stdout, storage, sizeof(storage));
+    int i = format_node(&b, node);
+    flush_str_buf(&b);
+    return i;
+}
+
 void free_node(ASTNode* node)
 {
     switch (node->class)
     {
     case Number:
+        if (node->type == BIGINT)
+            bigint_free(node->data.number.literal.big);
         free(node);
         break;
 
@@ -239,6 +1034,77 @@ void free_node(ASTNode* node)
         free(node);
         break;
 
+    case VarAccess:
+        free(node);
+        break;
+
+    case VarAssign:
+        free_node(node->data.assign.value);
+        free(node);
+        break;
+
+    case Convert:
+        free_node(node->data.convert.value);
+        free(node);
+        break;
+
+    case FuncDef:
+        free_node(node->data.func_def.body);
+        free(node);
+        break;
+
+    case Call:
+        for (int k = 0; k < node->data.call.n_args; k++)
+            free_node(node->data.call.args[k]);
+        free(node->data.call.args);
+        free(node);
+        break;
+
+    case Sequence:
+        for (int k = 0; k < node->data.sequence.count; k++)
+            free_node(node->data.sequence.items[k]);
+        free(node->data.sequence.items);
+        free(node);
+        break;
+
+    case Logic:
+        free_node(node->data.logic.left);
+        free_node(node->data.logic.right);
+        free(node);
+        break;
+
+    case Cond:
+        free_node(node->data.cond.cond);
+        free_node(node->data.cond.if_true);
+        free_node(node->data.cond.if_false);
+        free(node);
+        break;
+
+    case While:
+        free_node(node->data.loop.cond);
+        free_node(node->data.loop.body);
+        free(node);
+        break;
+
+    case For:
+        free_node(node->data.range.start);
+        free_node(node->data.range.end);
+        free_node(node->data.range.body);
+        free(node);
+        break;
+
+    case Invariant:
+        free_node(node->data.invariant.value);
+        free(node);
+        break;
+
+    case Fused:
+        for (int k = 0; k < node->data.fused.count; k++)
+            free_node(node->data.fused.operands[k]);
+        free(node->data.fused.operands);
+        free(node);
+        break;
+
     default:
         break;
     }
@@ -256,15 +1122,173 @@ const char* ErrorRepr[] = {
     "Runtime error"
 };
 
-const Error new_error(ErrorType type, Position pos, const char* details)
+/**
+ * Contains the type and message template of an error code
+ */
+typedef struct error_info
 {
-    Error e = { .type = type, .pos = pos, };
-    strncpy(e.details, details, MAX_ERR_DET_LEN);
+    ErrorType type;
+    const char* message;        // %c: character, %t: next data type, %s: name
+} ErrorInfo;
+
+/**
+ * Provides the type and message template for each error code
+ */
+const ErrorInfo ErrorTable[] = {
+
+    // Illegal character errors
+    [ERR_INVALID_CHAR]          = { IllegalCharError, "Invalid character '%c'" },
+    [ERR_INVALID_NUMBER]        = { IllegalCharError, "Not a valid number format" },
+    [ERR_INVALID_IDENTIFIER]    = { IllegalCharError, "Identifier too long" },
+
+    // Invalid syntax errors
+    [ERR_UNEXPECTED_EOF]        = { InvalidSyntaxError, "Unexpected end of input" },
+    [ERR_UNEXPECTED_TOKEN]      = { InvalidSyntaxError, "Unexpected token" },
+    [ERR_EXPECTED_OPERAND]      = { InvalidSyntaxError, "Expected another number" },
+    [ERR_EXPECTED_EXPRESSION]   = { InvalidSyntaxError, "Expected expression" },
+    [ERR_EXPECTED_RPAREN]       = { InvalidSyntaxError, "Expected ')'" },
+    [ERR_EXPECTED_NUMBER]       = { InvalidSyntaxError, "Expected number" },
+    [ERR_EXPECTED_NAME]         = { InvalidSyntaxError, "Expected identifier" },
+    [ERR_EXPECTED_LPAREN]       = { InvalidSyntaxError, "Expected '('" },
+    [ERR_EXPECTED_SEPARATOR]    = { InvalidSyntaxError, "Expected ',' or ')'" },
+    [ERR_EXPECTED_ASSIGN]       = { InvalidSyntaxError, "Expected '='" },
+    [ERR_EXPECTED_FUN]          = { InvalidSyntaxError, "Expected 'fun'" },
+    [ERR_DUPLICATE_PARAMETER]   = { InvalidSyntaxError, "Duplicate parameter '%s'" },
+    [ERR_EXPECTED_THEN]         = { InvalidSyntaxError, "Expected 'then'" },
+    [ERR_EXPECTED_ELSE]         = { InvalidSyntaxError, "Expected 'else'" },
+    [ERR_EXPECTED_DO]           = { InvalidSyntaxError, "Expected 'do'" },
+    [ERR_EXPECTED_TO]           = { InvalidSyntaxError, "Expected 'to'" },
+
+    // Runtime errors
+    [ERR_UNKNOWN_NODE]          = { RuntimeError, "Unable to interpret node: Type unknown" },
+    [ERR_UNKNOWN_NUMBER]        = { RuntimeError, "Unable to interpret node: Not a valid number type" },
+    [ERR_UNKNOWN_OPERATOR]      = { RuntimeError, "Unable to interpret node: Unknown operator" },
+    [ERR_CONVERSION]            = { RuntimeError, "Unable to convert from %t to %t" },
+    [ERR_NO_POSITIVE]           = { RuntimeError, "No positive method defined for type %t" },
+    [ERR_NO_NEGATIVE]           = { RuntimeError, "No negative method defined for type %t" },
+    [ERR_NO_ADDITION]           = { RuntimeError, "No addition method defined for type %t" },
+    [ERR_NO_SUBTRACTION]        = { RuntimeError, "No subtraction method defined for type %t" },
+    [ERR_NO_MULTIPLICATION]     = { RuntimeError, "No multiplication method defined for type %t" },
+    [ERR_NO_DIVISION]           = { RuntimeError, "No division method defined for type %t" },
+    [ERR_NO_MODULE]             = { RuntimeError, "No module method defined for type %t" },
+    [ERR_NO_POWER]              = { RuntimeError, "No power method defined for type %t" },
+    [ERR_NO_COMPARISON]         = { RuntimeError, "No comparison method defined for type %t" },
+    [ERR_NO_NOT]                = { RuntimeError, "No not method defined for type %t" },
+    [ERR_DIVISION_BY_ZERO]      = { RuntimeError, "Division by 0" },
+    [ERR_NEGATIVE_EXPONENT]     = { RuntimeError, "Negative exponent in integer power" },
+    [ERR_INTEGER_TOO_LARGE]     = { RuntimeError, "Integer too large" },
+    [ERR_UNDEFINED_VARIABLE]    = { RuntimeError, "Undefined variable '%s'" },
+    [ERR_UNDEFINED_FUNCTION]    = { RuntimeError, "Undefined function '%s'" },
+    [ERR_WRONG_ARGUMENTS]       = { RuntimeError, "Wrong number of arguments for '%s'" },
+    [ERR_RECURSION_DEPTH]       = { RuntimeError, "Maximum recursion depth exceeded" },
+    [ERR_MATH_DOMAIN]           = { RuntimeError, "Math domain error in '%s'" },
+
+    // Limit errors
+    [ERR_STEP_LIMIT]            = { RuntimeError, "Step limit exceeded" },
+    [ERR_DEPTH_LIMIT]           = { RuntimeError, "Depth limit exceeded" },
+    [ERR_MEMORY_LIMIT]          = { RuntimeError, "Memory limit exceeded" },
+    [ERR_TIME_LIMIT]            = { RuntimeError, "Time limit exceeded" },
+};
+
+const Error new_error(ErrorCode code, Position pos)
+{
+    Error e = { .pos = pos, .type = ErrorTable[code].type, .code = code };
+    return e;
+}
+
+const Error new_char_error(ErrorCode code, Position pos, char c)
+{
+    Error e = new_error(code, pos);
+    e.args.character = c;
+    return e;
+}
+
+const Error new_type_error(ErrorCode code, Position pos, TypePriority type)
+{
+    Error e = new_error(code, pos);
+    e.args.types[0] = (uint8_t) type;
+    return e;
+}
+
+const Error new_conversion_error(Position pos, TypePriority from, TypePriority to)
+{
+    Error e = new_error(ERR_CONVERSION, pos);
+    e.args.types[0] = (uint8_t) from;
+    e.args.types[1] = (uint8_t) to;
+    return e;
+}
+
+const Error new_name_error(ErrorCode code, Position pos, const char* name)
+{
+    Error e = new_error(code, pos);
+    e.args.name = name;
     return e;
 }
 
+int is_limit_error(const Error e)
+{
+    return e.code >= ERR_STEP_LIMIT;
+}
+
+int format_error_message(StrBuf* b, const Error e)
+{
+    const char* message = ErrorTable[e.code].message;
+    int i = 0, n_types = 0;
+
+    for (const char* p = message; *p; p++)
+    {
+        if (*p != '%')
+        {
+            // Copy the literal run up to the next argument
+            size_t len = strcspn(p, "%");
+            i += str_buf_append(b, p, len);
+            p += len - 1;
+            continue;
+        }
+
+        switch (*++p)
+        {
+        case 'c':
+            i += str_buf_append_char(b, e.args.character);
+            break;
+
+        case 't':
+            i += str_buf_append_str(
+                b, get_type_representation(e.args.types[n_types++]));
+            break;
+
+        case 's':
+            i += str_buf_append_str(b, e.args.name);
+            break;
+
+        default:
+            i += str_buf_append_char(b, *p);
+            break;
+        }
+    }
+
+    return i;
+}
+
+int format_error(StrBuf* b, const Error e)
+{
+    char num[MAX_INT_STR_LEN + 1];
+    int i = str_buf_append_str(b, ErrorRepr[e.type]);
+    i += str_buf_append_str(b, " at line ");
+    i += str_buf_append(b, num, format_int(e.pos.row, num));
+    i += str_buf_append_str(b, ", column ");
+    i += str_buf_append(b, num, format_int(e.pos.col, num));
+    i += str_buf_append_str(b, ": ");
+    i += format_error_message(b, e);
+    i += str_buf_append_char(b, '\n');
+    return i;
+}
+
 int print_error(const Error e)
 {
-    return printf("%s at line %d, column %d: %s\n", ErrorRepr[e.type],
-                  e.pos.row, e.pos.col, e.details);
+    char storage[PRINT_BUF_LEN];
+    StrBuf b = new_stream_str_buf(stdout, storage, sizeof(storage));
+    int i = format_error(&b, e);
+    flush_str_buf(&b);
+    return i;
 }
@@ -4,8 +4,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <math.h>
 
+#include "bigint.h"
+#include "numconv.h"
+#include "strbuf.h"
+
+// Size of the stack buffer used by the ```print_*``` functions
+#define PRINT_BUF_LEN 256
+
 /**
  * Represents a position (row, column) on a file
  */
@@ -18,7 +27,7 @@ typedef struct position
 
 // ----- TOKENS -----
 
-// Maximum lenght of token value
+// Maximum lenght of names. Number literals may have any length
 #define MAX_TOK_VAL_LEN 32
 
 /**
@@ -31,6 +40,10 @@ typedef enum token_type
     TT_INT,     // INT
     TT_FLT,     // FLOAT
 
+    // Names
+    TT_IDN,     // IDENTIFIER
+    TT_KEY,     // KEYWORD
+
     // Operators
     TT_ADD,     // '+'
     TT_SUB,     // '-'
@@ -38,11 +51,29 @@ typedef enum token_type
     TT_DIV,     // '/'
     TT_MOD,     // '%'
     TT_POW,     // '^'
+    TT_ASG,     // '='
+
+    // Comparison operators
+    TT_LT,      // '<'
+    TT_LE,      // '<='
+    TT_GT,      // '>'
+    TT_GE,      // '>='
+    TT_EQ,      // '=='
+    TT_NE,      // '!='
+
+    // Logical operators
+    TT_AND,     // 'and'
+    TT_OR,      // 'or'
+    TT_NOT,     // 'not'
 
     // Parentheses
     TT_LPA,     // '('
     TT_RPA,     // ')'
 
+    // Separators
+    TT_COM,     // ','
+    TT_SEM,     // ';'
+
 } TokenType;
 
 /**
@@ -52,7 +83,7 @@ typedef struct token
 {
     Position pos;
     TokenType type;
-    char value[MAX_TOK_VAL_LEN];
+    char value[];       // Allocated with the token, as long as needed
 } Token;
 
 /**
@@ -69,6 +100,32 @@ typedef struct token
  */
 const Token* new_token(Position pos, TokenType type, const char* value);
 
+/**
+ * Creates a new token whose value is a span of text, such as the digits
+ * of a literal
+ * 
+ * @param pos Position of the token
+ * @param type Type of token
+ * @param value Start of the value, which does not need to be
+ * null-terminated
+ * @param len Length of the value
+ * 
+ * @return The new token
+ * 
+ * @note Remember to call ```free_token``` afterwards
+ */
+const Token* new_token_len(Position pos, TokenType type, const char* value, size_t len);
+
+/**
+ * Writes the information of a token to a buffer
+ * 
+ * @param b The buffer
+ * @param t The token
+ * 
+ * @return The number of characters written
+ */
+int format_token(StrBuf* b, const Token* t);
+
 /**
  * Prints the information of a token to ```stdout```
  * 
@@ -78,6 +135,25 @@ const Token* new_token(Position pos, TokenType type, const char* value);
  */
 int print_token(const Token* t);
 
+/**
+ * Checks whether a token is a given keyword
+ * 
+ * @param t The token
+ * @param keyword The keyword
+ * 
+ * @return Boolean-like value
+ */
+int is_keyword(const Token* t, const char* keyword);
+
+/**
+ * Checks whether a token type is a comparison operator
+ * 
+ * @param type The token type
+ * 
+ * @return Boolean-like value
+ */
+int is_comparison(TokenType type);
+
 /**
  * Obtains the position of the next token
  * 
@@ -102,17 +178,23 @@ void free_token(Token* t);
  */
 typedef enum type_priority
 {
-    INT   = 0,          // Integer value
-    FLOAT = 1,          // Decimal value
+    INT    = 0,         // Integer value
+    BIGINT = 1,         // Arbitrary-precision integer value
+    FLOAT  = 2,         // Decimal value
+    NONE   = 3,         // No value (statements such as definitions)
 } TypePriority;
 
+// Values closer to 0 than this are treated as 0 by divisions
+#define ZERO_TOLERANCE 1e-9
+
 /**
  * Possible values for data
  */
 typedef union data_value
 {
-    int integer;
+    int64_t integer;
     double decimal;
+    BigInt* big;
 } DataValue;
 
 /**
@@ -133,7 +215,7 @@ typedef struct data_type
  * 
  * @note Remember to call ```free_data``` afterwards
  */
-DataType* new_int(int value);
+DataType* new_int(int64_t value);
 
 /**
  * Creates a new decimal value
@@ -146,6 +228,38 @@ DataType* new_int(int value);
  */
 DataType* new_float(double value);
 
+/**
+ * Creates a new empty value
+ * 
+ * @return The new value
+ * 
+ * @note Remember to call ```free_data``` afterwards
+ */
+DataType* new_none(void);
+
+/**
+ * Creates a new arbitrary-precision integer value
+ * 
+ * @param value Data value. Ownership is transferred to the new value
+ * 
+ * @return The new value
+ * 
+ * @note Remember to call ```free_data``` afterwards
+ */
+DataType* new_bigint(BigInt* value);
+
+/**
+ * Creates a new integer value from a big integer, using the 64-bit
+ * representation whenever the value fits in it
+ * 
+ * @param value Data value. Ownership is transferred to the new value
+ * 
+ * @return The new value
+ * 
+ * @note Remember to call ```free_data``` afterwards
+ */
+DataType* new_integer(BigInt* value);
+
 /**
  * Promotes a data value to another type
  * 
@@ -159,6 +273,17 @@ DataType* new_float(double value);
  */
 DataType* promote(DataType* data, TypePriority type);
 
+/**
+ * Copies a data value
+ * 
+ * @param data The data value
+ * 
+ * @return The copy
+ * 
+ * @note Remember to call ```free_data``` afterwards
+ */
+DataType* copy_value(const DataType* data);
+
 /**
  * Obtains a string representation of a data type
  * 
@@ -168,6 +293,17 @@ DataType* promote(DataType* data, TypePriority type);
  */
 const char* get_type_representation(TypePriority type);
 
+/**
+ * Writes the value of a data type to a buffer
+ * 
+ * @param b The buffer
+ * @param data The data value
+ * 
+ * @return The number of characters written, or ```-1``` if the type
+ * is unknown
+ */
+int format_value(StrBuf* b, const DataType* data);
+
 /**
  * Prints the value of a data type to ```stdout```
  * 
@@ -194,6 +330,18 @@ void free_value(DataType* data);
 */
 TypePriority max_priority(TypePriority type1, TypePriority type2);
 
+/**
+ * Checks whether a data type holds integer values
+ * 
+ * @param type The data type
+ * 
+ * @return Boolean-like value
+ * 
+ * @note Values of integer types may use any integer representation at
+ * runtime: operations on ```INT``` values promote to ```BIGINT``` on overflow
+ */
+int is_integer(TypePriority type);
+
 
 // ----- NODES -----
 
@@ -205,8 +353,99 @@ typedef enum node_class
     Number,     // Numeric value
     UnOp,       // Unary operation
     BinOp,      // Binary operation
+    VarAccess,  // Variable reference
+    VarAssign,  // Variable assignment
+    Convert,    // Type conversion (inserted by the typing pass)
+    FuncDef,    // Function definition
+    Call,       // Function call
+    Sequence,   // Sequence of statements
+    Logic,      // Short-circuit logical operation
+    Cond,       // Conditional expression
+    While,      // Loop while a condition holds
+    For,        // Loop over a range of numbers
+    Invariant,  // Loop-invariant subexpression (inserted by the typing pass)
+    Fused,      // Fused operations (inserted by the fusion pass)
 } NodeClass;
 
+/**
+ * Implementations of the operations, selected by the typing pass for the
+ * data type of each node
+ */
+typedef enum opcode
+{
+    OP_NONE,            // Not selected yet
+
+    // Unary operations
+    OP_POS_INT,
+    OP_POS_FLOAT,
+    OP_NEG_INT,
+    OP_NEG_FLOAT,
+    OP_NOT_INT,
+    OP_NOT_FLOAT,
+
+    // Binary operations
+    OP_ADD_INT,
+    OP_ADD_FLOAT,
+    OP_SUB_INT,
+    OP_SUB_FLOAT,
+    OP_MUL_INT,
+    OP_MUL_FLOAT,
+    OP_DIV_FLOAT,
+    OP_MOD_INT,
+    OP_MOD_FLOAT,
+    OP_DIV_FLOAT_UNCHECKED,     // Divisor proven to never be 0
+    OP_MOD_INT_UNCHECKED,       // Divisor proven to never be 0
+    OP_MOD_FLOAT_UNCHECKED,     // Divisor proven to never be 0
+    OP_POW_INT,
+    OP_POW_FLOAT,
+    OP_LT_INT,
+    OP_LT_FLOAT,
+    OP_LE_INT,
+    OP_LE_FLOAT,
+    OP_GT_INT,
+    OP_GT_FLOAT,
+    OP_GE_INT,
+    OP_GE_FLOAT,
+    OP_EQ_INT,
+    OP_EQ_FLOAT,
+    OP_NE_INT,
+    OP_NE_FLOAT,
+
+    // Fused operations
+    OP_SQUARE_INT,
+    OP_SQUARE_FLOAT,
+    OP_CUBE_INT,
+    OP_CUBE_FLOAT,      // Rounds differently from ```pow```
+    OP_SUM_INT,
+    OP_SUM_FLOAT,
+    OP_PRODUCT_INT,
+    OP_PRODUCT_FLOAT,
+    OP_MUL_ADD_FLOAT,   // a * b + c, rounded once
+    OP_MUL_SUB_FLOAT,   // a * b - c, rounded once
+    OP_ADD_MUL_FLOAT,   // c + a * b, rounded once
+    OP_SUB_MUL_FLOAT,   // c - a * b, rounded once
+
+    // Shape kernels, which round each operation like the original tree
+    OP_KERNEL_MUL_ADD_INT,      // a * b + c
+    OP_KERNEL_MUL_ADD_FLOAT,
+    OP_KERNEL_ADD_MUL_INT,      // a + b * c
+    OP_KERNEL_ADD_MUL_FLOAT,
+    OP_KERNEL_MUL_SUB_INT,      // a * b - c
+    OP_KERNEL_MUL_SUB_FLOAT,
+    OP_KERNEL_SUB_MUL_INT,      // a - b * c
+    OP_KERNEL_SUB_MUL_FLOAT,
+    OP_KERNEL_SUM_MUL_INT,      // (a + b) * c
+    OP_KERNEL_SUM_MUL_FLOAT,
+    OP_KERNEL_DIFF_MUL_INT,     // (a - b) * c
+    OP_KERNEL_DIFF_MUL_FLOAT,
+    OP_KERNEL_DOT_ADD_INT,      // a * b + c * d
+    OP_KERNEL_DOT_ADD_FLOAT,
+    OP_KERNEL_DOT_SUB_INT,      // a * b - c * d
+    OP_KERNEL_DOT_SUB_FLOAT,
+    OP_KERNEL_RATIO_FLOAT,              // (a + b) / (c - d)
+    OP_KERNEL_RATIO_FLOAT_UNCHECKED,    // Divisor proven to never be 0
+} Opcode;
+
 typedef struct ast_node ASTNode;
 
 /**
@@ -215,6 +454,7 @@ typedef struct ast_node ASTNode;
 typedef struct number_node
 {
     const Token* value;
+    DataValue literal;      // Value parsed from the token
 } NumberNode;
 
 /**
@@ -224,6 +464,7 @@ typedef struct un_op_node
 {
     const Token* sign;
     ASTNode* value;
+    Opcode opcode;
 } UnOpNode;
 
 /**
@@ -234,8 +475,151 @@ typedef struct bin_op_node
     const Token* op;
     ASTNode* left;
     ASTNode* right;
+    Opcode opcode;
+    int fork;               // Whether the right operand is evaluated in parallel
 } BinOpNode;
 
+/**
+ * Contains information about a variable reference node
+ */
+typedef struct var_access_node
+{
+    const Token* name;
+    int slot;               // Environment slot of the variable
+} VarAccessNode;
+
+/**
+ * Contains information about a variable assignment node
+ */
+typedef struct var_assign_node
+{
+    const Token* name;
+    int slot;               // Environment slot of the variable
+    ASTNode* value;
+} VarAssignNode;
+
+/**
+ * Contains information about a type conversion node. The target type is
+ * the type of the node
+ */
+typedef struct convert_node
+{
+    ASTNode* value;
+} ConvertNode;
+
+/**
+ * Contains information about a function definition node
+ */
+typedef struct func_def_node
+{
+    const Token* name;
+    int symbol;             // Symbol of the function
+    int n_params;
+    int n_locals;           // Number of frame slots, parameters first
+    int memo;               // Whether the results of calls are cached
+    ASTNode* body;
+} FuncDefNode;
+
+typedef struct specialization Specialization;
+
+/**
+ * Contains information about a function call node
+ */
+typedef struct call_node
+{
+    const Token* name;
+    int symbol;             // Symbol of the function
+    ASTNode** args;
+    int n_args;
+    int tail;               // Whether the call is in tail position
+    Specialization* spec;   // Callee, selected by the typing pass
+    int builtin;            // Built-in callee, selected by the typing pass (-1 if none)
+} CallNode;
+
+/**
+ * Contains information about a sequence of statements. Its value is the
+ * value of the last one
+ */
+typedef struct sequence_node
+{
+    ASTNode** items;
+    int count;
+} SequenceNode;
+
+/**
+ * Contains information about a logical operation node. The right operand
+ * is only evaluated when the left one does not decide the result
+ */
+typedef struct logic_node
+{
+    const Token* op;
+    ASTNode* left;
+    ASTNode* right;
+} LogicNode;
+
+/**
+ * Contains information about a conditional expression node
+ */
+typedef struct cond_node
+{
+    ASTNode* cond;
+    ASTNode* if_true;
+    ASTNode* if_false;
+    int select;             // Whether both branches are evaluated and one is selected
+} CondNode;
+
+/**
+ * Contains information about a while loop node. Its value is the value
+ * of the last iteration, or 0 if there is none
+ */
+typedef struct while_node
+{
+    ASTNode* cond;
+    ASTNode* body;
+    int n_invariants;       // Number of subexpressions hoisted out of the loop
+} WhileNode;
+
+/**
+ * Contains information about a for loop node. The counter goes from the
+ * start to the end value (inclusive) in steps of 1, and both values are
+ * evaluated once. Its value is the value of the last iteration, or 0 if
+ * there is none
+ */
+typedef struct for_node
+{
+    const Token* name;
+    int slot;               // Environment slot of the counter
+    ASTNode* start;
+    ASTNode* end;
+    ASTNode* body;
+    int n_invariants;       // Number of subexpressions hoisted out of the loop
+} ForNode;
+
+/**
+ * Contains information about a loop-invariant subexpression. It is
+ * evaluated the first time it is reached in each run of its loop, and
+ * its value is reused by the following iterations
+ */
+typedef struct invariant_node
+{
+    ASTNode* value;
+    int level;              // Number of loops between the node and its loop
+    int index;              // Position of the value among the loop's invariants
+} InvariantNode;
+
+/**
+ * Contains information about a fused operation node, which evaluates a
+ * tree of arithmetic operations with a single dispatch. The operands are
+ * evaluated in the order of the original tree
+ */
+typedef struct fused_node
+{
+    const Token* op;        // Operator of the outermost original operation
+    ASTNode** operands;
+    int count;
+    Opcode opcode;
+    int fork;               // Whether the operands are evaluated in parallel
+} FusedNode;
 
 /**
  * Possible values for data
@@ -245,6 +629,18 @@ typedef union node_data
     NumberNode number;
     UnOpNode unary;
     BinOpNode binary;
+    VarAccessNode access;
+    VarAssignNode assign;
+    ConvertNode convert;
+    FuncDefNode func_def;
+    CallNode call;
+    SequenceNode sequence;
+    LogicNode logic;
+    CondNode cond;
+    WhileNode loop;
+    ForNode range;
+    InvariantNode invariant;
+    FusedNode fused;
 } NodeData;
 
 /**
@@ -294,6 +690,258 @@ ASTNode* new_un_op_node(const Token* sign, ASTNode* value);
  */
 ASTNode* new_bin_op_node(const Token* op, ASTNode* left, ASTNode* right);
 
+/**
+ * Creates a new variable reference node
+ * 
+ * @param name Token representing the name of the variable
+ * @param slot Environment slot of the variable
+ * @param type Data type of the variable
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_var_access_node(const Token* name, int slot, TypePriority type);
+
+/**
+ * Creates a new variable assignment node
+ * 
+ * @param name Token representing the name of the variable
+ * @param slot Environment slot of the variable
+ * @param type Data type of the variable
+ * @param value Node containing the assigned value
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_var_assign_node(
+    const Token* name, 
+    int slot, 
+    TypePriority type, 
+    ASTNode* value
+);
+
+/**
+ * Creates a new type conversion node
+ * 
+ * @param value Node containing the value to convert
+ * @param type Data type to convert to
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_convert_node(ASTNode* value, TypePriority type);
+
+/**
+ * Creates a new function definition node
+ * 
+ * @param name Token representing the name of the function
+ * @param symbol Symbol of the function
+ * @param n_params Number of parameters
+ * @param n_locals Number of frame slots used by the body
+ * @param memo Whether the results of calls are cached
+ * @param body Node containing the body
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_func_def_node(
+    const Token* name, 
+    int symbol, 
+    int n_params, 
+    int n_locals, 
+    int memo, 
+    ASTNode* body
+);
+
+/**
+ * Creates a new function call node
+ * 
+ * @param name Token representing the name of the function
+ * @param symbol Symbol of the function
+ * @param args Nodes containing the arguments. Ownership is transferred
+ * to the new node
+ * @param n_args Number of arguments
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_call_node(const Token* name, int symbol, ASTNode** args, int n_args);
+
+/**
+ * Creates a new sequence node
+ * 
+ * @param items Nodes containing the statements. Ownership is transferred
+ * to the new node
+ * @param count Number of statements
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_sequence_node(ASTNode** items, int count);
+
+/**
+ * Creates a new logical operation node
+ * 
+ * @param op Token representing the operation
+ * @param left Node containing the left operand
+ * @param right Node containing the right operand
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_logic_node(const Token* op, ASTNode* left, ASTNode* right);
+
+/**
+ * Creates a new conditional expression node
+ * 
+ * @param cond Node containing the condition
+ * @param if_true Node containing the value when the condition holds
+ * @param if_false Node containing the value otherwise
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_cond_node(ASTNode* cond, ASTNode* if_true, ASTNode* if_false);
+
+/**
+ * Creates a new while loop node
+ * 
+ * @param cond Node containing the condition
+ * @param body Node containing the body
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_while_node(ASTNode* cond, ASTNode* body);
+
+/**
+ * Creates a new for loop node
+ * 
+ * @param name Token representing the name of the counter
+ * @param slot Environment slot of the counter
+ * @param start Node containing the first value of the counter
+ * @param end Node containing the last value of the counter
+ * @param body Node containing the body
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_for_node(
+    const Token* name, 
+    int slot, 
+    ASTNode* start, 
+    ASTNode* end, 
+    ASTNode* body
+);
+
+/**
+ * Creates a new loop-invariant subexpression node
+ * 
+ * @param value Node containing the subexpression
+ * @param level Number of loops between the node and the loop it is
+ * hoisted out of
+ * @param index Position of the value among the loop's invariants
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_invariant_node(ASTNode* value, int level, int index);
+
+/**
+ * Creates a new fused operation node
+ * 
+ * @param op Token representing the outermost original operation
+ * @param opcode Implementation of the fused operation
+ * @param type Data type of the result
+ * @param operands Nodes containing the operands. Ownership is transferred
+ * to the new node
+ * @param count Number of operands
+ * 
+ * @return The new node
+ * 
+ * @note Remember to call ```free_node``` afterwards
+ */
+ASTNode* new_fused_node(
+    const Token* op, 
+    Opcode opcode, 
+    TypePriority type, 
+    ASTNode** operands, 
+    int count
+);
+
+/**
+ * Contains the tokens owned by a cloned AST
+ */
+typedef struct token_pool
+{
+    Token** tokens;
+    int count;
+    int capacity;
+} TokenPool;
+
+/**
+ * Copies a token
+ * 
+ * @param t The token
+ * @param pool Where to copy the token, or ```NULL``` to share it
+ * 
+ * @return The copy
+ */
+const Token* clone_token(const Token* t, TokenPool* pool);
+
+/**
+ * Copies a node and its children
+ * 
+ * @param node The node
+ * @param pool Where to copy the tokens of the nodes, or ```NULL``` to
+ * share them with the original
+ * 
+ * @return The copy
+ * 
+ * @note Remember to call ```free_node``` afterwards, and
+ * ```free_token_pool``` once no copy uses the pool
+ */
+ASTNode* clone_node(const ASTNode* node, TokenPool* pool);
+
+/**
+ * Frees the tokens of a pool
+ * 
+ * @param pool The pool
+ */
+void free_token_pool(TokenPool* pool);
+
+/**
+ * Infers the data type of a binary operation node from its operands
+ * 
+ * @param binary The binary operation node
+ * 
+ * @note Integer powers are only kept as integers when the exponent
+ * is known to be non-negative
+ */
+void infer_type(ASTNode* binary);
+
+/**
+ * Writes the information of a node to a buffer
+ * 
+ * @param b The buffer
+ * @param node The node
+ * 
+ * @return The number of characters written, or ```-1``` if the node
+ * class is unknown
+ */
+int format_node(StrBuf* b, const ASTNode* node);
+
 /**
  * Prints the information of a node to ```stdout```
  * 
@@ -323,29 +971,170 @@ typedef enum error_type
     RuntimeError
 } ErrorType;
 
-// Maximum lenght of error details
-#define MAX_ERR_DET_LEN 128
+/**
+ * Specific errors. The message of each one is only built when the error
+ * is formatted
+ */
+typedef enum error_code
+{
+    // Illegal character errors
+    ERR_INVALID_CHAR,           // Invalid character (character)
+    ERR_INVALID_NUMBER,         // Not a valid number format
+    ERR_INVALID_IDENTIFIER,     // Identifier too long
+
+    // Invalid syntax errors
+    ERR_UNEXPECTED_EOF,         // Unexpected end of input
+    ERR_UNEXPECTED_TOKEN,       // Unexpected token
+    ERR_EXPECTED_OPERAND,       // Expected another number
+    ERR_EXPECTED_EXPRESSION,    // Expected expression
+    ERR_EXPECTED_RPAREN,        // Expected ')'
+    ERR_EXPECTED_NUMBER,        // Expected number
+    ERR_EXPECTED_NAME,          // Expected identifier
+    ERR_EXPECTED_LPAREN,        // Expected '('
+    ERR_EXPECTED_SEPARATOR,     // Expected ',' or ')'
+    ERR_EXPECTED_ASSIGN,        // Expected '='
+    ERR_EXPECTED_FUN,           // Expected 'fun'
+    ERR_DUPLICATE_PARAMETER,    // Duplicate parameter (name)
+    ERR_EXPECTED_THEN,          // Expected 'then'
+    ERR_EXPECTED_ELSE,          // Expected 'else'
+    ERR_EXPECTED_DO,            // Expected 'do'
+    ERR_EXPECTED_TO,            // Expected 'to'
+
+    // Runtime errors
+    ERR_UNKNOWN_NODE,           // Unknown node class
+    ERR_UNKNOWN_NUMBER,         // Unknown number type
+    ERR_UNKNOWN_OPERATOR,       // Unknown operator
+    ERR_CONVERSION,             // Unable to convert (from type, to type)
+    ERR_NO_POSITIVE,            // No positive method (type)
+    ERR_NO_NEGATIVE,            // No negative method (type)
+    ERR_NO_ADDITION,            // No addition method (type)
+    ERR_NO_SUBTRACTION,         // No subtraction method (type)
+    ERR_NO_MULTIPLICATION,      // No multiplication method (type)
+    ERR_NO_DIVISION,            // No division method (type)
+    ERR_NO_MODULE,              // No module method (type)
+    ERR_NO_POWER,               // No power method (type)
+    ERR_NO_COMPARISON,          // No comparison method (type)
+    ERR_NO_NOT,                 // No logical negation method (type)
+    ERR_DIVISION_BY_ZERO,       // Division by 0
+    ERR_NEGATIVE_EXPONENT,      // Negative exponent in integer power
+    ERR_INTEGER_TOO_LARGE,      // Integer too large
+    ERR_UNDEFINED_VARIABLE,     // Undefined variable (name)
+    ERR_UNDEFINED_FUNCTION,     // Undefined function (name)
+    ERR_WRONG_ARGUMENTS,        // Wrong number of arguments (name)
+    ERR_RECURSION_DEPTH,        // Maximum recursion depth exceeded
+    ERR_MATH_DOMAIN,            // Argument outside the domain of a function (name)
+
+    // Limit errors, the runtime errors of evaluations out of budget
+    ERR_STEP_LIMIT,             // Step limit exceeded
+    ERR_DEPTH_LIMIT,            // Depth limit exceeded
+    ERR_MEMORY_LIMIT,           // Memory limit exceeded
+    ERR_TIME_LIMIT,             // Time limit exceeded
+} ErrorCode;
 
 /**
- * Contains details of an error (type, position and details)
+ * Arguments of an error message
+ */
+typedef union error_args
+{
+    char character;             // Offending character
+    uint8_t types[2];           // Data types involved
+    const char* name;           // Name involved (not owned by the error)
+} ErrorArgs;
+
+/**
+ * Contains details of an error (position, type, code and arguments)
  */
 typedef struct error
 {
-    ErrorType type;
     Position pos;
-    char details[MAX_ERR_DET_LEN];
+    uint8_t type;               // ErrorType
+    uint8_t code;               // ErrorCode
+    ErrorArgs args;
 } Error;
 
 /**
- * Creates a new error with the given parameters
+ * Creates a new error without arguments
+ * 
+ * @param code Specific error
+ * @param pos Position where the error is found
+ * 
+ * @return The new error
+ */
+const Error new_error(ErrorCode code, Position pos);
+
+/**
+ * Creates a new error about a character
  * 
- * @param type Type of error
+ * @param code Specific error
  * @param pos Position where the error is found
- * @param details Details of the error
+ * @param c The character
  * 
  * @return The new error
  */
-const Error new_error(ErrorType type, Position pos, const char* details);
+const Error new_char_error(ErrorCode code, Position pos, char c);
+
+/**
+ * Creates a new error about a data type
+ * 
+ * @param code Specific error
+ * @param pos Position where the error is found
+ * @param type The data type
+ * 
+ * @return The new error
+ */
+const Error new_type_error(ErrorCode code, Position pos, TypePriority type);
+
+/**
+ * Creates a new error about a failed type conversion
+ * 
+ * @param pos Position where the error is found
+ * @param from The original data type
+ * @param to The target data type
+ * 
+ * @return The new error
+ */
+const Error new_conversion_error(Position pos, TypePriority from, TypePriority to);
+
+/**
+ * Creates a new error about a name
+ * 
+ * @param code Specific error
+ * @param pos Position where the error is found
+ * @param name The name. It must outlive the error
+ * 
+ * @return The new error
+ */
+const Error new_name_error(ErrorCode code, Position pos, const char* name);
+
+/**
+ * Checks whether an error stopped an evaluation that exceeded its budget,
+ * rather than an error of the code
+ * 
+ * @param e The error
+ * 
+ * @return Boolean-like value
+ */
+int is_limit_error(const Error e);
+
+/**
+ * Writes the message of an error to a buffer, without its type and position
+ * 
+ * @param b The buffer
+ * @param e The error
+ * 
+ * @return The number of characters written
+ */
+int format_error_message(StrBuf* b, const Error e);
+
+/**
+ * Writes the information of an error to a buffer, followed by a newline
+ * 
+ * @param b The buffer
+ * @param e The error
+ * 
+ * @return The number of characters written
+ */
+int format_error(StrBuf* b, const Error e);
 
 /**
  * Prints the information of an error to ```stdout```
@@ -0,0 +1,14 @@
+#include <time.h>
+
+#include "bench.h"
+
+// ----- BENCHMARKS -----
+
+// Public functions
+
+double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
@@ -0,0 +1,15 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// ----- BENCHMARKS -----
+
+// Helpers shared by the benchmarks, whose build commands add bench.c
+
+/**
+ * Obtains the time of a monotonic clock
+ *
+ * @return The time, in seconds
+ */
+double now(void);
+
+#endif  // BENCH_H
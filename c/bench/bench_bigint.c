@@ -0,0 +1,122 @@
+/**
+ * Benchmark of the arbitrary-precision integer type
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o bench_bigint bench/bench_bigint.c bench/bench.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c parallel.c interpreter.c -lm -lpthread```
+ */
+
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../interpreter.h"
+#include "../typing.h"
+#include "bench.h"
+
+// Internal multiplication routine of bigint.c, used as baseline
+void mag_mul_schoolbook(const uint32_t* a, int an, const uint32_t* b, int bn,
+                        uint32_t* out);
+
+/**
+ * Times the evaluation of an expression through the whole pipeline
+ *
+ * @param text The expression
+ */
+void bench_expression(const char* text)
+{
+    double start = now();
+
+    Lexer l = new_lexer(text);
+    LexerResult lr = tokenize(&l);
+    SymbolTable symbols = new_symbol_table();
+    Environment env = new_environment();
+    FunctionTable functions = new_function_table();
+    Parser p = new_parser(lr, &symbols);
+    ParserResult pr = parse(&p);
+    pr = check_types(pr.root, &symbols, &env, &functions);
+    Interpreter i = new_interpreter(pr.root, &env);
+    Result r = interpret(&i);
+
+    double eval = now();
+
+    char* buf = (char*) malloc(bigint_max_str_len(r.result->value.big) + 1);
+    size_t len = bigint_to_string(r.result->value.big, buf);
+
+    double end = now();
+
+    printf("%-16s %8zu digits   eval %8.3f ms   to_string %8.3f ms\n",
+           text, len, (eval - start) * 1e3, (end - eval) * 1e3);
+
+    free(buf);
+    free_value(r.result);
+    free_node(pr.root);
+    free_lexer_result(&lr);
+    free_function_table(&functions);
+    free_environment(&env);
+    free_symbol_table(&symbols);
+}
+
+/**
+ * Compares Karatsuba and schoolbook multiplication on squaring a number
+ *
+ * @param exp The exponent of the base 3 number to square
+ */
+void bench_square(uint64_t exp)
+{
+    BigInt* three = bigint_from_int(3);
+    BigInt* a = bigint_pow(three, exp);
+
+    double start = now();
+    BigInt* fast = bigint_mul(a, a);
+    double mid = now();
+    uint32_t* slow = (uint32_t*) malloc(2 * a->size * sizeof(uint32_t));
+    mag_mul_schoolbook(a->limbs, a->size, a->limbs, a->size, slow);
+    double end = now();
+
+    printf("3^%-8" PRIu64 " squared (%6d limbs)   karatsuba %8.3f ms   "
+           "schoolbook %8.3f ms   %s\n", exp, a->size,
+           (mid - start) * 1e3, (end - mid) * 1e3,
+           memcmp(fast->limbs, slow, fast->size * sizeof(uint32_t)) ? 
+           "MISMATCH" : "ok");
+
+    free(slow);
+    bigint_free(fast);
+    bigint_free(a);
+    bigint_free(three);
+}
+
+/**
+ * Times a factorial-like product of consecutive integers
+ *
+ * @param n The number of factors
+ */
+void bench_factorial(int n)
+{
+    double start = now();
+
+    BigInt* acc = bigint_from_int(1);
+    for (int k = 2; k <= n; k++)
+    {
+        BigInt* f = bigint_from_int(k);
+        BigInt* t = bigint_mul(acc, f);
+        bigint_free(acc);
+        bigint_free(f);
+        acc = t;
+    }
+
+    printf("%d! (%d limbs)   %8.3f ms\n", n, acc->size, (now() - start) * 1e3);
+    bigint_free(acc);
+}
+
+int main()
+{
+    bench_expression("2^100000");
+    bench_expression("3^200000");
+    bench_expression("7^1000000");
+
+    bench_square(20000);
+    bench_square(100000);
+    bench_square(500000);
+
+    bench_factorial(20000);
+    return 0;
+}
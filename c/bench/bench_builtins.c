@@ -0,0 +1,122 @@
+/**
+ * Benchmark of the batch implementations of the built-in functions
+ * against plain libm calls
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -march=native -o bench_builtins bench/bench_builtins.c bench/bench.c builtins.c -lm```
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../builtins.h"
+#include "bench.h"
+
+// Number of arguments of each run
+#define N_VALUES (1 << 20)
+
+// Number of runs of each implementation
+#define N_RUNS 20
+
+/**
+ * Obtains the distance between two doubles in units in the last place
+ *
+ * @param a The first double
+ * @param b The second double
+ *
+ * @return The distance
+ */
+double ulp_distance(double a, double b)
+{
+    if (a == b || (isnan(a) && isnan(b)))
+        return 0;
+    if (isnan(a) || isnan(b) || isinf(a) || isinf(b))
+        return INFINITY;
+
+    int64_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+
+    // Map the sign-magnitude patterns to a monotonic integer scale
+    if (ia < 0)
+        ia = INT64_MIN - ia;
+    if (ib < 0)
+        ib = INT64_MIN - ib;
+    if ((ia < 0) != (ib < 0))
+        return fabs((double) ia) + fabs((double) ib);
+    return (double) llabs(ia - ib);
+}
+
+/**
+ * Times the batch and libm versions of a built-in function over random
+ * arguments, and reports the largest difference between them
+ *
+ * @param id The function
+ * @param lo The lower bound of the arguments
+ * @param hi The upper bound of the arguments
+ */
+void bench_builtin(BuiltinId id, double lo, double hi)
+{
+    const Builtin* b = &Builtins[id];
+    double* x = (double*) malloc(N_VALUES * sizeof(double));
+    double* y = (double*) malloc(N_VALUES * sizeof(double));
+    double* scalar = (double*) malloc(N_VALUES * sizeof(double));
+    double* batch = (double*) malloc(N_VALUES * sizeof(double));
+
+    srand(42);
+    for (int k = 0; k < N_VALUES; k++)
+    {
+        x[k] = lo + (hi - lo) * rand() / (double) RAND_MAX;
+        y[k] = lo + (hi - lo) * rand() / (double) RAND_MAX;
+    }
+
+    double start = now();
+    for (int run = 0; run < N_RUNS; run++)
+    {
+        for (int k = 0; k < N_VALUES; k++)
+            scalar[k] = b->scalar(x[k], y[k]);
+    }
+    double mid = now();
+    for (int run = 0; run < N_RUNS; run++)
+        eval_builtin_batch(id, x, y, batch, N_VALUES);
+    double end = now();
+
+    double max_ulp = 0;
+    for (int k = 0; k < N_VALUES; k++)
+    {
+        double d = ulp_distance(scalar[k], batch[k]);
+        if (d > max_ulp)
+            max_ulp = d;
+    }
+
+    double per_value = 1e9 / ((double) N_RUNS * N_VALUES);
+    printf("%-6s [%9.3g, %9.3g]   libm %6.2f ns   batch %6.2f ns   "
+           "x%5.2f   max error %g ulp\n", b->name, lo, hi,
+           (mid - start) * per_value, (end - mid) * per_value,
+           (mid - start) / (end - mid), max_ulp);
+
+    free(x);
+    free(y);
+    free(scalar);
+    free(batch);
+}
+
+int main()
+{
+    bench_builtin(BI_SQRT, 0, 1e6);
+    bench_builtin(BI_EXP, -700, 700);
+    bench_builtin(BI_EXP, -1, 1);
+    bench_builtin(BI_LOG, 1e-300, 1e300);
+    bench_builtin(BI_LOG, 0.5, 2);
+    bench_builtin(BI_SIN, -100, 100);
+    bench_builtin(BI_SIN, -1e6, 1e6);
+    bench_builtin(BI_COS, -100, 100);
+    bench_builtin(BI_ABS, -1e6, 1e6);
+    bench_builtin(BI_MIN, -1e6, 1e6);
+    bench_builtin(BI_MAX, -1e6, 1e6);
+    bench_builtin(BI_FLOOR, -1e6, 1e6);
+    return 0;
+}
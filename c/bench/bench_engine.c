@@ -0,0 +1,95 @@
+/**
+ * Benchmark of several threads evaluating code, each with its own engine,
+ * against a single thread doing all the work
+ *
+ * Build the library as described in ```engine.c```, then build from the
+ * ```c``` directory with:
+ * ```gcc -O2 -o bench_engine bench/bench_engine.c bench/bench.c -L. -lengine -lm -lpthread```
+ */
+
+#include <unistd.h>
+#include <pthread.h>
+
+#include "../engine.h"
+#include "bench.h"
+
+// Number of lines evaluated by each thread
+#define N_LINES 20000
+
+// Maximum number of threads
+#define MAX_THREADS 64
+
+// Number of runs of each version, of which the fastest is kept
+#define N_RUNS 3
+
+/**
+ * Evaluates the lines of a thread with an engine of its own: a memoized
+ * function, a loop and arithmetic on its variables
+ *
+ * @param arg Where to store the sum of the values, as a ```double```
+ *
+ * @return ```NULL```
+ */
+void* run_thread(void* arg)
+{
+    Engine* e = new_engine(NULL);
+    double sum = 0;
+
+    free_value(engine_eval(e, "memo fun f(n) = if n < 2 then n else f(n - 1) + f(n - 2)"));
+    for (int k = 0; k < N_LINES; k++)
+    {
+        const char* text = (k % 2 == 0) ?
+            "x = f(30) + (s = 0; for j = 1 to 50 do s = s + j * j)" :
+            "x * 0.5 - sqrt(x)";
+        DataType* value = engine_eval(e, text);
+        if (value)
+        {
+            sum += (value->type == FLOAT) ? value->value.decimal : (double) value->value.integer;
+            free_value(value);
+        }
+    }
+
+    *(double*) arg = sum;
+    free_engine(e);
+    return NULL;
+}
+
+/**
+ * Times a number of threads evaluating their lines at the same time
+ *
+ * @param n_threads The number of threads
+ */
+void bench_threads(int n_threads)
+{
+    pthread_t threads[MAX_THREADS];
+    double sums[MAX_THREADS];
+    double best = INFINITY;
+
+    for (int run = 0; run < N_RUNS; run++)
+    {
+        double start = now();
+        for (int k = 0; k < n_threads; k++)
+            pthread_create(&threads[k], NULL, run_thread, &sums[k]);
+        for (int k = 0; k < n_threads; k++)
+            pthread_join(threads[k], NULL);
+        best = fmin(best, now() - start);
+    }
+
+    // Every engine evaluates the same lines, so the sums must match
+    int ok = 1;
+    for (int k = 1; k < n_threads; k++)
+        ok &= sums[k] == sums[0];
+
+    printf("%2d threads %9.3f ms   %10.0f lines/s   %s\n", n_threads,
+           best * 1e3, n_threads * N_LINES / best, ok ? "ok" : "MISMATCH");
+}
+
+int main()
+{
+    long n_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = (n_cores < MAX_THREADS / 2) ? 2 * (int) n_cores : MAX_THREADS;
+
+    for (int n_threads = 1; n_threads <= max_threads; n_threads *= 2)
+        bench_threads(n_threads);
+    return 0;
+}
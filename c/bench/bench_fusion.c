@@ -0,0 +1,157 @@
+/**
+ * Benchmark of arithmetic rewritten into fused operations and shape
+ * kernels against the same arithmetic evaluated one operation at a time
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o bench_fusion bench/bench_fusion.c bench/bench.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c -lm -lpthread```
+ *
+ * Add ```-DFUSE_CONTRACT=1``` to include the multiply-adds
+ */
+
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../interpreter.h"
+#include "../typing.h"
+#include "../fusion.h"
+#include "bench.h"
+
+// Number of iterations of each loop
+#define N_STEPS "1000000"
+
+// Number of runs of each version, of which the fastest is kept
+#define N_RUNS 5
+
+/**
+ * Counts the fused nodes of a typed AST
+ *
+ * @param node The root of the AST
+ *
+ * @return The number of fused nodes
+ */
+int count_fused(const ASTNode* node)
+{
+    const NodeData* data = &node->data;
+    int count = 0;
+    switch (node->class)
+    {
+    case UnOp:
+        return count_fused(data->unary.value);
+
+    case BinOp:
+        return count_fused(data->binary.left) + count_fused(data->binary.right);
+
+    case VarAssign:
+        return count_fused(data->assign.value);
+
+    case Convert:
+        return count_fused(data->convert.value);
+
+    case Sequence:
+        for (int k = 0; k < data->sequence.count; k++)
+            count += count_fused(data->sequence.items[k]);
+        return count;
+
+    case For:
+        return count_fused(data->range.body);
+
+    case Invariant:
+        return count_fused(data->invariant.value);
+
+    case Fused:
+        for (int k = 0; k < data->fused.count; k++)
+            count += count_fused(data->fused.operands[k]);
+        return count + 1;
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Times a program with and without its operations fused
+ *
+ * @param name The name of the case
+ * @param text The program, whose value is compared between both runs
+ */
+void bench_formula(const char* name, const char* text)
+{
+    double times[2];
+    double results[2];
+    int n_fused = 0;
+
+    for (int fused = 0; fused <= 1; fused++)
+    {
+        SymbolTable symbols = new_symbol_table();
+        Environment env = new_environment();
+        FunctionTable functions = new_function_table();
+
+        Lexer l = new_lexer(text);
+        LexerResult lr = tokenize(&l);
+        Parser p = new_parser(lr, &symbols);
+        ParserResult pr = parse(&p);
+        ASTNode* ast = check_types(pr.root, &symbols, &env, &functions).root;
+        if (fused)
+        {
+            ast = fuse_operations(ast);
+            n_fused = count_fused(ast);
+        }
+
+        times[fused] = INFINITY;
+        for (int run = 0; run < N_RUNS; run++)
+        {
+            Interpreter i = new_interpreter(ast, &env);
+            double start = now();
+            DataType* result = interpret(&i).result;
+            times[fused] = fmin(times[fused], now() - start);
+
+            results[fused] = (result->type == FLOAT) ?
+                result->value.decimal : (double) result->value.integer;
+            free_value(result);
+        }
+
+        free_node(ast);
+        free_lexer_result(&lr);
+        free_function_table(&functions);
+        free_environment(&env);
+        free_symbol_table(&symbols);
+    }
+
+    // Multiply-adds are rounded once, so their results may differ slightly
+    printf("%-10s plain %8.3f ms   fused %8.3f ms   x%5.2f   "
+           "(%d fused)   %s\n", name, times[0] * 1e3, times[1] * 1e3,
+           times[0] / times[1], n_fused,
+           (results[0] == results[1]) ? "ok" : "rounded");
+}
+
+int main()
+{
+    // Sums of several terms
+    bench_formula("sum",
+        "s = 0; for k = 1 to " N_STEPS " do s = s + k + 2 * k + 3");
+
+    // Squares and cubes of the counter
+    bench_formula("powers",
+        "s = 0; for k = 1 to " N_STEPS " do s = k^2 - k * k * k");
+
+    // Evaluation of a polynomial in Horner form
+    bench_formula("horner",
+        "s = 0.0; for k = 1 to " N_STEPS " do "
+        "(x = k / " N_STEPS "; s = s + ((2.0 * x + 3.0) * x - 1.5) * x + 0.5)");
+
+    // Shapes with a kernel, on integers and on floats
+    bench_formula("muladd",
+        "s = 0; for k = 1 to " N_STEPS " do s = s + (k * 3 + 1) * (k - 2)");
+
+    bench_formula("dot",
+        "s = 0.0; for k = 1 to " N_STEPS " do "
+        "(x = k * 0.5; s = s + (x * x - x * 0.25))");
+
+    bench_formula("ratio",
+        "s = 0.0; for k = 1 to " N_STEPS " do s = s + (k + 0.5) / (k - 0.25)");
+
+    // Arithmetic with nothing to fuse, which should be unaffected
+    bench_formula("none",
+        "s = 0.0; for k = 1 to " N_STEPS " do s = s + k / (k + 1)");
+    return 0;
+}
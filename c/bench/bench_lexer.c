@@ -0,0 +1,158 @@
+/**
+ * Benchmark of the lexical analysis of a large text split among several
+ * threads against the sequential analysis
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o bench_lexer bench/bench_lexer.c bench/bench.c bigint.c numconv.c strbuf.c symbols.c base.c lexer.c builtins.c -lm -lpthread```
+ *
+ * Run as ```./bench_lexer [threads]```, by default one per core
+ */
+
+#include <unistd.h>
+
+#include "../lexer.h"
+#include "../numconv.h"
+#include "bench.h"
+
+// Size of the generated text, in characters
+#define TEXT_LEN (16 << 20)
+
+// Number of runs of each version, of which the fastest is kept
+#define N_RUNS 3
+
+/**
+ * Generates a program with every kind of token, spread over many lines
+ *
+ * @param len The length of the program
+ *
+ * @return The program
+ */
+char* generate_text(int len)
+{
+    const char* lines[] = {
+        "x1 = 3.25 * (y_2 - 17) ^ 2;\n",
+        "fun f(a, b) = if a <= b then a % 7 else b / 2.5\n",
+        "\tfor i = 1 to 100 do s = s + i >= 3 and not q != 0\n",
+        "memo fun g(n) = g(n - 1) + g(n - 2)   ;  z == w or w < 1e\n",
+        "while k > 0 do (k = k - 1; total = total + sqrt(k))\n",
+    };
+    int n_lines = sizeof(lines) / sizeof(lines[0]);
+
+    char* text = (char*) malloc(len + 1);
+    int pos = 0;
+    for (int k = 0; ; k++)
+    {
+        int n = strlen(lines[k % n_lines]);
+        if (pos + n > len)
+            break;
+        memcpy(text + pos, lines[k % n_lines], n);
+        pos += n;
+    }
+    text[pos] = '\0';
+    return text;
+}
+
+/**
+ * Writes a position to a buffer
+ *
+ * @param b The buffer
+ * @param pos The position
+ */
+void format_pos(StrBuf* b, Position pos)
+{
+    char digits[24];
+    str_buf_append(b, digits, format_int(pos.row, digits));
+    str_buf_append_char(b, ':');
+    str_buf_append(b, digits, format_int(pos.col, digits));
+}
+
+/**
+ * Writes the outcome of an analysis: every token with its position, or
+ * the error
+ *
+ * @param b The buffer
+ * @param r The result
+ */
+void format_result(StrBuf* b, const LexerResult* r)
+{
+    if (r->tokens == NULL && r->size != 0)
+    {
+        format_error(b, r->err);
+        return;
+    }
+
+    for (int k = 0; k < r->size; k++)
+    {
+        format_token(b, r->tokens[k]);
+        str_buf_append_char(b, '@');
+        format_pos(b, r->tokens[k]->pos);
+        str_buf_append_char(b, ' ');
+    }
+}
+
+/**
+ * Analyzes a text sequentially and in parallel
+ *
+ * @param name The name of the case
+ * @param text The text
+ * @param n_threads The number of threads of the parallel analysis
+ */
+void bench_text(const char* name, const char* text, int n_threads)
+{
+    double times[2];
+    StrBuf outputs[2];
+
+    for (int parallel = 0; parallel <= 1; parallel++)
+    {
+        times[parallel] = INFINITY;
+        outputs[parallel] = new_str_buf(1 << 20);
+        for (int run = 0; run < N_RUNS; run++)
+        {
+            Lexer l = new_lexer(text);
+            double start = now();
+            LexerResult r = (parallel) ? tokenize_parallel(&l, n_threads) : tokenize(&l);
+            times[parallel] = fmin(times[parallel], now() - start);
+
+            // Both versions must give the same tokens or the same error
+            if (run == 0)
+                format_result(&outputs[parallel], &r);
+            if (r.tokens)
+                free_lexer_result(&r);
+        }
+    }
+
+    printf("%-12s sequential %8.3f ms   parallel %8.3f ms   x%5.2f   %s\n",
+           name, times[0] * 1e3, times[1] * 1e3, times[0] / times[1],
+           (strcmp(outputs[0].data, outputs[1].data) == 0) ? "ok" : "MISMATCH");
+
+    free_str_buf(&outputs[0]);
+    free_str_buf(&outputs[1]);
+}
+
+int main(int argc, char** argv)
+{
+    int n_threads = (argc > 1) ? atoi(argv[1]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    printf("%d threads\n", n_threads);
+
+    char* text = generate_text(TEXT_LEN);
+    int len = strlen(text);
+    bench_text("valid", text, n_threads);
+
+    // Two errors in different chunks, of which the first must be reported
+    const char* errors[][2] = {
+        { "char", "$" },
+        { "bang", "! " },
+        { "number", "1.2.3" },
+    };
+    for (size_t k = 0; k < sizeof(errors) / sizeof(errors[0]); k++)
+    {
+        char* copy = strdup(text);
+        memcpy(copy + len - len / 7, errors[k][1], strlen(errors[k][1]));
+        memcpy(copy + len - len / 3, errors[k][1], strlen(errors[k][1]));
+        bench_text(errors[k][0], copy, n_threads);
+        free(copy);
+    }
+
+    free(text);
+    return 0;
+}
@@ -0,0 +1,157 @@
+/**
+ * Benchmark of loops with their invariant subexpressions hoisted by the
+ * typing pass against the same loops evaluating them on every iteration
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o bench_licm bench/bench_licm.c bench/bench.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c parallel.c interpreter.c -lm -lpthread```
+ */
+
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../interpreter.h"
+#include "../typing.h"
+#include "bench.h"
+
+// Number of iterations of each loop
+#define N_STEPS "1000000"
+
+// Number of runs of each version, of which the fastest is kept
+#define N_RUNS 5
+
+/**
+ * Replaces the invariant nodes of a typed AST with their subexpressions
+ *
+ * @param node The root of the AST, which may be replaced
+ *
+ * @return The number of invariant nodes removed
+ */
+int strip_invariants(ASTNode** node)
+{
+    NodeData* data = &(*node)->data;
+    int count = 0;
+    switch ((*node)->class)
+    {
+    case UnOp:
+        return strip_invariants(&data->unary.value);
+
+    case BinOp:
+        count += strip_invariants(&data->binary.left);
+        return count + strip_invariants(&data->binary.right);
+
+    case VarAssign:
+        return strip_invariants(&data->assign.value);
+
+    case Convert:
+        return strip_invariants(&data->convert.value);
+
+    case Call:
+        for (int k = 0; k < data->call.n_args; k++)
+            count += strip_invariants(&data->call.args[k]);
+        return count;
+
+    case Sequence:
+        for (int k = 0; k < data->sequence.count; k++)
+            count += strip_invariants(&data->sequence.items[k]);
+        return count;
+
+    case Cond:
+        count += strip_invariants(&data->cond.cond);
+        count += strip_invariants(&data->cond.if_true);
+        return count + strip_invariants(&data->cond.if_false);
+
+    case While:
+        data->loop.n_invariants = 0;
+        count += strip_invariants(&data->loop.cond);
+        return count + strip_invariants(&data->loop.body);
+
+    case For:
+        data->range.n_invariants = 0;
+        count += strip_invariants(&data->range.start);
+        count += strip_invariants(&data->range.end);
+        return count + strip_invariants(&data->range.body);
+
+    case Invariant:
+    {
+        ASTNode* invariant = *node;
+        *node = data->invariant.value;
+        free(invariant);
+        return 1 + strip_invariants(node);
+    }
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Times a program with and without its loop invariants hoisted
+ *
+ * @param name The name of the case
+ * @param text The program, whose value is compared between both runs
+ */
+void bench_loop(const char* name, const char* text)
+{
+    SymbolTable symbols = new_symbol_table();
+    Environment env = new_environment();
+    FunctionTable functions = new_function_table();
+
+    Lexer l = new_lexer(text);
+    LexerResult lr = tokenize(&l);
+    Parser p = new_parser(lr, &symbols);
+    ParserResult pr = parse(&p);
+    ASTNode* ast = check_types(pr.root, &symbols, &env, &functions).root;
+
+    double times[2];
+    DataType* results[2];
+    int n_invariants = 0;
+    for (int hoisted = 1; hoisted >= 0; hoisted--)
+    {
+        if (!hoisted)
+            n_invariants = strip_invariants(&ast);
+
+        times[hoisted] = INFINITY;
+        for (int run = 0; run < N_RUNS; run++)
+        {
+            if (run > 0)
+                free_value(results[hoisted]);
+
+            Interpreter i = new_interpreter(ast, &env);
+            double start = now();
+            results[hoisted] = interpret(&i).result;
+            times[hoisted] = fmin(times[hoisted], now() - start);
+        }
+    }
+
+    printf("%-10s plain %8.3f ms   hoisted %8.3f ms   x%5.2f   "
+           "(%d invariants)   %s\n", name, times[0] * 1e3, times[1] * 1e3,
+           times[0] / times[1], n_invariants,
+           (results[0]->value.decimal == results[1]->value.decimal) ?
+           "ok" : "MISMATCH");
+
+    free_value(results[0]);
+    free_value(results[1]);
+    free_node(ast);
+    free_lexer_result(&lr);
+    free_function_table(&functions);
+    free_environment(&env);
+    free_symbol_table(&symbols);
+}
+
+int main()
+{
+    // Sum of a series with a constant factor
+    bench_loop("series",
+        "a = 3.0; b = 4.0; s = 0.0; "
+        "for k = 1 to " N_STEPS " do s = s + sqrt(a * a + b * b) / k^2");
+
+    // Fixed-point iteration of a function with a constant parameter
+    bench_loop("function",
+        "fun step(x, c) = (x + c / x) / 2; c = 2.0; x = 1.0; n = 0; "
+        "while n < " N_STEPS " do (n = n + 1; x = step(x, c * c - c))");
+
+    // Loop with nothing to hoist, which should be unaffected
+    bench_loop("none",
+        "s = 0.0; for k = 1 to " N_STEPS " do s = s + k / (k + 1)");
+    return 0;
+}
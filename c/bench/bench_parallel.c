@@ -0,0 +1,151 @@
+/**
+ * Benchmark of huge expressions evaluated with their independent
+ * subtrees forked to a pool of workers against sequential evaluation
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o bench_parallel bench/bench_parallel.c bench/bench.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c -lm -lpthread```
+ */
+
+#include <unistd.h>
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../interpreter.h"
+#include "../typing.h"
+#include "../fusion.h"
+#include "../parallel.h"
+#include "bench.h"
+
+// Number of leaves of the generated expressions
+#define N_LEAVES 200000
+
+// Number of runs of each version, of which the fastest is kept
+#define N_RUNS 5
+
+/**
+ * Writes a balanced expression over a range of leaves. Sums and products
+ * alternate by depth, and every leaf calls a built-in function
+ *
+ * @param b The buffer
+ * @param first The index of the first leaf
+ * @param count The number of leaves
+ * @param depth The depth of the expression in the whole tree
+ * @param fail The index of a leaf that divides by zero, or ```-1```
+ */
+void write_tree(StrBuf* b, int first, int count, int depth, int fail)
+{
+    if (count == 1)
+    {
+        if (first == fail)
+            str_buf_append_str(b, "x / 0");
+        else
+            str_buf_append_str(b, (first % 2) ? "sin(x)" : "cos(x)");
+        return;
+    }
+
+    int half = count / 2;
+    str_buf_append_char(b, '(');
+    write_tree(b, first, half, depth + 1, fail);
+    str_buf_append_str(b, (depth % 2) ? " * " : " + ");
+    write_tree(b, first + half, count - half, depth + 1, fail);
+    str_buf_append_char(b, ')');
+}
+
+/**
+ * Runs a program sequentially and with a pool
+ *
+ * @param name The name of the case
+ * @param text The program
+ * @param pool The pool
+ *
+ * @return Boolean-like value, false if the versions differ or no
+ * operation was forked
+ */
+int bench_program(const char* name, const char* text, ThreadPool* pool)
+{
+    double times[2];
+    StrBuf outputs[2];
+    int n_forks = 0;
+
+    SymbolTable symbols = new_symbol_table();
+    Environment env = new_environment();
+    FunctionTable functions = new_function_table();
+
+    Lexer l = new_lexer(text);
+    LexerResult lr = tokenize(&l);
+    Parser p = new_parser(lr, &symbols);
+    ParserResult pr = parse(&p);
+    ASTNode* ast = check_types(pr.root, &symbols, &env, &functions).root;
+    ast = fuse_operations(ast);
+
+    for (int forked = 0; forked <= 1; forked++)
+    {
+        if (forked)
+            n_forks = plan_forks(ast);
+
+        times[forked] = INFINITY;
+        outputs[forked] = new_str_buf(64);
+        for (int run = 0; run < N_RUNS; run++)
+        {
+            Interpreter i = new_interpreter(ast, &env);
+            i.pool = (forked) ? pool : NULL;
+            double start = now();
+            Result r = interpret(&i);
+            times[forked] = fmin(times[forked], now() - start);
+
+            // Both versions must give the same value or the same error
+            if (run == 0)
+            {
+                if (r.result)
+                    format_value(&outputs[forked], r.result);
+                else
+                    format_error(&outputs[forked], r.err);
+            }
+            if (r.result)
+                free_value(r.result);
+        }
+    }
+
+    // A tree without forks would only time sequential evaluation twice
+    int same = strcmp(outputs[0].data, outputs[1].data) == 0;
+    printf("%-8s sequential %8.3f ms   forked %8.3f ms   x%5.2f   "
+           "(%d forks)   %s\n", name, times[0] * 1e3, times[1] * 1e3,
+           times[0] / times[1], n_forks,
+           !same ? "MISMATCH" : (n_forks == 0) ? "NO FORKS" : "ok");
+
+    free_str_buf(&outputs[0]);
+    free_str_buf(&outputs[1]);
+    free_node(ast);
+    free_lexer_result(&lr);
+    free_function_table(&functions);
+    free_environment(&env);
+    free_symbol_table(&symbols);
+    return same && n_forks > 0;
+}
+
+int main()
+{
+    long n_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    ThreadPool* pool = new_thread_pool((int) n_cores);
+    printf("%ld workers\n", n_cores);
+
+    StrBuf b = new_str_buf(1 << 20);
+    int ok = 1;
+
+    // Pure arithmetic over a variable
+    str_buf_append_str(&b, "x = 0.5; ");
+    write_tree(&b, 0, N_LEAVES, 0, -1);
+    ok &= bench_program("pure", b.data, pool);
+
+    // Two leaves fail, and the leftmost error must be reported either way
+    b.len = 0;
+    str_buf_append_str(&b, "x = 0.5; ");
+    write_tree(&b, 0, N_LEAVES, 0, N_LEAVES - 1);
+    str_buf_append_str(&b, " + ");
+    write_tree(&b, 0, N_LEAVES, 0, N_LEAVES / 3);
+    ok &= bench_program("errors", b.data, pool);
+
+    free_str_buf(&b);
+    free_thread_pool(pool);
+    return !ok;
+}
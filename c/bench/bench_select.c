@@ -0,0 +1,152 @@
+/**
+ * Benchmark of conditionals evaluated with a branch against the
+ * branch-free select chosen by the typing pass for small branches
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o bench_select bench/bench_select.c bench/bench.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c parallel.c interpreter.c -lm -lpthread```
+ */
+
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../interpreter.h"
+#include "../typing.h"
+#include "bench.h"
+
+// Number of conditionals evaluated by each run
+#define N_STEPS "1000000"
+
+// Maximum number of selects toggled in a function
+#define MAX_SELECTS 16
+
+/**
+ * Collects the conditionals of a typed AST that are evaluated as selects
+ *
+ * @param node The root of the AST
+ * @param selects Where to store the conditionals
+ * @param count The number of conditionals stored, which is incremented
+ */
+void collect_selects(ASTNode* node, CondNode** selects, int* count)
+{
+    NodeData* data = &node->data;
+    switch (node->class)
+    {
+    case UnOp:
+        collect_selects(data->unary.value, selects, count);
+        break;
+
+    case BinOp:
+        collect_selects(data->binary.left, selects, count);
+        collect_selects(data->binary.right, selects, count);
+        break;
+
+    case Convert:
+        collect_selects(data->convert.value, selects, count);
+        break;
+
+    case Call:
+        for (int k = 0; k < data->call.n_args; k++)
+            collect_selects(data->call.args[k], selects, count);
+        break;
+
+    case Cond:
+        collect_selects(data->cond.cond, selects, count);
+        collect_selects(data->cond.if_true, selects, count);
+        collect_selects(data->cond.if_false, selects, count);
+        if (data->cond.select && *count < MAX_SELECTS)
+            selects[(*count)++] = &data->cond;
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Types a line of code and adds its functions to a table
+ *
+ * @param text The code
+ * @param symbols The symbol table of the session
+ * @param env The environment of the session
+ * @param functions The function table of the session
+ * @param lr Where to store the tokens, which the AST refers to
+ *
+ * @return The typed AST
+ */
+ASTNode* compile(const char* text, SymbolTable* symbols, Environment* env,
+                 FunctionTable* functions, LexerResult* lr)
+{
+    Lexer l = new_lexer(text);
+    *lr = tokenize(&l);
+    Parser p = new_parser(*lr, symbols);
+    ParserResult pr = parse(&p);
+    return check_types(pr.root, symbols, env, functions).root;
+}
+
+/**
+ * Times a recursive function that evaluates a conditional on each step,
+ * with and without selects
+ *
+ * @param name The name of the case
+ * @param def The definition of the function ```run(n, s, acc)```
+ */
+void bench_conditional(const char* name, const char* def)
+{
+    SymbolTable symbols = new_symbol_table();
+    Environment env = new_environment();
+    FunctionTable functions = new_function_table();
+    LexerResult def_tokens, run_tokens;
+
+    ASTNode* def_ast = compile(def, &symbols, &env, &functions, &def_tokens);
+    ASTNode* run_ast = compile("run(" N_STEPS ", 12345, 0)", &symbols, &env,
+                               &functions, &run_tokens);
+
+    Function* run = find_function(&functions, run_ast->data.call.symbol);
+    CondNode* selects[MAX_SELECTS];
+    int n_selects = 0;
+    for (Specialization* spec = run->specs; spec; spec = spec->next)
+        collect_selects(spec->body, selects, &n_selects);
+
+    double times[2];
+    DataType* results[2];
+    for (int select = 0; select <= 1; select++)
+    {
+        for (int k = 0; k < n_selects; k++)
+            selects[k]->select = select;
+
+        Interpreter i = new_interpreter(run_ast, &env);
+        double start = now();
+        results[select] = interpret(&i).result;
+        times[select] = now() - start;
+    }
+
+    printf("%-14s branch %8.3f ms   select %8.3f ms   x%5.2f   "
+           "(%d selects)   %s\n", name, times[0] * 1e3, times[1] * 1e3,
+           times[0] / times[1], n_selects,
+           (results[0]->value.integer == results[1]->value.integer) ?
+           "ok" : "MISMATCH");
+
+    free_value(results[0]);
+    free_value(results[1]);
+    free_node(run_ast);
+    free_node(def_ast);
+    free_lexer_result(&run_tokens);
+    free_lexer_result(&def_tokens);
+    free_function_table(&functions);
+    free_environment(&env);
+    free_symbol_table(&symbols);
+}
+
+int main()
+{
+    // A linear congruential generator provides the conditions
+    bench_conditional("random",
+        "fun run(n, s, acc) = if n == 0 then acc else run(n - 1, "
+        "(s * 1103515245 + 12345) % 2147483648, "
+        "acc + (if s % 1048576 < 524288 then n * 3 else acc % 7 - n))");
+    bench_conditional("predictable",
+        "fun run(n, s, acc) = if n == 0 then acc else run(n - 1, "
+        "(s * 1103515245 + 12345) % 2147483648, "
+        "acc + (if s >= 0 then n * 3 else acc % 7 - n))");
+    return 0;
+}
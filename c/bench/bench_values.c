@@ -0,0 +1,171 @@
+/**
+ * Benchmark of NaN-boxed values against values allocated as DataType,
+ * for the storage of variables: assigning values to slots, reading them
+ * as machine values and copying them out as data
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o bench_values bench/bench_values.c bench/bench.c bigint.c numconv.c strbuf.c base.c value.c builtins.c -lm```
+ */
+
+#include <malloc.h>
+
+#include "../value.h"
+#include "bench.h"
+
+// Number of slots
+#define N_SLOTS (1 << 20)
+
+// Number of passes over the slots per run
+#define N_PASSES 20
+
+// Number of runs of each version, of which the fastest is kept
+#define N_RUNS 5
+
+/**
+ * Assigns the slots, half integers and half doubles, as assignments did
+ * with DataType: the previous value is freed and a copy is allocated
+ */
+void assign_data(DataType** slots, int pass)
+{
+    for (int k = 0; k < N_SLOTS; k++)
+    {
+        if (slots[k])
+            free_value(slots[k]);
+        slots[k] = (k % 2) ? new_float(k * 0.5 + pass) : new_int(k + pass);
+    }
+}
+
+/**
+ * Assigns the slots as ```assign_data```, with NaN-boxed values
+ */
+void assign_values(Value* slots, int pass)
+{
+    for (int k = 0; k < N_SLOTS; k++)
+    {
+        release_value(slots[k]);
+        slots[k] = (k % 2) ? box_float(k * 0.5 + pass) : box_int(k + pass);
+    }
+}
+
+/**
+ * Reads the slots as machine values, checking their types
+ */
+double read_data(DataType* const* slots)
+{
+    double sum = 0;
+    for (int k = 0; k < N_SLOTS; k++)
+    {
+        const DataType* v = slots[k];
+        sum += (v->type == FLOAT) ? v->value.decimal : (double) v->value.integer;
+    }
+    return sum;
+}
+
+/**
+ * Reads the slots as ```read_data```, with NaN-boxed values
+ */
+double read_values(const Value* slots)
+{
+    double sum = 0;
+    for (int k = 0; k < N_SLOTS; k++)
+    {
+        Value v = slots[k];
+        sum += is_float_value(v) ? unbox_float(v) : (double) unbox_small_int(v);
+    }
+    return sum;
+}
+
+/**
+ * Copies the slots out as data, as variable accesses do
+ */
+double copy_data(DataType* const* slots)
+{
+    double sum = 0;
+    for (int k = 0; k < N_SLOTS; k++)
+    {
+        DataType* v = copy_value(slots[k]);
+        sum += v->type;
+        free_value(v);
+    }
+    return sum;
+}
+
+/**
+ * Copies the slots out as ```copy_data```, with NaN-boxed values
+ */
+double copy_values(const Value* slots)
+{
+    double sum = 0;
+    for (int k = 0; k < N_SLOTS; k++)
+    {
+        DataType* v = unbox_data(slots[k]);
+        sum += v->type;
+        free_value(v);
+    }
+    return sum;
+}
+
+int main()
+{
+    DataType** data = (DataType**) calloc(N_SLOTS, sizeof(DataType*));
+    Value* values = (Value*) malloc(N_SLOTS * sizeof(Value));
+    unset_values(values, N_SLOTS);
+
+    const char* names[3] = { "assign", "read", "copy out" };
+    double best[3][2];
+    double check[3][2] = { { 0 } };
+    for (int op = 0; op < 3; op++)
+        best[op][0] = best[op][1] = 1e30;
+
+    for (int run = 0; run < N_RUNS; run++)
+    {
+        for (int op = 0; op < 3; op++)
+        {
+            for (int version = 0; version < 2; version++)
+            {
+                double start = now();
+                for (int pass = 0; pass < N_PASSES; pass++)
+                {
+                    if (op == 0 && version == 0)
+                        assign_data(data, pass);
+                    else if (op == 0)
+                        assign_values(values, pass);
+                    else if (op == 1 && version == 0)
+                        check[op][version] += read_data(data);
+                    else if (op == 1)
+                        check[op][version] += read_values(values);
+                    else if (version == 0)
+                        check[op][version] += copy_data(data);
+                    else
+                        check[op][version] += copy_values(values);
+                }
+                double elapsed = (now() - start) / N_PASSES;
+                if (elapsed < best[op][version])
+                    best[op][version] = elapsed;
+            }
+        }
+    }
+
+    printf("%d slots, %d passes, best of %d runs\n", N_SLOTS, N_PASSES, N_RUNS);
+    printf("%-10s %12s %12s %8s\n", "", "DataType*", "Value", "speedup");
+    for (int op = 0; op < 3; op++)
+    {
+        printf("%-10s %9.2f ns %9.2f ns %7.2fx%s\n", names[op],
+               best[op][0] * 1e9 / N_SLOTS, best[op][1] * 1e9 / N_SLOTS,
+               best[op][0] / best[op][1],
+               (check[op][0] == check[op][1]) ? "" : "  (results differ)");
+    }
+
+    // Allocated values also take the header of their block
+    size_t data_bytes = sizeof(DataType*) + malloc_usable_size(data[0]) + sizeof(size_t);
+    printf("storage    %9zu B  %9zu B\n", data_bytes, sizeof(Value));
+
+    for (int k = 0; k < N_SLOTS; k++)
+    {
+        free_value(data[k]);
+        release_value(values[k]);
+    }
+    free(data);
+    free(values);
+    return 0;
+}
@@ -0,0 +1,264 @@
+/**
+ * Load generator for the evaluation server. Several clients send requests
+ * over their own connections, each waiting for a response before the next
+ * request, and the latencies of all of them are reported
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o loadgen bench/loadgen.c bench/bench.c ring.c strbuf.c -lpthread```
+ *
+ * Start the server with ```./console --serve /tmp/mc.sock``` and run
+ * ```./loadgen /tmp/mc.sock [clients] [requests] [code]```, or with
+ * ```./console --ring /mc``` and run ```./loadgen --ring /mc ...```
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../ring.h"
+#include "bench.h"
+
+// Default number of concurrent clients
+#define N_CLIENTS 8
+
+// Default number of requests of each client
+#define N_REQUESTS 10000
+
+// Default code of the requests
+#define DEFAULT_CODE "x = 12345; (x * x + 3 * x) % 97"
+
+/**
+ * Contains the work and the measurements of a client
+ */
+typedef struct client
+{
+    const char* path;       // Socket, or segment if ```ring``` is set
+    int ring;
+    const char* code;
+    int n_requests;
+    double* latencies;      // Seconds taken by each request
+    int n_errors;           // Requests answered with an error
+    int failed;             // Whether the connection failed
+} Client;
+
+/**
+ * Reads exactly a number of bytes from a socket
+ *
+ * @return Boolean-like value, false on error or end of input
+ */
+int read_full(int fd, char* buf, size_t len)
+{
+    size_t pos = 0;
+    while (pos < len)
+    {
+        ssize_t n = read(fd, buf + pos, len - pos);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return 0;
+        pos += n;
+    }
+    return 1;
+}
+
+/**
+ * Writes a number of bytes to a socket
+ *
+ * @return Boolean-like value, false on error
+ */
+int write_full(int fd, const char* buf, size_t len)
+{
+    size_t pos = 0;
+    while (pos < len)
+    {
+        ssize_t n = write(fd, buf + pos, len - pos);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return 0;
+        pos += n;
+    }
+    return 1;
+}
+
+/**
+ * Sends the requests of a client one after another
+ *
+ * @param arg The client
+ *
+ * @return ```NULL```
+ */
+void* run_client(void* arg)
+{
+    Client* c = (Client*) arg;
+
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, c->path, sizeof(addr.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0)
+    {
+        c->failed = 1;
+        if (fd >= 0)
+            close(fd);
+        return NULL;
+    }
+
+    // Every request is the same frame
+    uint32_t len = strlen(c->code);
+    char* request = (char*) malloc(4 + len);
+    request[0] = (char) (len >> 24);
+    request[1] = (char) (len >> 16);
+    request[2] = (char) (len >> 8);
+    request[3] = (char) len;
+    memcpy(request + 4, c->code, len);
+
+    char* response = NULL;
+    for (int k = 0; k < c->n_requests; k++)
+    {
+        double start = now();
+        unsigned char header[4];
+        if (!write_full(fd, request, 4 + len)
+            || !read_full(fd, (char*) header, 4))
+        {
+            c->failed = 1;
+            break;
+        }
+
+        uint32_t n = ((uint32_t) header[0] << 24) | ((uint32_t) header[1] << 16)
+            | ((uint32_t) header[2] << 8) | header[3];
+        response = (char*) realloc(response, n);
+        if (!read_full(fd, response, n))
+        {
+            c->failed = 1;
+            break;
+        }
+        c->latencies[k] = now() - start;
+
+        // The first byte is the status, which is 0 on success
+        if (n == 0 || response[0] != 0)
+            c->n_errors++;
+    }
+
+    free(response);
+    free(request);
+    close(fd);
+    return NULL;
+}
+
+/**
+ * Sends the requests of a client one after another through a channel of
+ * a shared memory segment
+ *
+ * @param arg The client
+ *
+ * @return ```NULL```
+ */
+void* run_ring_client(void* arg)
+{
+    Client* c = (Client*) arg;
+
+    RingClient rc;
+    if (!ring_connect(&rc, c->path))
+    {
+        c->failed = 1;
+        return NULL;
+    }
+
+    uint32_t len = strlen(c->code);
+    StrBuf response = new_str_buf(64);
+    for (int k = 0; k < c->n_requests; k++)
+    {
+        double start = now();
+        clear_str_buf(&response);
+        int status = ring_send(&rc, c->code, len) ? ring_receive(&rc, &response) : -1;
+        if (status < 0)
+        {
+            c->failed = 1;
+            break;
+        }
+        c->latencies[k] = now() - start;
+
+        if (status != 0)
+            c->n_errors++;
+    }
+
+    free_str_buf(&response);
+    ring_disconnect(&rc);
+    return NULL;
+}
+
+/**
+ * Compares two latencies, for sorting
+ */
+int compare_latencies(const void* a, const void* b)
+{
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char** argv)
+{
+    int ring = argc > 1 && strcmp(argv[1], "--ring") == 0;
+    argv += ring;
+    argc -= ring;
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s [--ring] socket|segment [clients] [requests] [code]\n", argv[0]);
+        return 1;
+    }
+    int n_clients = (argc > 2) ? atoi(argv[2]) : N_CLIENTS;
+    int n_requests = (argc > 3) ? atoi(argv[3]) : N_REQUESTS;
+    const char* code = (argc > 4) ? argv[4] : DEFAULT_CODE;
+
+    Client* clients = (Client*) calloc(n_clients, sizeof(Client));
+    pthread_t* threads = (pthread_t*) malloc(n_clients * sizeof(pthread_t));
+    double* latencies = (double*) calloc((size_t) n_clients * n_requests, sizeof(double));
+
+    double start = now();
+    for (int k = 0; k < n_clients; k++)
+    {
+        clients[k] = (Client) {
+            .path = argv[1],
+            .ring = ring,
+            .code = code,
+            .n_requests = n_requests,
+            .latencies = latencies + (size_t) k * n_requests,
+        };
+        pthread_create(&threads[k], NULL, ring ? run_ring_client : run_client, &clients[k]);
+    }
+
+    int n_errors = 0, n_failed = 0;
+    for (int k = 0; k < n_clients; k++)
+    {
+        pthread_join(threads[k], NULL);
+        n_errors += clients[k].n_errors;
+        n_failed += clients[k].failed;
+    }
+    double elapsed = now() - start;
+
+    if (n_failed)
+    {
+        fprintf(stderr, "%d of %d clients lost their connection\n", n_failed, n_clients);
+        return 1;
+    }
+
+    size_t total = (size_t) n_clients * n_requests;
+    qsort(latencies, total, sizeof(double), compare_latencies);
+    printf("%d clients x %d requests: %.0f requests/s, %d errors\n",
+           n_clients, n_requests, total / elapsed, n_errors);
+    printf("p50 %8.1f us   p90 %8.1f us   p99 %8.1f us   max %8.1f us\n",
+           latencies[total / 2] * 1e6, latencies[total * 9 / 10] * 1e6,
+           latencies[total * 99 / 100] * 1e6, latencies[total - 1] * 1e6);
+
+    free(latencies);
+    free(threads);
+    free(clients);
+    return 0;
+}
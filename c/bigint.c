@@ -0,0 +1,666 @@
+#include "bigint.h"
+
+// ----- BIG INTEGERS -----
+
+// Auxiliary functions (magnitudes)
+
+/**
+ * Obtains the number of significant limbs of a magnitude
+ *
+ * @param a The limbs
+ * @param n The number of limbs
+ *
+ * @return The number of limbs without leading zeros
+ */
+int mag_trim(const uint32_t* a, int n)
+{
+    while (n > 0 && a[n - 1] == 0)
+        n--;
+    return n;
+}
+
+/**
+ * Compares two magnitudes without leading zeros
+ *
+ * @return A negative value, 0 or a positive value if ```a``` is
+ * respectively lower than, equal to or greater than ```b```
+ */
+int mag_cmp(const uint32_t* a, int an, const uint32_t* b, int bn)
+{
+    if (an != bn)
+        return (an > bn) ? 1 : -1;
+
+    for (int i = an - 1; i >= 0; i--)
+    {
+        if (a[i] != b[i])
+            return (a[i] > b[i]) ? 1 : -1;
+    }
+    return 0;
+}
+
+/**
+ * Computes ```out = a + b```
+ *
+ * @return The number of limbs written to ```out```
+ *
+ * @note ```out``` must have room for ```max(an, bn) + 1``` limbs
+ * and may alias ```a```
+ */
+int mag_add(const uint32_t* a, int an, const uint32_t* b, int bn, uint32_t* out)
+{
+    if (an < bn)
+    {
+        const uint32_t* t = a; a = b; b = t;
+        int tn = an; an = bn; bn = tn;
+    }
+
+    uint32_t carry = 0;
+    int i;
+    for (i = 0; i < an; i++)
+    {
+        uint32_t s = a[i] + (i < bn ? b[i] : 0) + carry;
+        carry = (s >= BIGINT_BASE);
+        out[i] = carry ? s - BIGINT_BASE : s;
+    }
+    if (carry)
+        out[i++] = carry;
+    return i;
+}
+
+/**
+ * Computes ```a -= b```
+ *
+ * @return The number of significant limbs of ```a```
+ *
+ * @note ```a``` must be greater than or equal to ```b```
+ */
+int mag_sub_inplace(uint32_t* a, int an, const uint32_t* b, int bn)
+{
+    uint32_t borrow = 0;
+    for (int i = 0; i < an && (i < bn || borrow); i++)
+    {
+        uint32_t sub = (i < bn ? b[i] : 0) + borrow;
+        borrow = (a[i] < sub);
+        a[i] = borrow ? a[i] + BIGINT_BASE - sub : a[i] - sub;
+    }
+    return mag_trim(a, an);
+}
+
+/**
+ * Computes ```out += a``` starting at limb 0 of ```out```
+ *
+ * @note ```out``` must be big enough to absorb the final carry
+ */
+void mag_add_inplace(uint32_t* out, const uint32_t* a, int an)
+{
+    uint32_t carry = 0;
+    int i;
+    for (i = 0; i < an; i++)
+    {
+        uint32_t s = out[i] + a[i] + carry;
+        carry = (s >= BIGINT_BASE);
+        out[i] = carry ? s - BIGINT_BASE : s;
+    }
+    for (; carry; i++)
+    {
+        uint32_t s = out[i] + carry;
+        carry = (s >= BIGINT_BASE);
+        out[i] = carry ? s - BIGINT_BASE : s;
+    }
+}
+
+/**
+ * Computes ```out = a * b``` with the schoolbook method
+ *
+ * @note ```out``` must have room for ```an + bn``` limbs and must not
+ * alias the operands
+ */
+void mag_mul_schoolbook(const uint32_t* a, int an, const uint32_t* b, int bn,
+                        uint32_t* out)
+{
+    memset(out, 0, (an + bn) * sizeof(uint32_t));
+    for (int i = 0; i < an; i++)
+    {
+        uint64_t carry = 0, ai = a[i];
+        if (ai == 0)
+            continue;
+        for (int j = 0; j < bn; j++)
+        {
+            uint64_t cur = out[i + j] + ai * b[j] + carry;
+            carry = cur / BIGINT_BASE;
+            out[i + j] = (uint32_t) (cur % BIGINT_BASE);
+        }
+        out[i + bn] = (uint32_t) carry;
+    }
+}
+
+/**
+ * Obtains the scratch size required by ```mag_mul_karatsuba```
+ *
+ * @param n The size of the operands
+ *
+ * @return The number of scratch limbs
+ */
+size_t mag_karatsuba_scratch(int n)
+{
+    size_t total = 0;
+    while (n >= BIGINT_KARATSUBA_THRESHOLD)
+    {
+        int h = n - n / 2;
+        total += 4 * (size_t) (h + 1);
+        n = h + 1;
+    }
+    return total;
+}
+
+/**
+ * Computes ```out = a * b``` for two operands of the same size
+ * using Karatsuba multiplication
+ *
+ * @param a The first operand
+ * @param b The second operand
+ * @param n The size of both operands
+ * @param out The output, with room for ```2 * n``` limbs
+ * @param scratch Temporary storage of ```mag_karatsuba_scratch(n)``` limbs
+ */
+void mag_mul_karatsuba(const uint32_t* a, const uint32_t* b, int n,
+                       uint32_t* out, uint32_t* scratch)
+{
+    if (n < BIGINT_KARATSUBA_THRESHOLD)
+    {
+        mag_mul_schoolbook(a, n, b, n, out);
+        return;
+    }
+
+    // a = a1 * B^m + a0, b = b1 * B^m + b0
+    int m = n / 2, h = n - m;
+    uint32_t* sa = scratch;
+    uint32_t* sb = sa + (h + 1);
+    uint32_t* z1 = sb + (h + 1);
+    uint32_t* next = z1 + 2 * (h + 1);
+
+    // z0 = a0 * b0, z2 = a1 * b1
+    mag_mul_karatsuba(a, b, m, out, next);
+    mag_mul_karatsuba(a + m, b + m, h, out + 2 * m, next);
+
+    // z1 = (a0 + a1) * (b0 + b1) - z0 - z2
+    int sn = mag_add(a + m, h, a, m, sa);
+    memset(sa + sn, 0, (h + 1 - sn) * sizeof(uint32_t));
+    sn = mag_add(b + m, h, b, m, sb);
+    memset(sb + sn, 0, (h + 1 - sn) * sizeof(uint32_t));
+    mag_mul_karatsuba(sa, sb, h + 1, z1, next);
+
+    int zn = mag_trim(z1, 2 * (h + 1));
+    zn = mag_sub_inplace(z1, zn, out, mag_trim(out, 2 * m));
+    zn = mag_sub_inplace(z1, zn, out + 2 * m, mag_trim(out + 2 * m, 2 * h));
+
+    mag_add_inplace(out + m, z1, zn);
+}
+
+/**
+ * Computes ```out = a * b``` for operands of any size
+ *
+ * @note ```out``` must have room for ```an + bn``` limbs and must not
+ * alias the operands
+ */
+void mag_mul(const uint32_t* a, int an, const uint32_t* b, int bn, uint32_t* out)
+{
+    if (an < bn)
+    {
+        const uint32_t* t = a; a = b; b = t;
+        int tn = an; an = bn; bn = tn;
+    }
+
+    if (bn < BIGINT_KARATSUBA_THRESHOLD)
+    {
+        mag_mul_schoolbook(a, an, b, bn, out);
+        return;
+    }
+
+    // Multiply each bn-sized chunk of a by b and accumulate
+    uint32_t* chunk = (uint32_t*) malloc(
+        (3 * (size_t) bn + mag_karatsuba_scratch(bn)) * sizeof(uint32_t));
+    uint32_t* prod = chunk + bn;
+    uint32_t* scratch = prod + 2 * bn;
+
+    memset(out, 0, (an + bn) * sizeof(uint32_t));
+    for (int i = 0; i < an; i += bn)
+    {
+        int cn = (an - i < bn) ? an - i : bn;
+        memcpy(chunk, a + i, cn * sizeof(uint32_t));
+        memset(chunk + cn, 0, (bn - cn) * sizeof(uint32_t));
+        mag_mul_karatsuba(chunk, b, bn, prod, scratch);
+        mag_add_inplace(out + i, prod, mag_trim(prod, cn + bn));
+    }
+
+    free(chunk);
+}
+
+/**
+ * Divides a magnitude by a single limb in place
+ *
+ * @return The remainder
+ */
+uint32_t mag_divmod_small(uint32_t* a, int an, uint32_t d)
+{
+    uint64_t rem = 0;
+    for (int i = an - 1; i >= 0; i--)
+    {
+        uint64_t cur = rem * BIGINT_BASE + a[i];
+        a[i] = (uint32_t) (cur / d);
+        rem = cur % d;
+    }
+    return (uint32_t) rem;
+}
+
+/**
+ * Multiplies a magnitude by a single limb
+ *
+ * @return The number of limbs written to ```out```
+ *
+ * @note ```out``` must have room for ```an + 1``` limbs
+ */
+int mag_mul_small(const uint32_t* a, int an, uint32_t d, uint32_t* out)
+{
+    uint64_t carry = 0;
+    for (int i = 0; i < an; i++)
+    {
+        uint64_t cur = (uint64_t) a[i] * d + carry;
+        out[i] = (uint32_t) (cur % BIGINT_BASE);
+        carry = cur / BIGINT_BASE;
+    }
+    out[an] = (uint32_t) carry;
+    return an + 1;
+}
+
+/**
+ * Computes the remainder of ```u / v``` (Knuth's algorithm D)
+ *
+ * @param u The dividend
+ * @param un The size of the dividend
+ * @param v The divisor, without leading zeros
+ * @param vn The size of the divisor
+ * @param rem The remainder, with room for ```vn``` limbs
+ *
+ * @return The number of significant limbs of the remainder
+ */
+int mag_mod(const uint32_t* u, int un, const uint32_t* v, int vn, uint32_t* rem)
+{
+    if (mag_cmp(u, un, v, vn) < 0)
+    {
+        memcpy(rem, u, un * sizeof(uint32_t));
+        return un;
+    }
+
+    if (vn == 1)
+    {
+        uint32_t* tmp = (uint32_t*) malloc(un * sizeof(uint32_t));
+        memcpy(tmp, u, un * sizeof(uint32_t));
+        rem[0] = mag_divmod_small(tmp, un, v[0]);
+        free(tmp);
+        return mag_trim(rem, 1);
+    }
+
+    // Normalize so that the top limb of the divisor is at least BASE / 2
+    uint32_t d = BIGINT_BASE / (v[vn - 1] + 1);
+    uint32_t* nu = (uint32_t*) malloc((un + 1 + vn + 1) * sizeof(uint32_t));
+    uint32_t* nv = nu + un + 1;
+    mag_mul_small(u, un, d, nu);
+    mag_mul_small(v, vn, d, nv);
+
+    uint64_t vtop = nv[vn - 1], vnext = nv[vn - 2];
+    for (int j = un - vn; j >= 0; j--)
+    {
+        // Estimate the quotient limb
+        uint64_t num = (uint64_t) nu[j + vn] * BIGINT_BASE + nu[j + vn - 1];
+        uint64_t qhat = num / vtop, rhat = num % vtop;
+        while (qhat >= BIGINT_BASE
+               || qhat * vnext > rhat * BIGINT_BASE + nu[j + vn - 2])
+        {
+            qhat--;
+            rhat += vtop;
+            if (rhat >= BIGINT_BASE)
+                break;
+        }
+
+        // Multiply and subtract
+        uint64_t carry = 0;
+        int64_t borrow = 0;
+        for (int i = 0; i < vn; i++)
+        {
+            uint64_t p = qhat * nv[i] + carry;
+            carry = p / BIGINT_BASE;
+            int64_t t = (int64_t) nu[i + j] - (int64_t) (p % BIGINT_BASE) - borrow;
+            borrow = (t < 0);
+            nu[i + j] = (uint32_t) (borrow ? t + BIGINT_BASE : t);
+        }
+        int64_t t = (int64_t) nu[j + vn] - (int64_t) carry - borrow;
+
+        // Add back if the estimate was one too large
+        if (t < 0)
+        {
+            uint32_t c = 0;
+            for (int i = 0; i < vn; i++)
+            {
+                uint32_t s = nu[i + j] + nv[i] + c;
+                c = (s >= BIGINT_BASE);
+                nu[i + j] = c ? s - BIGINT_BASE : s;
+            }
+            t += c;
+        }
+        nu[j + vn] = (uint32_t) t;
+    }
+
+    // Unnormalize the remainder
+    mag_divmod_small(nu, vn, d);
+    memcpy(rem, nu, vn * sizeof(uint32_t));
+    free(nu);
+    return mag_trim(rem, vn);
+}
+
+
+// Auxiliary functions (big integers)
+
+/**
+ * Sets the size and sign of a big integer after an operation
+ *
+ * @param a The big integer
+ * @param size The number of limbs written
+ * @param sign The sign of the result if it is not 0
+ *
+ * @return The big integer
+ */
+BigInt* bigint_finish(BigInt* a, int size, int sign)
+{
+    a->size = mag_trim(a->limbs, size);
+    a->sign = a->size ? sign : 0;
+    return a;
+}
+
+/**
+ * Computes ```a + sign_b * b```
+ */
+BigInt* bigint_add_signed(const BigInt* a, const BigInt* b, int sign_b)
+{
+    int n = (a->size > b->size ? a->size : b->size) + 1;
+    BigInt* r = bigint_new(n);
+
+    if (b->sign == 0)
+    {
+        memcpy(r->limbs, a->limbs, a->size * sizeof(uint32_t));
+        return bigint_finish(r, a->size, a->sign);
+    }
+    if (a->sign == 0)
+    {
+        memcpy(r->limbs, b->limbs, b->size * sizeof(uint32_t));
+        return bigint_finish(r, b->size, sign_b * b->sign);
+    }
+
+    // Same signs: add magnitudes
+    if (a->sign == sign_b * b->sign)
+        return bigint_finish(r, mag_add(a->limbs, a->size, b->limbs, b->size,
+                                        r->limbs), a->sign);
+
+    // Different signs: subtract the smaller magnitude from the larger
+    int cmp = mag_cmp(a->limbs, a->size, b->limbs, b->size);
+    const BigInt* big = (cmp >= 0) ? a : b;
+    const BigInt* small = (cmp >= 0) ? b : a;
+    memcpy(r->limbs, big->limbs, big->size * sizeof(uint32_t));
+    int size = mag_sub_inplace(r->limbs, big->size, small->limbs, small->size);
+    return bigint_finish(r, size, (cmp >= 0) ? a->sign : sign_b * b->sign);
+}
+
+
+// Public functions
+
+BigInt* bigint_new(int capacity)
+{
+    if (capacity < 1)
+        capacity = 1;
+    BigInt* a = (BigInt*) malloc(sizeof(BigInt) + capacity * sizeof(uint32_t));
+    a->sign = 0;
+    a->size = 0;
+    a->capacity = capacity;
+    a->limbs = (uint32_t*) (a + 1);
+    return a;
+}
+
+BigInt* bigint_from_int(int64_t value)
+{
+    uint32_t storage[BIGINT_INT_LIMBS];
+    BigInt view;
+    bigint_view_int(&view, storage, value);
+    return bigint_copy(&view);
+}
+
+BigInt* bigint_from_string(const char* digits, size_t len)
+{
+    BigInt* a = bigint_new((int) (len / BIGINT_BASE_DIGITS + 1));
+    int n = 0;
+
+    // Read groups of 9 digits starting from the least significant one
+    for (size_t end = len; end > 0; )
+    {
+        size_t start = (end > BIGINT_BASE_DIGITS) ? end - BIGINT_BASE_DIGITS : 0;
+        uint32_t limb = 0;
+        for (size_t i = start; i < end; i++)
+            limb = limb * 10 + (uint32_t) (digits[i] - '0');
+        a->limbs[n++] = limb;
+        end = start;
+    }
+
+    return bigint_finish(a, n, 1);
+}
+
+void bigint_view_int(BigInt* view, uint32_t storage[BIGINT_INT_LIMBS],
+                     int64_t value)
+{
+    // Avoid overflow when negating INT64_MIN
+    uint64_t mag = (value < 0) ? -(uint64_t) value : (uint64_t) value;
+    int n = 0;
+    while (mag)
+    {
+        storage[n++] = (uint32_t) (mag % BIGINT_BASE);
+        mag /= BIGINT_BASE;
+    }
+
+    view->sign = (value > 0) - (value < 0);
+    view->size = n;
+    view->capacity = BIGINT_INT_LIMBS;
+    view->limbs = storage;
+}
+
+BigInt* bigint_copy(const BigInt* a)
+{
+    BigInt* r = bigint_new(a->size);
+    memcpy(r->limbs, a->limbs, a->size * sizeof(uint32_t));
+    r->size = a->size;
+    r->sign = a->sign;
+    return r;
+}
+
+int bigint_to_int(const BigInt* a, int64_t* value)
+{
+    if (a->size > BIGINT_INT_LIMBS)
+        return 0;
+
+    uint64_t mag = 0;
+    for (int i = a->size - 1; i >= 0; i--)
+    {
+        if (__builtin_mul_overflow(mag, (uint64_t) BIGINT_BASE, &mag)
+            || __builtin_add_overflow(mag, (uint64_t) a->limbs[i], &mag))
+            return 0;
+    }
+
+    if (a->sign >= 0)
+    {
+        if (mag > (uint64_t) INT64_MAX)
+            return 0;
+        *value = (int64_t) mag;
+    }
+    else
+    {
+        if (mag > (uint64_t) INT64_MAX + 1)
+            return 0;
+        *value = (int64_t) (0 - mag);
+    }
+    return 1;
+}
+
+double bigint_to_double(const BigInt* a)
+{
+    // Let strtod perform the correctly rounded conversion
+    char* buf = (char*) malloc(bigint_max_str_len(a) + 1);
+    bigint_to_string(a, buf);
+    double value = strtod(buf, NULL);
+    free(buf);
+    return value;
+}
+
+int bigint_is_zero(const BigInt* a)
+{
+    return a->sign == 0;
+}
+
+int bigint_cmp(const BigInt* a, const BigInt* b)
+{
+    if (a->sign != b->sign)
+        return (a->sign > b->sign) ? 1 : -1;
+    return a->sign * mag_cmp(a->limbs, a->size, b->limbs, b->size);
+}
+
+BigInt* bigint_neg(const BigInt* a)
+{
+    BigInt* r = bigint_copy(a);
+    r->sign = -r->sign;
+    return r;
+}
+
+BigInt* bigint_add(const BigInt* a, const BigInt* b)
+{
+    return bigint_add_signed(a, b, 1);
+}
+
+BigInt* bigint_sub(const BigInt* a, const BigInt* b)
+{
+    return bigint_add_signed(a, b, -1);
+}
+
+BigInt* bigint_mul(const BigInt* a, const BigInt* b)
+{
+    BigInt* r = bigint_new(a->size + b->size);
+    if (a->sign == 0 || b->sign == 0)
+        return r;
+
+    if (a == b)
+        mag_mul(a->limbs, a->size, a->limbs, a->size, r->limbs);
+    else
+        mag_mul(a->limbs, a->size, b->limbs, b->size, r->limbs);
+    return bigint_finish(r, a->size + b->size, a->sign * b->sign);
+}
+
+BigInt* bigint_mod(const BigInt* a, const BigInt* b)
+{
+    if (b->sign == 0)
+        return NULL;
+
+    BigInt* r = bigint_new(b->size);
+    if (a->sign == 0)
+        return r;
+
+    int size = mag_mod(a->limbs, a->size, b->limbs, b->size, r->limbs);
+    return bigint_finish(r, size, a->sign);
+}
+
+BigInt* bigint_pow(const BigInt* a, uint64_t exp)
+{
+    // Trivial bases never grow
+    if (a->size == 0 || (a->size == 1 && a->limbs[0] == 1))
+    {
+        if (exp == 0)
+            return bigint_from_int(1);
+
+        // (-1)^even = 1, 0^n = 0
+        BigInt* r = bigint_copy(a);
+        if (exp % 2 == 0)
+            r->sign = (r->sign != 0);
+        return r;
+    }
+
+    // Reject results that are too large before computing them
+    if (bigint_pow_size(a, exp) > BIGINT_MAX_LIMBS)
+        return NULL;
+
+    BigInt* acc = bigint_from_int(1);
+    BigInt* base = bigint_copy(a);
+    while (exp > 0)
+    {
+        if (exp & 1)
+        {
+            BigInt* t = bigint_mul(acc, base);
+            bigint_free(acc);
+            acc = t;
+        }
+        exp >>= 1;
+        if (exp)
+        {
+            BigInt* t = bigint_mul(base, base);
+            bigint_free(base);
+            base = t;
+        }
+    }
+
+    bigint_free(base);
+    return acc;
+}
+
+double bigint_pow_size(const BigInt* a, uint64_t exp)
+{
+    // Trivial bases never grow
+    if (a->size == 0 || (a->size == 1 && a->limbs[0] == 1))
+        return 1;
+
+    return exp * ((a->size - 1) + log10(a->limbs[a->size - 1] + 1.0)
+                  / BIGINT_BASE_DIGITS);
+}
+
+size_t bigint_max_str_len(const BigInt* a)
+{
+    return (size_t) (a->size ? a->size : 1) * BIGINT_BASE_DIGITS + 1;
+}
+
+size_t bigint_to_string(const BigInt* a, char* buf)
+{
+    if (a->sign == 0)
+    {
+        strcpy(buf, "0");
+        return 1;
+    }
+
+    char* p = buf;
+    if (a->sign < 0)
+        *p++ = '-';
+
+    // Most significant limb without padding
+    p += sprintf(p, "%u", a->limbs[a->size - 1]);
+
+    // Remaining limbs padded to 9 digits
+    for (int i = a->size - 2; i >= 0; i--)
+    {
+        uint32_t limb = a->limbs[i];
+        for (int d = BIGINT_BASE_DIGITS - 1; d >= 0; d--)
+        {
+            p[d] = (char) ('0' + limb % 10);
+            limb /= 10;
+        }
+        p += BIGINT_BASE_DIGITS;
+    }
+
+    *p = '\0';
+    return (size_t) (p - buf);
+}
+
+void bigint_free(BigInt* a)
+{
+    free(a);
+}
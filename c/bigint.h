@@ -0,0 +1,218 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+// ----- BIG INTEGERS -----
+
+// Base of each limb. A decimal base keeps base-10 conversion linear
+#define BIGINT_BASE 1000000000u
+
+// Number of decimal digits stored in each limb
+#define BIGINT_BASE_DIGITS 9
+
+// Number of limbs needed to hold any 64-bit integer
+#define BIGINT_INT_LIMBS 3
+
+// Operand size (in limbs) below which schoolbook multiplication is used
+#define BIGINT_KARATSUBA_THRESHOLD 32
+
+// Maximum size (in limbs) of a big integer result
+#define BIGINT_MAX_LIMBS (1 << 22)
+
+/**
+ * Arbitrary-precision integer in sign-magnitude representation
+ */
+typedef struct bigint
+{
+    int sign;           // -1, 0 or 1
+    int size;           // Number of limbs in use
+    int capacity;       // Number of limbs allocated
+    uint32_t* limbs;    // Little-endian limbs in base ```BIGINT_BASE```
+} BigInt;
+
+/**
+ * Creates a new big integer with value 0
+ *
+ * @param capacity Number of limbs to reserve
+ *
+ * @return The new big integer
+ *
+ * @note Remember to call ```bigint_free``` afterwards
+ */
+BigInt* bigint_new(int capacity);
+
+/**
+ * Creates a new big integer from a 64-bit integer
+ *
+ * @param value The integer
+ *
+ * @return The new big integer
+ *
+ * @note Remember to call ```bigint_free``` afterwards
+ */
+BigInt* bigint_from_int(int64_t value);
+
+/**
+ * Creates a new big integer from a string of decimal digits
+ *
+ * @param digits The digits, without sign
+ * @param len The number of digits
+ *
+ * @return The new big integer
+ *
+ * @note Remember to call ```bigint_free``` afterwards
+ */
+BigInt* bigint_from_string(const char* digits, size_t len);
+
+/**
+ * Initializes a big integer view over a 64-bit integer, without allocating
+ *
+ * @param view The view to initialize
+ * @param storage Limb storage for the view
+ * @param value The integer
+ *
+ * @note The view must not be freed nor outlive ```storage```
+ */
+void bigint_view_int(BigInt* view, uint32_t storage[BIGINT_INT_LIMBS],
+                     int64_t value);
+
+/**
+ * Creates a copy of a big integer
+ *
+ * @param a The big integer
+ *
+ * @return The new big integer
+ *
+ * @note Remember to call ```bigint_free``` afterwards
+ */
+BigInt* bigint_copy(const BigInt* a);
+
+/**
+ * Obtains the value of a big integer as a 64-bit integer, if it fits
+ *
+ * @param a The big integer
+ * @param value Where to store the value
+ *
+ * @return ```1``` if the value fits, ```0``` otherwise
+ */
+int bigint_to_int(const BigInt* a, int64_t* value);
+
+/**
+ * Obtains the nearest double to a big integer
+ *
+ * @param a The big integer
+ *
+ * @return The converted value
+ */
+double bigint_to_double(const BigInt* a);
+
+/**
+ * Checks if a big integer is 0
+ *
+ * @param a The big integer
+ *
+ * @return Boolean-like value
+ */
+int bigint_is_zero(const BigInt* a);
+
+/**
+ * Compares two big integers
+ *
+ * @param a The first big integer
+ * @param b The second big integer
+ *
+ * @return A negative value, 0 or a positive value if ```a``` is
+ * respectively lower than, equal to or greater than ```b```
+ */
+int bigint_cmp(const BigInt* a, const BigInt* b);
+
+/**
+ * Computes ```-a```
+ *
+ * @note Remember to call ```bigint_free``` on the result afterwards
+ */
+BigInt* bigint_neg(const BigInt* a);
+
+/**
+ * Computes ```a + b```
+ *
+ * @note Remember to call ```bigint_free``` on the result afterwards
+ */
+BigInt* bigint_add(const BigInt* a, const BigInt* b);
+
+/**
+ * Computes ```a - b```
+ *
+ * @note Remember to call ```bigint_free``` on the result afterwards
+ */
+BigInt* bigint_sub(const BigInt* a, const BigInt* b);
+
+/**
+ * Computes ```a * b```, using Karatsuba multiplication for large operands
+ *
+ * @note Remember to call ```bigint_free``` on the result afterwards
+ */
+BigInt* bigint_mul(const BigInt* a, const BigInt* b);
+
+/**
+ * Computes the remainder of the truncated division ```a / b```
+ *
+ * @return The remainder, which has the sign of ```a```,
+ * or ```NULL``` if ```b``` is 0
+ *
+ * @note Remember to call ```bigint_free``` on the result afterwards
+ */
+BigInt* bigint_mod(const BigInt* a, const BigInt* b);
+
+/**
+ * Computes ```a ^ exp``` by squaring
+ *
+ * @return The power, or ```NULL``` if the result would exceed
+ * ```BIGINT_MAX_LIMBS``` limbs
+ *
+ * @note Remember to call ```bigint_free``` on the result afterwards
+ */
+BigInt* bigint_pow(const BigInt* a, uint64_t exp);
+
+/**
+ * Estimates the size of ```a ^ exp``` without computing it
+ *
+ * @return An approximation of the number of limbs of the power, from
+ * above
+ */
+double bigint_pow_size(const BigInt* a, uint64_t exp);
+
+/**
+ * Obtains an upper bound of the length of the decimal representation
+ * of a big integer, including sign
+ *
+ * @param a The big integer
+ *
+ * @return The maximum number of characters, without the null terminator
+ */
+size_t bigint_max_str_len(const BigInt* a);
+
+/**
+ * Writes the decimal representation of a big integer to a buffer
+ *
+ * @param a The big integer
+ * @param buf The buffer, with room for at least
+ * ```bigint_max_str_len(a) + 1``` characters
+ *
+ * @return The number of characters written, without the null terminator
+ */
+size_t bigint_to_string(const BigInt* a, char* buf);
+
+/**
+ * Frees the memory used by a big integer
+ *
+ * @param a The big integer
+ */
+void bigint_free(BigInt* a);
+
+#endif  // BIGINT_H
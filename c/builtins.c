@@ -0,0 +1,425 @@
+#include "builtins.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// ----- BUILT-IN FUNCTIONS -----
+
+// Number of values processed at once by the batch implementations: the
+// width of the target's vector registers
+#if defined(__AVX__)
+#define LANES 4
+#else
+#define LANES 2
+#endif
+
+// Adding and subtracting 1.5 * 2^52 rounds a double to the nearest integer,
+// leaving the integer in the low bits of the sum
+#define ROUND_MAGIC 6755399441055744.0
+
+// Arguments of sin and cos above this magnitude are reduced by libm
+#define TRIG_REDUCTION_LIMIT 1048576.0
+
+// Splits of ln(2) and pi/2 whose leading parts multiply exactly by small
+// integers (fdlibm)
+#define LN2_HI 6.93147180369123816490e-01
+#define LN2_LO 1.90821492927058770002e-10
+#define PIO2_1 1.57079632673412561417e+00
+#define PIO2_2 6.07710050630396597660e-11
+#define PIO2_3 2.02226624871116645580e-21
+
+/**
+ * Vectors of doubles and of their bit patterns. Comparisons between
+ * ```vdouble``` values give lane masks of all ones or all zeros
+ */
+typedef double vdouble __attribute__((vector_size(LANES * sizeof(double))));
+typedef int64_t vlong __attribute__((vector_size(LANES * sizeof(double))));
+
+// Auxiliary functions
+
+/**
+ * Broadcasts a value to every lane
+ *
+ * @param value The value
+ *
+ * @return The vector
+ */
+vdouble vsplat(double value)
+{
+    vdouble v;
+    for (int k = 0; k < LANES; k++)
+        v[k] = value;
+    return v;
+}
+
+/**
+ * Selects the lanes of a vector where a mask is set, and the lanes of
+ * another vector elsewhere
+ *
+ * @param mask The mask
+ * @param a The vector selected where the mask is set
+ * @param b The vector selected elsewhere
+ *
+ * @return The vector
+ */
+vdouble vselect(vlong mask, vdouble a, vdouble b)
+{
+    return (vdouble) (((vlong) a & mask) | ((vlong) b & ~mask));
+}
+
+/**
+ * Rounds every lane to the nearest integer
+ *
+ * @param x The vector, whose lanes must be below 2^51 in magnitude
+ * @param n Where to store the integers
+ *
+ * @return The rounded vector
+ */
+vdouble vround(vdouble x, vlong* n)
+{
+    vdouble t = x + vsplat(ROUND_MAGIC);
+    *n = (vlong) t - (vlong) vsplat(ROUND_MAGIC);
+    return t - vsplat(ROUND_MAGIC);
+}
+
+/**
+ * Obtains 2^n for every lane
+ *
+ * @param n The exponents, which must be normal
+ *
+ * @return The powers
+ */
+vdouble vpow2(vlong n)
+{
+    return (vdouble) ((n + 1023) << 52);
+}
+
+/**
+ * Obtains the square root of every lane
+ *
+ * @param x The vector
+ *
+ * @return The square roots
+ */
+vdouble vsqrt(vdouble x)
+{
+#if defined(__AVX__)
+    return (vdouble) _mm256_sqrt_pd((__m256d) x);
+#elif defined(__SSE2__)
+    return (vdouble) _mm_sqrt_pd((__m128d) x);
+#else
+    for (int k = 0; k < LANES; k++)
+        x[k] = sqrt(x[k]);
+    return x;
+#endif
+}
+
+/**
+ * Obtains e^x for every lane: ```x = n*ln(2) + r``` with ```|r| <= ln(2)/2```,
+ * and e^r is approximated by its Taylor polynomial of degree 13
+ *
+ * @param x The vector
+ *
+ * @return The exponentials
+ */
+vdouble vexp(vdouble x)
+{
+    // Out of these bounds the result is 0 or infinity. NaN lanes stay NaN
+    x = vselect(x > vsplat(710.0), vsplat(710.0), x);
+    x = vselect(x < vsplat(-746.0), vsplat(-746.0), x);
+
+    vlong n;
+    vdouble nd = vround(x * vsplat(1.44269504088896340736), &n);
+    vdouble r = (x - nd * vsplat(LN2_HI)) - nd * vsplat(LN2_LO);
+
+    vdouble p = vsplat(1.0 / 6227020800.0);
+    p = p * r + vsplat(1.0 / 479001600.0);
+    p = p * r + vsplat(1.0 / 39916800.0);
+    p = p * r + vsplat(1.0 / 3628800.0);
+    p = p * r + vsplat(1.0 / 362880.0);
+    p = p * r + vsplat(1.0 / 40320.0);
+    p = p * r + vsplat(1.0 / 5040.0);
+    p = p * r + vsplat(1.0 / 720.0);
+    p = p * r + vsplat(1.0 / 120.0);
+    p = p * r + vsplat(1.0 / 24.0);
+    p = p * r + vsplat(1.0 / 6.0);
+    p = p * r + vsplat(0.5);
+    p = p * r + vsplat(1.0);
+    p = p * r + vsplat(1.0);
+
+    // 2^n is applied in two halves so that both are normal numbers
+    vlong half = n >> 1;
+    return p * vpow2(half) * vpow2(n - half);
+}
+
+/**
+ * Obtains ln(x) for every lane: ```x = 2^e * (1 + f)``` with ```1 + f``` in
+ * ```[sqrt(2)/2, sqrt(2))```, and ln(1 + f) is approximated by the series
+ * of ```2*atanh(s)``` with ```s = f / (2 + f)```
+ *
+ * @param x The vector
+ *
+ * @return The logarithms (NaN for lanes outside the domain)
+ */
+vdouble vlog(vdouble x)
+{
+    vdouble input = x;
+
+    // Subnormals are scaled to normal numbers
+    vlong tiny = x < vsplat(0x1p-1022);
+    x = vselect(tiny, x * vsplat(0x1p54), x);
+
+    vlong bits = (vlong) x;
+    vlong e = ((bits >> 52) & 0x7FF) - 1023 + (tiny & -54);
+    vdouble m = (vdouble) ((bits & 0x000FFFFFFFFFFFFF) | 0x3FF0000000000000);
+    vlong big = m > vsplat(1.41421356237309504880);
+    m = vselect(big, m * vsplat(0.5), m);
+    e -= big;
+
+    vdouble f = m - vsplat(1.0);
+    vdouble s = f / (vsplat(2.0) + f);
+    vdouble z = s * s;
+    vdouble hfsq = vsplat(0.5) * f * f;
+
+    vdouble r = vsplat(2.0 / 21.0);
+    r = r * z + vsplat(2.0 / 19.0);
+    r = r * z + vsplat(2.0 / 17.0);
+    r = r * z + vsplat(2.0 / 15.0);
+    r = r * z + vsplat(2.0 / 13.0);
+    r = r * z + vsplat(2.0 / 11.0);
+    r = r * z + vsplat(2.0 / 9.0);
+    r = r * z + vsplat(2.0 / 7.0);
+    r = r * z + vsplat(2.0 / 5.0);
+    r = r * z + vsplat(2.0 / 3.0);
+    r = r * z;
+
+    vdouble ed = __builtin_convertvector(e, vdouble);
+    vdouble res = ed * vsplat(LN2_HI)
+        - ((hfsq - (s * (hfsq + r) + ed * vsplat(LN2_LO))) - f);
+
+    // Special values
+    res = vselect(input == vsplat(INFINITY), input, res);
+    res = vselect(input <= vsplat(0.0), vsplat(NAN), res);
+    return vselect(input != input, input, res);
+}
+
+/**
+ * Obtains sin(x) or cos(x) for every lane: ```x = q*pi/2 + r``` with
+ * ```|r| <= pi/4```, and the quadrant ```q``` selects the Taylor polynomial
+ * of sin(r) or cos(r) and its sign
+ *
+ * @param x The vector
+ * @param shift ```0``` for sin, or ```1``` for cos
+ *
+ * @return The values
+ */
+vdouble vsincos(vdouble x, int shift)
+{
+    vlong q;
+    vdouble qd = vround(x * vsplat(0.63661977236758134308), &q);
+    vdouble r = ((x - qd * vsplat(PIO2_1)) - qd * vsplat(PIO2_2))
+        - qd * vsplat(PIO2_3);
+    vdouble z = r * r;
+
+    vdouble s = vsplat(1.0 / 355687428096000.0);
+    s = s * z - vsplat(1.0 / 1307674368000.0);
+    s = s * z + vsplat(1.0 / 6227020800.0);
+    s = s * z - vsplat(1.0 / 39916800.0);
+    s = s * z + vsplat(1.0 / 362880.0);
+    s = s * z - vsplat(1.0 / 5040.0);
+    s = s * z + vsplat(1.0 / 120.0);
+    s = s * z - vsplat(1.0 / 6.0);
+    s = r + r * z * s;
+
+    vdouble c = vsplat(-1.0 / 6402373705728000.0);
+    c = c * z + vsplat(1.0 / 20922789888000.0);
+    c = c * z - vsplat(1.0 / 87178291200.0);
+    c = c * z + vsplat(1.0 / 479001600.0);
+    c = c * z - vsplat(1.0 / 3628800.0);
+    c = c * z + vsplat(1.0 / 40320.0);
+    c = c * z - vsplat(1.0 / 720.0);
+    c = c * z + vsplat(1.0 / 24.0);
+    c = vsplat(1.0) - vsplat(0.5) * z + z * z * c;
+
+    vlong quadrant = q + shift;
+    vdouble res = vselect((quadrant & 1) != 0, c, s);
+    res = vselect((quadrant & 2) != 0, -res, res);
+
+    // Large and non-finite arguments
+    vlong large = ~((vsplat(-TRIG_REDUCTION_LIMIT) <= x) & (x <= vsplat(TRIG_REDUCTION_LIMIT)));
+    for (int k = 0; k < LANES; k++)
+    {
+        if (large[k])
+            res[k] = (shift) ? cos(x[k]) : sin(x[k]);
+    }
+    return res;
+}
+
+/**
+ * Obtains the largest integer not greater than each lane
+ *
+ * @param x The vector
+ *
+ * @return The integers, as doubles
+ */
+vdouble vfloor(vdouble x)
+{
+    // Adding and subtracting 2^52 rounds magnitudes below 2^52
+    vlong sign = (vlong) x & (int64_t) 0x8000000000000000;
+    vdouble ax = (vdouble) ((vlong) x ^ sign);
+    vdouble t = (ax + vsplat(0x1p52)) - vsplat(0x1p52);
+    t = (vdouble) ((vlong) t | sign);
+    t = vselect(t > x, t - vsplat(1.0), t);
+
+    // Larger lanes are already integers. Zeros keep their sign
+    vlong exact = ~(ax < vsplat(0x1p52)) | (x == vsplat(0.0));
+    return vselect(exact, x, t);
+}
+
+/**
+ * Defines the batch implementation of a function from a vector kernel.
+ * The last partial vector is padded with valid arguments
+ */
+#define DEFINE_BATCH(name, kernel)                                          \
+void name(const double* x, const double* y, double* out, size_t n)         \
+{                                                                           \
+    vdouble vx, vy = vsplat(1.0);                                           \
+    size_t k = 0;                                                           \
+    for (; k + LANES <= n; k += LANES)                                      \
+    {                                                                       \
+        memcpy(&vx, x + k, sizeof(vx));                                     \
+        if (y)                                                              \
+            memcpy(&vy, y + k, sizeof(vy));                                 \
+        vdouble r = kernel;                                                 \
+        memcpy(out + k, &r, sizeof(r));                                     \
+    }                                                                       \
+    if (k < n)                                                              \
+    {                                                                       \
+        vx = vy = vsplat(1.0);                                              \
+        memcpy(&vx, x + k, (n - k) * sizeof(double));                       \
+        if (y)                                                              \
+            memcpy(&vy, y + k, (n - k) * sizeof(double));                   \
+        vdouble r = kernel;                                                 \
+        memcpy(out + k, &r, (n - k) * sizeof(double));                      \
+    }                                                                       \
+}
+
+DEFINE_BATCH(batch_sqrt, vsqrt(vx))
+DEFINE_BATCH(batch_exp, vexp(vx))
+DEFINE_BATCH(batch_log, vlog(vx))
+DEFINE_BATCH(batch_sin, vsincos(vx, 0))
+DEFINE_BATCH(batch_cos, vsincos(vx, 1))
+DEFINE_BATCH(batch_abs, (vdouble) ((vlong) vx & 0x7FFFFFFFFFFFFFFF))
+DEFINE_BATCH(batch_min, vselect(vy < vx, vy, vx))
+DEFINE_BATCH(batch_max, vselect(vy > vx, vy, vx))
+DEFINE_BATCH(batch_floor, vfloor(vx))
+
+// Scalar implementations
+
+double scalar_sqrt(double x, double y)
+{
+    return sqrt(x);
+}
+
+double scalar_exp(double x, double y)
+{
+    return exp(x);
+}
+
+double scalar_log(double x, double y)
+{
+    return log(x);
+}
+
+double scalar_sin(double x, double y)
+{
+    return sin(x);
+}
+
+double scalar_cos(double x, double y)
+{
+    return cos(x);
+}
+
+double scalar_abs(double x, double y)
+{
+    return fabs(x);
+}
+
+double scalar_min(double x, double y)
+{
+    return (y < x) ? y : x;
+}
+
+double scalar_max(double x, double y)
+{
+    return (y > x) ? y : x;
+}
+
+double scalar_floor(double x, double y)
+{
+    return floor(x);
+}
+
+// Domains
+
+int non_negative_domain(double x)
+{
+    return !(x < 0);
+}
+
+int positive_domain(double x)
+{
+    return !(x <= 0);
+}
+
+int finite_domain(double x)
+{
+    return !isinf(x);
+}
+
+
+// Public functions
+
+const Builtin Builtins[BI_COUNT] = {
+    [BI_SQRT]  = { "sqrt",  1, RESULT_FLOAT,  1, non_negative_domain, scalar_sqrt,  batch_sqrt },
+    [BI_EXP]   = { "exp",   1, RESULT_FLOAT,  1, NULL,                scalar_exp,   batch_exp },
+    [BI_LOG]   = { "log",   1, RESULT_FLOAT,  0, positive_domain,     scalar_log,   batch_log },
+    [BI_SIN]   = { "sin",   1, RESULT_FLOAT,  0, finite_domain,       scalar_sin,   batch_sin },
+    [BI_COS]   = { "cos",   1, RESULT_FLOAT,  0, finite_domain,       scalar_cos,   batch_cos },
+    [BI_ABS]   = { "abs",   1, RESULT_WIDEST, 1, NULL,                scalar_abs,   batch_abs },
+    [BI_MIN]   = { "min",   2, RESULT_WIDEST, 0, NULL,                scalar_min,   batch_min },
+    [BI_MAX]   = { "max",   2, RESULT_WIDEST, 0, NULL,                scalar_max,   batch_max },
+    [BI_FLOOR] = { "floor", 1, RESULT_INT,    0, NULL,                scalar_floor, batch_floor },
+};
+
+int find_builtin(const char* name)
+{
+    for (int id = 0; id < BI_COUNT; id++)
+    {
+        if (strcmp(Builtins[id].name, name) == 0)
+            return id;
+    }
+    return -1;
+}
+
+int eval_builtin_batch(BuiltinId id, const double* x, const double* y, double* out, size_t n)
+{
+    const Builtin* b = &Builtins[id];
+
+    // Checked before running the kernel, since the results may overwrite x
+    int ok = 1;
+    if (b->in_domain)
+    {
+        for (size_t k = 0; k < n && ok; k++)
+            ok = b->in_domain(x[k]);
+    }
+
+    b->batch(x, (b->n_args == 2) ? y : NULL, out, n);
+    return ok;
+}
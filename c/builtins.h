@@ -0,0 +1,84 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include <stddef.h>
+
+// ----- BUILT-IN FUNCTIONS -----
+
+/**
+ * Built-in math functions
+ */
+typedef enum builtin_id
+{
+    BI_SQRT,
+    BI_EXP,
+    BI_LOG,
+    BI_SIN,
+    BI_COS,
+    BI_ABS,
+    BI_MIN,
+    BI_MAX,
+    BI_FLOOR,
+    BI_COUNT,
+} BuiltinId;
+
+/**
+ * Rules for the data type of the result of a built-in function
+ */
+typedef enum builtin_result
+{
+    RESULT_FLOAT,       // Arguments are converted to FLOAT
+    RESULT_WIDEST,      // Arguments are converted to the widest of their types
+    RESULT_INT,         // Integer result, whatever the type of the argument
+} BuiltinResult;
+
+/**
+ * Contains the description and implementations of a built-in function.
+ * Functions of one argument ignore the second one
+ */
+typedef struct builtin
+{
+    const char* name;
+    int n_args;
+    BuiltinResult result;
+    int non_negative;                   // Whether the result is never negative
+    int (*in_domain)(double x);         // Valid arguments (```NULL``` if all are)
+    double (*scalar)(double x, double y);
+    void (*batch)(const double* x, const double* y, double* out, size_t n);
+} Builtin;
+
+/**
+ * Provides the built-in functions, indexed by identifier
+ */
+extern const Builtin Builtins[BI_COUNT];
+
+/**
+ * Obtains a built-in function by name
+ *
+ * @param name The name
+ *
+ * @return The identifier of the function, or ```-1``` if there is none
+ */
+int find_builtin(const char* name);
+
+/**
+ * Evaluates a built-in function over arrays of FLOAT arguments, using the
+ * vector instructions of the target where available
+ *
+ * @param id The function
+ * @param x The first argument of each call
+ * @param y The second argument of each call (```NULL``` for functions of
+ * one argument)
+ * @param out Where to store the results. May be ```x``` or ```y```
+ * @param n The number of calls
+ *
+ * @return ```1``` on success, or ```0``` if some argument is outside the
+ * domain of the function. The results of those calls are NaN
+ *
+ * @note The vector versions of ```exp```, ```log```, ```sin``` and ```cos```
+ * are polynomial approximations within a few units in the last place of
+ * the libm results
+ */
+int eval_builtin_batch(BuiltinId id, const double* x, const double* y, double* out, size_t n);
+
+#endif  // BUILTINS_H
@@ -0,0 +1,780 @@
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "columns.h"
+
+// ----- COLUMNS -----
+
+/**
+ * Contains the I/O done while a chunk is evaluated: the values of the
+ * previous chunk are written and the next chunk is read, both using the
+ * buffers the evaluation does not
+ */
+typedef struct column_job
+{
+    ColumnInput* inputs;
+    int n_inputs;
+    ColumnOutput* output;
+    int chunk;              // Buffers to use
+    int ok;                 // Whether the I/O succeeded
+} ColumnJob;
+
+// Auxiliary functions
+
+/**
+ * Obtains the format of a column file from its extension
+ *
+ * @param path The path of the file
+ * @param len The length of the path
+ *
+ * @return The format, or ```-1``` if the extension is not known
+ */
+int column_format(const char* path, size_t len)
+{
+    const char* extensions[] = { ".i64", ".f64", ".csv" };
+    for (int k = 0; k < 3; k++)
+        if (len >= 4 && memcmp(path + len - 4, extensions[k], 4) == 0)
+            return k;
+    return -1;
+}
+
+/**
+ * Finds the next line of a CSV file, reading more of the file if needed
+ *
+ * @param c The column
+ * @param line Where to store the start of the line
+ * @param len Where to store the length of the line, without its newline
+ *
+ * @return ```1``` if there is a line, ```0``` at the end of the file, or
+ * ```-1``` on a read error
+ *
+ * @note The line is valid until the next call
+ */
+int next_csv_line(ColumnInput* c, const char** line, size_t* len)
+{
+    while (1)
+    {
+        char* start = c->buf + c->buf_pos;
+        size_t avail = c->buf_len - c->buf_pos;
+        char* end = (char*) memchr(start, '\n', avail);
+
+        // The last line may have no newline
+        if (end != NULL || (c->eof && avail > 0))
+        {
+            size_t n = (end != NULL) ? (size_t) (end - start) : avail;
+            c->buf_pos += (end != NULL) ? n + 1 : n;
+            if (n > 0 && start[n - 1] == '\r')
+                n--;
+            c->line++;
+            *line = start;
+            *len = n;
+            return 1;
+        }
+        if (c->eof)
+            return 0;
+
+        // The partial line is moved to the front, and the buffer grows for
+        // lines longer than a read
+        memmove(c->buf, start, avail);
+        c->buf_len = avail;
+        c->buf_pos = 0;
+        if (c->buf_cap - c->buf_len < CSV_READ_LEN)
+        {
+            c->buf_cap *= 2;
+            c->buf = (char*) realloc(c->buf, c->buf_cap);
+        }
+
+        ssize_t n = read(c->fd, c->buf + c->buf_len, CSV_READ_LEN);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            c->eof = 1;
+        c->buf_len += n;
+    }
+}
+
+/**
+ * Finds a field of a CSV line. Surrounding spaces and quotes are skipped
+ *
+ * @param line The line
+ * @param len The length of the line
+ * @param field The index of the field
+ * @param start Where to store the start of the field
+ * @param field_len Where to store the length of the field
+ *
+ * @return Boolean-like value, false if the line has fewer fields
+ */
+int csv_field(const char* line, size_t len, int field, const char** start, size_t* field_len)
+{
+    const char* end = line + len;
+    for (int k = 0; k < field; k++)
+    {
+        const char* comma = (const char*) memchr(line, ',', end - line);
+        if (comma == NULL)
+            return 0;
+        line = comma + 1;
+    }
+
+    const char* comma = (const char*) memchr(line, ',', end - line);
+    if (comma != NULL)
+        end = comma;
+
+    while (line < end && *line == ' ')
+        line++;
+    while (end > line && end[-1] == ' ')
+        end--;
+    if (end - line >= 2 && *line == '"' && end[-1] == '"')
+    {
+        line++;
+        end--;
+    }
+
+    *start = line;
+    *field_len = end - line;
+    return 1;
+}
+
+/**
+ * Finds the field of a CSV column in the header of its file
+ *
+ * @param c The column, whose file is at its start
+ * @param field The name of the field of the column
+ *
+ * @return Boolean-like value, false after writing the error to ```stderr```
+ */
+int read_csv_header(ColumnInput* c, const char* field)
+{
+    const char* line;
+    size_t len;
+    if (next_csv_line(c, &line, &len) <= 0)
+    {
+        fprintf(stderr, "Cannot read the header of '%s'\n", c->path);
+        return 0;
+    }
+
+    const char* name;
+    size_t name_len;
+    for (c->field = 0; csv_field(line, len, c->field, &name, &name_len); c->field++)
+        if (name_len == strlen(field) && memcmp(name, field, name_len) == 0)
+            break;
+    if (!csv_field(line, len, c->field, &name, &name_len))
+    {
+        fprintf(stderr, "'%s' has no field '%s'\n", c->path, field);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Obtains the type of a CSV column without an explicit type: integers if
+ * all its values are integers, and decimals otherwise. The file is read
+ * up to its first decimal value, and then from its start again
+ *
+ * @param c The column, whose header has been read
+ * @param field The name of the field of the column
+ *
+ * @return Boolean-like value, false after writing the error to ```stderr```
+ */
+int scan_csv_type(ColumnInput* c, const char* field)
+{
+    const char* line;
+    size_t len;
+    int found;
+
+    c->type = INT;
+    while (c->type == INT && (found = next_csv_line(c, &line, &len)) > 0)
+    {
+        // Missing fields are reported when the rows are read
+        int64_t integer;
+        const char* text;
+        size_t text_len;
+        if (len > 0 && csv_field(line, len, c->field, &text, &text_len)
+            && !parse_int(text, text_len, &integer))
+            c->type = FLOAT;
+    }
+
+    if (c->type == INT && found < 0)
+    {
+        fprintf(stderr, "Cannot read '%s': %s\n", c->path, strerror(errno));
+        return 0;
+    }
+    if (lseek(c->fd, 0, SEEK_SET) < 0)
+    {
+        fprintf(stderr, "Cannot read '%s' twice to find the type of '%s', "
+                "give it as %s:i64 or %s:f64\n", c->path, c->name, c->name, c->name);
+        return 0;
+    }
+
+    c->buf_len = c->buf_pos = 0;
+    c->eof = 0;
+    c->line = 0;
+    return read_csv_header(c, field);
+}
+
+/**
+ * Reads the next chunk of a CSV column
+ *
+ * @param c The column
+ * @param chunk The buffer where the chunk is stored
+ *
+ * @return Boolean-like value, false after storing the error in the column
+ */
+int load_csv_chunk(ColumnInput* c, int chunk)
+{
+    DataValue* values = c->values[chunk];
+    int n = 0, found = 1;
+    const char* line;
+    size_t len;
+
+    while (n < COLUMN_CHUNK && (found = next_csv_line(c, &line, &len)) > 0)
+    {
+        // Empty lines have no row
+        if (len == 0)
+            continue;
+
+        const char* text;
+        size_t text_len;
+        if (!csv_field(line, len, c->field, &text, &text_len))
+        {
+            snprintf(c->error, COLUMN_ERROR_LEN, "Line %ld of '%s' has no field %d",
+                     c->line, c->path, c->field + 1);
+            return 0;
+        }
+
+        int parsed = (c->type == INT) ?
+            parse_int(text, text_len, &values[n].integer) :
+            parse_double(text, text_len, &values[n].decimal);
+        if (!parsed)
+        {
+            snprintf(c->error, COLUMN_ERROR_LEN, "Line %ld of '%s': '%.*s' is not %s",
+                     c->line, c->path, (int) ((text_len < 32) ? text_len : 32), text,
+                     (c->type == INT) ? "an integer" : "a number");
+            return 0;
+        }
+        n++;
+    }
+
+    if (found < 0)
+    {
+        snprintf(c->error, COLUMN_ERROR_LEN, "Cannot read '%s': %s", c->path, strerror(errno));
+        return 0;
+    }
+
+    c->chunk[chunk] = values;
+    c->n_rows[chunk] = n;
+    return 1;
+}
+
+/**
+ * Reads the next chunk of a raw column. Its rows are not copied, but its
+ * pages are read now, so that the evaluation does not wait for them
+ *
+ * @param c The column
+ * @param chunk The buffer where the chunk is stored
+ */
+void load_raw_chunk(ColumnInput* c, int chunk)
+{
+    // The chunk read last time into this buffer has been evaluated
+    long page = sysconf(_SC_PAGESIZE);
+    size_t done = c->offset - (size_t) c->n_rows[chunk ^ 1] * sizeof(DataValue);
+    done -= done % page;
+    if (done > c->released)
+    {
+        madvise((char*) c->map + c->released, done - c->released, MADV_DONTNEED);
+        c->released = done;
+    }
+
+    size_t n = (c->size - c->offset) / sizeof(DataValue);
+    if (n > COLUMN_CHUNK)
+        n = COLUMN_CHUNK;
+    c->chunk[chunk] = (const DataValue*) (c->map + c->offset);
+    c->n_rows[chunk] = n;
+
+    for (size_t pos = 0; pos < n * sizeof(DataValue); pos += page)
+        (void) *(volatile const char*) (c->map + c->offset + pos);
+    c->offset += n * sizeof(DataValue);
+}
+
+/**
+ * Writes the values of a chunk to an output column
+ *
+ * @param c The column
+ * @param chunk The buffer of the values, which is emptied
+ *
+ * @return Boolean-like value, false after storing the error in the column
+ */
+int store_column_rows(ColumnOutput* c, int chunk)
+{
+    StrBuf* rows = &c->rows[chunk];
+    size_t pos = 0;
+    while (pos < rows->len)
+    {
+        ssize_t n = write(c->fd, rows->data + pos, rows->len - pos);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            snprintf(c->error, COLUMN_ERROR_LEN, "Cannot write '%s': %s", c->path, strerror(errno));
+            return 0;
+        }
+        pos += n;
+    }
+
+    clear_str_buf(rows);
+    return 1;
+}
+
+/**
+ * Does the I/O of a chunk
+ *
+ * @param arg The ColumnJob
+ *
+ * @return ```NULL```
+ */
+void* run_column_io(void* arg)
+{
+    ColumnJob* job = (ColumnJob*) arg;
+
+    job->ok = store_column_rows(job->output, job->chunk);
+    for (int k = 0; k < job->n_inputs && job->ok; k++)
+    {
+        ColumnInput* c = &job->inputs[k];
+        if (c->format == COLUMN_CSV)
+            job->ok = load_csv_chunk(c, job->chunk);
+        else
+            load_raw_chunk(c, job->chunk);
+    }
+    return NULL;
+}
+
+/**
+ * Writes the I/O error of some columns
+ *
+ * @param inputs The input columns
+ * @param n_inputs The number of input columns
+ * @param output The output column
+ * @param out Where to write the error
+ */
+void format_column_error(const ColumnInput* inputs, int n_inputs, const ColumnOutput* output, StrBuf* out)
+{
+    const char* error = output->error;
+    for (int k = 0; k < n_inputs && *error == '\0'; k++)
+        error = inputs[k].error;
+
+    str_buf_append_str(out, error);
+    str_buf_append_char(out, '\n');
+}
+
+/**
+ * Assigns a variable to a column before its code is parsed, so that the
+ * code is typed with it
+ *
+ * @param s The session
+ * @param c The column
+ */
+void declare_column(Session* s, ColumnInput* c)
+{
+    c->slot = intern_symbol(&s->symbols, c->name, strlen(c->name));
+
+    Symbol* symbol = get_symbol(&s->symbols, c->slot);
+    symbol->type = (symbol->assigned) ? max_priority(symbol->type, c->type) : c->type;
+    symbol->assigned = 1;
+
+    reserve_environment(&s->env, c->slot + 1);
+    if (s->env.slots[c->slot] == VALUE_UNSET)
+        s->env.slots[c->slot] = (c->type == FLOAT) ? box_float(0) : box_int(0);
+}
+
+/**
+ * Stores the values of a row in the variables of the input columns
+ *
+ * @param s The session
+ * @param inputs The input columns
+ * @param n_inputs The number of input columns
+ * @param chunk The buffer of the chunk of the row
+ * @param row The index of the row in the chunk
+ */
+void bind_row(Session* s, const ColumnInput* inputs, int n_inputs, int chunk, int row)
+{
+    for (int k = 0; k < n_inputs; k++)
+    {
+        const ColumnInput* c = &inputs[k];
+        DataValue value = c->chunk[chunk][row];
+
+        Value* slot = &s->env.slots[c->slot];
+        release_value(*slot);
+        if (c->type == FLOAT)
+            *slot = box_float(value.decimal);
+        else if (c->bound == FLOAT)
+            *slot = box_float((double) value.integer);
+        else
+            *slot = box_int(value.integer);
+    }
+}
+
+/**
+ * Appends a value to the values of a chunk in the format of an output column
+ *
+ * @param c The column
+ * @param rows The values of the chunk
+ * @param value The value
+ *
+ * @return Boolean-like value, false if the format cannot hold the value
+ */
+int append_column_value(const ColumnOutput* c, StrBuf* rows, const DataType* value)
+{
+    double decimal;
+    switch (c->format)
+    {
+    case COLUMN_I64:
+        if (value->type != INT)
+            return 0;
+        str_buf_append(rows, (const char*) &value->value.integer, sizeof(int64_t));
+        return 1;
+
+    case COLUMN_F64:
+        if (value->type == FLOAT)
+            decimal = value->value.decimal;
+        else if (value->type == INT)
+            decimal = (double) value->value.integer;
+        else
+            decimal = bigint_to_double(value->value.big);
+        str_buf_append(rows, (const char*) &decimal, sizeof(double));
+        return 1;
+
+    default:
+        format_value(rows, value);
+        str_buf_append_char(rows, '\n');
+        return 1;
+    }
+}
+
+/**
+ * Writes the position of a row before an error
+ *
+ * @param out Where to write it
+ * @param row The index of the row
+ */
+void format_row(StrBuf* out, long row)
+{
+    char digits[24];
+    str_buf_append_str(out, "Row ");
+    str_buf_append(out, digits, format_int(row + 1, digits));
+    str_buf_append_str(out, ": ");
+}
+
+/**
+ * Evaluates the code for the rows of a chunk
+ *
+ * @param s The session
+ * @param root The AST of the code
+ * @param pool The workers for its forked subtrees, or ```NULL```
+ * @param inputs The input columns
+ * @param n_inputs The number of input columns
+ * @param output The output column
+ * @param chunk The buffer of the chunk
+ * @param first The index of the first row of the chunk
+ * @param out Where to write the error, if any
+ *
+ * @return Boolean-like value, false if a row failed
+ */
+int evaluate_chunk(
+    Session* s,
+    const ASTNode* root,
+    ThreadPool* pool,
+    const ColumnInput* inputs,
+    int n_inputs,
+    ColumnOutput* output,
+    int chunk,
+    long first,
+    StrBuf* out
+)
+{
+    StrBuf* rows = &output->rows[chunk];
+    for (int row = 0; row < inputs[0].n_rows[chunk]; row++)
+    {
+        bind_row(s, inputs, n_inputs, chunk, row);
+
+        Interpreter i = new_interpreter(root, &s->env);
+        i.pool = pool;
+        set_budget(&i, &s->budget);
+        Result r = interpret(&i);
+
+        if (r.result == NULL)
+        {
+            format_row(out, first + row);
+            format_error(out, r.err);
+            return 0;
+        }
+
+        int ok = append_column_value(output, rows, r.result);
+        free_value(r.result);
+        if (!ok)
+        {
+            format_row(out, first + row);
+            str_buf_append_str(out, "Integer too large for an .i64 column\n");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+// Public functions
+
+int open_column_input(ColumnInput* c, const char* spec)
+{
+    const char* eq = strchr(spec, '=');
+    size_t name_len = (eq != NULL) ? (size_t) (eq - spec) : 0;
+
+    // The name may be followed by the type of the values
+    int type = -1;
+    const char* colon = (eq != NULL) ? (const char*) memchr(spec, ':', name_len) : NULL;
+    if (colon != NULL)
+    {
+        if (eq - colon == 4 && memcmp(colon, ":i64", 4) == 0)
+            type = INT;
+        else if (eq - colon == 4 && memcmp(colon, ":f64", 4) == 0)
+            type = FLOAT;
+        name_len = (type >= 0) ? (size_t) (colon - spec) : 0;
+    }
+    if (name_len == 0 || name_len >= MAX_TOK_VAL_LEN)
+    {
+        fprintf(stderr, "Invalid column '%s', expected name=path or name:type=path "
+                "(i64 or f64)\n", spec);
+        return 0;
+    }
+
+    memset(c, 0, sizeof(ColumnInput));
+    c->fd = -1;
+    memcpy(c->name, spec, name_len);
+    c->path = strdup(eq + 1);
+
+    // CSV paths may be followed by the name of the field
+    const char* field = c->name;
+    char* field_colon = strrchr(c->path, ':');
+    if (field_colon != NULL && column_format(c->path, field_colon - c->path) == COLUMN_CSV)
+    {
+        *field_colon = '\0';
+        field = field_colon + 1;
+    }
+
+    int format = column_format(c->path, strlen(c->path));
+    if (format < 0)
+    {
+        fprintf(stderr, "Unknown format of '%s', expected .i64, .f64 or .csv\n", c->path);
+        close_column_input(c);
+        return 0;
+    }
+    c->format = (ColumnFormat) format;
+    c->type = (format == COLUMN_F64) ? FLOAT : INT;
+    if (type >= 0 && format != COLUMN_CSV && type != (int) c->type)
+    {
+        fprintf(stderr, "'%s' does not hold the type of '%s'\n", c->path, c->name);
+        close_column_input(c);
+        return 0;
+    }
+
+    int fd = open(c->path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0)
+    {
+        fprintf(stderr, "Cannot open '%s': %s\n", c->path, strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        close_column_input(c);
+        return 0;
+    }
+
+    if (c->format == COLUMN_CSV)
+    {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        c->fd = fd;
+        c->buf_cap = 2 * CSV_READ_LEN;
+        c->buf = (char*) malloc(c->buf_cap);
+        c->values[0] = (DataValue*) malloc(COLUMN_CHUNK * sizeof(DataValue));
+        c->values[1] = (DataValue*) malloc(COLUMN_CHUNK * sizeof(DataValue));
+        int ok = read_csv_header(c, field);
+        if (ok && type >= 0)
+            c->type = (TypePriority) type;
+        else if (ok)
+            ok = scan_csv_type(c, field);
+        if (!ok)
+            close_column_input(c);
+        return ok;
+    }
+
+    if (st.st_size % sizeof(DataValue) != 0)
+    {
+        fprintf(stderr, "'%s' does not hold 8-byte values\n", c->path);
+        close(fd);
+        close_column_input(c);
+        return 0;
+    }
+
+    // Empty files cannot be mapped
+    c->size = st.st_size;
+    if (c->size > 0)
+    {
+        void* map = mmap(NULL, c->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            fprintf(stderr, "Cannot map '%s': %s\n", c->path, strerror(errno));
+            close(fd);
+            c->size = 0;
+            close_column_input(c);
+            return 0;
+        }
+        madvise(map, c->size, MADV_SEQUENTIAL);
+        c->map = (const char*) map;
+    }
+
+    // The mapping stays valid after the file is closed
+    close(fd);
+    return 1;
+}
+
+void close_column_input(ColumnInput* c)
+{
+    if (c->size > 0)
+        munmap((void*) c->map, c->size);
+    if (c->fd >= 0)
+        close(c->fd);
+    free(c->values[0]);
+    free(c->values[1]);
+    free(c->buf);
+    free(c->path);
+}
+
+int open_column_output(ColumnOutput* c, const char* path)
+{
+    int format = column_format(path, strlen(path));
+    if (format < 0)
+    {
+        fprintf(stderr, "Unknown format of '%s', expected .i64, .f64 or .csv\n", path);
+        return 0;
+    }
+
+    c->path = path;
+    c->format = (ColumnFormat) format;
+    c->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (c->fd < 0)
+    {
+        fprintf(stderr, "Cannot create '%s': %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    c->rows[0] = new_str_buf(COLUMN_CHUNK * sizeof(double));
+    c->rows[1] = new_str_buf(COLUMN_CHUNK * sizeof(double));
+    c->error[0] = '\0';
+    return 1;
+}
+
+void close_column_output(ColumnOutput* c)
+{
+    close(c->fd);
+    free_str_buf(&c->rows[0]);
+    free_str_buf(&c->rows[1]);
+}
+
+int run_columns(
+    Session* s,
+    Lexer* l,
+    ColumnInput* inputs,
+    int n_inputs,
+    ColumnOutput* output,
+    StrBuf* out
+)
+{
+    for (int k = 0; k < n_inputs; k++)
+        declare_column(s, &inputs[k]);
+
+    LexerResult lr;
+    ASTNode* root = compile_code(s, l, &lr, out);
+    if (root == NULL)
+        return 0;
+
+    const char* problem = NULL;
+    if (n_inputs == 0)
+        problem = "There are no input columns";
+    else if (root->type == NONE)
+        problem = "The code has no value to write";
+    else if (output->format == COLUMN_I64 && root->type == FLOAT)
+        problem = "Decimal values cannot be written to an .i64 column";
+    if (problem != NULL)
+    {
+        str_buf_append_str(out, problem);
+        str_buf_append_char(out, '\n');
+        free_node(root);
+        free_lexer_result(&lr);
+        return 0;
+    }
+
+    // Integer columns may be bound to variables widened by the code
+    for (int k = 0; k < n_inputs; k++)
+        inputs[k].bound = get_symbol(&s->symbols, inputs[k].slot)->type;
+    ThreadPool* pool = (s->pool && plan_forks(root)) ? s->pool : NULL;
+
+    // The first chunk is read before anything is evaluated
+    ColumnJob job = { inputs, n_inputs, output, 0, 1 };
+    run_column_io(&job);
+    int ok = job.ok, chunk = 0;
+    if (!ok)
+        format_column_error(inputs, n_inputs, output, out);
+
+    long first = 0;
+    while (ok)
+    {
+        int n = inputs[0].n_rows[chunk];
+        for (int k = 1; k < n_inputs && ok; k++)
+        {
+            if (inputs[k].n_rows[chunk] == n)
+                continue;
+            str_buf_append_str(out, "Columns '");
+            str_buf_append_str(out, inputs[0].name);
+            str_buf_append_str(out, "' and '");
+            str_buf_append_str(out, inputs[k].name);
+            str_buf_append_str(out, "' have different numbers of rows\n");
+            ok = 0;
+        }
+        if (!ok || n == 0)
+            break;
+
+        // The next chunk is read, and the values of the previous one
+        // written, while this one is evaluated
+        pthread_t io;
+        job.chunk = chunk ^ 1;
+        pthread_create(&io, NULL, run_column_io, &job);
+        ok = evaluate_chunk(s, root, pool, inputs, n_inputs, output, chunk, first, out);
+        pthread_join(io, NULL);
+
+        if (ok && !job.ok)
+        {
+            format_column_error(inputs, n_inputs, output, out);
+            ok = 0;
+        }
+        if (!ok)
+            break;
+
+        first += n;
+        chunk ^= 1;
+    }
+
+    // The values of the rows before an error are written too
+    int stored = store_column_rows(output, chunk ^ 1) && store_column_rows(output, chunk);
+    if (ok && !stored)
+    {
+        format_column_error(inputs, n_inputs, output, out);
+        ok = 0;
+    }
+
+    free_node(root);
+    free_lexer_result(&lr);
+    return ok;
+}
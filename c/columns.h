@@ -0,0 +1,146 @@
+#ifndef COLUMNS_H
+#define COLUMNS_H
+
+#include "session.h"
+
+// ----- COLUMNS -----
+
+// An expression is evaluated once per row of a set of input columns, each
+// bound to a variable, and its values form an output column. Columns are
+// raw arrays of 64-bit integers (```.i64```) or doubles (```.f64```) in
+// native byte order, or fields of CSV files with a header line (```.csv```)
+
+// Number of rows evaluated per chunk. The next chunk is read, and the
+// results of the previous one written, while a chunk is evaluated
+#define COLUMN_CHUNK 65536
+
+// Size of each read from a CSV file, in bytes
+#define CSV_READ_LEN (1 << 20)
+
+// Largest length of an I/O error message
+#define COLUMN_ERROR_LEN 256
+
+/**
+ * Formats of column files
+ */
+typedef enum column_format
+{
+    COLUMN_I64,         // Raw 64-bit integers
+    COLUMN_F64,         // Raw doubles
+    COLUMN_CSV,         // Field of a CSV file, or values one per line on output
+} ColumnFormat;
+
+/**
+ * Contains an input column and the chunks read from it
+ */
+typedef struct column_input
+{
+    char name[MAX_TOK_VAL_LEN];     // Variable bound to the column
+    char* path;
+    ColumnFormat format;
+    TypePriority type;              // Type of the values (```INT``` or ```FLOAT```)
+    int slot;                       // Environment slot of the variable
+    TypePriority bound;             // Type of the variable, which may be wider
+
+    // Raw files are mapped, and their chunks point into the mapping
+    const char* map;
+    size_t size;
+    size_t offset;                  // Bytes already read
+    size_t released;                // Length of the prefix whose pages were released
+
+    // CSV files are read in blocks, and their chunks are parsed into values
+    int fd;
+    char* buf;
+    size_t buf_len;                 // Bytes read into the buffer
+    size_t buf_pos;                 // Start of the next line in the buffer
+    size_t buf_cap;
+    int eof;
+    int field;                      // Index of the field of the column
+    long line;                      // Number of lines read
+    DataValue* values[2];
+
+    const DataValue* chunk[2];      // Rows of the chunk being evaluated and the next one
+    int n_rows[2];
+    char error[COLUMN_ERROR_LEN];   // Error of the last read (empty if none)
+} ColumnInput;
+
+/**
+ * Contains an output column and the results waiting to be written to it
+ */
+typedef struct column_output
+{
+    const char* path;
+    ColumnFormat format;
+    int fd;
+    StrBuf rows[2];                 // Results of the chunk being evaluated and the previous one
+    char error[COLUMN_ERROR_LEN];   // Error of the last write (empty if none)
+} ColumnOutput;
+
+/**
+ * Opens an input column
+ *
+ * @param c Where to store the column
+ * @param spec The binding: ```name=path```, or ```name=path:field``` to
+ * read a CSV field with another name than the variable. The name may be
+ * followed by the type of the values, as in ```name:f64=path```
+ *
+ * @return Boolean-like value, false after writing the error to ```stderr```
+ *
+ * @note Remember to call ```close_column_input``` afterwards
+ * @note CSV columns without a type hold integers if all their values are
+ * integers, and decimals otherwise, which takes an extra read of the file
+ * up to its first decimal value
+ */
+int open_column_input(ColumnInput* c, const char* spec);
+
+/**
+ * Closes an input column
+ *
+ * @param c The column
+ */
+void close_column_input(ColumnInput* c);
+
+/**
+ * Creates an output column, replacing the file if it exists
+ *
+ * @param c Where to store the column
+ * @param path The path of the file, whose extension gives the format
+ *
+ * @return Boolean-like value, false after writing the error to ```stderr```
+ *
+ * @note Remember to call ```close_column_output``` afterwards
+ */
+int open_column_output(ColumnOutput* c, const char* path);
+
+/**
+ * Closes an output column
+ *
+ * @param c The column
+ */
+void close_column_output(ColumnOutput* c);
+
+/**
+ * Evaluates an expression for every row of some input columns, which are
+ * bound to their variables, and writes its values to an output column.
+ * The code is compiled once and its AST is run for all the rows
+ *
+ * @param s The session, whose variables and functions the code may use
+ * @param l The lexer of the code
+ * @param inputs The input columns
+ * @param n_inputs The number of input columns
+ * @param output The output column
+ * @param out Where to write the error, if any
+ *
+ * @return Boolean-like value, false if the code or the files failed. The
+ * values of the rows before an error are written
+ */
+int run_columns(
+    Session* s,
+    Lexer* l,
+    ColumnInput* inputs,
+    int n_inputs,
+    ColumnOutput* output,
+    StrBuf* out
+);
+
+#endif  // COLUMNS_H
@@ -1,6 +1,40 @@
-#include "lexer.h"
-#include "parser.h"
-#include "interpreter.h"
+/**
+ * Console of the C implementation
+ *
+ * Usage: ```console [--limits list] [mode]```, where the mode is one of:
+ *
+ * - Nothing: lines are read from the console, and variables and functions
+ * persist across them until ```q``` or ```quit```
+ * - ```script.mc```: the file is run as a script. Each statement is lexed,
+ * parsed and evaluated before the next one is read, newlines separate
+ * statements except inside parentheses, the value of each one is printed,
+ * and the script stops at the first error
+ * - ```--serve path```: requests are answered on a Unix domain socket, or
+ * on stdin and stdout for ```--serve -```, with a session per client (see
+ * server.h for the frames)
+ * - ```--ring /name```: the same frames are served to local producers
+ * through a shared memory segment (see ring.h)
+ * - ```--columns code output name=path...```: the code is evaluated for
+ * every row of the input columns, each bound to a variable, and its
+ * values are written to the output column (see columns.h for the formats
+ * and ```open_column_input``` for the bindings)
+ *
+ * ```--limits steps=N,depth=N,memory=BYTES,time=SECONDS``` (any subset)
+ * limits each line, statement, request or row (see ```Budget```)
+ *
+ * The console is built with the library (see engine.c)
+ */
+
+#include "session.h"
+#include "script.h"
+#include "server.h"
+#include "columns.h"
+
+#include <unistd.h>
+#include <errno.h>
+
+// Size of the batch writer used for the console output
+#define CONSOLE_BUF_LEN (64 * 1024)
 
 char* strip(char* str)
 {
@@ -9,9 +43,13 @@ char* strip(char* str)
     while (str[i] == ' ' || str[i] == '\t')
         i++;
     
-    while (str[i] != ' ' && str[i] != '\t' && str[i] != '\0')
+    while (str[i] != '\0')
         str[j++] = str[i++];
 
+    // Names make "q = 1" a valid line, so only trailing blanks are removed
+    while (j > 0 && (str[j - 1] == ' ' || str[j - 1] == '\t'))
+        j--;
+
     str[j] = '\0';
 
     return str;
@@ -30,55 +68,176 @@ char* lower(char* str)
     return str;
 }
 
-int main()
+/**
+ * Evaluates an expression for every row of some column files
+ *
+ * @param s The session
+ * @param code The expression
+ * @param path The path of the output column
+ * @param specs The bindings of the input columns (```name=path``` or
+ * ```name:type=path```)
+ * @param n_specs The number of input columns
+ * @param out Where to write the error
+ *
+ * @return The exit status of the console
+ */
+int run_column_files(Session* s, const char* code, const char* path, char** specs, int n_specs, StrBuf* out)
+{
+    ColumnInput* inputs = (ColumnInput*) malloc(n_specs * sizeof(ColumnInput));
+    int n_open = 0;
+    while (n_open < n_specs && open_column_input(&inputs[n_open], specs[n_open]))
+        n_open++;
+
+    ColumnOutput output;
+    int ok = (n_open == n_specs) && open_column_output(&output, path);
+    if (ok)
+    {
+        Lexer l = new_lexer(code);
+        ok = run_columns(s, &l, inputs, n_specs, &output, out);
+        close_column_output(&output);
+    }
+
+    for (int k = 0; k < n_open; k++)
+        close_column_input(&inputs[k]);
+    free(inputs);
+    return (ok) ? 0 : 1;
+}
+
+/**
+ * Runs a script file statement by statement, writing the value of each
+ * one, and stops at the first error
+ *
+ * @param s The session
+ * @param path The path of the file
+ * @param out Where to write the values and the error
+ *
+ * @return The exit status of the console
+ */
+int run_script(Session* s, const char* path, StrBuf* out)
+{
+    Script script;
+    if (!open_script(&script, path))
+    {
+        fprintf(stderr, "Cannot open '%s': %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    // Only one statement is lexed, parsed and evaluated at a time
+    int ok = 1;
+    Lexer l;
+    while (ok && next_statement(&script, &l))
+        ok = run_code(s, &l, out);
+
+    close_script(&script);
+    return (ok) ? 0 : 1;
+}
+
+/**
+ * Runs the lines typed in the console until it is closed or quit
+ *
+ * @param s The session
+ * @param out Where to write the values and errors
+ */
+void run_console(Session* s, StrBuf* out)
 {
     char text[100], aux[100];
-    printf("Type 'q' or 'Quit' to quit.\n");
+
+    // Interactive sessions flush before waiting for input so that the
+    // prompt is visible
+    int interactive = isatty(fileno(stdin));
+
+    str_buf_append_str(out, "Type 'q' or 'Quit' to quit.\n");
     while (1)
     {
-        printf("mc > ");
-        fgets(text, sizeof(text), stdin);
-        text[strlen(text) - 1] = '\0';
+        str_buf_append_str(out, "mc > ");
+        if (interactive)
+            flush_str_buf(out);
+
+        if (fgets(text, sizeof(text), stdin) == NULL)
+            break;
+        text[strcspn(text, "\n")] = '\0';
 
         lower(strip(strcpy(aux, text)));
         if (strcmp(aux, "q") == 0 || strcmp(aux, "quit") == 0)
             break;
 
-        Lexer l = new_lexer(text);
-        LexerResult lr = tokenize(&l);
-
-        if (lr.tokens == NULL && lr.size != 0)
+        // Statistics of the result caches
+        if (strcmp(aux, ":memo") == 0)
         {
-            print_error(lr.err);
-            free_lexer_result(&lr);
+            format_memo_stats(out, &s->functions);
             continue;
         }
 
-        Parser p = new_parser(lr);
-        ParserResult pr = parse(&p);
+        Lexer l = new_lexer(text);
+        run_code(s, &l, out);
+    }
+}
 
-        if (pr.root == NULL)
+int main(int argc, char** argv)
+{
+    // '--limits list' limits every evaluation of the sessions, in any mode
+    Budget budget = { 0 };
+    if (argc > 2 && strcmp(argv[1], "--limits") == 0)
+    {
+        if (!parse_budget(argv[2], &budget))
         {
-            print_error(pr.err);
-            free_lexer_result(&lr);
-            continue;
+            fprintf(stderr, "Invalid limits '%s'\n", argv[2]);
+            return 1;
         }
+        argc -= 2;
+        argv += 2;
+    }
 
-        Interpreter i = new_interpreter(pr.root);
-        Result r = interpret(&i);
+    // Results are written in blocks
+    char* storage = (char*) malloc(CONSOLE_BUF_LEN);
+    StrBuf out = new_stream_str_buf(stdout, storage, CONSOLE_BUF_LEN);
 
-        if (r.result == NULL)
-        {
-            print_error(r.err);
-            free_lexer_result(&lr);
-            free_node(pr.root);
-            continue;
-        }
+    // Huge expressions are split among the cores, if there are several
+    long n_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int n_threads = (n_cores > 1) ? (int) n_cores : 1;
+    ThreadPool* pool = (n_cores > 1) ? new_thread_pool(n_threads) : NULL;
 
-        print_value(r.result);
-        printf("\n");
+    int status = 0;
 
-        free_lexer_result(&lr);
-        free_node(pr.root);
+    // '--serve path' answers requests on a socket, or on stdin and stdout
+    // for '--serve -', and '--ring name' on a shared memory segment, with
+    // a session per client
+    if (argc > 2 && strcmp(argv[1], "--serve") == 0)
+    {
+        if (strcmp(argv[2], "-") == 0)
+            status = !serve_pipes(STDIN_FILENO, STDOUT_FILENO, pool, n_threads, &budget);
+        else
+            status = !serve_socket(argv[2], pool, n_threads, &budget);
+    }
+    else if (argc > 2 && strcmp(argv[1], "--ring") == 0)
+        status = !serve_ring(argv[2], pool, n_threads, &budget);
+
+    // '--columns code output name=path...' evaluates the code for every row
+    // of the input columns
+    else if (argc > 4 && strcmp(argv[1], "--columns") == 0)
+    {
+        Session s = new_session(pool, n_threads);
+        s.budget = budget;
+        status = run_column_files(&s, argv[2], argv[3], argv + 4, argc - 4, &out);
+        free_session(&s);
     }
+
+    // Otherwise variables and functions persist across lines, and a file
+    // argument is run as a script instead of reading lines
+    else
+    {
+        Session s = new_session(pool, n_threads);
+        s.budget = budget;
+        if (argc > 1)
+            status = run_script(&s, argv[1], &out);
+        else
+            run_console(&s, &out);
+        free_session(&s);
+    }
+
+    if (pool)
+        free_thread_pool(pool);
+    free_str_buf(&out);
+    free(storage);
+    return status;
 }
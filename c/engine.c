@@ -0,0 +1,153 @@
+/**
+ * Library interface of the C implementation, for programs that embed it
+ *
+ * Build the static library from the ```c``` directory with:
+ * ```for f in bigint numconv strbuf symbols base value lexer parser ranges functions builtins licm typing fusion parallel interpreter session engine; do gcc -O2 -fPIC -c $f.c || break; done && ar rcs libengine.a bigint.o numconv.o strbuf.o symbols.o base.o value.o lexer.o parser.o ranges.o functions.o builtins.o licm.o typing.o fusion.o parallel.o interpreter.o session.o engine.o```
+ *
+ * or the shared library with:
+ * ```gcc -O2 -shared -fPIC -o libengine.so bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c session.c engine.c -lm -lpthread```
+ *
+ * and link programs against either with ```-L. -lengine -lm -lpthread```.
+ * The console is the library plus its own modes:
+ * ```gcc -O2 -o console console.c script.c ring.c server.c columns.c -L. -lengine -lm -lpthread```
+ */
+
+
+#include "engine.h"
+
+// ----- ENGINES -----
+
+// Auxiliary functions
+
+/**
+ * Keeps the error of a failed evaluation in its engine. The messages are
+ * formatted right away, since the names they mention belong to the tokens
+ * of the code
+ *
+ * @param e The engine
+ * @param err The error
+ */
+void keep_error(Engine* e, const Error err)
+{
+    StrBuf b = new_fixed_str_buf(e->message, sizeof(e->message));
+    format_error(&b, err);
+    e->message[strcspn(e->message, "\n")] = '\0';
+
+    b = new_fixed_str_buf(e->details, sizeof(e->details));
+    format_error_message(&b, err);
+
+    e->err = err;
+    e->err.args = (ErrorArgs) { 0 };
+
+    e->stats.n_errors++;
+    if (is_limit_error(err))
+        e->stats.n_limited++;
+}
+
+// Public functions
+
+EngineOptions default_engine_options(void)
+{
+    return (EngineOptions) {
+        .n_threads = 1,
+        .budget = { 0 },
+    };
+}
+
+Engine* new_engine(const EngineOptions* options)
+{
+    Engine* e = (Engine*) calloc(1, sizeof(Engine));
+    e->options = (options) ? *options : default_engine_options();
+    if (e->options.n_threads < 1)
+        e->options.n_threads = 1;
+
+    e->pool = (e->options.n_threads > 1) ? new_thread_pool(e->options.n_threads) : NULL;
+    e->session = new_session(e->pool, e->options.n_threads);
+    e->session.budget = e->options.budget;
+    return e;
+}
+
+void free_engine(Engine* e)
+{
+    free_session(&e->session);
+    if (e->pool)
+        free_thread_pool(e->pool);
+    free(e);
+}
+
+void reset_engine(Engine* e)
+{
+    free_session(&e->session);
+    e->session = new_session(e->pool, e->options.n_threads);
+    e->session.budget = e->options.budget;
+}
+
+void set_engine_budget(Engine* e, const Budget* budget)
+{
+    e->options.budget = *budget;
+    e->session.budget = *budget;
+}
+
+DataType* engine_eval(Engine* e, const char* text)
+{
+    double start = monotonic_time();
+    e->stats.n_evals++;
+
+    Lexer l = new_lexer(text);
+    LexerResult lr;
+    Error err;
+    ASTNode* root = build_code(&e->session, &l, &lr, &err);
+
+    DataType* value = NULL;
+    if (root == NULL)
+        keep_error(e, err);
+    else
+    {
+        Result r = eval_code(&e->session, root);
+        if (r.result == NULL)
+            keep_error(e, r.err);
+        value = r.result;
+        free_node(root);
+    }
+
+    free_lexer_result(&lr);
+    e->stats.seconds += monotonic_time() - start;
+    return value;
+}
+
+int engine_run(Engine* e, const char* text, StrBuf* out)
+{
+    DataType* value = engine_eval(e, text);
+    if (value == NULL)
+    {
+        str_buf_append_str(out, e->message);
+        str_buf_append_char(out, '\n');
+        return 0;
+    }
+
+    // Definitions have no value to show
+    if (value->type != NONE)
+    {
+        format_value(out, value);
+        str_buf_append_char(out, '\n');
+    }
+
+    free_value(value);
+    return 1;
+}
+
+EngineStats get_engine_stats(const Engine* e)
+{
+    EngineStats stats = e->stats;
+    const FunctionTable* t = &e->session.functions;
+    for (int s = 0; s < t->size; s++)
+    {
+        const Function* f = t->functions[s];
+        if (f == NULL || f->cache == NULL)
+            continue;
+
+        stats.memo_hits += f->cache->hits;
+        stats.memo_misses += f->cache->misses;
+    }
+    return stats;
+}
@@ -0,0 +1,136 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "session.h"
+
+// ----- ENGINES -----
+
+// Library interface, for programs that embed the language. An engine
+// holds everything an evaluation touches, and the modules keep no global
+// state other than constant tables, so each thread may own an engine and
+// evaluate with it without locks. Nothing is printed: values are returned
+// and errors are kept in the engine. The build commands of the library
+// are in engine.c
+
+// Size of the buffers of the error messages
+#define ENGINE_MESSAGE_LEN 256
+
+/**
+ * Contains the options of an engine
+ */
+typedef struct engine_options
+{
+    int n_threads;          // Threads that lex huge texts and evaluate huge expressions (1 to run sequentially)
+    Budget budget;          // Limits of each evaluation (none by default)
+} EngineOptions;
+
+/**
+ * Contains the statistics of the evaluations of an engine
+ */
+typedef struct engine_stats
+{
+    uint64_t n_evals;       // Evaluations run
+    uint64_t n_errors;      // Evaluations that failed, of any type
+    uint64_t n_limited;     // Evaluations that exceeded a limit
+    double seconds;         // Time spent in evaluations
+    uint64_t memo_hits;     // Calls answered by the result caches
+    uint64_t memo_misses;   // Calls to memoized functions that were run
+} EngineStats;
+
+/**
+ * Contains a context that evaluates code: the variables and functions
+ * with their result caches, the workers, the options and the statistics,
+ * and the last error
+ */
+typedef struct engine
+{
+    Session session;
+    ThreadPool* pool;       // Workers of the engine (```NULL``` if sequential)
+    EngineOptions options;
+    EngineStats stats;      // Statistics of the evaluations (see ```get_engine_stats```)
+    Error err;              // Last error (its arguments are not kept)
+    char message[ENGINE_MESSAGE_LEN];   // Full description of the last error
+    char details[ENGINE_MESSAGE_LEN];   // Message of the last error alone
+} Engine;
+
+/**
+ * Obtains the default options of an engine: sequential and unlimited
+ *
+ * @return The options
+ */
+EngineOptions default_engine_options(void);
+
+/**
+ * Creates an engine with no variables or functions
+ *
+ * @param options The options, or ```NULL``` for the default ones
+ *
+ * @return The new engine
+ *
+ * @note Remember to call ```free_engine``` afterwards
+ * @note An engine runs code in one thread at a time, and separate
+ * engines may run in parallel
+ */
+Engine* new_engine(const EngineOptions* options);
+
+/**
+ * Frees an engine, with its variables, functions and workers
+ *
+ * @param e The engine
+ */
+void free_engine(Engine* e);
+
+/**
+ * Forgets the variables and functions of an engine, keeping its options,
+ * statistics and workers
+ *
+ * @param e The engine
+ */
+void reset_engine(Engine* e);
+
+/**
+ * Changes the limits of the next evaluations of an engine
+ *
+ * @param e The engine
+ * @param budget The limits
+ */
+void set_engine_budget(Engine* e, const Budget* budget);
+
+/**
+ * Evaluates a line or statement, whose variables and functions persist
+ * in the engine
+ *
+ * @param e The engine
+ * @param text The code
+ *
+ * @return The value of the code, of type ```NONE``` for definitions, or
+ * ```NULL``` if it failed, in which case the fields ```err```,
+ * ```message``` and ```details``` of the engine describe the error
+ *
+ * @note Remember to call ```free_value``` afterwards
+ */
+DataType* engine_eval(Engine* e, const char* text);
+
+/**
+ * Evaluates a line or statement, as ```engine_eval``` does, and writes
+ * its value, or its error, as the console shows them
+ *
+ * @param e The engine
+ * @param text The code
+ * @param out Where to write the value or the error
+ *
+ * @return Boolean-like value, false if the code failed
+ */
+int engine_run(Engine* e, const char* text, StrBuf* out);
+
+/**
+ * Obtains the statistics of an engine, including those of the result
+ * caches of its functions
+ *
+ * @param e The engine
+ *
+ * @return The statistics
+ */
+EngineStats get_engine_stats(const Engine* e);
+
+#endif  // ENGINE_H
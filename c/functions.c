@@ -0,0 +1,385 @@
+#include "functions.h"
+#include "numconv.h"
+
+// ----- FUNCTIONS -----
+
+// Auxiliary functions
+
+/**
+ * Creates an empty result cache
+ *
+ * @param n_args The number of arguments of the function
+ *
+ * @return The new cache
+ */
+MemoCache* new_memo_cache(int n_args)
+{
+    MemoCache* cache = (MemoCache*) malloc(sizeof(MemoCache));
+    cache->entries = (MemoEntry*) calloc(MEMO_CACHE_SIZE, sizeof(MemoEntry));
+    cache->n_args = n_args;
+    cache->count = 0;
+    cache->hits = cache->misses = cache->evictions = 0;
+    return cache;
+}
+
+/**
+ * Frees the key and result of a cache entry, leaving it empty
+ *
+ * @param cache The cache
+ * @param entry The entry
+ */
+void clear_memo_entry(MemoCache* cache, MemoEntry* entry)
+{
+    free_frame(entry->args, cache->n_args);
+    release_value(entry->result);
+    entry->spec = NULL;
+    entry->args = NULL;
+    entry->result = VALUE_UNSET;
+}
+
+/**
+ * Empties a result cache. Its statistics are kept
+ *
+ * @param cache The cache
+ */
+void clear_memo_cache(MemoCache* cache)
+{
+    for (int k = 0; k < MEMO_CACHE_SIZE; k++)
+    {
+        if (cache->entries[k].spec)
+            clear_memo_entry(cache, &cache->entries[k]);
+    }
+    cache->count = 0;
+}
+
+/**
+ * Mixes a 64-bit word into a hash (FNV-1a)
+ *
+ * @param h The hash
+ * @param word The word
+ *
+ * @return The new hash
+ */
+uint64_t hash_word(uint64_t h, uint64_t word)
+{
+    for (int k = 0; k < 8; k++)
+    {
+        h ^= (word >> (8 * k)) & 0xFF;
+        h *= 1099511628211u;
+    }
+    return h;
+}
+
+/**
+ * Obtains the cache entry of a call
+ *
+ * @param cache The cache
+ * @param spec The callee
+ * @param args The values of the arguments
+ *
+ * @return The entry
+ */
+MemoEntry* find_memo_entry(MemoCache* cache, const Specialization* spec, const Value* args)
+{
+    uint64_t h = hash_word(14695981039346656037u, (uint64_t) (uintptr_t) spec);
+    for (int k = 0; k < cache->n_args; k++)
+    {
+        // Values that are not allocated are their own hash key
+        if (!is_boxed_value(args[k]))
+        {
+            h = hash_word(h, args[k]);
+            continue;
+        }
+
+        const DataType* data = view_value(args[k], NULL);
+        uint64_t bits;
+        double decimal;
+        if (data->type == BIGINT)
+        {
+            decimal = bigint_to_double(data->value.big);
+            memcpy(&bits, &decimal, sizeof(bits));
+        }
+        else
+            bits = (uint64_t) data->value.integer;
+        h = hash_word(h ^ data->type, bits);
+    }
+    return &cache->entries[h & (MEMO_CACHE_SIZE - 1)];
+}
+
+/**
+ * Checks whether two values are the same key of a cache
+ *
+ * @param a The first value
+ * @param b The second value
+ *
+ * @return Boolean-like value
+ *
+ * @note Floats are compared by representation, so ```0.0``` and ```-0.0```
+ * are different keys
+ */
+int same_key(Value a, Value b)
+{
+    // Integers only take a single form, so values that are not allocated
+    // are the same key if they have the same bits
+    if (!is_boxed_value(a) || !is_boxed_value(b))
+        return a == b;
+
+    const DataType* x = view_value(a, NULL);
+    const DataType* y = view_value(b, NULL);
+    if (x->type != y->type)
+        return 0;
+    if (x->type == INT)
+        return x->value.integer == y->value.integer;
+    return bigint_cmp(x->value.big, y->value.big) == 0;
+}
+
+/**
+ * Moves every specialization of a function to the discarded ones
+ *
+ * @param t The table
+ * @param f The function
+ */
+void discard_specializations(FunctionTable* t, Function* f)
+{
+    while (f->specs)
+    {
+        Specialization* spec = f->specs;
+        f->specs = spec->next;
+        spec->next = t->stale;
+        t->stale = spec;
+    }
+}
+
+/**
+ * Frees the memory used by a specialization
+ *
+ * @param spec The specialization
+ */
+void free_specialization(Specialization* spec)
+{
+    free(spec->params);
+    free(spec->locals);
+    if (spec->body)
+        free_node(spec->body);
+    free(spec);
+}
+
+/**
+ * Frees the memory used by a function
+ *
+ * @param f The function
+ */
+void free_function(Function* f)
+{
+    while (f->specs)
+    {
+        Specialization* spec = f->specs;
+        f->specs = spec->next;
+        free_specialization(spec);
+    }
+
+    if (f->cache)
+    {
+        clear_memo_cache(f->cache);
+        free(f->cache->entries);
+        free(f->cache);
+    }
+
+    free_node(f->body);
+    free_token_pool(&f->pool);
+    free(f);
+}
+
+
+// Public functions
+
+FunctionTable new_function_table(void)
+{
+    FunctionTable t = {
+        .functions = NULL,
+        .size = 0,
+        .retired = NULL,
+        .n_retired = 0,
+        .stale = NULL,
+    };
+    return t;
+}
+
+Function* define_function(FunctionTable* t, const ASTNode* def)
+{
+    const FuncDefNode* func_def = &def->data.func_def;
+
+    // Specializations and cached results of every function may depend
+    // on the previous definition
+    for (int s = 0; s < t->size; s++)
+    {
+        if (t->functions[s] == NULL)
+            continue;
+        discard_specializations(t, t->functions[s]);
+        if (t->functions[s]->cache)
+            clear_memo_cache(t->functions[s]->cache);
+    }
+
+    if (func_def->symbol >= t->size)
+    {
+        int size = (t->size) ? t->size : 16;
+        while (size <= func_def->symbol)
+            size *= 2;
+        t->functions = (Function**) realloc(t->functions, size * sizeof(Function*));
+        memset(t->functions + t->size, 0, (size - t->size) * sizeof(Function*));
+        t->size = size;
+    }
+
+    // The previous definition may still be referenced by the nodes of the
+    // current line, so it is kept until the table is freed
+    Function* old = t->functions[func_def->symbol];
+    if (old)
+    {
+        t->retired = (Function**) realloc(
+            t->retired, (t->n_retired + 1) * sizeof(Function*));
+        t->retired[t->n_retired++] = old;
+    }
+
+    Function* f = (Function*) malloc(sizeof(Function));
+    f->pool = (TokenPool) { .tokens = NULL, .count = 0, .capacity = 0 };
+    f->body = clone_node(func_def->body, &f->pool);
+    f->name = clone_token(func_def->name, &f->pool);
+    f->symbol = func_def->symbol;
+    f->n_params = func_def->n_params;
+    f->n_locals = func_def->n_locals;
+    f->specs = NULL;
+    f->cache = (func_def->memo) ? new_memo_cache(f->n_params) : NULL;
+
+    t->functions[func_def->symbol] = f;
+    return f;
+}
+
+Function* find_function(const FunctionTable* t, int symbol)
+{
+    if (symbol < 0 || symbol >= t->size)
+        return NULL;
+    return t->functions[symbol];
+}
+
+Specialization* get_specialization(Function* f, const TypePriority* params)
+{
+    for (Specialization* spec = f->specs; spec; spec = spec->next)
+    {
+        if (memcmp(spec->params, params, f->n_params * sizeof(TypePriority)) == 0)
+            return spec;
+    }
+
+    Specialization* spec = (Specialization*) malloc(sizeof(Specialization));
+    spec->function = f;
+    spec->params = (TypePriority*) malloc((f->n_params + 1) * sizeof(TypePriority));
+    memcpy(spec->params, params, f->n_params * sizeof(TypePriority));
+    spec->locals = (TypePriority*) malloc((f->n_locals + 1) * sizeof(TypePriority));
+    for (int k = 0; k < f->n_locals; k++)
+        spec->locals[k] = (k < f->n_params) ? params[k] : INT;
+    spec->ret = INT;
+    spec->body = NULL;
+    spec->state = SPEC_NEW;
+    spec->used = 0;
+    spec->fused = 0;
+    spec->next = f->specs;
+    f->specs = spec;
+    return spec;
+}
+
+void reset_specialization(Specialization* spec)
+{
+    if (spec->body)
+        free_node(spec->body);
+    spec->body = NULL;
+    spec->state = SPEC_NEW;
+    spec->used = 0;
+    spec->fused = 0;
+}
+
+DataType* memo_lookup(MemoCache* cache, const Specialization* spec, const Value* args)
+{
+    MemoEntry* entry = find_memo_entry(cache, spec, args);
+    if (entry->spec == spec)
+    {
+        int k = 0;
+        while (k < cache->n_args && same_key(entry->args[k], args[k]))
+            k++;
+        if (k == cache->n_args)
+        {
+            cache->hits++;
+            return unbox_data(entry->result);
+        }
+    }
+
+    cache->misses++;
+    return NULL;
+}
+
+void memo_store(MemoCache* cache, const Specialization* spec, Value* args, const DataType* result)
+{
+    MemoEntry* entry = find_memo_entry(cache, spec, args);
+    if (entry->spec)
+    {
+        clear_memo_entry(cache, entry);
+        cache->evictions++;
+    }
+    else
+        cache->count++;
+
+    entry->spec = spec;
+    entry->args = args;
+    entry->result = box_copy(result);
+}
+
+void format_memo_stats(StrBuf* b, const FunctionTable* t)
+{
+    char num[MAX_INT_STR_LEN + 1];
+    for (int s = 0; s < t->size; s++)
+    {
+        const Function* f = t->functions[s];
+        if (f == NULL || f->cache == NULL)
+            continue;
+
+        const MemoCache* c = f->cache;
+        str_buf_append_str(b, f->name->value);
+        str_buf_append_str(b, ": ");
+        str_buf_append(b, num, format_int((int64_t) c->hits, num));
+        str_buf_append_str(b, " hits, ");
+        str_buf_append(b, num, format_int((int64_t) c->misses, num));
+        str_buf_append_str(b, " misses, ");
+        str_buf_append(b, num, format_int((int64_t) c->evictions, num));
+        str_buf_append_str(b, " evictions, ");
+        str_buf_append(b, num, format_int(c->count, num));
+        str_buf_append_str(b, " entries\n");
+    }
+}
+
+void free_frame(Value* frame, int size)
+{
+    if (frame == NULL)
+        return;
+    for (int k = 0; k < size; k++)
+        release_value(frame[k]);
+    free(frame);
+}
+
+void free_function_table(FunctionTable* t)
+{
+    for (int s = 0; s < t->size; s++)
+    {
+        if (t->functions[s])
+            free_function(t->functions[s]);
+    }
+    for (int k = 0; k < t->n_retired; k++)
+        free_function(t->retired[k]);
+    while (t->stale)
+    {
+        Specialization* spec = t->stale;
+        t->stale = spec->next;
+        free_specialization(spec);
+    }
+
+    free(t->functions);
+    free(t->retired);
+    *t = new_function_table();
+}
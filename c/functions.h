@@ -0,0 +1,197 @@
+#ifndef FUNCTIONS_H
+#define FUNCTIONS_H
+
+#include "base.h"
+#include "value.h"
+#include "strbuf.h"
+
+// ----- FUNCTIONS -----
+
+// Number of entries of the result cache of a memoized function
+#define MEMO_CACHE_SIZE 1024
+
+// Maximum number of nested calls being evaluated
+#define MAX_CALL_DEPTH 1000
+
+typedef struct function Function;
+
+/**
+ * Typing states of a specialization
+ */
+typedef enum spec_state
+{
+    SPEC_NEW,           // Body not typed
+    SPEC_TYPING,        // Body being typed, the return type is an assumption
+    SPEC_READY,         // Body typed
+} SpecState;
+
+/**
+ * Contains a version of a function typed for some argument types
+ */
+struct specialization
+{
+    Function* function;
+    TypePriority* params;   // Types of the arguments
+    TypePriority* locals;   // Types of the frame slots, parameters first
+    TypePriority ret;       // Return type
+    ASTNode* body;          // Typed body, shares the tokens of the function
+    SpecState state;
+    int used;               // Whether its types were read while typing
+    int fused;              // Whether its body went through the fusion pass
+    Specialization* next;
+};
+
+/**
+ * Contains an entry of the result cache of a memoized function
+ */
+typedef struct memo_entry
+{
+    const Specialization* spec;     // Callee (```NULL``` if the entry is empty)
+    Value* args;
+    Value result;
+} MemoEntry;
+
+/**
+ * Caches the results of the calls to a function. Each key has a single
+ * possible entry, so a colliding key replaces the previous one
+ */
+typedef struct memo_cache
+{
+    MemoEntry* entries;
+    int n_args;
+    int count;              // Number of entries in use
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} MemoCache;
+
+/**
+ * Contains a user defined function
+ */
+struct function
+{
+    const Token* name;
+    int symbol;             // Symbol of the function
+    int n_params;
+    int n_locals;           // Number of frame slots, parameters first
+    ASTNode* body;          // Untyped body
+    TokenPool pool;         // Tokens of the body
+    Specialization* specs;
+    MemoCache* cache;       // Result cache (```NULL``` if not memoized)
+};
+
+/**
+ * Contains the functions defined in a session, indexed by symbol
+ */
+typedef struct function_table
+{
+    Function** functions;   // Current definitions (```NULL``` if undefined)
+    int size;
+    Function** retired;     // Replaced definitions, still used by older code
+    int n_retired;
+    Specialization* stale;  // Discarded specializations, still used by older code
+} FunctionTable;
+
+/**
+ * Creates an empty function table
+ *
+ * @return The new table
+ *
+ * @note Remember to call ```free_function_table``` afterwards
+ */
+FunctionTable new_function_table(void);
+
+/**
+ * Defines a function, replacing any previous definition with the same name
+ *
+ * @param t The table
+ * @param def The function definition node. Its body is copied
+ *
+ * @return The new function
+ *
+ * @note Every existing specialization is discarded and every result cache
+ * emptied, since they may depend on the previous definition
+ */
+Function* define_function(FunctionTable* t, const ASTNode* def);
+
+/**
+ * Obtains the current definition of a function
+ *
+ * @param t The table
+ * @param symbol The symbol of the function
+ *
+ * @return The function, or ```NULL``` if it is not defined
+ */
+Function* find_function(const FunctionTable* t, int symbol);
+
+/**
+ * Obtains the specialization of a function for some argument types,
+ * creating it if needed
+ *
+ * @param f The function
+ * @param params The types of the arguments
+ *
+ * @return The specialization
+ *
+ * @note New specializations are in the ```SPEC_NEW``` state and assume an
+ * ```INT``` return type. Their parameters take the types of the arguments,
+ * and their other locals ```INT```
+ */
+Specialization* get_specialization(Function* f, const TypePriority* params);
+
+/**
+ * Discards the typed body of a specialization so it is typed again. The
+ * return and local types are kept as the starting assumptions
+ *
+ * @param spec The specialization
+ */
+void reset_specialization(Specialization* spec);
+
+/**
+ * Looks up the result of a call in a result cache
+ *
+ * @param cache The cache
+ * @param spec The callee
+ * @param args The values of the arguments
+ *
+ * @return A copy of the result, or ```NULL``` if it is not cached
+ *
+ * @note Remember to call ```free_value``` afterwards
+ */
+DataType* memo_lookup(MemoCache* cache, const Specialization* spec, const Value* args);
+
+/**
+ * Stores the result of a call in a result cache
+ *
+ * @param cache The cache
+ * @param spec The callee
+ * @param args The values of the arguments. Ownership is transferred
+ * to the cache
+ * @param result The result. It is copied
+ */
+void memo_store(MemoCache* cache, const Specialization* spec, Value* args, const DataType* result);
+
+/**
+ * Writes the statistics of the result caches of the defined functions
+ *
+ * @param b The buffer
+ * @param t The table
+ */
+void format_memo_stats(StrBuf* b, const FunctionTable* t);
+
+/**
+ * Frees the values of a call frame
+ *
+ * @param frame The frame
+ * @param size The number of slots
+ */
+void free_frame(Value* frame, int size);
+
+/**
+ * Frees the memory used by a function table and its functions
+ *
+ * @param t The table
+ */
+void free_function_table(FunctionTable* t);
+
+#endif  // FUNCTIONS_H
@@ -0,0 +1,450 @@
+#include "fusion.h"
+
+// ----- OPERATION FUSION -----
+
+/**
+ * Contains the pattern of a shape kernel: an operation whose operands are
+ * either any node or another operation, whose own operands become
+ * operands of the kernel
+ */
+typedef struct kernel_shape
+{
+    Opcode outer;       // Implementation of the outermost operation
+    Opcode left;        // Implementation of the left operation, or ```OP_NONE``` for any node
+    Opcode right;       // Implementation of the right operation, or ```OP_NONE``` for any node
+    Opcode kernel;
+} KernelShape;
+
+/**
+ * Shapes that have a kernel, tried in order so that the shapes with four
+ * operands are preferred
+ */
+const KernelShape KernelShapes[] = {
+    { OP_ADD_INT,   OP_MUL_INT,   OP_MUL_INT,   OP_KERNEL_DOT_ADD_INT },
+    { OP_ADD_FLOAT, OP_MUL_FLOAT, OP_MUL_FLOAT, OP_KERNEL_DOT_ADD_FLOAT },
+    { OP_SUB_INT,   OP_MUL_INT,   OP_MUL_INT,   OP_KERNEL_DOT_SUB_INT },
+    { OP_SUB_FLOAT, OP_MUL_FLOAT, OP_MUL_FLOAT, OP_KERNEL_DOT_SUB_FLOAT },
+    { OP_DIV_FLOAT, OP_ADD_FLOAT, OP_SUB_FLOAT, OP_KERNEL_RATIO_FLOAT },
+    { OP_DIV_FLOAT_UNCHECKED, OP_ADD_FLOAT, OP_SUB_FLOAT, OP_KERNEL_RATIO_FLOAT_UNCHECKED },
+    { OP_ADD_INT,   OP_MUL_INT,   OP_NONE,      OP_KERNEL_MUL_ADD_INT },
+    { OP_ADD_FLOAT, OP_MUL_FLOAT, OP_NONE,      OP_KERNEL_MUL_ADD_FLOAT },
+    { OP_ADD_INT,   OP_NONE,      OP_MUL_INT,   OP_KERNEL_ADD_MUL_INT },
+    { OP_ADD_FLOAT, OP_NONE,      OP_MUL_FLOAT, OP_KERNEL_ADD_MUL_FLOAT },
+    { OP_SUB_INT,   OP_MUL_INT,   OP_NONE,      OP_KERNEL_MUL_SUB_INT },
+    { OP_SUB_FLOAT, OP_MUL_FLOAT, OP_NONE,      OP_KERNEL_MUL_SUB_FLOAT },
+    { OP_SUB_INT,   OP_NONE,      OP_MUL_INT,   OP_KERNEL_SUB_MUL_INT },
+    { OP_SUB_FLOAT, OP_NONE,      OP_MUL_FLOAT, OP_KERNEL_SUB_MUL_FLOAT },
+    { OP_MUL_INT,   OP_ADD_INT,   OP_NONE,      OP_KERNEL_SUM_MUL_INT },
+    { OP_MUL_FLOAT, OP_ADD_FLOAT, OP_NONE,      OP_KERNEL_SUM_MUL_FLOAT },
+    { OP_MUL_INT,   OP_SUB_INT,   OP_NONE,      OP_KERNEL_DIFF_MUL_INT },
+    { OP_MUL_FLOAT, OP_SUB_FLOAT, OP_NONE,      OP_KERNEL_DIFF_MUL_FLOAT },
+};
+
+// Auxiliary functions
+
+/**
+ * Checks whether a node is a literal with a given integer value, possibly
+ * converted to ```FLOAT```
+ *
+ * @param node The node
+ * @param value The value
+ *
+ * @return Boolean-like value
+ */
+int is_constant(const ASTNode* node, int value)
+{
+    if (node->class == Convert)
+        node = node->data.convert.value;
+    if (node->class != Number)
+        return 0;
+
+    if (node->type == INT)
+        return node->data.number.literal.integer == value;
+    return node->type == FLOAT && node->data.number.literal.decimal == value;
+}
+
+/**
+ * Checks whether two nodes read the same variable
+ *
+ * @param a The first node
+ * @param b The second node
+ *
+ * @return Boolean-like value
+ */
+int same_variable(const ASTNode* a, const ASTNode* b)
+{
+    return a->class == VarAccess && b->class == VarAccess
+        && a->data.access.slot == b->data.access.slot;
+}
+
+/**
+ * Obtains the fused implementation of a chain of operations
+ *
+ * @param opcode The implementation of each operation
+ *
+ * @return The fused implementation, or ```OP_NONE``` if the operation
+ * does not form chains
+ */
+Opcode chain_opcode(Opcode opcode)
+{
+    switch (opcode)
+    {
+    case OP_ADD_INT:
+        return OP_SUM_INT;
+
+    case OP_ADD_FLOAT:
+        return OP_SUM_FLOAT;
+
+    case OP_MUL_INT:
+        return OP_PRODUCT_INT;
+
+    case OP_MUL_FLOAT:
+        return OP_PRODUCT_FLOAT;
+
+    default:
+        return OP_NONE;
+    }
+}
+
+/**
+ * Fuses a chain of three or more additions or multiplications nested on
+ * the left, such as ```(a + b) + c```. A product of a variable by itself
+ * three times becomes a cube
+ *
+ * @param node The outermost operation, which is freed on success
+ *
+ * @return The fused node, or ```NULL``` if the operation is not a chain
+ */
+ASTNode* fuse_chain(ASTNode* node)
+{
+    Opcode opcode = node->data.binary.opcode;
+    Opcode fused = chain_opcode(opcode);
+    if (fused == OP_NONE)
+        return NULL;
+
+    int count = 1;
+    const ASTNode* link = node;
+    while (link->class == BinOp && link->data.binary.opcode == opcode)
+    {
+        count++;
+        link = link->data.binary.left;
+    }
+    if (count < 3)
+        return NULL;
+
+    // The right operands are collected from the outermost link inwards
+    ASTNode** operands = (ASTNode**) malloc(count * sizeof(ASTNode*));
+    ASTNode* current = node;
+    for (int k = count - 1; k > 0; k--)
+    {
+        ASTNode* left = current->data.binary.left;
+        operands[k] = current->data.binary.right;
+        if (current != node)
+            free(current);
+        current = left;
+    }
+    operands[0] = current;
+
+    int product = fused == OP_PRODUCT_INT || fused == OP_PRODUCT_FLOAT;
+    if (product && count == 3 && same_variable(operands[0], operands[1])
+        && same_variable(operands[0], operands[2]))
+    {
+        // Multiplied in the same order as the chain, so the value is the same
+        free_node(operands[1]);
+        free_node(operands[2]);
+        fused = (fused == OP_PRODUCT_INT) ? OP_CUBE_INT : OP_CUBE_FLOAT;
+        count = 1;
+    }
+
+    ASTNode* res = new_fused_node(node->data.binary.op, fused, node->type,
+                                  operands, count);
+    free(node);
+    return res;
+}
+
+/**
+ * Fuses a float addition or subtraction with a multiplication in one of
+ * its operands into a multiply-add, which is rounded once
+ *
+ * @param node The addition or subtraction, which is freed on success
+ *
+ * @return The fused node, or ```NULL``` if there is no multiplication
+ */
+ASTNode* fuse_multiply_add(ASTNode* node)
+{
+    const BinOpNode* binary = &node->data.binary;
+    if (binary->opcode != OP_ADD_FLOAT && binary->opcode != OP_SUB_FLOAT)
+        return NULL;
+
+    int add = binary->opcode == OP_ADD_FLOAT;
+    ASTNode* left = binary->left;
+    ASTNode* right = binary->right;
+    ASTNode** operands = (ASTNode**) malloc(3 * sizeof(ASTNode*));
+    Opcode fused;
+
+    // The operands keep the evaluation order of the original tree
+    if (left->class == BinOp && left->data.binary.opcode == OP_MUL_FLOAT)
+    {
+        operands[0] = left->data.binary.left;
+        operands[1] = left->data.binary.right;
+        operands[2] = right;
+        fused = (add) ? OP_MUL_ADD_FLOAT : OP_MUL_SUB_FLOAT;
+        free(left);
+    }
+    else if (right->class == BinOp && right->data.binary.opcode == OP_MUL_FLOAT)
+    {
+        operands[0] = left;
+        operands[1] = right->data.binary.left;
+        operands[2] = right->data.binary.right;
+        fused = (add) ? OP_ADD_MUL_FLOAT : OP_SUB_MUL_FLOAT;
+        free(right);
+    }
+    else
+    {
+        free(operands);
+        return NULL;
+    }
+
+    ASTNode* res = new_fused_node(binary->op, fused, node->type, operands, 3);
+    free(node);
+    return res;
+}
+
+/**
+ * Fuses a power with a constant exponent of 2 or 3, or a product of a
+ * variable by itself, into a square or a cube
+ *
+ * @param node The operation, which is freed on success
+ *
+ * @return The fused node, or ```NULL``` if the operation is neither
+ */
+ASTNode* fuse_power(ASTNode* node)
+{
+    const BinOpNode* binary = &node->data.binary;
+    int integer = binary->opcode == OP_POW_INT || binary->opcode == OP_MUL_INT;
+    Opcode fused;
+
+    switch (binary->opcode)
+    {
+    case OP_MUL_INT:
+    case OP_MUL_FLOAT:
+        if (!same_variable(binary->left, binary->right))
+            return NULL;
+        fused = (integer) ? OP_SQUARE_INT : OP_SQUARE_FLOAT;
+        break;
+
+    case OP_POW_INT:
+    case OP_POW_FLOAT:
+        // x * x rounds like pow(x, 2), but x * x * x may not match pow(x, 3)
+        if (is_constant(binary->right, 2))
+            fused = (integer) ? OP_SQUARE_INT : OP_SQUARE_FLOAT;
+        else if (is_constant(binary->right, 3) && (integer || FUSE_CONTRACT))
+            fused = (integer) ? OP_CUBE_INT : OP_CUBE_FLOAT;
+        else
+            return NULL;
+        break;
+
+    default:
+        return NULL;
+    }
+
+    ASTNode** operands = (ASTNode**) malloc(sizeof(ASTNode*));
+    operands[0] = binary->left;
+    free_node(binary->right);
+
+    ASTNode* res = new_fused_node(binary->op, fused, node->type, operands, 1);
+    free(node);
+    return res;
+}
+
+/**
+ * Checks whether an operand of an operation matches the pattern of a shape
+ *
+ * @param node The operand
+ * @param opcode The implementation it must have, or ```OP_NONE``` for any
+ * node
+ *
+ * @return Boolean-like value
+ */
+int matches_shape(const ASTNode* node, Opcode opcode)
+{
+    return opcode == OP_NONE
+        || (node->class == BinOp && node->data.binary.opcode == opcode);
+}
+
+/**
+ * Moves an operand of an operation to the operands of a kernel
+ *
+ * @param node The operand, which is freed if its own operands are moved
+ * @param opcode The implementation it matched, or ```OP_NONE``` to move
+ * the operand itself
+ * @param operands The operands of the kernel
+ * @param count The number of operands already moved
+ *
+ * @return The new number of operands
+ */
+int take_operands(ASTNode* node, Opcode opcode, ASTNode** operands, int count)
+{
+    if (opcode == OP_NONE)
+    {
+        operands[count] = node;
+        return count + 1;
+    }
+
+    operands[count] = node->data.binary.left;
+    operands[count + 1] = node->data.binary.right;
+    free(node);
+    return count + 2;
+}
+
+/**
+ * Replaces an operation whose tree has the shape of a kernel, such as
+ * ```a * b + c```, with the kernel, whose operands are the leaves of the
+ * shape in the order of the original tree
+ *
+ * @param node The operation, which is freed on success
+ *
+ * @return The fused node, or ```NULL``` if no shape matches
+ */
+ASTNode* fuse_kernel(ASTNode* node)
+{
+    const BinOpNode* binary = &node->data.binary;
+    for (size_t k = 0; k < sizeof(KernelShapes) / sizeof(KernelShapes[0]); k++)
+    {
+        const KernelShape* shape = &KernelShapes[k];
+        if (binary->opcode != shape->outer
+            || !matches_shape(binary->left, shape->left)
+            || !matches_shape(binary->right, shape->right))
+            continue;
+
+        ASTNode** operands = (ASTNode**) malloc(4 * sizeof(ASTNode*));
+        int count = take_operands(binary->left, shape->left, operands, 0);
+        count = take_operands(binary->right, shape->right, operands, count);
+
+        ASTNode* res = new_fused_node(binary->op, shape->kernel, node->type,
+                                      operands, count);
+        free(node);
+        return res;
+    }
+    return NULL;
+}
+
+// Private function declarations
+
+void fuse_node(ASTNode** node);
+
+/**
+ * Fuses a binary operation with the operations below it
+ *
+ * @param node The operation, which may be replaced
+ */
+void fuse_operation(ASTNode** node)
+{
+    ASTNode* fused = fuse_chain(*node);
+    if (fused == NULL && FUSE_CONTRACT)
+        fused = fuse_multiply_add(*node);
+    if (fused == NULL)
+        fused = fuse_kernel(*node);
+
+    if (fused)
+    {
+        for (int k = 0; k < fused->data.fused.count; k++)
+            fuse_node(&fused->data.fused.operands[k]);
+        *node = fused;
+        return;
+    }
+
+    fuse_node(&(*node)->data.binary.left);
+    fuse_node(&(*node)->data.binary.right);
+
+    fused = fuse_power(*node);
+    if (fused)
+        *node = fused;
+}
+
+/**
+ * Fuses the operations of a node and its children
+ *
+ * @param node The node, which may be replaced
+ */
+void fuse_node(ASTNode** node)
+{
+    NodeData* data = &(*node)->data;
+    switch ((*node)->class)
+    {
+    case UnOp:
+        fuse_node(&data->unary.value);
+        break;
+
+    case BinOp:
+        fuse_operation(node);
+        break;
+
+    case VarAssign:
+        fuse_node(&data->assign.value);
+        break;
+
+    case Convert:
+        fuse_node(&data->convert.value);
+        break;
+
+    case Call:
+    {
+        for (int k = 0; k < data->call.n_args; k++)
+            fuse_node(&data->call.args[k]);
+
+        // Each specialization is rewritten once, including recursive ones
+        Specialization* spec = data->call.spec;
+        if (spec && spec->body && !spec->fused)
+        {
+            spec->fused = 1;
+            spec->body = fuse_operations(spec->body);
+        }
+        break;
+    }
+
+    case Sequence:
+        for (int k = 0; k < data->sequence.count; k++)
+            fuse_node(&data->sequence.items[k]);
+        break;
+
+    case Logic:
+        fuse_node(&data->logic.left);
+        fuse_node(&data->logic.right);
+        break;
+
+    case Cond:
+        fuse_node(&data->cond.cond);
+        fuse_node(&data->cond.if_true);
+        fuse_node(&data->cond.if_false);
+        break;
+
+    case While:
+        fuse_node(&data->loop.cond);
+        fuse_node(&data->loop.body);
+        break;
+
+    case For:
+        fuse_node(&data->range.start);
+        fuse_node(&data->range.end);
+        fuse_node(&data->range.body);
+        break;
+
+    case Invariant:
+        fuse_node(&data->invariant.value);
+        break;
+
+    default:
+        // Function definitions keep their untyped body
+        break;
+    }
+}
+
+
+// Public functions
+
+ASTNode* fuse_operations(ASTNode* root)
+{
+    fuse_node(&root);
+    return root;
+}
@@ -0,0 +1,43 @@
+#ifndef FUSION_H
+#define FUSION_H
+
+#include "base.h"
+#include "functions.h"
+
+// ----- OPERATION FUSION -----
+
+// Whether operations may be fused when the result is rounded differently:
+// float multiply-adds become a single fma() and float cubes are multiplied
+// out instead of calling pow(). Off by default, since results may change
+// in the last bit. Build with -DFUSE_CONTRACT=1 to enable
+#ifndef FUSE_CONTRACT
+#define FUSE_CONTRACT 0
+#endif
+
+/**
+ * Rewrites the arithmetic of a typed AST into ```Fused``` nodes, which
+ * evaluate several operations with a single dispatch and no intermediate
+ * values:
+ *
+ * - Chains of three or more additions or multiplications of the same
+ * type, such as ```a + b + c```, become a single sum or product
+ * - Powers with a constant exponent of 2 or 3 and products of a variable
+ * with itself, such as ```x^2``` or ```x * x```, become squares and cubes
+ * - Common shapes of two or three operations of the same type, such as
+ * ```a * b + c```, ```a * b - c * d``` or ```(a + b) / (c - d)```, become
+ * calls to a kernel written for the shape, whose operands are any nodes
+ * - With ```FUSE_CONTRACT```, float multiply-adds such as ```a * b + c```
+ * become a single fused multiply-add instead of a kernel
+ *
+ * Except for the contractions, fused nodes give exactly the values of
+ * the operations they replace, including the promotion of integers to
+ * ```BIGINT```. The bodies of the specializations called by the AST are
+ * rewritten too, once each
+ *
+ * @param root The root of the AST, as returned by ```check_types```
+ *
+ * @return The new root of the AST
+ */
+ASTNode* fuse_operations(ASTNode* root);
+
+#endif  // FUSION_H
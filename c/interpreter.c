@@ -1,4 +1,8 @@
 #include "interpreter.h"
+#include "builtins.h"
+#include "parallel.h"
+
+#include <time.h>
 
 // ----- INTERPRETER -----
 
@@ -11,508 +15,2402 @@ int isZero(const DataType* value)
     case INT:
         return value->value.integer == 0;
 
+    case BIGINT:
+        return bigint_is_zero(value->value.big);
+
     case FLOAT:
-        return fabs(value->value.decimal) < 1e-9;
+        return fabs(value->value.decimal) < ZERO_TOLERANCE;
 
     default:
         return 1;
     }
 }
 
-Result visit_node_with_promotion(const ASTNode* node, TypePriority type)
+/**
+ * Raises an integer to a non-negative integer power by squaring
+ * 
+ * @param base The base
+ * @param exp The exponent
+ * @param result Where to store the result
+ * 
+ * @return ```1``` on success, or ```0``` if the result overflows
+ */
+int int_pow(int64_t base, int64_t exp, int64_t* result)
 {
-    Result res;
+    int64_t acc = 1;
 
-    res = visit(node);
-    if (res.result == NULL)
-        return res;
-    
-    if (node->type != type)
+    while (exp > 0)
     {
-        res.result = promote(res.result, type);
-        if (res.result == NULL)
-        {
-            char details[MAX_ERR_DET_LEN];
-            sprintf(
-                details,
-                "Unable to convert from %s to %s",
-                get_type_representation(node->type),
-                get_type_representation(type)
-            );
-            res.err = new_error(
-                RuntimeError,
-                node->pos,
-                details
-            );
-        }
+        if ((exp & 1) && __builtin_mul_overflow(acc, base, &acc))
+            return 0;
+        exp >>= 1;
+        if (exp && __builtin_mul_overflow(base, base, &base))
+            return 0;
     }
 
-    return res;
+    *result = acc;
+    return 1;
 }
 
+/**
+ * Obtains a big integer view of an integer value, without allocating
+ * 
+ * @param data The integer value
+ * @param view Storage for the view, if required
+ * @param storage Limb storage for the view, if required
+ * 
+ * @return The big integer
+ */
+const BigInt* as_bigint(const DataType* data, BigInt* view, 
+                        uint32_t storage[BIGINT_INT_LIMBS])
+{
+    if (data->type == BIGINT)
+        return data->value.big;
+    bigint_view_int(view, storage, data->value.integer);
+    return view;
+}
 
-// Private function declarations
+/**
+ * Adds two integer values, promoting to ```BIGINT``` on overflow
+ * 
+ * @param left The left operand
+ * @param right The right operand
+ * 
+ * @return The sum
+ */
+DataType* int_add(const DataType* left, const DataType* right)
+{
+    int64_t r;
+    if (left->type == INT && right->type == INT 
+        && !__builtin_add_overflow(left->value.integer, right->value.integer, &r))
+        return new_int(r);
+
+    BigInt lv, rv;
+    uint32_t ls[BIGINT_INT_LIMBS], rs[BIGINT_INT_LIMBS];
+    return new_integer(bigint_add(as_bigint(left, &lv, ls), as_bigint(right, &rv, rs)));
+}
 
-Result visit_NumberNode(const ASTNode* node);
+/**
+ * Subtracts two integer values, promoting to ```BIGINT``` on overflow
+ * 
+ * @param left The left operand
+ * @param right The right operand
+ * 
+ * @return The difference
+ */
+DataType* int_sub(const DataType* left, const DataType* right)
+{
+    int64_t r;
+    if (left->type == INT && right->type == INT 
+        && !__builtin_sub_overflow(left->value.integer, right->value.integer, &r))
+        return new_int(r);
+
+    BigInt lv, rv;
+    uint32_t ls[BIGINT_INT_LIMBS], rs[BIGINT_INT_LIMBS];
+    return new_integer(bigint_sub(as_bigint(left, &lv, ls), as_bigint(right, &rv, rs)));
+}
 
-Result visit_UnOpNode(const ASTNode* node);
+/**
+ * Multiplies two integer values, promoting to ```BIGINT``` on overflow
+ * 
+ * @param left The left operand
+ * @param right The right operand
+ * 
+ * @return The product
+ */
+DataType* int_mul(const DataType* left, const DataType* right)
+{
+    int64_t r;
+    if (left->type == INT && right->type == INT 
+        && !__builtin_mul_overflow(left->value.integer, right->value.integer, &r))
+        return new_int(r);
+
+    BigInt lv, rv;
+    uint32_t ls[BIGINT_INT_LIMBS], rs[BIGINT_INT_LIMBS];
+    return new_integer(bigint_mul(as_bigint(left, &lv, ls), as_bigint(right, &rv, rs)));
+}
 
-Result visit_BinOpNode(const ASTNode* node);
+/**
+ * Obtains the remainder of the truncated division of two integer values
+ * 
+ * @param left The left operand
+ * @param right The right operand, which must not be 0
+ * 
+ * @return The remainder
+ */
+DataType* int_mod(const DataType* left, const DataType* right)
+{
+    if (left->type == INT && right->type == INT)
+    {
+        // INT64_MIN % -1 traps on some platforms
+        return new_int(right->value.integer == -1 ? 
+                       0 : left->value.integer % right->value.integer);
+    }
 
-// Unary operators
+    BigInt lv, rv;
+    uint32_t ls[BIGINT_INT_LIMBS], rs[BIGINT_INT_LIMBS];
+    return new_integer(bigint_mod(as_bigint(left, &lv, ls), as_bigint(right, &rv, rs)));
+}
 
-Result pos(const DataType* value, const ASTNode* node);
+/**
+ * Negates an integer value, promoting to ```BIGINT``` on overflow
+ * 
+ * @param value The operand
+ * 
+ * @return The negated value
+ */
+DataType* int_neg(const DataType* value)
+{
+    if (value->type == INT && value->value.integer != INT64_MIN)
+        return new_int(-value->value.integer);
 
-Result neg(const DataType* value, const ASTNode* node);
+    BigInt v;
+    uint32_t vs[BIGINT_INT_LIMBS];
+    return new_integer(bigint_neg(as_bigint(value, &v, vs)));
+}
 
-// Binary operators
+/**
+ * Obtains the truth value of a data value: every value other than 0 is true
+ * 
+ * @param value The data value
+ * 
+ * @return Boolean-like value
+ */
+int is_true(const DataType* value)
+{
+    switch (value->type)
+    {
+    case INT:
+        return value->value.integer != 0;
 
-Result add(const DataType* left, const DataType* right, const ASTNode* node);
+    case BIGINT:
+        return !bigint_is_zero(value->value.big);
 
-Result sub(const DataType* left, const DataType* right, const ASTNode* node);
+    case FLOAT:
+        return value->value.decimal != 0;
 
-Result mul(const DataType* left, const DataType* right, const ASTNode* node);
+    default:
+        return 0;
+    }
+}
 
-Result div_(const DataType* left, const DataType* right, const ASTNode* node);
+/**
+ * Compares two integer values
+ * 
+ * @param left The left operand
+ * @param right The right operand
+ * 
+ * @return A negative value, 0 or a positive value if ```left``` is less
+ * than, equal to or greater than ```right```
+ */
+int int_cmp(const DataType* left, const DataType* right)
+{
+    if (left->type == INT && right->type == INT)
+        return (left->value.integer > right->value.integer) 
+             - (left->value.integer < right->value.integer);
 
-Result mod(const DataType* left, const DataType* right, const ASTNode* node);
+    BigInt lv, rv;
+    uint32_t ls[BIGINT_INT_LIMBS], rs[BIGINT_INT_LIMBS];
+    return bigint_cmp(as_bigint(left, &lv, ls), as_bigint(right, &rv, rs));
+}
 
-Result pow_(const DataType* left, const DataType* right, const ASTNode* node);
+/**
+ * Rounds a float down to an integer value
+ * 
+ * @param x The float, which must be finite
+ * 
+ * @return The integer value, as ```BIGINT``` if it does not fit in 64 bits
+ */
+DataType* float_floor(double x)
+{
+    x = floor(x);
+    if (fabs(x) < 0x1p63)
+        return new_int((int64_t) x);
+
+    // x = m * 2^(e - 53) exactly, with e > 53
+    int e;
+    int64_t m = (int64_t) ldexp(frexp(x, &e), 53);
+    BigInt* two = bigint_from_int(2);
+    BigInt* scale = bigint_pow(two, (uint64_t) (e - 53));
+    BigInt* mantissa = bigint_from_int(m);
+    BigInt* value = bigint_mul(mantissa, scale);
+    bigint_free(two);
+    bigint_free(scale);
+    bigint_free(mantissa);
+    return new_integer(value);
+}
 
+/**
+ * Obtains the storage of the value of a loop invariant in the frame of
+ * its loop
+ * 
+ * @param i The interpreter
+ * @param node The invariant node
+ * 
+ * @return The storage, which holds ```VALUE_UNSET``` if the invariant has
+ * not been evaluated yet
+ */
+Value* get_invariant(const Interpreter* i, const ASTNode* node)
+{
+    const LoopFrame* frame = i->loop;
+    for (int k = 0; k < node->data.invariant.level; k++)
+        frame = frame->outer;
+    return &frame->invariants[node->data.invariant.index];
+}
 
-// Public functions
+/**
+ * Starts a run of a loop
+ * 
+ * @param i The interpreter
+ * @param frame Storage for the frame of the loop
+ * @param n_invariants The number of invariants of the loop
+ */
+void enter_loop(Interpreter* i, LoopFrame* frame, int n_invariants)
+{
+    frame->invariants = (n_invariants) ? 
+        (Value*) malloc(n_invariants * sizeof(Value)) : NULL;
+    unset_values(frame->invariants, n_invariants);
+    frame->n_invariants = n_invariants;
+    frame->outer = i->loop;
+    i->loop = frame;
+}
 
-Interpreter new_interpreter(const ASTNode* ast)
+/**
+ * Ends a run of a loop, freeing the values of its invariants
+ * 
+ * @param i The interpreter
+ * @param frame The frame of the loop
+ */
+void exit_loop(Interpreter* i, LoopFrame* frame)
 {
-    Interpreter i = { ast };
-    return i;
+    for (int k = 0; k < frame->n_invariants; k++)
+        release_value(frame->invariants[k]);
+    free(frame->invariants);
+    i->loop = frame->outer;
 }
 
-Result interpret(Interpreter* i)
+/**
+ * Pushes a temporary onto the stack of values held by the evaluations in
+ * progress, so that it is freed if an error unwinds past them
+ *
+ * @param i The interpreter
+ * @param data The temporary: a data value, or an array of values
+ * @param n_values The size of the array, or ```-1``` for a data value
+ * @param memo The call whose arguments the array is, if its result is to
+ * be memoized, or ```NULL```
+ *
+ * @return The index of the temporary in the stack
+ */
+int own(Interpreter* i, void* data, int n_values, const Specialization* memo)
 {
-    return visit(i->ast);
+    if (i->n_owned == i->owned_capacity)
+    {
+        i->owned_capacity = (i->owned_capacity) ? 2 * i->owned_capacity : 64;
+        i->owned = (Owned*) realloc(i->owned, i->owned_capacity * sizeof(Owned));
+    }
+
+    Owned* o = &i->owned[i->n_owned];
+    o->data = data;
+    o->n_values = n_values;
+    o->memo = memo;
+    return i->n_owned++;
 }
 
-Result visit(const ASTNode* node)
+/**
+ * Pushes a data value onto the stack of temporaries, as ```own```
+ *
+ * @param i The interpreter
+ * @param value The value, or ```NULL``` to reserve an entry
+ *
+ * @return The index of the value in the stack
+ */
+int own_value(Interpreter* i, DataType* value)
 {
-    Result res;
+    return own(i, value, -1, NULL);
+}
 
-    switch (node->class)
+/**
+ * Frees the temporaries pushed after a mark and pops them
+ *
+ * @param i The interpreter
+ * @param mark The number of temporaries to keep
+ */
+void release_owned(Interpreter* i, int mark)
+{
+    while (i->n_owned > mark)
     {
-    case Number:
-        return visit_NumberNode(node);
+        Owned* o = &i->owned[--i->n_owned];
+        if (o->data == NULL)
+            continue;
+        if (o->n_values < 0)
+            free_value((DataType*) o->data);
+        else
+            free_frame((Value*) o->data, o->n_values);
+    }
+}
 
-    case UnOp:
-        return visit_UnOpNode(node);
+/**
+ * Sets the point the errors of the evaluations that follow unwind to
+ *
+ * @param i The interpreter
+ * @param point Storage for the point, whose ```env``` must be filled by
+ * ```setjmp``` right after
+ */
+void set_catch_point(Interpreter* i, CatchPoint* point)
+{
+    point->n_owned = i->n_owned;
+    point->loop = i->loop;
+    point->slots = i->slots;
+    point->depth = i->depth;
+    point->outer = i->on_error;
+    i->on_error = point;
+}
 
-    case BinOp:
-        return visit_BinOpNode(node);
-    
-    default:
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            "Unable to interpret node: Type unknown"
-        );
-        return res;
-    }
+/**
+ * Removes the innermost catch point once its evaluations succeed
+ *
+ * @param i The interpreter
+ * @param point The point
+ */
+void clear_catch_point(Interpreter* i, CatchPoint* point)
+{
+    i->on_error = point->outer;
 }
 
+/**
+ * Stops the evaluation in progress with an error, which unwinds to the
+ * innermost catch point. The temporaries and loop frames of the
+ * evaluations being unwound are freed first, while their frames are
+ * still on the stack
+ *
+ * @param i The interpreter
+ * @param err The error
+ */
+_Noreturn void fail_eval(Interpreter* i, Error err)
+{
+    CatchPoint* point = i->on_error;
 
-// Private function implementations
+    release_owned(i, point->n_owned);
+    while (i->loop != point->loop)
+        exit_loop(i, i->loop);
+
+    i->slots = point->slots;
+    i->depth = point->depth;
+    i->on_error = point->outer;
+    i->err = err;
+    longjmp(point->env, 1);
+}
 
-Result visit_NumberNode(const ASTNode* node)
+/**
+ * Checks the budget of an evaluation once the visits counted down since
+ * the last check run out, and starts counting down the next ones
+ *
+ * @param i The interpreter
+ * @param node The node being visited, where an exceeded limit is reported
+ */
+void check_budget(Interpreter* i, const ASTNode* node)
 {
-    Result res;
+    if (i->steps_left == 0)
+        fail_eval(i, new_error(ERR_STEP_LIMIT, node->pos));
+    if (i->deadline > 0 && monotonic_time() > i->deadline)
+        fail_eval(i, new_error(ERR_TIME_LIMIT, node->pos));
+
+    int64_t n = (i->steps_left < BUDGET_INTERVAL) ? 
+        (int64_t) i->steps_left : BUDGET_INTERVAL;
+    i->steps_left -= n;
+    i->fuel = n - 1;    // This visit is one of them
+}
 
-    switch (node->data.number.value->type)
-    {
-    case TT_INT:
-        res.result = new_int(atoi(node->data.number.value->value));
-        break;
+/**
+ * Obtains the number of limbs of an integer value, as counted by the
+ * memory limit
+ *
+ * @param value The value, or ```NULL```
+ *
+ * @return The number of limbs, which is 0 for machine integers
+ */
+size_t count_limbs(const DataType* value)
+{
+    return (value && value->type == BIGINT) ? (size_t) value->value.big->size : 0;
+}
 
-    case TT_FLT:
-        res.result = new_float(atof(node->data.number.value->value));
-        break;
-    
-    default:
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            "Unable to interpret node: Not a valid number type"
-        );
-        break;
-    }
+/**
+ * Adds two machine integers, recording whether the sum overflows
+ * 
+ * @param left The left operand
+ * @param right The right operand
+ * @param overflow Set to ```1``` if the sum does not fit in 64 bits
+ * 
+ * @return The sum, wrapped around on overflow
+ */
+int64_t add_checked(int64_t left, int64_t right, int* overflow)
+{
+    int64_t r;
+    *overflow |= __builtin_add_overflow(left, right, &r);
+    return r;
+}
+
+/**
+ * Subtracts two machine integers, recording whether the difference
+ * overflows
+ * 
+ * @param left The left operand
+ * @param right The right operand
+ * @param overflow Set to ```1``` if the difference does not fit in 64 bits
+ * 
+ * @return The difference, wrapped around on overflow
+ */
+int64_t sub_checked(int64_t left, int64_t right, int* overflow)
+{
+    int64_t r;
+    *overflow |= __builtin_sub_overflow(left, right, &r);
+    return r;
+}
 
+/**
+ * Multiplies two machine integers, recording whether the product
+ * overflows
+ * 
+ * @param left The left operand
+ * @param right The right operand
+ * @param overflow Set to ```1``` if the product does not fit in 64 bits
+ * 
+ * @return The product, wrapped around on overflow
+ */
+int64_t mul_checked(int64_t left, int64_t right, int* overflow)
+{
+    int64_t r;
+    *overflow |= __builtin_mul_overflow(left, right, &r);
+    return r;
+}
+
+/**
+ * Applies an operation to two integer values, freeing them
+ * 
+ * @param op The operation, such as ```int_add```
+ * @param left The left operand
+ * @param right The right operand
+ * 
+ * @return The result
+ */
+DataType* combine_ints(
+    DataType* (*op)(const DataType*, const DataType*), 
+    DataType* left, 
+    DataType* right
+)
+{
+    DataType* res = op(left, right);
+    free_value(left);
+    free_value(right);
     return res;
 }
 
-Result visit_UnOpNode(const ASTNode* node)
+// Shapes of the kernels of fused operations, as expressions of the
+// operations ADD, SUB and MUL on the operands A, B, C and D. Each shape
+// expands to a kernel for machine integers, which fails on overflow, a
+// kernel for doubles and a kernel for integers of any size, so adding a
+// shape only takes a line here, its opcodes and its pattern in fusion.c
+#define KERNEL_SHAPES(K)                                                    \
+    K(MUL_ADD,  mul_add,  ADD(MUL(A, B), C))                                \
+    K(ADD_MUL,  add_mul,  ADD(A, MUL(B, C)))                                \
+    K(MUL_SUB,  mul_sub,  SUB(MUL(A, B), C))                                \
+    K(SUB_MUL,  sub_mul,  SUB(A, MUL(B, C)))                                \
+    K(SUM_MUL,  sum_mul,  MUL(ADD(A, B), C))                                \
+    K(DIFF_MUL, diff_mul, MUL(SUB(A, B), C))                                \
+    K(DOT_ADD,  dot_add,  ADD(MUL(A, B), MUL(C, D)))                        \
+    K(DOT_SUB,  dot_sub,  SUB(MUL(A, B), MUL(C, D)))
+
+// Kernels for machine integers
+#define A v[0].integer
+#define B v[1].integer
+#define C v[2].integer
+#define D v[3].integer
+#define ADD(x, y) add_checked(x, y, &overflow)
+#define SUB(x, y) sub_checked(x, y, &overflow)
+#define MUL(x, y) mul_checked(x, y, &overflow)
+
+#define DEFINE_INT_KERNEL(NAME, name, expr)                                 \
+int kernel_##name##_int(const DataValue* v, DataValue* out)                 \
+{                                                                           \
+    int overflow = 0;                                                       \
+    out->integer = expr;                                                    \
+    return !overflow;                                                       \
+}
+
+KERNEL_SHAPES(DEFINE_INT_KERNEL)
+
+#undef A
+#undef B
+#undef C
+#undef D
+#undef ADD
+#undef SUB
+#undef MUL
+
+/**
+ * Multiplies two doubles, rounding the product before it is used
+ * 
+ * @param x The first factor
+ * @param y The second factor
+ * 
+ * @return The product
+ * 
+ * @note Compilers may contract a product and a sum in the same expression
+ * into a fused multiply-add, which rounds once (GCC does by default where
+ * the processor has one). The volatile store keeps the kernels equal to
+ * the operations they replace
+ */
+double round_mul(double x, double y)
 {
-    Result res, res_signed;
+    volatile double product = x * y;
+    return product;
+}
 
-    res = visit(node->data.unary.value);
-    if (res.result == NULL)
-        return res;
+// Kernels for doubles, which round each operation
+#define A v[0].decimal
+#define B v[1].decimal
+#define C v[2].decimal
+#define D v[3].decimal
+#define ADD(x, y) ((x) + (y))
+#define SUB(x, y) ((x) - (y))
+#define MUL(x, y) round_mul(x, y)
+
+#define DEFINE_FLOAT_KERNEL(NAME, name, expr)                               \
+int kernel_##name##_float(const DataValue* v, DataValue* out)               \
+{                                                                           \
+    out->decimal = expr;                                                    \
+    return 1;                                                               \
+}
 
-    switch (node->data.unary.sign->type)
-    {
-    case TT_ADD:
-        res_signed = pos(res.result, node);
-        break;
+KERNEL_SHAPES(DEFINE_FLOAT_KERNEL)
+
+#undef A
+#undef B
+#undef C
+#undef D
+#undef ADD
+#undef SUB
+#undef MUL
+
+// Kernels for integers of any size, used once some value does not fit
+// in 64 bits
+#define A copy_value(v[0])
+#define B copy_value(v[1])
+#define C copy_value(v[2])
+#define D copy_value(v[3])
+#define ADD(x, y) combine_ints(int_add, x, y)
+#define SUB(x, y) combine_ints(int_sub, x, y)
+#define MUL(x, y) combine_ints(int_mul, x, y)
+
+#define DEFINE_BIG_KERNEL(NAME, name, expr)                                 \
+DataType* kernel_##name##_big(DataType* const* v)                           \
+{                                                                           \
+    return expr;                                                            \
+}
 
-    case TT_SUB:
-        res_signed = neg(res.result, node);
-        break;
-    
-    default:
-        return res;  // Should not happen
-    }
+KERNEL_SHAPES(DEFINE_BIG_KERNEL)
+
+#undef A
+#undef B
+#undef C
+#undef D
+#undef ADD
+#undef SUB
+#undef MUL
+
+/**
+ * Divides a sum by a difference of doubles, ```(a + b) / (c - d)```
+ * 
+ * @param v The operands
+ * @param out Where to store the quotient
+ * 
+ * @return ```1``` on success, or ```0``` if the divisor is 0
+ */
+int kernel_ratio_float(const DataValue* v, DataValue* out)
+{
+    double divisor = v[2].decimal - v[3].decimal;
+    out->decimal = (v[0].decimal + v[1].decimal) / divisor;
+    return divisor != 0;
+}
 
-    free_value(res.result);
-    return res_signed;
+/**
+ * Divides a sum by a difference of doubles, ```(a + b) / (c - d)```,
+ * whose divisor was proven to never be 0
+ * 
+ * @param v The operands
+ * @param out Where to store the quotient
+ * 
+ * @return ```1```
+ */
+int kernel_ratio_float_unchecked(const DataValue* v, DataValue* out)
+{
+    out->decimal = (v[0].decimal + v[1].decimal) / (v[2].decimal - v[3].decimal);
+    return 1;
 }
 
-Result visit_BinOpNode(const ASTNode* node)
+/**
+ * Kernel of a fused operation on machine values
+ */
+typedef int (*MachineKernel)(const DataValue* v, DataValue* out);
+
+/**
+ * Kernel of a fused operation on integers of any size
+ */
+typedef DataType* (*BigKernel)(DataType* const* v);
+
+#define MACHINE_KERNELS(NAME, name, expr)                                   \
+    [OP_KERNEL_##NAME##_INT]    = kernel_##name##_int,                      \
+    [OP_KERNEL_##NAME##_FLOAT]  = kernel_##name##_float,
+
+#define BIG_KERNELS(NAME, name, expr)                                       \
+    [OP_KERNEL_##NAME##_INT]    = kernel_##name##_big,
+
+/**
+ * Provides the machine kernel of each shape kernel implementation
+ */
+const MachineKernel MachineKernels[] = {
+    KERNEL_SHAPES(MACHINE_KERNELS)
+    [OP_KERNEL_RATIO_FLOAT]             = kernel_ratio_float,
+    [OP_KERNEL_RATIO_FLOAT_UNCHECKED]   = kernel_ratio_float_unchecked,
+};
+
+/**
+ * Provides the kernel on integers of any size of each integer shape
+ * kernel implementation
+ */
+const BigKernel BigKernels[] = {
+    KERNEL_SHAPES(BIG_KERNELS)
+};
+
+/**
+ * Checks whether a fused operation is a shape kernel
+ * 
+ * @param opcode The implementation of the operation
+ * 
+ * @return Boolean-like value
+ */
+int is_kernel(Opcode opcode)
 {
-    Result left, right, res;
+    // Shape kernels are the last implementations
+    return opcode >= OP_KERNEL_MUL_ADD_INT;
+}
 
-    left = visit_node_with_promotion(node->data.binary.left, node->type);
-    if (left.result == NULL)
-        return left;
-    
-    right = visit_node_with_promotion(node->data.binary.right, node->type);
-    if (right.result == NULL)
+/**
+ * Checks whether a fused operation is a sum or product of any number of
+ * operands
+ * 
+ * @param opcode The implementation of the operation
+ * 
+ * @return Boolean-like value
+ */
+int is_chain(Opcode opcode)
+{
+    return opcode == OP_SUM_INT || opcode == OP_SUM_FLOAT
+        || opcode == OP_PRODUCT_INT || opcode == OP_PRODUCT_FLOAT;
+}
+
+int eval_fused_unboxed(const Interpreter* i, const ASTNode* node, DataValue* out);
+
+/**
+ * Obtains the machine value of a variable or invariant
+ * 
+ * @param v The value
+ * @param out Where to store the machine value
+ * 
+ * @return ```1``` on success, or ```0``` if the value is unassigned or
+ * does not fit in 64 bits
+ */
+int unbox_machine(Value v, DataValue* out)
+{
+    if (is_float_value(v))
+    {
+        out->decimal = unbox_float(v);
+        return 1;
+    }
+    if (is_small_int_value(v))
     {
-        free_value(left.result);
-        return right;
+        out->integer = unbox_small_int(v);
+        return 1;
     }
+    if (!is_boxed_value(v))
+        return 0;
+
+    const DataType* data = view_value(v, NULL);
+    if (data->type == BIGINT)
+        return 0;
+    *out = data->value;
+    return 1;
+}
 
-    switch (node->data.binary.op->type)
+/**
+ * Evaluates a branch of a select on machine values, without allocating
+ * data values. The branch must have been checked by the typing pass to
+ * have no side effects and to never fail
+ * 
+ * @param i The interpreter
+ * @param node The branch
+ * @param out Where to store the value, as ```integer``` for integer nodes
+ * or ```decimal``` for ```FLOAT``` nodes
+ * 
+ * @return ```1``` on success, or ```0``` if some value does not fit in
+ * 64 bits
+ */
+int eval_unboxed(const Interpreter* i, const ASTNode* node, DataValue* out)
+{
+    DataValue a, b;
+    switch (node->class)
     {
-    case TT_ADD:
-        res = add(left.result, right.result, node);
-        break;
-    
-    case TT_SUB:
-        res = sub(left.result, right.result, node);
-        break;
+    case Number:
+        if (node->type == BIGINT)
+            return 0;
+        *out = node->data.number.literal;
+        return 1;
 
-    case TT_MUL:
-        res = mul(left.result, right.result, node);
-        break;
+    case VarAccess:
+        return unbox_machine(i->slots[node->data.access.slot], out);
 
-    case TT_DIV:
-        res = div_(left.result, right.result, node);
-        break;
+    case Invariant:
+        // Only invariants already evaluated in this run of the loop
+        return unbox_machine(*get_invariant(i, node), out);
 
-    case TT_MOD:
-        res = mod(left.result, right.result, node);
-        break;
+    case Convert:
+        if (!eval_unboxed(i, node->data.convert.value, &a))
+            return 0;
+        out->decimal = (double) a.integer;
+        return 1;
 
-    case TT_POW:
-        res = pow_(left.result, right.result, node);
-        break;
+    case UnOp:
+        if (!eval_unboxed(i, node->data.unary.value, &a))
+            return 0;
 
-    default:
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            "Unable to interpret node: Unknown operator"
-        );
-        break;
-    }
-    
-    free_value(left.result);
-    free_value(right.result);
-    return res;
-}
+        switch (node->data.unary.opcode)
+        {
+        case OP_POS_INT:
+        case OP_POS_FLOAT:
+            *out = a;
+            return 1;
 
-Result pos(const DataType* value, const ASTNode* node)
-{
-    Result res;
+        case OP_NEG_INT:
+            out->integer = -a.integer;
+            return a.integer != INT64_MIN;
 
-    switch (node->type)
-    {
-    case INT:
-        res.result = new_int(+value->value.integer);
-        break;
+        case OP_NEG_FLOAT:
+            out->decimal = -a.decimal;
+            return 1;
 
-    case FLOAT:
-        res.result = new_float(+value->value.decimal);
-        break;
+        case OP_NOT_INT:
+            out->integer = !a.integer;
+            return 1;
 
-    default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No positive method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            details
-        );
-        break;
-    }
+        case OP_NOT_FLOAT:
+            out->integer = a.decimal == 0;
+            return 1;
 
-    return res;
-}
+        default:
+            return 0;
+        }
 
-Result neg(const DataType* value, const ASTNode* node)
-{
-    Result res;
+    case BinOp:
+        if (!eval_unboxed(i, node->data.binary.left, &a)
+            || !eval_unboxed(i, node->data.binary.right, &b))
+            return 0;
 
-    switch (node->type)
-    {
-    case INT:
-        res.result = new_int(-value->value.integer);
-        break;
+        switch (node->data.binary.opcode)
+        {
+        case OP_ADD_INT:
+            return !__builtin_add_overflow(a.integer, b.integer, &out->integer);
+
+        case OP_SUB_INT:
+            return !__builtin_sub_overflow(a.integer, b.integer, &out->integer);
+
+        case OP_MUL_INT:
+            return !__builtin_mul_overflow(a.integer, b.integer, &out->integer);
+
+        case OP_MOD_INT_UNCHECKED:
+            out->integer = (b.integer == -1) ? 0 : a.integer % b.integer;
+            return 1;
+
+        case OP_ADD_FLOAT:
+            out->decimal = a.decimal + b.decimal;
+            return 1;
+
+        case OP_SUB_FLOAT:
+            out->decimal = a.decimal - b.decimal;
+            return 1;
+
+        case OP_MUL_FLOAT:
+            out->decimal = a.decimal * b.decimal;
+            return 1;
+
+        case OP_DIV_FLOAT_UNCHECKED:
+            out->decimal = a.decimal / b.decimal;
+            return 1;
+
+        case OP_MOD_FLOAT_UNCHECKED:
+            out->decimal = remainder(a.decimal, b.decimal);
+            return 1;
+
+        case OP_LT_INT:   out->integer = a.integer <  b.integer; return 1;
+        case OP_LE_INT:   out->integer = a.integer <= b.integer; return 1;
+        case OP_GT_INT:   out->integer = a.integer >  b.integer; return 1;
+        case OP_GE_INT:   out->integer = a.integer >= b.integer; return 1;
+        case OP_EQ_INT:   out->integer = a.integer == b.integer; return 1;
+        case OP_NE_INT:   out->integer = a.integer != b.integer; return 1;
+        case OP_LT_FLOAT: out->integer = a.decimal <  b.decimal; return 1;
+        case OP_LE_FLOAT: out->integer = a.decimal <= b.decimal; return 1;
+        case OP_GT_FLOAT: out->integer = a.decimal >  b.decimal; return 1;
+        case OP_GE_FLOAT: out->integer = a.decimal >= b.decimal; return 1;
+        case OP_EQ_FLOAT: out->integer = a.decimal == b.decimal; return 1;
+        case OP_NE_FLOAT: out->integer = a.decimal != b.decimal; return 1;
+
+        default:
+            return 0;
+        }
 
-    case FLOAT:
-        res.result = new_float(-value->value.decimal);
-        break;
+    case Fused:
+        return eval_fused_unboxed(i, node, out);
 
     default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No negative method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            details
-        );
-        break;
+        return 0;
     }
-
-    return res;
 }
 
-Result add(const DataType* left, const DataType* right, const ASTNode* node)
+/**
+ * Evaluates a fused operation on machine values, as ```eval_unboxed```
+ * 
+ * @param i The interpreter
+ * @param node The fused node
+ * @param out Where to store the value
+ * 
+ * @return ```1``` on success, or ```0``` if some value does not fit in
+ * 64 bits
+ */
+int eval_fused_unboxed(const Interpreter* i, const ASTNode* node, DataValue* out)
 {
-    Result res;
+    const FusedNode* fused = &node->data.fused;
+    DataValue v[4];     // Kernels have at most 4 operands
+    int64_t square;
 
-    switch (node->type)
+    // Chains are accumulated as their operands are evaluated
+    if (is_chain(fused->opcode))
     {
-    case INT:
-        res.result = new_int(left->value.integer + right->value.integer);
-        break;
-
-    case FLOAT:
-        res.result = new_float(left->value.decimal + right->value.decimal);
-        break;
+        if (!eval_unboxed(i, fused->operands[0], out))
+            return 0;
 
-    default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No addition method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            details
-        );
-        break;
+        for (int k = 1; k < fused->count; k++)
+        {
+            if (!eval_unboxed(i, fused->operands[k], &v[0]))
+                return 0;
+
+            switch (fused->opcode)
+            {
+            case OP_SUM_INT:
+                if (__builtin_add_overflow(out->integer, v[0].integer, &out->integer))
+                    return 0;
+                break;
+
+            case OP_PRODUCT_INT:
+                if (__builtin_mul_overflow(out->integer, v[0].integer, &out->integer))
+                    return 0;
+                break;
+
+            case OP_SUM_FLOAT:
+                out->decimal += v[0].decimal;
+                break;
+
+            case OP_PRODUCT_FLOAT:
+                out->decimal *= v[0].decimal;
+                break;
+
+            default:
+                return 0;
+            }
+        }
+        return 1;
     }
 
-    return res;
-}
-
-Result sub(const DataType* left, const DataType* right, const ASTNode* node)
-{
-    Result res;
+    for (int k = 0; k < fused->count; k++)
+    {
+        if (!eval_unboxed(i, fused->operands[k], &v[k]))
+            return 0;
+    }
 
-    switch (node->type)
+    switch (fused->opcode)
     {
-    case INT:
-        res.result = new_int(left->value.integer - right->value.integer);
-        break;
+    case OP_SQUARE_INT:
+        return !__builtin_mul_overflow(v[0].integer, v[0].integer, &out->integer);
 
-    case FLOAT:
-        res.result = new_float(left->value.decimal - right->value.decimal);
-        break;
+    case OP_CUBE_INT:
+        return !__builtin_mul_overflow(v[0].integer, v[0].integer, &square)
+            && !__builtin_mul_overflow(square, v[0].integer, &out->integer);
 
-    default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No subtraction method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            details
-        );
-        break;
-    }
+    case OP_SQUARE_FLOAT:
+        out->decimal = v[0].decimal * v[0].decimal;
+        return 1;
 
-    return res;
-}
+    case OP_CUBE_FLOAT:
+        out->decimal = v[0].decimal * v[0].decimal * v[0].decimal;
+        return 1;
 
-Result mul(const DataType* left, const DataType* right, const ASTNode* node)
-{
-    Result res;
+    case OP_MUL_ADD_FLOAT:
+        out->decimal = fma(v[0].decimal, v[1].decimal, v[2].decimal);
+        return 1;
 
-    switch (node->type)
-    {
-    case INT:
-        res.result = new_int(left->value.integer * right->value.integer);
-        break;
+    case OP_MUL_SUB_FLOAT:
+        out->decimal = fma(v[0].decimal, v[1].decimal, -v[2].decimal);
+        return 1;
 
-    case FLOAT:
-        res.result = new_float(left->value.decimal * right->value.decimal);
-        break;
+    case OP_ADD_MUL_FLOAT:
+        out->decimal = fma(v[1].decimal, v[2].decimal, v[0].decimal);
+        return 1;
+
+    case OP_SUB_MUL_FLOAT:
+        out->decimal = fma(-v[1].decimal, v[2].decimal, v[0].decimal);
+        return 1;
 
     default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No multiplication method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            details
-        );
-        break;
+        return is_kernel(fused->opcode) && MachineKernels[fused->opcode](v, out);
     }
+}
 
-    return res;
+/**
+ * Implementation of a unary operation
+ */
+typedef DataType* (*UnaryImpl)(const DataType* value, const ASTNode* node);
+
+/**
+ * Implementation of a binary operation. Operations that fail return
+ * ```NULL``` and store the error in the interpreter, since the operands
+ * are freed by the node before the error is raised
+ */
+typedef DataType* (*BinaryImpl)(const DataType* left, const DataType* right, 
+                                const ASTNode* node, Interpreter* i);
+
+/**
+ * Implementation of a fused operation, which evaluates the operands of
+ * the node itself
+ */
+typedef DataType* (*FusedImpl)(Interpreter* i, const ASTNode* node);
+
+/**
+ * Copies the arguments of a call
+ * 
+ * @param frame The frame of the call
+ * @param n_args The number of arguments
+ * 
+ * @return The copies
+ */
+Value* copy_args(const Value* frame, int n_args)
+{
+    Value* args = (Value*) malloc((n_args + 1) * sizeof(Value));
+    for (int k = 0; k < n_args; k++)
+        args[k] = copy_boxed(frame[k]);
+    return args;
 }
 
-Result div_(const DataType* left, const DataType* right, const ASTNode* node)
+/**
+ * Runs a call and the chain of tail calls it makes. Results of memoized
+ * functions are looked up before running their body, and stored for every
+ * call of the chain once the final value is known
+ * 
+ * @param i The interpreter
+ * @param spec The callee
+ * @param frame The frame of the call, with the arguments in the first
+ * slots. Ownership is transferred to the function
+ * 
+ * @return The result of the call
+ */
+DataType* call_function(Interpreter* i, const Specialization* spec, Value* frame)
 {
-    Result res;
+    DataType* result;
+    Value* saved = i->slots;
 
-    if (isZero(right))
-    {
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            "Division by 0"
-        );
-        return res;
-    }
+    // Arguments of the calls of memoized functions waiting for the result
+    // are held above this mark
+    int mark = i->n_owned;
 
-    switch (node->type)
+    while (1)
     {
-    case INT:
-        res.result = new_int(left->value.integer / right->value.integer);
-        break;
-
-    case FLOAT:
-        res.result = new_float(left->value.decimal / right->value.decimal);
-        break;
+        const Function* f = spec->function;
+        if (f->cache)
+        {
+            result = memo_lookup(f->cache, spec, frame);
+            if (result)
+            {
+                free_frame(frame, f->n_locals);
+                break;
+            }
+
+            // Keys are copied since the body may assign its parameters
+            own(i, copy_args(frame, f->n_params), f->cache->n_args, spec);
+        }
 
-    default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No division method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            details
-        );
-        break;
+        own(i, frame, f->n_locals, NULL);
+        i->slots = frame;
+        result = visit(i, spec->body);
+        i->slots = saved;
+        i->n_owned--;
+        free_frame(frame, f->n_locals);
+
+        if (result != NULL || i->pending == NULL)
+            break;
+
+        // Continue with the tail call
+        spec = i->pending;
+        frame = i->pending_frame;
+        i->pending = NULL;
+        i->pending_frame = NULL;
     }
 
-    return res;
+    for (int k = mark; k < i->n_owned; k++)
+    {
+        const Specialization* key = i->owned[k].memo;
+        memo_store(key->function->cache, key, (Value*) i->owned[k].data, result);
+    }
+    i->n_owned = mark;
+    return result;
 }
 
-Result mod(const DataType* left, const DataType* right, const ASTNode* node)
+/**
+ * Runs a call to a built-in function
+ * 
+ * @param i The interpreter
+ * @param node The call node
+ * 
+ * @return The result of the call
+ */
+DataType* call_builtin(Interpreter* i, const ASTNode* node)
 {
-    Result res;
+    DataType* result;
+    const CallNode* call = &node->data.call;
+    const Builtin* b = &Builtins[call->builtin];
+    DataType* args[2] = { NULL, NULL };
+    int mark = i->n_owned;
 
-    if (isZero(right))
+    for (int k = 0; k < call->n_args; k++)
     {
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            "Division by 0"
-        );
-        return res;
+        args[k] = visit(i, call->args[k]);
+        own_value(i, args[k]);
     }
 
-    switch (node->type)
+    const DataType* x = args[0];
+    const DataType* y = (args[1]) ? args[1] : args[0];
+    if (x->type == FLOAT && b->result != RESULT_INT)
     {
-    case INT:
-        res.result = new_int(left->value.integer % right->value.integer);
-        break;
-
-    case FLOAT:
-        res.result = new_float(remainder(left->value.decimal, right->value.decimal));
-        break;
-
-    default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No module method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
-            node->pos,
-            details
-        );
-        break;
+        if (b->in_domain && !b->in_domain(x->value.decimal))
+            fail_eval(i, new_name_error(ERR_MATH_DOMAIN, node->pos, call->name->value));
+        result = new_float(b->scalar(x->value.decimal, y->value.decimal));
+    }
+    else if (x->type == FLOAT)
+    {
+        if (!isfinite(x->value.decimal))
+            fail_eval(i, new_conversion_error(node->pos, FLOAT, INT));
+        result = float_floor(x->value.decimal);
+    }
+    else
+    {
+        switch (call->builtin)
+        {
+        case BI_ABS:
+            if ((x->type == INT) ? x->value.integer < 0 : x->value.big->sign < 0)
+                result = int_neg(x);
+            else
+                result = copy_value(x);
+            break;
+
+        case BI_MIN:
+            result = copy_value((int_cmp(y, x) < 0) ? y : x);
+            break;
+
+        case BI_MAX:
+            result = copy_value((int_cmp(y, x) > 0) ? y : x);
+            break;
+
+        default:
+            // floor of an integer
+            result = copy_value(x);
+            break;
+        }
     }
 
-    return res;
+    release_owned(i, mark);
+    return result;
 }
 
-Result pow_(const DataType* left, const DataType* right, const ASTNode* node)
-{
-    Result res;
 
-    switch (node->type)
+// Private function declarations
+
+DataType* visit_NumberNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_UnOpNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_BinOpNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_forked_BinOpNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_forked_FusedNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_VarAccessNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_VarAssignNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_ConvertNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_FuncDefNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_CallNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_SequenceNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_LogicNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_CondNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_WhileNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_ForNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_InvariantNode(Interpreter* i, const ASTNode* node);
+
+DataType* visit_FusedNode(Interpreter* i, const ASTNode* node);
+
+// Unary operators
+
+DataType* pos_int(const DataType* value, const ASTNode* node);
+
+DataType* pos_float(const DataType* value, const ASTNode* node);
+
+DataType* neg_int(const DataType* value, const ASTNode* node);
+
+DataType* neg_float(const DataType* value, const ASTNode* node);
+
+DataType* not_int(const DataType* value, const ASTNode* node);
+
+DataType* not_float(const DataType* value, const ASTNode* node);
+
+// Binary operators
+
+DataType* add_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* add_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* sub_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* sub_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* mul_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* mul_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* div_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* mod_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* mod_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* div_float_unchecked(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* mod_int_unchecked(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* mod_float_unchecked(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* pow_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* pow_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+// Comparison operators
+
+DataType* lt_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* lt_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* le_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* le_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* gt_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* gt_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* ge_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* ge_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* eq_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* eq_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* ne_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+DataType* ne_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i);
+
+// Fused operations
+
+DataType* square_int(Interpreter* i, const ASTNode* node);
+
+DataType* square_float(Interpreter* i, const ASTNode* node);
+
+DataType* cube_int(Interpreter* i, const ASTNode* node);
+
+DataType* cube_float(Interpreter* i, const ASTNode* node);
+
+DataType* sum_int(Interpreter* i, const ASTNode* node);
+
+DataType* sum_float(Interpreter* i, const ASTNode* node);
+
+DataType* product_int(Interpreter* i, const ASTNode* node);
+
+DataType* product_float(Interpreter* i, const ASTNode* node);
+
+DataType* mul_add_float(Interpreter* i, const ASTNode* node);
+
+DataType* mul_sub_float(Interpreter* i, const ASTNode* node);
+
+DataType* add_mul_float(Interpreter* i, const ASTNode* node);
+
+DataType* sub_mul_float(Interpreter* i, const ASTNode* node);
+
+DataType* int_kernel(Interpreter* i, const ASTNode* node);
+
+DataType* float_kernel(Interpreter* i, const ASTNode* node);
+
+#define FUSED_KERNELS(NAME, name, expr)                                     \
+    [OP_KERNEL_##NAME##_INT]    = int_kernel,                               \
+    [OP_KERNEL_##NAME##_FLOAT]  = float_kernel,
+
+/**
+ * Provides the function of each unary operation implementation
+ */
+const UnaryImpl UnaryImpls[] = {
+    [OP_POS_INT]    = pos_int,
+    [OP_POS_FLOAT]  = pos_float,
+    [OP_NEG_INT]    = neg_int,
+    [OP_NEG_FLOAT]  = neg_float,
+    [OP_NOT_INT]    = not_int,
+    [OP_NOT_FLOAT]  = not_float,
+};
+
+/**
+ * Provides the function of each binary operation implementation
+ */
+const BinaryImpl BinaryImpls[] = {
+    [OP_ADD_INT]    = add_int,
+    [OP_ADD_FLOAT]  = add_float,
+    [OP_SUB_INT]    = sub_int,
+    [OP_SUB_FLOAT]  = sub_float,
+    [OP_MUL_INT]    = mul_int,
+    [OP_MUL_FLOAT]  = mul_float,
+    [OP_DIV_FLOAT]  = div_float,
+    [OP_MOD_INT]    = mod_int,
+    [OP_MOD_FLOAT]  = mod_float,
+    [OP_DIV_FLOAT_UNCHECKED]    = div_float_unchecked,
+    [OP_MOD_INT_UNCHECKED]      = mod_int_unchecked,
+    [OP_MOD_FLOAT_UNCHECKED]    = mod_float_unchecked,
+    [OP_POW_INT]    = pow_int,
+    [OP_POW_FLOAT]  = pow_float,
+    [OP_LT_INT]     = lt_int,
+    [OP_LT_FLOAT]   = lt_float,
+    [OP_LE_INT]     = le_int,
+    [OP_LE_FLOAT]   = le_float,
+    [OP_GT_INT]     = gt_int,
+    [OP_GT_FLOAT]   = gt_float,
+    [OP_GE_INT]     = ge_int,
+    [OP_GE_FLOAT]   = ge_float,
+    [OP_EQ_INT]     = eq_int,
+    [OP_EQ_FLOAT]   = eq_float,
+    [OP_NE_INT]     = ne_int,
+    [OP_NE_FLOAT]   = ne_float,
+};
+
+/**
+ * Provides the function of each fused operation implementation
+ */
+const FusedImpl FusedImpls[] = {
+    [OP_SQUARE_INT]     = square_int,
+    [OP_SQUARE_FLOAT]   = square_float,
+    [OP_CUBE_INT]       = cube_int,
+    [OP_CUBE_FLOAT]     = cube_float,
+    [OP_SUM_INT]        = sum_int,
+    [OP_SUM_FLOAT]      = sum_float,
+    [OP_PRODUCT_INT]    = product_int,
+    [OP_PRODUCT_FLOAT]  = product_float,
+    [OP_MUL_ADD_FLOAT]  = mul_add_float,
+    [OP_MUL_SUB_FLOAT]  = mul_sub_float,
+    [OP_ADD_MUL_FLOAT]  = add_mul_float,
+    [OP_SUB_MUL_FLOAT]  = sub_mul_float,
+    KERNEL_SHAPES(FUSED_KERNELS)
+    [OP_KERNEL_RATIO_FLOAT]             = float_kernel,
+    [OP_KERNEL_RATIO_FLOAT_UNCHECKED]   = float_kernel,
+};
+
+
+// Public functions
+
+Environment new_environment(void)
+{
+    Environment env = { .slots = NULL, .size = 0 };
+    return env;
+}
+
+void reserve_environment(Environment* env, int size)
+{
+    if (size <= env->size)
+        return;
+
+    if (size < 2 * env->size)
+        size = 2 * env->size;
+    env->slots = (Value*) realloc(env->slots, size * sizeof(Value));
+    unset_values(env->slots + env->size, size - env->size);
+    env->size = size;
+}
+
+void free_environment(Environment* env)
+{
+    for (int s = 0; s < env->size; s++)
+        release_value(env->slots[s]);
+    free(env->slots);
+    env->slots = NULL;
+    env->size = 0;
+}
+
+Interpreter new_interpreter(const ASTNode* ast, Environment* env)
+{
+    Interpreter i = { 
+        .ast = ast, 
+        .env = env, 
+        .slots = env->slots, 
+        .depth = 0, 
+        .pending = NULL, 
+        .pending_frame = NULL, 
+        .loop = NULL, 
+        .pool = NULL, 
+        .worker = 0, 
+        .owned = NULL, 
+        .n_owned = 0, 
+        .owned_capacity = 0, 
+        .on_error = NULL, 
+        .fuel = INT64_MAX, 
+        .steps_left = 0, 
+        .deadline = 0, 
+        .max_depth = MAX_CALL_DEPTH, 
+        .max_limbs = SIZE_MAX, 
+    };
+    return i;
+}
+
+void set_budget(Interpreter* i, const Budget* budget)
+{
+    // Without a step or time limit, there is nothing to check
+    uint64_t steps = (budget->max_steps) ? budget->max_steps : UINT64_MAX;
+    if (budget->max_steps == 0 && budget->max_seconds <= 0)
+    {
+        i->fuel = INT64_MAX;
+        i->steps_left = 0;
+    }
+    else
+    {
+        i->fuel = (steps < BUDGET_INTERVAL) ? (int64_t) steps : BUDGET_INTERVAL;
+        i->steps_left = steps - i->fuel;
+    }
+
+    i->deadline = (budget->max_seconds > 0) ? 
+        monotonic_time() + budget->max_seconds : 0;
+    i->max_depth = (budget->max_depth > 0 && budget->max_depth < MAX_CALL_DEPTH) ? 
+        budget->max_depth : MAX_CALL_DEPTH;
+    i->max_limbs = (budget->max_memory) ? 
+        budget->max_memory / sizeof(uint32_t) : SIZE_MAX;
+}
+
+double monotonic_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+Result interpret(Interpreter* i)
+{
+    Result res;
+    CatchPoint point;
+
+    set_catch_point(i, &point);
+    if (setjmp(point.env) == 0)
+    {
+        res.result = visit(i, i->ast);
+        clear_catch_point(i, &point);
+    }
+    else
+    {
+        res.result = NULL;
+        res.err = i->err;
+    }
+
+    // The stack of temporaries lives as long as the outermost evaluation
+    if (i->on_error == NULL)
+    {
+        free(i->owned);
+        i->owned = NULL;
+        i->owned_capacity = 0;
+    }
+    return res;
+}
+
+DataType* visit(Interpreter* i, const ASTNode* node)
+{
+    // The budget is only checked once every BUDGET_INTERVAL visits
+    if (--i->fuel < 0)
+        check_budget(i, node);
+
+    switch (node->class)
+    {
+    case Number:
+        return visit_NumberNode(i, node);
+
+    case UnOp:
+        return visit_UnOpNode(i, node);
+
+    case BinOp:
+        return visit_BinOpNode(i, node);
+
+    case VarAccess:
+        return visit_VarAccessNode(i, node);
+
+    case VarAssign:
+        return visit_VarAssignNode(i, node);
+
+    case Convert:
+        return visit_ConvertNode(i, node);
+
+    case FuncDef:
+        return visit_FuncDefNode(i, node);
+
+    case Call:
+        return visit_CallNode(i, node);
+
+    case Sequence:
+        return visit_SequenceNode(i, node);
+
+    case Logic:
+        return visit_LogicNode(i, node);
+
+    case Cond:
+        return visit_CondNode(i, node);
+
+    case While:
+        return visit_WhileNode(i, node);
+
+    case For:
+        return visit_ForNode(i, node);
+
+    case Invariant:
+        return visit_InvariantNode(i, node);
+
+    case Fused:
+        return visit_FusedNode(i, node);
+    
+    default:
+        fail_eval(i, new_error(
+            ERR_UNKNOWN_NODE,
+            node->pos
+        ));
+    }
+}
+
+
+// Private function implementations
+
+DataType* visit_NumberNode(Interpreter* i, const ASTNode* node)
+{
+    const DataValue* literal = &node->data.number.literal;
+
+    switch (node->type)
     {
     case INT:
-        res.result = new_int(pow(left->value.integer, right->value.integer));
-        break;
+        return new_int(literal->integer);
 
-    case FLOAT:
-        res.result = new_float(pow(left->value.decimal, right->value.decimal));
-        break;
+    case BIGINT:
+        return new_bigint(bigint_copy(literal->big));
 
+    case FLOAT:
+        return new_float(literal->decimal);
+    
     default:
-        char details[MAX_ERR_DET_LEN];
-        sprintf(
-            details, 
-            "No power method defined for type %s", 
-            get_type_representation(node->type)
-        );
-        res.result = NULL;
-        res.err = new_error(
-            RuntimeError,
+        fail_eval(i, new_error(
+            ERR_UNKNOWN_NUMBER,
+            node->pos
+        ));
+    }
+}
+
+DataType* visit_UnOpNode(Interpreter* i, const ASTNode* node)
+{
+    DataType* value = visit(i, node->data.unary.value);
+    DataType* res = UnaryImpls[node->data.unary.opcode](value, node);
+    free_value(value);
+    return res;
+}
+
+DataType* visit_BinOpNode(Interpreter* i, const ASTNode* node)
+{
+    if (node->data.binary.fork && i->pool)
+        return visit_forked_BinOpNode(i, node);
+
+    // The left operand is held while the right one is evaluated
+    DataType* left = visit(i, node->data.binary.left);
+    own_value(i, left);
+    DataType* right = visit(i, node->data.binary.right);
+    i->n_owned--;
+
+    DataType* res = BinaryImpls[node->data.binary.opcode](left, right, node, i);
+    free_value(left);
+    free_value(right);
+    if (res == NULL)
+        fail_eval(i, i->err);
+    return res;
+}
+
+/**
+ * Evaluates a binary operation whose right operand is evaluated by the
+ * pool while the interpreter evaluates the left one
+ */
+DataType* visit_forked_BinOpNode(Interpreter* i, const ASTNode* node)
+{
+    Result right;
+    CatchPoint point;
+    Task task;
+
+    fork_task(i, &task, node->data.binary.right);
+
+    // The task lives in this frame, so it is joined before an error of the
+    // left operand unwinds past it. The left operand comes first in
+    // evaluation order, so its error wins
+    set_catch_point(i, &point);
+    if (setjmp(point.env))
+    {
+        right = join_task(i, &task);
+        if (right.result)
+            free_value(right.result);
+        fail_eval(i, i->err);
+    }
+    DataType* left = visit(i, node->data.binary.left);
+    clear_catch_point(i, &point);
+
+    right = join_task(i, &task);
+    if (right.result == NULL)
+    {
+        free_value(left);
+        fail_eval(i, right.err);
+    }
+
+    DataType* res = BinaryImpls[node->data.binary.opcode](left, right.result, node, i);
+    free_value(left);
+    free_value(right.result);
+    if (res == NULL)
+        fail_eval(i, i->err);
+    return res;
+}
+
+DataType* visit_VarAccessNode(Interpreter* i, const ASTNode* node)
+{
+    Value value = i->slots[node->data.access.slot];
+
+    if (value == VALUE_UNSET)
+    {
+        fail_eval(i, new_name_error(
+            ERR_UNDEFINED_VARIABLE,
             node->pos,
-            details
+            node->data.access.name->value
+        ));
+    }
+
+    return unbox_data(value);
+}
+
+DataType* visit_VarAssignNode(Interpreter* i, const ASTNode* node)
+{
+    DataType* res = visit(i, node->data.assign.value);
+
+    Value* slot = &i->slots[node->data.assign.slot];
+    release_value(*slot);
+    *slot = box_copy(res);
+    return res;
+}
+
+DataType* visit_ConvertNode(Interpreter* i, const ASTNode* node)
+{
+    // Integers are the only values converted (to FLOAT)
+    return promote(visit(i, node->data.convert.value), FLOAT);
+}
+
+DataType* visit_FuncDefNode(Interpreter* i, const ASTNode* node)
+{
+    // Functions are defined by the typing pass
+    return new_none();
+}
+
+DataType* visit_CallNode(Interpreter* i, const ASTNode* node)
+{
+    const CallNode* call = &node->data.call;
+    const Specialization* spec = call->spec;
+    int n_locals;
+
+    if (call->builtin >= 0)
+        return call_builtin(i, node);
+
+    // Evaluate the arguments into the callee's frame
+    n_locals = spec->function->n_locals;
+    Value* frame = (Value*) malloc((n_locals + 1) * sizeof(Value));
+    unset_values(frame, n_locals);
+    own(i, frame, n_locals, NULL);
+    for (int k = 0; k < call->n_args; k++)
+        frame[k] = box_data(visit(i, call->args[k]));
+    i->n_owned--;
+
+    // Tail calls are run by the caller's loop, so they use no stack
+    if (call->tail)
+    {
+        i->pending = spec;
+        i->pending_frame = frame;
+        return NULL;
+    }
+
+    if (i->depth >= i->max_depth)
+    {
+        free_frame(frame, n_locals);
+        fail_eval(i, new_error((i->max_depth < MAX_CALL_DEPTH) ? 
+            ERR_DEPTH_LIMIT : ERR_RECURSION_DEPTH, node->pos));
+    }
+
+    i->depth++;
+    DataType* res = call_function(i, spec, frame);
+    i->depth--;
+    return res;
+}
+
+DataType* visit_SequenceNode(Interpreter* i, const ASTNode* node)
+{
+    const SequenceNode* sequence = &node->data.sequence;
+
+    for (int k = 0; k < sequence->count - 1; k++)
+        free_value(visit(i, sequence->items[k]));
+
+    return visit(i, sequence->items[sequence->count - 1]);
+}
+
+DataType* visit_LogicNode(Interpreter* i, const ASTNode* node)
+{
+    const LogicNode* logic = &node->data.logic;
+
+    DataType* value = visit(i, logic->left);
+
+    // The right operand is not evaluated when the left one decides
+    int truth = is_true(value);
+    free_value(value);
+    if (truth == (logic->op->type == TT_OR))
+        return new_int(truth);
+
+    value = visit(i, logic->right);
+    truth = is_true(value);
+    free_value(value);
+    return new_int(truth);
+}
+
+DataType* visit_CondNode(Interpreter* i, const ASTNode* node)
+{
+    const CondNode* cond = &node->data.cond;
+
+    DataType* value = visit(i, cond->cond);
+    int truth = is_true(value);
+    free_value(value);
+    if (!cond->select)
+        return visit(i, (truth) ? cond->if_true : cond->if_false);
+
+    // Both branches are evaluated, and the result is picked by indexing
+    // instead of a hard to predict branch
+    DataValue values[2];
+    if (!eval_unboxed(i, cond->if_false, &values[0])
+        || !eval_unboxed(i, cond->if_true, &values[1]))
+        return visit(i, (truth) ? cond->if_true : cond->if_false);
+
+    DataValue picked = values[truth != 0];
+    return (node->type == FLOAT) ? 
+        new_float(picked.decimal) : new_int(picked.integer);
+}
+
+DataType* visit_WhileNode(Interpreter* i, const ASTNode* node)
+{
+    const WhileNode* loop = &node->data.loop;
+    LoopFrame frame;
+    enter_loop(i, &frame, loop->n_invariants);
+
+    // The value of the last iteration is held while the condition is
+    // evaluated again
+    int held = own_value(i, NULL);
+
+    while (1)
+    {
+        DataType* cond = visit(i, loop->cond);
+        int truth = is_true(cond);
+        free_value(cond);
+        if (!truth)
+            break;
+
+        DataType* value = (DataType*) i->owned[held].data;
+        if (value)
+            free_value(value);
+        i->owned[held].data = NULL;
+        i->owned[held].data = visit(i, loop->body);
+    }
+
+    DataType* value = (DataType*) i->owned[held].data;
+    i->n_owned--;
+    exit_loop(i, &frame);
+
+    // Loops without iterations evaluate to 0
+    return (value) ? value : 
+        (node->type == FLOAT) ? new_float(0) : new_int(0);
+}
+
+DataType* visit_ForNode(Interpreter* i, const ASTNode* node)
+{
+    const ForNode* loop = &node->data.range;
+
+    // The counter, the end and the value of the last iteration are held
+    // while the body is evaluated, and updated in place
+    int mark = i->n_owned;
+    int counter = own_value(i, visit(i, loop->start));
+    int end = own_value(i, visit(i, loop->end));
+    int held = own_value(i, NULL);
+
+    // The bounds have the type of the counter
+    const DataType one = { .type = INT, .value.integer = 1 };
+    LoopFrame frame;
+    enter_loop(i, &frame, loop->n_invariants);
+
+    while (1)
+    {
+        DataType* count = (DataType*) i->owned[counter].data;
+        const DataType* last = (const DataType*) i->owned[end].data;
+        if ((count->type == FLOAT) ? 
+            count->value.decimal > last->value.decimal : 
+            int_cmp(count, last) > 0)
+            break;
+
+        Value* slot = &i->slots[loop->slot];
+        release_value(*slot);
+        *slot = box_copy(count);
+
+        DataType* value = (DataType*) i->owned[held].data;
+        if (value)
+            free_value(value);
+        i->owned[held].data = NULL;
+        i->owned[held].data = visit(i, loop->body);
+
+        // Float counters stop once they are too large to be incremented
+        count = (DataType*) i->owned[counter].data;
+        if (count->type == FLOAT)
+        {
+            double next = count->value.decimal + 1;
+            if (next == count->value.decimal)
+                break;
+            count->value.decimal = next;
+        }
+        else
+        {
+            i->owned[counter].data = int_add(count, &one);
+            free_value(count);
+        }
+    }
+
+    DataType* value = (DataType*) i->owned[held].data;
+    i->owned[held].data = NULL;
+    exit_loop(i, &frame);
+    release_owned(i, mark);
+
+    // Loops without iterations evaluate to 0
+    return (value) ? value : 
+        (node->type == FLOAT) ? new_float(0) : new_int(0);
+}
+
+DataType* visit_InvariantNode(Interpreter* i, const ASTNode* node)
+{
+    Value* value = get_invariant(i, node);
+
+    // The first evaluation in each run of the loop is kept
+    if (*value != VALUE_UNSET)
+        return unbox_data(*value);
+
+    DataType* res = visit(i, node->data.invariant.value);
+    *value = box_copy(res);
+    return res;
+}
+
+DataType* visit_FusedNode(Interpreter* i, const ASTNode* node)
+{
+    if (node->data.fused.fork && i->pool)
+        return visit_forked_FusedNode(i, node);
+
+    return FusedImpls[node->data.fused.opcode](i, node);
+}
+
+/**
+ * Evaluates a fused operation whose operands after the first one are
+ * evaluated by the pool while the interpreter evaluates the first one.
+ * The implementation then runs on literals holding their values
+ */
+DataType* visit_forked_FusedNode(Interpreter* i, const ASTNode* node)
+{
+    const FusedNode* fused = &node->data.fused;
+    Task tasks[FORK_MAX_OPERANDS];
+    Result values[FORK_MAX_OPERANDS];
+    CatchPoint point;
+
+    for (int k = 1; k < fused->count; k++)
+        fork_task(i, &tasks[k], fused->operands[k]);
+
+    // Tasks are joined newest first, before an error unwinds past them
+    set_catch_point(i, &point);
+    if (setjmp(point.env))
+    {
+        for (int k = fused->count - 1; k >= 1; k--)
+        {
+            values[k] = join_task(i, &tasks[k]);
+            if (values[k].result)
+                free_value(values[k].result);
+        }
+        fail_eval(i, i->err);
+    }
+    values[0].result = visit(i, fused->operands[0]);
+    clear_catch_point(i, &point);
+
+    for (int k = fused->count - 1; k >= 1; k--)
+        values[k] = join_task(i, &tasks[k]);
+
+    // The values are held until the operation is done, and the leftmost
+    // error wins, as in evaluation order
+    int mark = i->n_owned;
+    for (int k = 0; k < fused->count; k++)
+        own_value(i, values[k].result);
+    for (int k = 1; k < fused->count; k++)
+        if (values[k].result == NULL)
+            fail_eval(i, values[k].err);
+
+    ASTNode literals[FORK_MAX_OPERANDS];
+    ASTNode* operands[FORK_MAX_OPERANDS];
+    for (int k = 0; k < fused->count; k++)
+    {
+        literals[k].class = Number;
+        literals[k].type = values[k].result->type;
+        literals[k].pos = fused->operands[k]->pos;
+        literals[k].data.number.value = NULL;
+        literals[k].data.number.literal = values[k].result->value;
+        operands[k] = &literals[k];
+    }
+
+    ASTNode local = *node;
+    local.data.fused.operands = operands;
+    local.data.fused.fork = 0;
+    DataType* res = FusedImpls[fused->opcode](i, &local);
+    release_owned(i, mark);
+    return res;
+}
+
+DataType* pos_int(const DataType* value, const ASTNode* node)
+{
+    return copy_value(value);
+}
+
+DataType* pos_float(const DataType* value, const ASTNode* node)
+{
+    return new_float(+value->value.decimal);
+}
+
+DataType* neg_int(const DataType* value, const ASTNode* node)
+{
+    return int_neg(value);
+}
+
+DataType* neg_float(const DataType* value, const ASTNode* node)
+{
+    return new_float(-value->value.decimal);
+}
+
+DataType* not_int(const DataType* value, const ASTNode* node)
+{
+    return new_int(!is_true(value));
+}
+
+DataType* not_float(const DataType* value, const ASTNode* node)
+{
+    return new_int(value->value.decimal == 0);
+}
+
+DataType* add_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return int_add(left, right);
+}
+
+DataType* add_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_float(left->value.decimal + right->value.decimal);
+}
+
+DataType* sub_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return int_sub(left, right);
+}
+
+DataType* sub_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_float(left->value.decimal - right->value.decimal);
+}
+
+DataType* mul_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    // A product has as many limbs as both operands
+    if (count_limbs(left) + count_limbs(right) > i->max_limbs)
+    {
+        i->err = new_error(
+            ERR_MEMORY_LIMIT,
+            node->pos
         );
-        break;
+        return NULL;
     }
 
+    return int_mul(left, right);
+}
+
+DataType* mul_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_float(left->value.decimal * right->value.decimal);
+}
+
+DataType* div_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    if (isZero(right))
+    {
+        i->err = new_error(
+            ERR_DIVISION_BY_ZERO,
+            node->pos
+        );
+        return NULL;
+    }
+
+    return new_float(left->value.decimal / right->value.decimal);
+}
+
+DataType* mod_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    if (isZero(right))
+    {
+        i->err = new_error(
+            ERR_DIVISION_BY_ZERO,
+            node->pos
+        );
+        return NULL;
+    }
+
+    return int_mod(left, right);
+}
+
+DataType* mod_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    if (isZero(right))
+    {
+        i->err = new_error(
+            ERR_DIVISION_BY_ZERO,
+            node->pos
+        );
+        return NULL;
+    }
+
+    return new_float(remainder(left->value.decimal, right->value.decimal));
+}
+
+DataType* div_float_unchecked(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_float(left->value.decimal / right->value.decimal);
+}
+
+DataType* mod_int_unchecked(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return int_mod(left, right);
+}
+
+DataType* mod_float_unchecked(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_float(remainder(left->value.decimal, right->value.decimal));
+}
+
+DataType* pow_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    BigInt lv, rv;
+    uint32_t ls[BIGINT_INT_LIMBS], rs[BIGINT_INT_LIMBS];
+    const BigInt* base = as_bigint(left, &lv, ls);
+    const BigInt* exp = as_bigint(right, &rv, rs);
+    int64_t r;
+
+    if (exp->sign < 0)
+    {
+        i->err = new_error(
+            ERR_NEGATIVE_EXPONENT,
+            node->pos
+        );
+        return NULL;
+    }
+
+    // Small-int fast path
+    if (left->type == INT && right->type == INT 
+        && int_pow(left->value.integer, right->value.integer, &r))
+        return new_int(r);
+
+    if (right->type == INT && bigint_pow_size(base, right->value.integer) > i->max_limbs)
+    {
+        i->err = new_error(
+            ERR_MEMORY_LIMIT,
+            node->pos
+        );
+        return NULL;
+    }
+
+    // Exponents beyond 64 bits only fit trivial bases
+    BigInt* big = NULL;
+    if (right->type == INT)
+        big = bigint_pow(base, (uint64_t) right->value.integer);
+    else if (base->size == 0 || (base->size == 1 && base->limbs[0] == 1))
+        big = bigint_pow(base, 2 - exp->limbs[0] % 2);
+
+    if (big == NULL)
+    {
+        i->err = new_error(
+            ERR_INTEGER_TOO_LARGE,
+            node->pos
+        );
+        return NULL;
+    }
+
+    return new_integer(big);
+}
+
+DataType* pow_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_float(pow(left->value.decimal, right->value.decimal));
+}
+
+DataType* lt_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(int_cmp(left, right) < 0);
+}
+
+DataType* lt_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(left->value.decimal < right->value.decimal);
+}
+
+DataType* le_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(int_cmp(left, right) <= 0);
+}
+
+DataType* le_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(left->value.decimal <= right->value.decimal);
+}
+
+DataType* gt_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(int_cmp(left, right) > 0);
+}
+
+DataType* gt_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(left->value.decimal > right->value.decimal);
+}
+
+DataType* ge_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(int_cmp(left, right) >= 0);
+}
+
+DataType* ge_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(left->value.decimal >= right->value.decimal);
+}
+
+DataType* eq_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(int_cmp(left, right) == 0);
+}
+
+DataType* eq_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(left->value.decimal == right->value.decimal);
+}
+
+DataType* ne_int(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(int_cmp(left, right) != 0);
+}
+
+DataType* ne_float(const DataType* left, const DataType* right, const ASTNode* node, Interpreter* i)
+{
+    return new_int(left->value.decimal != right->value.decimal);
+}
+
+/**
+ * Evaluates the operands of a float fused operation
+ * 
+ * @param i The interpreter
+ * @param node The fused node
+ * @param values Where to store the values of the operands
+ */
+void visit_decimals(Interpreter* i, const ASTNode* node, double* values)
+{
+    for (int k = 0; k < node->data.fused.count; k++)
+    {
+        DataType* value = visit(i, node->data.fused.operands[k]);
+        values[k] = value->value.decimal;
+        free_value(value);
+    }
+}
+
+/**
+ * Evaluates an integer sum or product, in machine integers until some
+ * value does not fit in 64 bits
+ * 
+ * @param i The interpreter
+ * @param node The fused node
+ * @param product Whether the operands are multiplied instead of added
+ * 
+ * @return The result
+ */
+DataType* fold_int(Interpreter* i, const ASTNode* node, int product)
+{
+    const FusedNode* fused = &node->data.fused;
+    int64_t acc = 0;
+
+    // Accumulator once out of machine integers, held while the remaining
+    // operands are evaluated
+    int total = own_value(i, NULL);
+
+    for (int k = 0; k < fused->count; k++)
+    {
+        DataType* value = visit(i, fused->operands[k]);
+        DataType* sum = (DataType*) i->owned[total].data;
+        if (sum == NULL && value->type == INT)
+        {
+            int64_t r = value->value.integer;
+            int overflow = (k > 0) && ((product) ? 
+                __builtin_mul_overflow(acc, r, &r) : 
+                __builtin_add_overflow(acc, r, &r));
+            if (!overflow)
+            {
+                acc = r;
+                free_value(value);
+                continue;
+            }
+        }
+
+        if (k == 0)
+        {
+            i->owned[total].data = value;
+            continue;
+        }
+        if (product && count_limbs(sum) + count_limbs(value) > i->max_limbs)
+        {
+            free_value(value);
+            fail_eval(i, new_error(ERR_MEMORY_LIMIT, node->pos));
+        }
+        if (sum == NULL)
+            sum = new_int(acc);
+
+        i->owned[total].data = (product) ? int_mul(sum, value) : int_add(sum, value);
+        free_value(sum);
+        free_value(value);
+    }
+
+    DataType* sum = (DataType*) i->owned[total].data;
+    i->n_owned--;
+    return (sum) ? sum : new_int(acc);
+}
+
+/**
+ * Evaluates a float sum or product
+ * 
+ * @param i The interpreter
+ * @param node The fused node
+ * @param product Whether the operands are multiplied instead of added
+ * 
+ * @return The result
+ */
+DataType* fold_float(Interpreter* i, const ASTNode* node, int product)
+{
+    const FusedNode* fused = &node->data.fused;
+    double acc = 0;
+
+    // Accumulated in the order of the original chain
+    for (int k = 0; k < fused->count; k++)
+    {
+        DataType* value = visit(i, fused->operands[k]);
+        double x = value->value.decimal;
+        free_value(value);
+        if (k == 0)
+            acc = x;
+        else
+            acc = (product) ? acc * x : acc + x;
+    }
+
+    return new_float(acc);
+}
+
+DataType* square_int(Interpreter* i, const ASTNode* node)
+{
+    DataType* value = visit(i, node->data.fused.operands[0]);
+    if (count_limbs(value) * 2 > i->max_limbs)
+    {
+        free_value(value);
+        fail_eval(i, new_error(ERR_MEMORY_LIMIT, node->pos));
+    }
+
+    DataType* res = int_mul(value, value);
+    free_value(value);
+    return res;
+}
+
+DataType* square_float(Interpreter* i, const ASTNode* node)
+{
+    double x;
+    visit_decimals(i, node, &x);
+    return new_float(x * x);
+}
+
+DataType* cube_int(Interpreter* i, const ASTNode* node)
+{
+    DataType* value = visit(i, node->data.fused.operands[0]);
+    if (count_limbs(value) * 3 > i->max_limbs)
+    {
+        free_value(value);
+        fail_eval(i, new_error(ERR_MEMORY_LIMIT, node->pos));
+    }
+
+    DataType* square = int_mul(value, value);
+    DataType* res = int_mul(square, value);
+    free_value(square);
+    free_value(value);
+    return res;
+}
+
+DataType* cube_float(Interpreter* i, const ASTNode* node)
+{
+    double x;
+    visit_decimals(i, node, &x);
+    return new_float(x * x * x);
+}
+
+DataType* sum_int(Interpreter* i, const ASTNode* node)
+{
+    return fold_int(i, node, 0);
+}
+
+DataType* sum_float(Interpreter* i, const ASTNode* node)
+{
+    return fold_float(i, node, 0);
+}
+
+DataType* product_int(Interpreter* i, const ASTNode* node)
+{
+    return fold_int(i, node, 1);
+}
+
+DataType* product_float(Interpreter* i, const ASTNode* node)
+{
+    return fold_float(i, node, 1);
+}
+
+DataType* mul_add_float(Interpreter* i, const ASTNode* node)
+{
+    double v[3];
+    visit_decimals(i, node, v);
+    return new_float(fma(v[0], v[1], v[2]));
+}
+
+DataType* mul_sub_float(Interpreter* i, const ASTNode* node)
+{
+    double v[3];
+    visit_decimals(i, node, v);
+    return new_float(fma(v[0], v[1], -v[2]));
+}
+
+DataType* add_mul_float(Interpreter* i, const ASTNode* node)
+{
+    double v[3];
+    visit_decimals(i, node, v);
+    return new_float(fma(v[1], v[2], v[0]));
+}
+
+DataType* sub_mul_float(Interpreter* i, const ASTNode* node)
+{
+    double v[3];
+    visit_decimals(i, node, v);
+    return new_float(fma(-v[1], v[2], v[0]));
+}
+
+DataType* int_kernel(Interpreter* i, const ASTNode* node)
+{
+    const FusedNode* fused = &node->data.fused;
+    DataType* v[4];
+    DataValue x[4], out;
+    DataType* res;
+    int machine = 1;
+    int mark = i->n_owned;
+
+    // Operands are held until the last one is evaluated
+    for (int k = 0; k < fused->count; k++)
+    {
+        v[k] = visit(i, fused->operands[k]);
+        own_value(i, v[k]);
+        x[k] = v[k]->value;
+        machine &= v[k]->type == INT;
+    }
+
+    if (machine && MachineKernels[fused->opcode](x, &out))
+        res = new_int(out.integer);
+    else
+    {
+        // Shapes multiply pairs of operands, so their results have at
+        // most as many limbs as all of them
+        size_t limbs = 0;
+        for (int k = 0; k < fused->count; k++)
+            limbs += count_limbs(v[k]);
+        if (limbs > i->max_limbs)
+            fail_eval(i, new_error(ERR_MEMORY_LIMIT, node->pos));
+        res = BigKernels[fused->opcode](v);
+    }
+
+    release_owned(i, mark);
     return res;
 }
+
+DataType* float_kernel(Interpreter* i, const ASTNode* node)
+{
+    const FusedNode* fused = &node->data.fused;
+    DataValue x[4], out;
+
+    for (int k = 0; k < fused->count; k++)
+    {
+        DataType* value = visit(i, fused->operands[k]);
+        x[k].decimal = value->value.decimal;
+        free_value(value);
+    }
+
+    // Only the checked ratio fails, when its divisor is 0
+    if (!MachineKernels[fused->opcode](x, &out))
+    {
+        fail_eval(i, new_error(
+            ERR_DIVISION_BY_ZERO,
+            node->pos
+        ));
+    }
+
+    return new_float(out.decimal);
+}
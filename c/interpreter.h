@@ -1,16 +1,113 @@
 #ifndef INTERPRETER_H
 #define INTERPRETER_H
 
+#include <setjmp.h>
+
 #include "base.h"
+#include "value.h"
+#include "functions.h"
 
 // ----- INTERPRETER -----
 
+/**
+ * Contains the values of the variables, indexed by environment slot
+ */
+typedef struct environment
+{
+    Value* slots;       // Values of the variables (```VALUE_UNSET``` if unassigned)
+    int size;
+} Environment;
+
+/**
+ * Contains the values of the invariants of a loop being run
+ */
+typedef struct loop_frame LoopFrame;
+struct loop_frame
+{
+    Value* invariants;          // Values of the invariants (```VALUE_UNSET``` until reached)
+    int n_invariants;
+    LoopFrame* outer;           // Frame of the enclosing loop
+};
+
+typedef struct thread_pool ThreadPool;
+
+/**
+ * Contains a temporary held by an evaluation in progress, which is freed
+ * if an error unwinds the evaluation
+ */
+typedef struct owned
+{
+    void* data;                     // A data value, or an array of values
+    int n_values;                   // Size of the array (-1 for a data value)
+    const Specialization* memo;     // Call whose arguments the array is, to memoize its result
+} Owned;
+
+/**
+ * Contains the state restored when an error unwinds to an evaluation
+ */
+typedef struct catch_point CatchPoint;
+struct catch_point
+{
+    jmp_buf env;
+    int n_owned;                // Temporaries held when the point was set
+    LoopFrame* loop;
+    Value* slots;
+    int depth;
+    CatchPoint* outer;          // Enclosing point
+};
+
+// Number of nodes visited between checks of the budget of an evaluation
+#define BUDGET_INTERVAL 4096
+
+/**
+ * Contains the limits of an evaluation, so that untrusted code cannot
+ * keep a thread busy or exhaust its memory. Fields set to 0 are not
+ * limited. Exceeding a limit stops the evaluation with a limit error (see
+ * ```is_limit_error```)
+ *
+ * @note Steps and time are checked every ```BUDGET_INTERVAL``` visits,
+ * and the size of products and powers is estimated before they are
+ * computed. A time limit alone cannot interrupt a single huge integer
+ * operation, so it should come with a memory limit
+ */
+typedef struct budget
+{
+    uint64_t max_steps;     // Nodes visited
+    int max_depth;          // Nested calls, below ```MAX_CALL_DEPTH```
+    size_t max_memory;      // Bytes of the digits of any integer value
+    double max_seconds;     // Wall-clock time
+} Budget;
+
 /**
  * Contains information for the interpretation of an Abstract Syntax Tree
  */
 typedef struct interpreter
 {
     const ASTNode* ast;
+    Environment* env;
+    Value* slots;                   // Variables in scope: the environment or a call frame
+    int depth;                      // Number of nested calls being evaluated
+    const Specialization* pending;  // Callee of a tail call left to the caller
+    Value* pending_frame;           // Arguments of the pending tail call
+    LoopFrame* loop;                // Innermost loop being run
+    ThreadPool* pool;               // Workers for forked subtrees (```NULL``` to run sequentially)
+    int worker;                     // Index in the pool of the thread running the interpreter
+
+    // Errors unwind the evaluation straight to the innermost catch point,
+    // freeing the temporaries pushed on this stack since it was set
+    Owned* owned;
+    int n_owned;
+    int owned_capacity;
+    CatchPoint* on_error;           // Innermost catch point
+    Error err;                      // Error being unwound
+
+    // Limits of the evaluation. Visits count down ```fuel```, and the
+    // budget is only checked when it runs out
+    int64_t fuel;                   // Visits left until the next check
+    uint64_t steps_left;            // Visits left after those
+    double deadline;                // Monotonic time to stop at (0 for none)
+    int max_depth;                  // Nested calls allowed
+    size_t max_limbs;               // Size allowed for integer values
 } Interpreter;
 
 /**
@@ -22,14 +119,56 @@ typedef struct interpreter_result
     Error err;
 } Result;
 
+/**
+ * Creates an empty environment
+ * 
+ * @return The new environment
+ * 
+ * @note Remember to call ```free_environment``` afterwards
+ */
+Environment new_environment(void);
+
+/**
+ * Makes room in an environment for a number of slots. New slots are
+ * unassigned
+ * 
+ * @param env The environment
+ * @param size The number of slots
+ */
+void reserve_environment(Environment* env, int size);
+
+/**
+ * Frees the memory used by an environment and its values
+ * 
+ * @param env The environment
+ */
+void free_environment(Environment* env);
+
 /**
  * Creates and initializes an interpreter for an AST
  * 
  * @param ast The root of the AST
+ * @param env The environment where variables are stored
  * 
  * @return The new interpreter
 */
-Interpreter new_interpreter(const ASTNode* ast);
+Interpreter new_interpreter(const ASTNode* ast, Environment* env);
+
+/**
+ * Limits the evaluations of an interpreter. The time limit starts
+ * counting when the budget is set
+ * 
+ * @param i The interpreter
+ * @param budget The limits
+ */
+void set_budget(Interpreter* i, const Budget* budget);
+
+/**
+ * Obtains the time of a monotonic clock, which measures the time limits
+ * 
+ * @return The time, in seconds
+ */
+double monotonic_time(void);
 
 /**
  * Interprets the AST
@@ -40,18 +179,23 @@ Interpreter new_interpreter(const ASTNode* ast);
  * 
  * @note In case of error, the ```result``` field is ```NULL```
  * and the ```err``` field contains the error
+ * @note The AST must have been lowered by ```check_types``` with the
+ * interpreter's environment
  */
 Result interpret(Interpreter* i);
 
 /**
  * Interprets an AST node
  * 
- * @return The result of the interpretation
+ * @param i The interpreter
+ * @param node The node
  * 
+ * @return The result of the interpretation, or ```NULL``` if the node is
+ * a tail call left pending to the caller
  * 
- * @note In case of error, the ```result``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to the innermost catch point, which is set by
+ * ```interpret```
  */
-Result visit(const ASTNode* node);
+DataType* visit(Interpreter* i, const ASTNode* node);
 
 #endif  // INTERPRETER_H
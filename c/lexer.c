@@ -1,7 +1,42 @@
+#include <pthread.h>
+
 #include "lexer.h"
 
 // ----- LEXER -----
 
+/**
+ * Names reserved by the language
+ */
+const char* Keywords[] = {
+    "fun",
+    "memo",
+    "if",
+    "then",
+    "else",
+    "while",
+    "for",
+    "to",
+    "do",
+};
+
+/**
+ * Contains an operator spelled as a word
+ */
+typedef struct word_operator
+{
+    const char* name;
+    TokenType type;
+} WordOperator;
+
+/**
+ * Operators spelled as words
+ */
+const WordOperator WordOperators[] = {
+    { "and", TT_AND },
+    { "or",  TT_OR },
+    { "not", TT_NOT },
+};
+
 // Auxiliary functions
 
 /**
@@ -28,6 +63,131 @@ int is_alpha(char c)
     return ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'));
 }
 
+/**
+ * Checks whether a character can start an identifier
+ * 
+ * @param c The character
+ * 
+ * @return Boolean-like value
+ */
+int is_name_start(char c)
+{
+    return is_alpha(c) || c == '_';
+}
+
+/**
+ * Checks whether a character can be part of an identifier
+ * 
+ * @param c The character
+ * 
+ * @return Boolean-like value
+ */
+int is_name_char(char c)
+{
+    return is_name_start(c) || is_digit(c);
+}
+
+/**
+ * Checks whether the text can be split before a character, which is the
+ * case when the character cannot continue the token before it
+ * 
+ * @param c The character
+ * 
+ * @return Boolean-like value
+ */
+int is_token_boundary(char c)
+{
+    // '=' may complete a comparison, so it is not a boundary
+    switch (c)
+    {
+    case ' ': case '\t': case '\r': case '\n':
+    case '+': case '-': case '*': case '/': case '%': case '^':
+    case '(': case ')': case ',': case ';':
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Contains the analysis of a chunk of the text, with positions relative
+ * to the start of the chunk
+ */
+typedef struct lexer_chunk
+{
+    Lexer l;
+    LexerResult res;
+    Position base;          // Position of the chunk in the text, minus a column
+    const Token** dest;     // Where to move the tokens in the joined result
+} LexerChunk;
+
+/**
+ * Converts a position relative to a chunk into a position in the text
+ * 
+ * @param c The chunk
+ * @param pos The relative position
+ * 
+ * @return The position in the text
+ */
+Position chunk_to_text_pos(const LexerChunk* c, Position pos)
+{
+    if (pos.row == 1)
+        return (Position) { c->base.row, c->base.col + pos.col };
+    return (Position) { c->base.row + pos.row - 1, pos.col };
+}
+
+/**
+ * Analyzes a chunk of the text
+ * 
+ * @param arg The chunk
+ * 
+ * @return ```NULL```
+ */
+void* tokenize_chunk(void* arg)
+{
+    LexerChunk* c = (LexerChunk*) arg;
+    c->res = tokenize(&c->l);
+    return NULL;
+}
+
+/**
+ * Moves the tokens of a chunk into the joined result, fixing their positions
+ * 
+ * @param arg The chunk
+ * 
+ * @return ```NULL```
+ */
+void* move_chunk_tokens(void* arg)
+{
+    LexerChunk* c = (LexerChunk*) arg;
+    for (int k = 0; k < c->res.size; k++)
+    {
+        Token* t = (Token*) c->res.tokens[k];
+        t->pos = chunk_to_text_pos(c, t->pos);
+        c->dest[k] = t;
+    }
+    return NULL;
+}
+
+/**
+ * Runs a function over every chunk, the first one on the calling thread
+ * 
+ * @param chunks The chunks
+ * @param n_chunks The number of chunks
+ * @param fn The function
+ */
+void run_on_chunks(LexerChunk* chunks, int n_chunks, void* (*fn)(void*))
+{
+    pthread_t* threads = (pthread_t*) malloc(n_chunks * sizeof(pthread_t));
+    for (int k = 1; k < n_chunks; k++)
+        pthread_create(&threads[k], NULL, fn, &chunks[k]);
+    fn(&chunks[0]);
+    for (int k = 1; k < n_chunks; k++)
+        pthread_join(threads[k], NULL);
+    free(threads);
+}
+
 
 // Public functions
 
@@ -36,6 +196,7 @@ Lexer new_lexer(const char* text)
     Lexer l = { 
         .text = text, 
         .pos = -1, 
+        .end = strlen(text), 
         .row = 1, 
         .col = 0, 
         .current = '\0', 
@@ -44,10 +205,24 @@ Lexer new_lexer(const char* text)
     return l;
 }
 
+Lexer new_sub_lexer(const char* text, int start, int end, Position pos)
+{
+    Lexer l = { 
+        .text = text, 
+        .pos = start - 1, 
+        .end = end, 
+        .row = pos.row, 
+        .col = pos.col - 1, 
+        .current = '\0', 
+    };
+    advance_lexer(&l);
+    return l;
+}
+
 LexerResult new_lexer_result(Lexer l)
 {
     LexerResult r;
-    int size = strlen(l.text);
+    int size = l.end - l.pos;
     r.tokens = (const Token**) calloc(size, sizeof(const Token*));
     r.current = 0;
     r.size = size;
@@ -85,7 +260,7 @@ void advance_lexer(Lexer* l)
     }
     (l->col)++;
 
-    l->current = l->text[l->pos];
+    l->current = (l->pos < l->end) ? l->text[l->pos] : '\0';
 }
 
 Position get_current_pos(const Lexer* l)
@@ -95,35 +270,74 @@ Position get_current_pos(const Lexer* l)
 
 const Token* get_number(Lexer* l)
 {
-    char value[16];
-    int dot_count = 0, i;
+    // Literals of any length are copied straight from the text
+    int start = l->pos, dot_count = 0;
 
-    for (i = 0; is_digit(l->current) || l->current == '.'; i++)
+    while (is_digit(l->current) || l->current == '.')
     {
-        value[i] = '\0';
-
         if (l->current == '.')
             dot_count++;
-
-        value[i] = l->current;
         advance_lexer(l);
     }
 
-    value[i] = '\0';
-    
+    const char* value = l->text + start;
+    size_t len = l->pos - start;
+
     switch (dot_count)
     {
     case 0:
-        return new_token(get_current_pos(l), TT_INT, value);
+        return new_token_len(get_current_pos(l), TT_INT, value, len);
 
     case 1:
-        return new_token(get_current_pos(l), TT_FLT, value);
+        return new_token_len(get_current_pos(l), TT_FLT, value, len);
     
     default:
         return NULL;
     }
 }
 
+const Token* get_identifier(Lexer* l)
+{
+    char value[MAX_TOK_VAL_LEN];
+    Position pos = get_current_pos(l);
+    int i;
+
+    for (i = 0; is_name_char(l->current); i++)
+    {
+        // Name too long to be stored in a token
+        if (i == MAX_TOK_VAL_LEN - 1)
+            return NULL;
+
+        value[i] = l->current;
+        advance_lexer(l);
+    }
+
+    value[i] = '\0';
+
+    for (size_t k = 0; k < sizeof(WordOperators) / sizeof(WordOperators[0]); k++)
+    {
+        if (strcmp(value, WordOperators[k].name) == 0)
+            return new_token(pos, WordOperators[k].type, value);
+    }
+    for (size_t k = 0; k < sizeof(Keywords) / sizeof(Keywords[0]); k++)
+    {
+        if (strcmp(value, Keywords[k]) == 0)
+            return new_token(pos, TT_KEY, value);
+    }
+    return new_token(pos, TT_IDN, value);
+}
+
+const Token* get_comparison(Lexer* l, TokenType single, TokenType with_equals)
+{
+    Position pos = get_current_pos(l);
+    advance_lexer(l);
+    if (l->current != '=')
+        return new_token(pos, single, NULL);
+
+    advance_lexer(l);
+    return new_token(pos, with_equals, NULL);
+}
+
 LexerResult tokenize(Lexer* l)
 {
     LexerResult res = new_lexer_result(*l);
@@ -132,9 +346,10 @@ LexerResult tokenize(Lexer* l)
     {
         switch (l->current)
         {
-        // Ignore whitespace
+        // Ignore whitespace, including the '\r' of CRLF line endings
         case ' ':
         case '\t':
+        case '\r':
         // Update row and column on newline
         case '\n':
             advance_lexer(l);
@@ -172,6 +387,35 @@ LexerResult tokenize(Lexer* l)
             advance_lexer(l);
             break;
 
+        case '=':
+            append_token_to_result(&res, get_comparison(l, TT_ASG, TT_EQ));
+            break;
+
+        // Comparison operators
+
+        case '<':
+            append_token_to_result(&res, get_comparison(l, TT_LT, TT_LE));
+            break;
+
+        case '>':
+            append_token_to_result(&res, get_comparison(l, TT_GT, TT_GE));
+            break;
+
+        case '!':
+            // '!' is only valid as part of '!='
+            if (l->pos + 1 >= l->end || l->text[l->pos + 1] != '=')
+            {
+                free_lexer_result(&res);
+                res.err = new_char_error(
+                    ERR_INVALID_CHAR,
+                    get_current_pos(l),
+                    l->current
+                );
+                return res;
+            }
+            append_token_to_result(&res, get_comparison(l, TT_NE, TT_NE));
+            break;
+
         case '(':
             append_token_to_result(&res, new_token(get_current_pos(l), TT_LPA, NULL));
             advance_lexer(l);
@@ -182,6 +426,16 @@ LexerResult tokenize(Lexer* l)
             advance_lexer(l);
             break;
 
+        case ',':
+            append_token_to_result(&res, new_token(get_current_pos(l), TT_COM, NULL));
+            advance_lexer(l);
+            break;
+
+        case ';':
+            append_token_to_result(&res, new_token(get_current_pos(l), TT_SEM, NULL));
+            advance_lexer(l);
+            break;
+
         // Complex tokens
         default:
 
@@ -195,9 +449,24 @@ LexerResult tokenize(Lexer* l)
                 {
                     free_lexer_result(&res);
                     res.err = new_error(
-                        IllegalCharError,
-                        get_current_pos(l),
-                        "Not a valid number format"
+                        ERR_INVALID_NUMBER,
+                        get_current_pos(l)
+                    );
+                    return res;
+                }
+                append_token_to_result(&res, t);
+            }
+
+            // Names
+            else if (is_name_start(l->current))
+            {
+                const Token* t = get_identifier(l);
+                if (!t)
+                {
+                    free_lexer_result(&res);
+                    res.err = new_error(
+                        ERR_INVALID_IDENTIFIER,
+                        get_current_pos(l)
                     );
                     return res;
                 }
@@ -207,13 +476,11 @@ LexerResult tokenize(Lexer* l)
             // Illegal character
             else
             {
-                char details[MAX_ERR_DET_LEN];
-                sprintf(details, "Invalid character '%c'", l->current);
                 free_lexer_result(&res);
-                res.err = new_error(
-                    IllegalCharError,
+                res.err = new_char_error(
+                    ERR_INVALID_CHAR,
                     get_current_pos(l),
-                    details
+                    l->current
                 );
                 return res;
             }
@@ -225,3 +492,94 @@ LexerResult tokenize(Lexer* l)
     trim_lexer_result(&res);
     return res;
 }
+
+LexerResult tokenize_parallel(Lexer* l, int n_threads)
+{
+    int start = l->pos;
+    int length = l->end - start;
+    int n_chunks = length / LEX_MIN_CHUNK;
+    if (n_chunks > n_threads)
+        n_chunks = n_threads;
+    if (n_chunks <= 1)
+        return tokenize(l);
+
+    // Each chunk ends before a character that cannot continue a token, so
+    // every token lies within one chunk
+    LexerChunk* chunks = (LexerChunk*) malloc(n_chunks * sizeof(LexerChunk));
+    int chunk_start = start;
+    for (int k = 0; k < n_chunks; k++)
+    {
+        int chunk_end = l->end;
+        if (k < n_chunks - 1)
+        {
+            chunk_end = start + (int) ((long) length * (k + 1) / n_chunks);
+            if (chunk_end < chunk_start)
+                chunk_end = chunk_start;
+            while (chunk_end < l->end && !is_token_boundary(l->text[chunk_end]))
+                chunk_end++;
+        }
+
+        chunks[k].l = new_sub_lexer(l->text, chunk_start, chunk_end, (Position) { 1, 1 });
+        chunk_start = chunk_end;
+    }
+
+    run_on_chunks(chunks, n_chunks, tokenize_chunk);
+
+    // Chunks are placed after the previous one ends. The first failed
+    // chunk holds the error a sequential analysis would stop at
+    int n_tokens = 0, failed = -1;
+    chunks[0].base = (Position) { l->row, l->col - 1 };
+    for (int k = 0; k < n_chunks; k++)
+    {
+        if (k > 0)
+        {
+            Position end = chunk_to_text_pos(&chunks[k - 1], get_current_pos(&chunks[k - 1].l));
+            chunks[k].base = (Position) { end.row, end.col - 1 };
+        }
+        if (chunks[k].res.tokens == NULL && chunks[k].res.size != 0)
+        {
+            failed = k;
+            break;
+        }
+        n_tokens += chunks[k].res.size;
+    }
+
+    LexerResult res;
+    if (failed >= 0)
+    {
+        res = chunks[failed].res;
+        res.err.pos = chunk_to_text_pos(&chunks[failed], res.err.pos);
+        for (int k = 0; k < n_chunks; k++)
+        {
+            if (k != failed && chunks[k].res.tokens)
+                free_lexer_result(&chunks[k].res);
+        }
+    }
+    else
+    {
+        res.tokens = (const Token**) malloc(n_tokens * sizeof(const Token*));
+        res.current = n_tokens;
+        res.size = n_tokens;
+
+        int offset = 0;
+        for (int k = 0; k < n_chunks; k++)
+        {
+            chunks[k].dest = res.tokens + offset;
+            offset += chunks[k].res.size;
+        }
+        run_on_chunks(chunks, n_chunks, move_chunk_tokens);
+
+        for (int k = 0; k < n_chunks; k++)
+            free(chunks[k].res.tokens);
+    }
+
+    // The lexer ends where a sequential analysis would have stopped
+    LexerChunk* last = &chunks[(failed >= 0) ? failed : n_chunks - 1];
+    Position pos = chunk_to_text_pos(last, get_current_pos(&last->l));
+    *l = last->l;
+    l->end = chunks[n_chunks - 1].l.end;
+    l->row = pos.row;
+    l->col = pos.col;
+    free(chunks);
+    return res;
+}
@@ -5,6 +5,11 @@
 
 // ----- LEXER -----
 
+// Smallest chunk of text (in characters) lexed by a separate thread
+#ifndef LEX_MIN_CHUNK
+#define LEX_MIN_CHUNK (1 << 20)
+#endif
+
 /**
  * Contains information for the lexical analysis of a text
  */
@@ -12,6 +17,7 @@ typedef struct lexer
 {
     const char* text;
     int pos;
+    int end;            // Position where the analysis stops
     int row;
     int col;
     char current;
@@ -37,6 +43,18 @@ typedef struct lexer_result
  */
 Lexer new_lexer(const char* text);
 
+/**
+ * Creates and initializes a lexer with part of a text
+ * 
+ * @param text The text, which does not need to be null-terminated
+ * @param start The position of the first character to analyze
+ * @param end The position after the last character to analyze
+ * @param pos The row and column of the first character
+ * 
+ * @return The new lexer
+ */
+Lexer new_sub_lexer(const char* text, int start, int end, Position pos);
+
 /**
  * Reserves memory for a lexer result for a given lexer
  * 
@@ -97,6 +115,28 @@ Position get_current_pos(const Lexer* l);
  */
 const Token* get_number(Lexer* l);
 
+/**
+ * Obtains an identifier or keyword token starting from the current position
+ * of the text
+ * 
+ * @param l The lexer
+ * 
+ * @return The token on success, or ```NULL``` in case of error
+ */
+const Token* get_identifier(Lexer* l);
+
+/**
+ * Obtains a comparison or assignment token starting from the current
+ * position of the text, which may be followed by ```'='```
+ * 
+ * @param l The lexer
+ * @param single The token type of the character alone
+ * @param with_equals The token type of the character followed by ```'='```
+ * 
+ * @return The token
+ */
+const Token* get_comparison(Lexer* l, TokenType single, TokenType with_equals);
+
 /**
  * Performs a lexical analysis of the lexer's text
  * 
@@ -110,4 +150,20 @@ const Token* get_number(Lexer* l);
  */
 LexerResult tokenize(Lexer* l);
 
+/**
+ * Performs a lexical analysis of the lexer's text on several threads.
+ * The text is split into chunks at characters that cannot continue a
+ * token, each chunk is analyzed separately and the tokens are joined
+ * with their positions in the whole text
+ * 
+ * @param l The lexer
+ * @param n_threads The maximum number of threads, including the caller
+ * 
+ * @return The same result as ```tokenize```, including the first error
+ * 
+ * @note Texts shorter than ```LEX_MIN_CHUNK``` per thread use fewer threads
+ * @note Remember to call ```free_lexer_result()``` afterwards
+ */
+LexerResult tokenize_parallel(Lexer* l, int n_threads);
+
 #endif  // LEXER_H
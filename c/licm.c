@@ -0,0 +1,284 @@
+#include "licm.h"
+
+// ----- LOOP-INVARIANT CODE MOTION -----
+
+/**
+ * Contains the state of the hoisting of a loop
+ */
+typedef struct hoister
+{
+    int* assigned;          // Slots assigned in the loop
+    int n_assigned;
+    int* n_invariants;      // Number of invariants of the loop
+} Hoister;
+
+// Auxiliary functions
+
+/**
+ * Checks whether a variable is assigned in the loop
+ *
+ * @param h The hoister
+ * @param slot The slot of the variable
+ *
+ * @return Boolean-like value
+ */
+int is_assigned(const Hoister* h, int slot)
+{
+    for (int k = 0; k < h->n_assigned; k++)
+    {
+        if (h->assigned[k] == slot)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * Adds a variable to the ones assigned in the loop
+ *
+ * @param h The hoister
+ * @param slot The slot of the variable
+ */
+void add_assigned(Hoister* h, int slot)
+{
+    if (is_assigned(h, slot))
+        return;
+
+    h->assigned = (int*) realloc(h->assigned, (h->n_assigned + 1) * sizeof(int));
+    h->assigned[h->n_assigned++] = slot;
+}
+
+/**
+ * Collects the variables assigned in a node and its children
+ *
+ * @param h The hoister
+ * @param node The node
+ */
+void collect_assigned(Hoister* h, const ASTNode* node)
+{
+    const NodeData* data = &node->data;
+    switch (node->class)
+    {
+    case UnOp:
+        collect_assigned(h, data->unary.value);
+        break;
+
+    case BinOp:
+        collect_assigned(h, data->binary.left);
+        collect_assigned(h, data->binary.right);
+        break;
+
+    case VarAssign:
+        add_assigned(h, data->assign.slot);
+        collect_assigned(h, data->assign.value);
+        break;
+
+    case Convert:
+        collect_assigned(h, data->convert.value);
+        break;
+
+    case Call:
+        for (int k = 0; k < data->call.n_args; k++)
+            collect_assigned(h, data->call.args[k]);
+        break;
+
+    case Sequence:
+        for (int k = 0; k < data->sequence.count; k++)
+            collect_assigned(h, data->sequence.items[k]);
+        break;
+
+    case Logic:
+        collect_assigned(h, data->logic.left);
+        collect_assigned(h, data->logic.right);
+        break;
+
+    case Cond:
+        collect_assigned(h, data->cond.cond);
+        collect_assigned(h, data->cond.if_true);
+        collect_assigned(h, data->cond.if_false);
+        break;
+
+    case While:
+        collect_assigned(h, data->loop.cond);
+        collect_assigned(h, data->loop.body);
+        break;
+
+    case For:
+        add_assigned(h, data->range.slot);
+        collect_assigned(h, data->range.start);
+        collect_assigned(h, data->range.end);
+        collect_assigned(h, data->range.body);
+        break;
+
+    case Invariant:
+        collect_assigned(h, data->invariant.value);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/**
+ * Checks whether the value of a node is the same in every iteration of
+ * the loop
+ *
+ * @param h The hoister
+ * @param node The node
+ *
+ * @return Boolean-like value
+ */
+int is_invariant(const Hoister* h, const ASTNode* node)
+{
+    const NodeData* data = &node->data;
+    switch (node->class)
+    {
+    case Number:
+        return 1;
+
+    case VarAccess:
+        return !is_assigned(h, data->access.slot);
+
+    case UnOp:
+        return is_invariant(h, data->unary.value);
+
+    case BinOp:
+        return is_invariant(h, data->binary.left)
+            && is_invariant(h, data->binary.right);
+
+    case Convert:
+        return is_invariant(h, data->convert.value);
+
+    case Call:
+        for (int k = 0; k < data->call.n_args; k++)
+        {
+            if (!is_invariant(h, data->call.args[k]))
+                return 0;
+        }
+        return 1;
+
+    case Sequence:
+        for (int k = 0; k < data->sequence.count; k++)
+        {
+            if (!is_invariant(h, data->sequence.items[k]))
+                return 0;
+        }
+        return 1;
+
+    case Logic:
+        return is_invariant(h, data->logic.left)
+            && is_invariant(h, data->logic.right);
+
+    case Cond:
+        return is_invariant(h, data->cond.cond)
+            && is_invariant(h, data->cond.if_true)
+            && is_invariant(h, data->cond.if_false);
+
+    default:
+        // Assignments, loops and the invariants of nested loops
+        return 0;
+    }
+}
+
+/**
+ * Replaces the largest invariant subexpressions of a node with
+ * ```Invariant``` nodes
+ *
+ * @param h The hoister
+ * @param node The node, which may be replaced
+ * @param level The number of loops between the node and the hoisted loop
+ */
+void hoist_node(Hoister* h, ASTNode** node, int level)
+{
+    NodeData* data = &(*node)->data;
+    if (is_invariant(h, *node))
+    {
+        // Literals and variables are as cheap as a cached value
+        if ((*node)->class != Number && (*node)->class != VarAccess)
+            *node = new_invariant_node(*node, level, (*h->n_invariants)++);
+        return;
+    }
+
+    switch ((*node)->class)
+    {
+    case UnOp:
+        hoist_node(h, &data->unary.value, level);
+        break;
+
+    case BinOp:
+        hoist_node(h, &data->binary.left, level);
+        hoist_node(h, &data->binary.right, level);
+        break;
+
+    case VarAssign:
+        hoist_node(h, &data->assign.value, level);
+        break;
+
+    case Convert:
+        hoist_node(h, &data->convert.value, level);
+        break;
+
+    case Call:
+        for (int k = 0; k < data->call.n_args; k++)
+            hoist_node(h, &data->call.args[k], level);
+        break;
+
+    case Sequence:
+        for (int k = 0; k < data->sequence.count; k++)
+            hoist_node(h, &data->sequence.items[k], level);
+        break;
+
+    case Logic:
+        hoist_node(h, &data->logic.left, level);
+        hoist_node(h, &data->logic.right, level);
+        break;
+
+    case Cond:
+        hoist_node(h, &data->cond.cond, level);
+        hoist_node(h, &data->cond.if_true, level);
+        hoist_node(h, &data->cond.if_false, level);
+        break;
+
+    // Nested loops are run with their own invariants
+    case While:
+        hoist_node(h, &data->loop.cond, level + 1);
+        hoist_node(h, &data->loop.body, level + 1);
+        break;
+
+    case For:
+        hoist_node(h, &data->range.start, level);
+        hoist_node(h, &data->range.end, level);
+        hoist_node(h, &data->range.body, level + 1);
+        break;
+
+    case Invariant:
+        hoist_node(h, &data->invariant.value, level);
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+// Public functions
+
+void hoist_invariants(ASTNode* loop)
+{
+    Hoister h = { .assigned = NULL, .n_assigned = 0 };
+    collect_assigned(&h, loop);
+
+    if (loop->class == While)
+    {
+        h.n_invariants = &loop->data.loop.n_invariants;
+        hoist_node(&h, &loop->data.loop.cond, 0);
+        hoist_node(&h, &loop->data.loop.body, 0);
+    }
+    else
+    {
+        // The bounds of a for loop are evaluated once
+        h.n_invariants = &loop->data.range.n_invariants;
+        hoist_node(&h, &loop->data.range.body, 0);
+    }
+
+    free(h.assigned);
+}
@@ -0,0 +1,25 @@
+#ifndef LICM_H
+#define LICM_H
+
+#include "base.h"
+
+// ----- LOOP-INVARIANT CODE MOTION -----
+
+/**
+ * Hoists the subexpressions of a typed loop whose value does not change
+ * between iterations: each one is wrapped in an ```Invariant``` node,
+ * which is evaluated once per run of the loop instead of once per
+ * iteration.
+ *
+ * A subexpression is invariant when it reads no variable assigned in the
+ * loop. Nothing else can change its value, since functions only see
+ * their parameters and locals. Invariants are evaluated the first time
+ * they are reached, so a hoisted subexpression never fails or does work
+ * that the loop would not have done
+ *
+ * @param loop The ```While``` or ```For``` node, whose nested loops have
+ * already been processed
+ */
+void hoist_invariants(ASTNode* loop);
+
+#endif  // LICM_H
@@ -0,0 +1,820 @@
+#include "numconv.h"
+#include "numconv_tables.h"
+
+// ----- NUMERIC CONVERSIONS -----
+
+// Double layout
+#define DBL_SIGNIFICAND_BITS 52
+#define DBL_HIDDEN_BIT (1ull << DBL_SIGNIFICAND_BITS)
+#define DBL_SIGNIFICAND_MASK (DBL_HIDDEN_BIT - 1)
+#define DBL_EXPONENT_BIAS (0x3FF + DBL_SIGNIFICAND_BITS)
+#define DBL_INFINITY_BITS 0x7FF0000000000000ull
+
+// Limbs of the exact integers, enough for a double or a 17-digit
+// significand times any power of 5 and of 2 their comparisons need
+#define EXACT_LIMBS 40
+
+/**
+ * Two-digit strings for every number in ```[0, 100)```
+ */
+const char DigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * Powers of ten that fit in 64 bits
+ */
+const uint64_t Pow10Int[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+    10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+    100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+    100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+/**
+ * Powers of ten that are exactly representable as doubles
+ */
+const double Pow10Exact[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+
+// Auxiliary functions (formatting)
+
+/**
+ * Floating point value with a 64-bit significand: ```f * 2^e```
+ */
+typedef struct diy_fp
+{
+    uint64_t f;
+    int e;
+} DiyFp;
+
+/**
+ * Decomposes a finite, positive double
+ */
+DiyFp diyfp_from_double(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    int biased = (int) ((bits >> DBL_SIGNIFICAND_BITS) & 0x7FF);
+    uint64_t significand = bits & DBL_SIGNIFICAND_MASK;
+
+    // Subnormals have no hidden bit
+    if (biased)
+        return (DiyFp) { significand + DBL_HIDDEN_BIT, biased - DBL_EXPONENT_BIAS };
+    return (DiyFp) { significand, 1 - DBL_EXPONENT_BIAS };
+}
+
+/**
+ * Shifts a value so that the most significant bit of its significand is set
+ */
+DiyFp diyfp_normalize(DiyFp x)
+{
+    int shift = __builtin_clzll(x.f);
+    return (DiyFp) { x.f << shift, x.e - shift };
+}
+
+/**
+ * Multiplies two values, rounding the result to 64 bits
+ */
+DiyFp diyfp_mul(DiyFp x, DiyFp y)
+{
+    unsigned __int128 p = (unsigned __int128) x.f * y.f;
+    uint64_t h = (uint64_t) (p >> 64), l = (uint64_t) p;
+    return (DiyFp) { h + (l >> 63), x.e + y.e + 64 };
+}
+
+/**
+ * Obtains the boundaries of the rounding interval of a value, both
+ * normalized to the exponent of the upper one
+ */
+void diyfp_boundaries(DiyFp v, DiyFp* minus, DiyFp* plus)
+{
+    *plus = diyfp_normalize((DiyFp) { (v.f << 1) + 1, v.e - 1 });
+
+    // The interval is asymmetric right above a power of two
+    if (v.f == DBL_HIDDEN_BIT)
+        *minus = (DiyFp) { (v.f << 2) - 1, v.e - 2 };
+    else
+        *minus = (DiyFp) { (v.f << 1) - 1, v.e - 1 };
+
+    minus->f <<= minus->e - plus->e;
+    minus->e = plus->e;
+}
+
+/**
+ * Obtains a cached power of ten ```c = 10^-K``` so that the exponent of
+ * ```c * 2^e``` falls in ```[-60, -32]```
+ */
+DiyFp cached_power(int e, int* K)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int) dk;
+    if (dk - k > 0.0)
+        k++;
+
+    unsigned index = (unsigned) ((k >> 3) + 1);
+    *K = -(CACHED_POWERS_MIN_EXP + (int) index * CACHED_POWERS_STEP);
+    return (DiyFp) { CachedPowers[index].f, CachedPowers[index].e };
+}
+
+/**
+ * Moves the last generated digit towards the exact value while the
+ * result stays inside the rounding interval
+ */
+void grisu_round(char* digits, int len, uint64_t delta, uint64_t rest,
+                 uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa
+           && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        digits[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+/**
+ * Counts the decimal digits of a 32-bit number
+ */
+int count_digits(uint32_t n)
+{
+    int count = 1;
+    while (count < 10 && n >= Pow10Int[count])
+        count++;
+    return count;
+}
+
+/**
+ * Generates the shortest digits inside ```[Mp - delta, Mp]```
+ */
+void grisu_digits(DiyFp W, DiyFp Mp, uint64_t delta, char* digits, int* len, int* K)
+{
+    DiyFp one = { 1ull << -Mp.e, Mp.e };
+    uint64_t wp_w = Mp.f - W.f;
+    uint32_t p1 = (uint32_t) (Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = count_digits(p1);
+    *len = 0;
+
+    // Integral part
+    while (kappa > 0)
+    {
+        uint32_t d = p1 / (uint32_t) Pow10Int[kappa - 1];
+        p1 %= (uint32_t) Pow10Int[kappa - 1];
+        if (d || *len)
+            digits[(*len)++] = (char) ('0' + d);
+        kappa--;
+
+        uint64_t rest = ((uint64_t) p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *K += kappa;
+            grisu_round(digits, *len, delta, rest, Pow10Int[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    // Fractional part
+    while (1)
+    {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char) (p2 >> -one.e);
+        if (d || *len)
+            digits[(*len)++] = (char) ('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+
+        if (p2 < delta)
+        {
+            *K += kappa;
+            grisu_round(digits, *len, delta, p2, one.f,
+                        wp_w * (-kappa < 20 ? Pow10Int[-kappa] : 0));
+            return;
+        }
+    }
+}
+
+/**
+ * Obtains the shortest digits of a finite, positive double so that
+ * ```value = digits * 10^K```
+ */
+void grisu2(double value, char* digits, int* len, int* K)
+{
+    DiyFp v = diyfp_from_double(value);
+    DiyFp minus, plus;
+    diyfp_boundaries(v, &minus, &plus);
+
+    DiyFp c_mk = cached_power(plus.e, K);
+    DiyFp W = diyfp_mul(diyfp_normalize(v), c_mk);
+    DiyFp Wp = diyfp_mul(plus, c_mk);
+    DiyFp Wm = diyfp_mul(minus, c_mk);
+
+    // Stay on the safe side of the rounding errors of the products
+    Wm.f++;
+    Wp.f--;
+    grisu_digits(W, Wp, Wp.f - Wm.f, digits, len, K);
+}
+
+
+// Auxiliary functions (parsing)
+
+/**
+ * Converts a decimal significand and exponent into the bits of the nearest
+ * double (Eisel-Lemire), without any fallback
+ *
+ * @param q The decimal exponent
+ * @param w The decimal significand, with at most 19 digits
+ *
+ * @return The bits of the double
+ */
+uint64_t eisel_lemire(int64_t q, uint64_t w)
+{
+    if (w == 0 || q < POW5_MIN_EXP)
+        return 0;
+    if (q > POW5_MAX_EXP)
+        return DBL_INFINITY_BITS;
+
+    int lz = __builtin_clzll(w);
+    w <<= lz;
+
+    // 128-bit approximation of w * 5^q
+    const uint64_t* pow5 = Pow5Table[q - POW5_MIN_EXP];
+    unsigned __int128 first = (unsigned __int128) w * pow5[0];
+    uint64_t hi = (uint64_t) (first >> 64), lo = (uint64_t) first;
+    if ((hi & 0x1FF) == 0x1FF)
+    {
+        uint64_t second = (uint64_t) (((unsigned __int128) w * pow5[1]) >> 64);
+        lo += second;
+        if (second > lo)
+            hi++;
+    }
+
+    int upper = (int) (hi >> 63);
+    int shift = upper + 64 - DBL_SIGNIFICAND_BITS - 3;
+    uint64_t mantissa = hi >> shift;
+    int64_t power2 = (((152170 + 65536) * q) >> 16) + 63 + upper - lz + 1023;
+
+    // Subnormal
+    if (power2 <= 0)
+    {
+        if (-power2 + 1 >= 64)
+            return 0;
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = (mantissa < DBL_HIDDEN_BIT) ? 0 : 1;
+        return mantissa | ((uint64_t) power2 << DBL_SIGNIFICAND_BITS);
+    }
+
+    // Exact halfway cases round to even
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1
+        && (mantissa << shift) == hi)
+        mantissa &= ~1ull;
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (DBL_HIDDEN_BIT << 1))
+    {
+        mantissa = DBL_HIDDEN_BIT;
+        power2++;
+    }
+    mantissa &= ~DBL_HIDDEN_BIT;
+
+    if (power2 >= 0x7FF)
+        return DBL_INFINITY_BITS;
+    return mantissa | ((uint64_t) power2 << DBL_SIGNIFICAND_BITS);
+}
+
+/**
+ * Contains a nonnegative integer, least significant limb first, for the
+ * rare exact comparisons of the formatting
+ */
+typedef struct exact
+{
+    uint32_t limbs[EXACT_LIMBS];
+    int n;                          // Number of limbs in use, without leading zeros
+} Exact;
+
+/**
+ * Sets an exact integer to a 64-bit value
+ */
+void exact_from_u64(Exact* x, uint64_t value)
+{
+    x->limbs[0] = (uint32_t) value;
+    x->limbs[1] = (uint32_t) (value >> 32);
+    x->n = (value >> 32) ? 2 : (value != 0);
+}
+
+/**
+ * Multiplies an exact integer by a 32-bit factor
+ */
+void exact_mul_small(Exact* x, uint32_t factor)
+{
+    uint64_t carry = 0;
+    for (int i = 0; i < x->n; i++)
+    {
+        uint64_t p = (uint64_t) x->limbs[i] * factor + carry;
+        x->limbs[i] = (uint32_t) p;
+        carry = p >> 32;
+    }
+    if (carry)
+        x->limbs[x->n++] = (uint32_t) carry;
+}
+
+/**
+ * Multiplies an exact integer by ```5^q```, for ```q >= 0```
+ */
+void exact_mul_pow5(Exact* x, int q)
+{
+    // 5^13 is the largest power of 5 that fits in 32 bits
+    for (; q >= 13; q -= 13)
+        exact_mul_small(x, 1220703125u);
+    uint32_t factor = 1;
+    for (; q > 0; q--)
+        factor *= 5;
+    exact_mul_small(x, factor);
+}
+
+/**
+ * Multiplies an exact integer by ```2^bits```, for ```bits >= 0```
+ */
+void exact_shift(Exact* x, int bits)
+{
+    if (x->n == 0)
+        return;
+
+    int words = bits / 32, rest = bits % 32;
+    uint32_t top = rest ? x->limbs[x->n - 1] >> (32 - rest) : 0;
+    for (int i = x->n - 1; i > 0; i--)
+        x->limbs[i + words] = (x->limbs[i] << rest) | (rest ? x->limbs[i - 1] >> (32 - rest) : 0);
+    x->limbs[words] = x->limbs[0] << rest;
+    memset(x->limbs, 0, words * sizeof(uint32_t));
+    x->n += words;
+    if (top)
+        x->limbs[x->n++] = top;
+}
+
+/**
+ * Compares two exact integers
+ *
+ * @return A negative number, 0 or a positive number if the first one is
+ * smaller, equal or greater
+ */
+int exact_compare(const Exact* x, const Exact* y)
+{
+    if (x->n != y->n)
+        return (x->n > y->n) ? 1 : -1;
+    for (int i = x->n - 1; i >= 0; i--)
+        if (x->limbs[i] != y->limbs[i])
+            return (x->limbs[i] > y->limbs[i]) ? 1 : -1;
+    return 0;
+}
+
+/**
+ * Rewrites the digits of a result, without trailing zeros
+ *
+ * @param c The new decimal significand
+ * @param exp The decimal exponent of the significand
+ * @param digits Where to write the digits
+ * @param len Where to store their number
+ * @param K Where to store their decimal exponent
+ */
+void set_digits(uint64_t c, int exp, char* digits, int* len, int* K)
+{
+    while (c % 10 == 0)
+    {
+        c /= 10;
+        exp++;
+    }
+    char tmp[20];
+    int n = 0;
+    for (; c; c /= 10)
+        tmp[n++] = (char) ('0' + c % 10);
+    for (int j = 0; j < n; j++)
+        digits[j] = tmp[n - 1 - j];
+    *len = n;
+    *K = exp;
+}
+
+/**
+ * Drops the last digit of a Grisu2 result while the shorter digits still
+ * parse back to the same value
+ *
+ * @note Grisu2 misses the shortest output for about 0.1% of the doubles,
+ * all of them with 16 or 17 digits
+ */
+void shorten_digits(double value, char* digits, int* len, int* K)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    while (*len >= 16)
+    {
+        uint64_t w = 0;
+        for (int i = 0; i < *len - 1; i++)
+            w = w * 10 + (uint64_t) (digits[i] - '0');
+
+        // Try the nearest candidate first
+        uint64_t candidates[2] = { w, w + 1 };
+        if (digits[*len - 1] >= '5')
+        {
+            candidates[0] = w + 1;
+            candidates[1] = w;
+        }
+
+        int i;
+        for (i = 0; i < 2 && eisel_lemire(*K + 1, candidates[i]) != bits; i++)
+            ;
+        if (i == 2)
+            return;
+
+        set_digits(candidates[i], *K + 1, digits, len, K);
+    }
+}
+
+/**
+ * Approximates ```v * 10^-K``` as a fixed point number with 64 fractional
+ * bits, off by less than 4 in its last bit
+ *
+ * @return Boolean-like value, false if ```5^-K``` is not tabulated
+ */
+int scale_fixed(DiyFp v, int K, unsigned __int128* t)
+{
+    int q = -K;
+    if (q < POW5_MIN_EXP || q > POW5_MAX_EXP)
+        return 0;
+
+    // The top 128 bits of v * 5^q, whose binary exponent gives the shift
+    v = diyfp_normalize(v);
+    const uint64_t* pow5 = Pow5Table[q - POW5_MIN_EXP];
+    unsigned __int128 high = (unsigned __int128) v.f * pow5[0]
+        + (uint64_t) (((unsigned __int128) v.f * pow5[1]) >> 64);
+    int shift = -(v.e + (int) (((152170 + 65536) * (int64_t) q) >> 16) + 1);
+    if (shift < 1 || shift > 63)
+        return 0;
+
+    *t = high >> shift;
+    return 1;
+}
+
+/**
+ * Compares a value with the midpoint between two consecutive decimal
+ * significands, exactly
+ *
+ * @param v The value
+ * @param w The lower significand
+ * @param K The decimal exponent of the significands
+ *
+ * @return A negative number, 0 or a positive number if the value is below,
+ * at or above ```(w + 1/2) * 10^K```
+ */
+int compare_midpoint(DiyFp v, uint64_t w, int K)
+{
+    // 2v = v.f * 2^(v.e + 1) against (2w + 1) * 5^K * 2^K
+    Exact x, y;
+    exact_from_u64(&x, v.f);
+    exact_from_u64(&y, 2 * w + 1);
+    if (K >= 0)
+        exact_mul_pow5(&y, K);
+    else
+        exact_mul_pow5(&x, -K);
+    if (v.e + 1 >= K)
+        exact_shift(&x, v.e + 1 - K);
+    else
+        exact_shift(&y, K - v.e - 1);
+    return exact_compare(&x, &y);
+}
+
+/**
+ * Replaces a result of 16 or 17 digits by the significand of that length
+ * nearest to the value, ties to even, if it also parses back to the value
+ *
+ * @note Grisu2 returns some digits in the rounding interval of the value,
+ * not always the nearest ones, and the interval may hold several of them
+ * only when they have 16 or 17 digits
+ */
+void round_digits(double value, char* digits, int* len, int* K)
+{
+    if (*len < 16)
+        return;
+
+    uint64_t w = 0;
+    for (int i = 0; i < *len; i++)
+        w = w * 10 + (uint64_t) (digits[i] - '0');
+
+    // The approximation decides unless the value is almost at a midpoint
+    DiyFp v = diyfp_from_double(value);
+    unsigned __int128 t;
+    uint64_t nearest = w;
+    int decided = 0;
+    if (scale_fixed(v, *K, &t))
+    {
+        t += (unsigned __int128) 1 << 63;
+        nearest = (uint64_t) (t >> 64);
+        decided = (uint64_t) t >= 4 && (uint64_t) t <= UINT64_MAX - 4;
+    }
+
+    if (!decided)
+    {
+        while (compare_midpoint(v, nearest, *K) > 0)
+            nearest++;
+        while (compare_midpoint(v, nearest - 1, *K) < 0)
+            nearest--;
+        if ((nearest & 1) && compare_midpoint(v, nearest, *K) == 0)
+            nearest++;
+        else if ((nearest & 1) && compare_midpoint(v, nearest - 1, *K) == 0)
+            nearest--;
+    }
+
+    if (nearest == w)
+        return;
+
+    // Below a power of two the rounding interval is narrower, so the
+    // nearest digits may belong to the previous double
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (eisel_lemire(*K, nearest) == bits)
+        set_digits(nearest, *K, digits, len, K);
+}
+
+/**
+ * Parses a decimal number with ```strtod```, for the rare inputs with
+ * more than 19 significant digits
+ */
+double parse_double_slow(const char* str, size_t len)
+{
+    char local[64];
+    char* buf = (len < sizeof(local)) ? local : (char*) malloc(len + 1);
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+
+    double value = strtod(buf, NULL);
+
+    if (buf != local)
+        free(buf);
+    return value;
+}
+
+
+// Public functions
+
+size_t format_int(int64_t value, char* buf)
+{
+    char tmp[MAX_INT_STR_LEN];
+    char* p = tmp + sizeof(tmp);
+    uint64_t mag = (value < 0) ? -(uint64_t) value : (uint64_t) value;
+
+    // Two digits at a time, from the least significant ones
+    while (mag >= 100)
+    {
+        p -= 2;
+        memcpy(p, DigitPairs + 2 * (mag % 100), 2);
+        mag /= 100;
+    }
+    if (mag >= 10)
+    {
+        p -= 2;
+        memcpy(p, DigitPairs + 2 * mag, 2);
+    }
+    else
+        *--p = (char) ('0' + mag);
+
+    size_t len = 0;
+    if (value < 0)
+        buf[len++] = '-';
+    memcpy(buf + len, p, tmp + sizeof(tmp) - p);
+    len += tmp + sizeof(tmp) - p;
+    buf[len] = '\0';
+    return len;
+}
+
+size_t format_double(double value, char* buf)
+{
+    char* p = buf;
+
+    if (isnan(value))
+    {
+        strcpy(buf, "nan");
+        return 3;
+    }
+    if (signbit(value))
+    {
+        *p++ = '-';
+        value = -value;
+    }
+    if (isinf(value))
+    {
+        strcpy(p, "inf");
+        return p + 3 - buf;
+    }
+    if (value == 0.0)
+    {
+        strcpy(p, "0.0");
+        return p + 3 - buf;
+    }
+
+    char digits[20];
+    int len, K;
+    grisu2(value, digits, &len, &K);
+    shorten_digits(value, digits, &len, &K);
+    round_digits(value, digits, &len, &K);
+
+    // Position of the decimal point relative to the first digit
+    int point = len + K;
+
+    // Scientific notation
+    if (point - 1 < -4 || point - 1 >= 16)
+    {
+        *p++ = digits[0];
+        if (len > 1)
+        {
+            *p++ = '.';
+            memcpy(p, digits + 1, len - 1);
+            p += len - 1;
+        }
+
+        int exp = point - 1;
+        *p++ = 'e';
+        *p++ = (exp < 0) ? '-' : '+';
+        if (exp < 0)
+            exp = -exp;
+        if (exp >= 100)
+        {
+            *p++ = (char) ('0' + exp / 100);
+            exp %= 100;
+        }
+        memcpy(p, DigitPairs + 2 * exp, 2);
+        p += 2;
+    }
+
+    // 0.000ddd
+    else if (point <= 0)
+    {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -point);
+        p += -point;
+        memcpy(p, digits, len);
+        p += len;
+    }
+
+    // ddd000.0
+    else if (point >= len)
+    {
+        memcpy(p, digits, len);
+        p += len;
+        memset(p, '0', point - len);
+        p += point - len;
+        *p++ = '.';
+        *p++ = '0';
+    }
+
+    // ddd.ddd
+    else
+    {
+        memcpy(p, digits, point);
+        p += point;
+        *p++ = '.';
+        memcpy(p, digits + point, len - point);
+        p += len - point;
+    }
+
+    *p = '\0';
+    return p - buf;
+}
+
+int parse_int(const char* str, size_t len, int64_t* value)
+{
+    const char* p = str, *end = str + len;
+    int negative = 0;
+
+    if (p < end && (*p == '+' || *p == '-'))
+        negative = (*p++ == '-');
+    if (p == end)
+        return 0;
+
+    // Accumulate as a negative number to reach INT64_MIN
+    int64_t acc = 0;
+    for (; p < end; p++)
+    {
+        if (*p < '0' || *p > '9')
+            return 0;
+        if (__builtin_mul_overflow(acc, 10, &acc)
+            || __builtin_sub_overflow(acc, *p - '0', &acc))
+            return 0;
+    }
+
+    if (!negative)
+    {
+        if (acc == INT64_MIN)
+            return 0;
+        acc = -acc;
+    }
+    *value = acc;
+    return 1;
+}
+
+int parse_double(const char* str, size_t len, double* value)
+{
+    const char* p = str, *end = str + len;
+    int negative = 0, digits = 0, significant = 0, truncated = 0;
+    uint64_t w = 0;
+    int64_t q = 0;
+
+    if (p < end && (*p == '+' || *p == '-'))
+        negative = (*p++ == '-');
+
+    // Integral part
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+    {
+        if (significant < 19)
+        {
+            w = w * 10 + (uint64_t) (*p - '0');
+            significant += (w != 0);
+        }
+        else
+        {
+            q++;
+            truncated |= (*p != '0');
+        }
+    }
+
+    // Fractional part
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+        {
+            if (significant < 19)
+            {
+                w = w * 10 + (uint64_t) (*p - '0');
+                significant += (w != 0);
+                q--;
+            }
+            else
+                truncated |= (*p != '0');
+        }
+    }
+
+    if (digits == 0)
+        return 0;
+
+    // Exponent
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        int exp_negative = 0;
+        int64_t exp = 0;
+
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+            exp_negative = (*p++ == '-');
+        if (p == end)
+            return 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            if (exp < 100000)
+                exp = exp * 10 + (*p - '0');
+        }
+        q += exp_negative ? -exp : exp;
+    }
+
+    if (p != end)
+        return 0;
+
+    // Too many digits for the fast paths
+    if (truncated)
+    {
+        *value = parse_double_slow(str, len);
+        return 1;
+    }
+
+    double result;
+
+    // Exact operands: a single correctly rounded operation (Clinger)
+    if (w <= DBL_HIDDEN_BIT && q >= -22 && q <= 22)
+    {
+        result = (double) w;
+        result = (q < 0) ? result / Pow10Exact[-q] : result * Pow10Exact[q];
+    }
+    else
+    {
+        uint64_t bits = eisel_lemire(q, w);
+        memcpy(&result, &bits, sizeof(result));
+    }
+
+    *value = negative ? -result : result;
+    return 1;
+}
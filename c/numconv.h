@@ -0,0 +1,73 @@
+#ifndef NUMCONV_H
+#define NUMCONV_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+// ----- NUMERIC CONVERSIONS -----
+
+// Maximum length of a formatted integer, without the null terminator
+#define MAX_INT_STR_LEN 20
+
+// Maximum length of a formatted double, without the null terminator
+#define MAX_DBL_STR_LEN 24
+
+/**
+ * Writes the decimal representation of an integer to a buffer
+ *
+ * @param value The integer
+ * @param buf The buffer, with room for at least ```MAX_INT_STR_LEN + 1```
+ * characters
+ *
+ * @return The number of characters written, without the null terminator
+ */
+size_t format_int(int64_t value, char* buf);
+
+/**
+ * Writes the shortest decimal representation of a double that parses back
+ * to the same value (Grisu2) to a buffer. Among the shortest ones, it is
+ * the nearest to the value, and the one with an even last digit when two
+ * are equally near, as Python's ```repr``` writes it
+ *
+ * @param value The double
+ * @param buf The buffer, with room for at least ```MAX_DBL_STR_LEN + 1```
+ * characters
+ *
+ * @return The number of characters written, without the null terminator
+ *
+ * @note Values are written in fixed notation with at least one decimal
+ * (```0.5```, ```5.0```) when their decimal exponent is in ```[-4, 16)```,
+ * and in scientific notation (```1e+16```, ```2.5e-05```) otherwise
+ */
+size_t format_double(double value, char* buf);
+
+/**
+ * Parses a decimal integer
+ *
+ * @param str The text, with an optional sign followed by digits
+ * @param len The length of the text
+ * @param value Where to store the value
+ *
+ * @return ```1``` on success, or ```0``` if the text is not a valid
+ * integer or does not fit in 64 bits
+ */
+int parse_int(const char* str, size_t len, int64_t* value);
+
+/**
+ * Parses a decimal number into the nearest double (Eisel-Lemire)
+ *
+ * @param str The text, with an optional sign, digits with an optional
+ * decimal point and an optional exponent (```e``` or ```E```)
+ * @param len The length of the text
+ * @param value Where to store the value
+ *
+ * @return ```1``` on success, or ```0``` if the text is not a valid number
+ *
+ * @note Values out of range are parsed as infinity or 0
+ */
+int parse_double(const char* str, size_t len, double* value);
+
+#endif  // NUMCONV_H
@@ -0,0 +1,397 @@
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+
+#include "parallel.h"
+
+// ----- PARALLEL EVALUATION -----
+
+/**
+ * Contains the queued tasks of a worker. The worker adds and takes tasks
+ * at the tail, and other workers take the oldest ones from the head
+ */
+typedef struct deque
+{
+    Task** tasks;
+    int head;               // Position of the oldest task
+    int tail;               // Position after the newest task
+    int capacity;
+    pthread_mutex_t lock;
+} Deque;
+
+/**
+ * Contains the arguments of a worker thread
+ */
+typedef struct worker_args
+{
+    ThreadPool* pool;
+    int index;
+} WorkerArgs;
+
+struct thread_pool
+{
+    Deque* deques;          // Queues of the workers, indexed by worker
+    int n_workers;
+    pthread_t* threads;     // Threads of the workers other than 0
+    WorkerArgs* args;
+    atomic_int n_queued;    // Number of tasks in all the queues
+    atomic_int stop;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle;    // Signaled when a task is queued or the pool stops
+};
+
+// Auxiliary functions
+
+/**
+ * Adds a task at the tail of a queue
+ *
+ * @param d The queue
+ * @param t The task
+ */
+void push_task(Deque* d, Task* t)
+{
+    pthread_mutex_lock(&d->lock);
+    if (d->tail == d->capacity)
+    {
+        // Taken tasks leave room at the head
+        int count = d->tail - d->head;
+        if (d->head > 0)
+            memmove(d->tasks, d->tasks + d->head, count * sizeof(Task*));
+        d->head = 0;
+        d->tail = count;
+        if (count == d->capacity)
+        {
+            d->capacity = (d->capacity) ? 2 * d->capacity : 16;
+            d->tasks = (Task**) realloc(d->tasks, d->capacity * sizeof(Task*));
+        }
+    }
+    d->tasks[d->tail++] = t;
+    pthread_mutex_unlock(&d->lock);
+}
+
+/**
+ * Takes a task from a queue
+ *
+ * @param d The queue
+ * @param newest Whether to take the newest task instead of the oldest
+ * @param expected The only task that may be taken, or ```NULL``` for any
+ *
+ * @return The task, or ```NULL``` if there is none to take
+ */
+Task* take_task(Deque* d, int newest, const Task* expected)
+{
+    Task* t = NULL;
+    pthread_mutex_lock(&d->lock);
+    if (d->head < d->tail)
+    {
+        t = d->tasks[(newest) ? d->tail - 1 : d->head];
+        if (expected && t != expected)
+            t = NULL;
+        else if (newest)
+            d->tail--;
+        else
+            d->head++;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return t;
+}
+
+/**
+ * Finds a queued task for a worker: its own newest task, or else the
+ * oldest task of another worker
+ *
+ * @param pool The pool
+ * @param worker The index of the worker
+ *
+ * @return The task, or ```NULL``` if every queue is empty
+ */
+Task* find_task(ThreadPool* pool, int worker)
+{
+    if (atomic_load(&pool->n_queued) == 0)
+        return NULL;
+
+    Task* t = take_task(&pool->deques[worker], 1, NULL);
+    for (int k = 1; t == NULL && k < pool->n_workers; k++)
+        t = take_task(&pool->deques[(worker + k) % pool->n_workers], 0, NULL);
+
+    if (t)
+        atomic_fetch_sub(&pool->n_queued, 1);
+    return t;
+}
+
+/**
+ * Evaluates a task
+ *
+ * @param t The task
+ * @param worker The index of the worker that runs it
+ */
+void run_task(Task* t, int worker)
+{
+    t->i.ast = t->node;
+    t->i.worker = worker;
+    t->res = interpret(&t->i);
+    atomic_store(&t->done, 1);
+}
+
+/**
+ * Runs the tasks of a pool in a worker thread until the pool stops
+ *
+ * @param arg The arguments of the worker
+ *
+ * @return ```NULL```
+ */
+void* run_worker(void* arg)
+{
+    const WorkerArgs* w = (const WorkerArgs*) arg;
+    ThreadPool* pool = w->pool;
+
+    while (1)
+    {
+        Task* t = find_task(pool, w->index);
+        if (t)
+        {
+            run_task(t, w->index);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->idle_lock);
+        while (atomic_load(&pool->n_queued) == 0 && !atomic_load(&pool->stop))
+            pthread_cond_wait(&pool->idle, &pool->idle_lock);
+        pthread_mutex_unlock(&pool->idle_lock);
+
+        if (atomic_load(&pool->stop))
+            return NULL;
+    }
+}
+
+/**
+ * Measures a subtree and marks the operations in it whose operands can
+ * be evaluated in parallel
+ *
+ * @param node The root of the subtree
+ * @param pure Where to store whether the subtree has no side effects
+ * @param n_forks The number of operations marked, which is incremented
+ *
+ * @return The number of nodes of the subtree
+ */
+long measure(ASTNode* node, int* pure, int* n_forks)
+{
+    NodeData* data = &node->data;
+    long size = 1;
+    int child_pure = 1;
+    *pure = 1;
+
+    switch (node->class)
+    {
+    case UnOp:
+        return 1 + measure(data->unary.value, pure, n_forks);
+
+    case BinOp:
+    {
+        int left_pure, right_pure;
+        long left = measure(data->binary.left, &left_pure, n_forks);
+        long right = measure(data->binary.right, &right_pure, n_forks);
+
+        data->binary.fork = left_pure && right_pure
+            && left >= FORK_MIN_NODES && right >= FORK_MIN_NODES;
+        *n_forks += data->binary.fork;
+        *pure = left_pure && right_pure;
+        return 1 + left + right;
+    }
+
+    case Convert:
+        return 1 + measure(data->convert.value, pure, n_forks);
+
+    case VarAssign:
+        size += measure(data->assign.value, &child_pure, n_forks);
+        *pure = 0;
+        return size;
+
+    case Call:
+        for (int k = 0; k < data->call.n_args; k++)
+        {
+            size += measure(data->call.args[k], &child_pure, n_forks);
+            *pure &= child_pure;
+        }
+
+        // User functions may assign variables or fill result caches
+        if (data->call.spec)
+            *pure = 0;
+        return size;
+
+    case Sequence:
+        for (int k = 0; k < data->sequence.count; k++)
+        {
+            size += measure(data->sequence.items[k], &child_pure, n_forks);
+            *pure &= child_pure;
+        }
+        return size;
+
+    case Logic:
+        size += measure(data->logic.left, &child_pure, n_forks);
+        *pure &= child_pure;
+        size += measure(data->logic.right, &child_pure, n_forks);
+        *pure &= child_pure;
+        return size;
+
+    case Cond:
+        size += measure(data->cond.cond, &child_pure, n_forks);
+        *pure &= child_pure;
+        size += measure(data->cond.if_true, &child_pure, n_forks);
+        *pure &= child_pure;
+        size += measure(data->cond.if_false, &child_pure, n_forks);
+        *pure &= child_pure;
+        return size;
+
+    case While:
+        size += measure(data->loop.cond, &child_pure, n_forks);
+        size += measure(data->loop.body, &child_pure, n_forks);
+        *pure = 0;
+        return size;
+
+    case For:
+        size += measure(data->range.start, &child_pure, n_forks);
+        size += measure(data->range.end, &child_pure, n_forks);
+        size += measure(data->range.body, &child_pure, n_forks);
+        *pure = 0;
+        return size;
+
+    // The first evaluation of an invariant stores its value in the loop
+    case Invariant:
+        size += measure(data->invariant.value, &child_pure, n_forks);
+        *pure = 0;
+        return size;
+
+    case Fused:
+    {
+        int n_large = 0;
+        for (int k = 0; k < data->fused.count; k++)
+        {
+            long operand = measure(data->fused.operands[k], &child_pure, n_forks);
+            n_large += operand >= FORK_MIN_NODES;
+            size += operand;
+            *pure &= child_pure;
+        }
+
+        data->fused.fork = *pure && n_large >= 2
+            && data->fused.count <= FORK_MAX_OPERANDS;
+        *n_forks += data->fused.fork;
+        return size;
+    }
+
+    case FuncDef:
+        *pure = 0;
+        return size;
+
+    default:
+        return size;
+    }
+}
+
+
+// Public functions
+
+ThreadPool* new_thread_pool(int n_workers)
+{
+    ThreadPool* pool = (ThreadPool*) malloc(sizeof(ThreadPool));
+    pool->n_workers = (n_workers > 1) ? n_workers : 1;
+    pool->deques = (Deque*) calloc(pool->n_workers, sizeof(Deque));
+    for (int k = 0; k < pool->n_workers; k++)
+        pthread_mutex_init(&pool->deques[k].lock, NULL);
+
+    atomic_init(&pool->n_queued, 0);
+    atomic_init(&pool->stop, 0);
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    pool->threads = (pthread_t*) malloc(pool->n_workers * sizeof(pthread_t));
+    pool->args = (WorkerArgs*) malloc(pool->n_workers * sizeof(WorkerArgs));
+
+    // Workers inherit a mask that blocks every signal, so signals are
+    // handled by the thread that created the pool
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    for (int k = 1; k < pool->n_workers; k++)
+    {
+        pool->args[k].pool = pool;
+        pool->args[k].index = k;
+        pthread_create(&pool->threads[k], NULL, run_worker, &pool->args[k]);
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return pool;
+}
+
+void free_thread_pool(ThreadPool* pool)
+{
+    pthread_mutex_lock(&pool->idle_lock);
+    atomic_store(&pool->stop, 1);
+    pthread_cond_broadcast(&pool->idle);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    for (int k = 1; k < pool->n_workers; k++)
+        pthread_join(pool->threads[k], NULL);
+
+    for (int k = 0; k < pool->n_workers; k++)
+    {
+        free(pool->deques[k].tasks);
+        pthread_mutex_destroy(&pool->deques[k].lock);
+    }
+    pthread_mutex_destroy(&pool->idle_lock);
+    pthread_cond_destroy(&pool->idle);
+    free(pool->deques);
+    free(pool->threads);
+    free(pool->args);
+    free(pool);
+}
+
+int plan_forks(ASTNode* root)
+{
+    int pure, n_forks = 0;
+    measure(root, &pure, &n_forks);
+    return n_forks;
+}
+
+void fork_task(Interpreter* i, Task* t, const ASTNode* node)
+{
+    ThreadPool* pool = i->pool;
+    t->node = node;
+    t->i = *i;
+
+    // The task unwinds its own errors
+    t->i.owned = NULL;
+    t->i.n_owned = 0;
+    t->i.owned_capacity = 0;
+    t->i.on_error = NULL;
+    atomic_init(&t->done, 0);
+
+    atomic_fetch_add(&pool->n_queued, 1);
+    push_task(&pool->deques[i->worker], t);
+
+    pthread_mutex_lock(&pool->idle_lock);
+    pthread_cond_signal(&pool->idle);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+Result join_task(Interpreter* i, Task* t)
+{
+    ThreadPool* pool = i->pool;
+
+    // Tasks are joined in reverse order, so an untaken task is the newest
+    if (take_task(&pool->deques[i->worker], 1, t))
+    {
+        atomic_fetch_sub(&pool->n_queued, 1);
+        run_task(t, i->worker);
+        return t->res;
+    }
+
+    while (!atomic_load(&t->done))
+    {
+        Task* other = find_task(pool, i->worker);
+        if (other)
+            run_task(other, i->worker);
+        else
+            sched_yield();
+    }
+    return t->res;
+}
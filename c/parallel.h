@@ -0,0 +1,87 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdatomic.h>
+
+#include "interpreter.h"
+
+// ----- PARALLEL EVALUATION -----
+
+// Smallest operand (in nodes) evaluated as a separate task. Smaller ones
+// take less time to evaluate than to hand over to another thread
+#define FORK_MIN_NODES 4096
+
+// Most operands of a fused operation evaluated in parallel, which covers
+// every shape kernel
+#define FORK_MAX_OPERANDS 4
+
+/**
+ * Contains a subtree forked to be evaluated by any worker of a pool
+ */
+typedef struct task
+{
+    const ASTNode* node;
+    Interpreter i;          // Copy of the forking interpreter
+    Result res;
+    atomic_int done;        // Set once ```res``` holds the result
+} Task;
+
+/**
+ * Creates a pool of workers that evaluate forked subtrees. Each worker
+ * keeps its own queue of tasks and takes tasks from the others when it
+ * runs out
+ *
+ * @param n_workers The number of workers, including the thread that runs
+ * the interpreter, which is worker 0
+ *
+ * @return The new pool
+ *
+ * @note Remember to call ```free_thread_pool``` afterwards
+ * @note A pool serves one interpreter at a time
+ */
+ThreadPool* new_thread_pool(int n_workers);
+
+/**
+ * Stops the workers of a pool and frees its memory
+ *
+ * @param pool The pool
+ */
+void free_thread_pool(ThreadPool* pool);
+
+/**
+ * Marks the binary operations of a typed AST whose operands can be
+ * evaluated in parallel: both must have at least ```FORK_MIN_NODES```
+ * nodes, and neither may have side effects (assignments, loops, loop
+ * invariants or calls to user functions), so their order cannot change
+ * the result. Fused operations of up to ```FORK_MAX_OPERANDS``` operands
+ * are marked when two of them are that large and none has side effects.
+ * Function bodies are evaluated sequentially
+ *
+ * @param root The root of the AST
+ *
+ * @return The number of operations marked
+ */
+int plan_forks(ASTNode* root);
+
+/**
+ * Queues a subtree to be evaluated by the pool of an interpreter
+ *
+ * @param i The interpreter, which must have a pool
+ * @param t Storage for the task, until it is joined
+ * @param node The subtree
+ */
+void fork_task(Interpreter* i, Task* t, const ASTNode* node);
+
+/**
+ * Waits for a forked subtree to be evaluated. If no other worker has
+ * taken it, it is evaluated by the calling thread; otherwise the thread
+ * runs other queued tasks while it waits
+ *
+ * @param i The interpreter that forked the task
+ * @param t The task
+ *
+ * @return The result of the subtree
+ */
+Result join_task(Interpreter* i, Task* t);
+
+#endif  // PARALLEL_H
@@ -4,6 +4,81 @@
 
 // Auxiliary functions
 
+/**
+ * Stops the parse with an error, unwinding the rules being parsed to
+ * ```parse```
+ * 
+ * @param p The parser
+ * @param err The error
+ */
+_Noreturn void fail_parse(Parser* p, Error err)
+{
+    p->err = err;
+    longjmp(*p->on_error, 1);
+}
+
+/**
+ * Keeps a subtree until its parent node is built, so that it is freed if
+ * the parse fails before
+ * 
+ * @param p The parser
+ * @param node The subtree
+ */
+void push_node(Parser* p, ASTNode* node)
+{
+    if (p->n_pending == p->pending_capacity)
+    {
+        p->pending_capacity = (p->pending_capacity) ? 2 * p->pending_capacity : 16;
+        p->pending = (ASTNode**) realloc(p->pending, 
+                                         p->pending_capacity * sizeof(ASTNode*));
+    }
+    p->pending[p->n_pending++] = node;
+}
+
+/**
+ * Takes back the last subtree kept by ```push_node```
+ * 
+ * @param p The parser
+ * 
+ * @return The subtree
+ */
+ASTNode* pop_node(Parser* p)
+{
+    return p->pending[--p->n_pending];
+}
+
+/**
+ * Takes back the last subtrees kept by ```push_node``` as a list
+ * 
+ * @param p The parser
+ * @param count The number of subtrees
+ * 
+ * @return The list of subtrees, in the order they were kept, or ```NULL```
+ * if ```count``` is 0
+ */
+ASTNode** pop_nodes(Parser* p, int count)
+{
+    if (count == 0)
+        return NULL;
+
+    p->n_pending -= count;
+    ASTNode** nodes = (ASTNode**) malloc(count * sizeof(ASTNode*));
+    memcpy(nodes, p->pending + p->n_pending, count * sizeof(ASTNode*));
+    return nodes;
+}
+
+/**
+ * Frees the scope of the function being parsed
+ * 
+ * @param p The parser
+ */
+void free_scope(Parser* p)
+{
+    free(p->scope->symbols);
+    free(p->scope);
+    p->scope = NULL;
+}
+
 /**
  * Consumes a binary operation (left associative):
  * 
@@ -13,25 +88,22 @@
  * @param func The rule function of the operands
  * @param ops The valid operators for the rule
  * @param n_ops The number of valid operators
+ * @param build The constructor of the operation nodes
  * 
- * @return The result of parsing the rule
+ * @return The node of the rule
  * 
- * @note In case of error, the ```root``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to ```parse```
 */
-ParserResult bin_op(
+ASTNode* bin_op(
     Parser* p, 
-    ParserResult (*func)(Parser*), 
+    ASTNode* (*func)(Parser*), 
     TokenType ops[], 
-    int n_ops
+    int n_ops,
+    ASTNode* (*build)(const Token*, ASTNode*, ASTNode*)
 )
 {
-    ParserResult left;
-    
     // Consume left node
-    left = func(p);
-    if (left.root == NULL)
-    return left;
+    ASTNode* left = func(p);
     
     int f_current_tok_in_ops = 1;   // The current token is a valid operator
     while (p->current && f_current_tok_in_ops)
@@ -48,28 +120,15 @@ ParserResult bin_op(
 
                 // Consume operator
                 const Token* op = p->current;
+                push_node(p, left);
                 if (advance_parser(p) == NULL)
-                {
-                    free_node(left.root);
-                    left.root = NULL;
-                    left.err = new_error(
-                        InvalidSyntaxError,
-                        get_next_position(op),
-                        "Expected another number"
-                    );
-                    return left;
-                }
+                    fail_parse(p, new_error(ERR_EXPECTED_OPERAND, get_next_position(op)));
 
                 // Consume right node
-                ParserResult right = func(p);
-                if (right.root == NULL)
-                {
-                    free_node(left.root);
-                    return right;
-                }
+                ASTNode* right = func(p);
 
                 // Build binary node
-                left.root = new_bin_op_node(op, left.root, right.root);
+                left = build(op, pop_node(p), right);
                 break;
             }
         }
@@ -79,36 +138,239 @@ ParserResult bin_op(
     return left;
 }
 
+/**
+ * Obtains the token after the current one without consuming it
+ * 
+ * @param p The parser
+ * 
+ * @return The next token, or ```NULL``` if there are no more tokens
+ */
+const Token* peek_parser(const Parser* p)
+{
+    return (p->idx + 1 < p->tok_count) ? p->tok_list[p->idx + 1] : NULL;
+}
+
+/**
+ * Obtains the position of the current token, or the position after the
+ * last token if all of them have been consumed
+ * 
+ * @param p The parser
+ * 
+ * @return The position
+ */
+Position get_parser_position(const Parser* p)
+{
+    if (p->current)
+        return p->current->pos;
+    return get_next_position(p->tok_list[p->tok_count - 1]);
+}
+
+/**
+ * Obtains the frame slot of a local variable in a scope
+ * 
+ * @param scope The scope
+ * @param symbol The symbol of the variable
+ * 
+ * @return The slot, or ```-1``` if the variable is not in the scope
+ */
+int find_local(const Scope* scope, int symbol)
+{
+    for (int k = 0; k < scope->count; k++)
+    {
+        if (scope->symbols[k] == symbol)
+            return k;
+    }
+    return -1;
+}
+
+/**
+ * Resolves a variable name to its slot: a frame slot inside a function
+ * body, or an environment slot otherwise
+ * 
+ * @param p The parser
+ * @param name Token representing the name
+ * 
+ * @return The slot
+ */
+int resolve_name(Parser* p, const Token* name)
+{
+    int symbol = intern_symbol(p->symbols, name->value, strlen(name->value));
+    if (p->scope == NULL)
+        return symbol;
+
+    int slot = find_local(p->scope, symbol);
+    if (slot != -1)
+        return slot;
+
+    // New local variable
+    Scope* scope = p->scope;
+    if (scope->count == scope->capacity)
+    {
+        scope->capacity = (scope->capacity) ? 2 * scope->capacity : 8;
+        scope->symbols = (int*) realloc(scope->symbols, scope->capacity * sizeof(int));
+    }
+    scope->symbols[scope->count] = symbol;
+    return scope->count++;
+}
+
 
 // Private function declarations
 
 /**
  * Consumes the program rule (root of the grammar):
  * 
- * ```prog ::= expr```
+ * ```prog ::= stmt { ';' stmt } [ ';' ]```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* prog(Parser* p);
+
+/**
+ * Consumes a statement:
+ * 
+ * ```stmt ::= fdef | expr```
  * 
  * @param p The parser
  * 
- * @return The result of parsing the rule
+ * @return The node of the rule
  * 
- * @note In case of error, the ```root``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to ```parse```
  */
-ParserResult prog(Parser* p);
+ASTNode* stmt(Parser* p);
+
+/**
+ * Consumes a function definition:
+ * 
+ * ```fdef ::= [ 'memo' ] 'fun' IDN '(' [ IDN { ',' IDN } ] ')' '=' expr```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* fdef(Parser* p);
+
+/**
+ * Consumes an expression:
+ * 
+ * ```expr ::= IDN '=' expr | cond | wloop | floop | lor```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* expr(Parser* p);
+
+/**
+ * Consumes a conditional expression:
+ * 
+ * ```cond ::= 'if' expr 'then' expr 'else' expr```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* cond(Parser* p);
+
+/**
+ * Consumes a while loop:
+ * 
+ * ```wloop ::= 'while' expr 'do' expr```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* wloop(Parser* p);
+
+/**
+ * Consumes a for loop:
+ * 
+ * ```floop ::= 'for' IDN '=' expr 'to' expr 'do' expr```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* floop(Parser* p);
+
+/**
+ * Consumes a disjunction:
+ * 
+ * ```lor ::= land { 'or' land }```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* lor(Parser* p);
+
+/**
+ * Consumes a conjunction:
+ * 
+ * ```land ::= lnot { 'and' lnot }```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* land(Parser* p);
+
+/**
+ * Consumes a logical negation:
+ * 
+ * ```lnot ::= 'not' lnot | comp```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* lnot(Parser* p);
+
+/**
+ * Consumes a comparison (not associative):
+ * 
+ * ```comp ::= arit [ ( '<' | '<=' | '>' | '>=' | '==' | '!=' ) arit ]```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* comp(Parser* p);
 
 /**
  * Consumes a math expression:
  * 
- * ```expr ::= term { ('+' | '-') term }```
+ * ```arit ::= term { ('+' | '-') term }```
  * 
  * @param p The parser
  * 
- * @return The result of parsing the rule
+ * @return The node of the rule
  * 
- * @note In case of error, the ```root``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to ```parse```
  */
-ParserResult expr(Parser* p);
+ASTNode* arit(Parser* p);
 
 /**
  * Consumes a math term:
@@ -117,12 +379,11 @@ ParserResult expr(Parser* p);
  * 
  * @param p The parser
  * 
- * @return The result of parsing the rule
+ * @return The node of the rule
  * 
- * @note In case of error, the ```root``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to ```parse```
  */
-ParserResult term(Parser* p);
+ASTNode* term(Parser* p);
 
 /**
  * Consumes a math factor:
@@ -131,26 +392,37 @@ ParserResult term(Parser* p);
  * 
  * @param p The parser
  * 
- * @return The result of parsing the rule
+ * @return The node of the rule
  * 
- * @note In case of error, the ```root``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to ```parse```
  */
-ParserResult fact(Parser* p);
+ASTNode* fact(Parser* p);
 
 /**
  * Consumes a numeric value:
  * 
- * ```nval ::= '(' expr ')' | nlit```
+ * ```nval ::= '(' expr { ';' expr } ')' | call | IDN | nlit```
  * 
  * @param p The parser
  * 
- * @return The result of parsing the rule
+ * @return The node of the rule
  * 
- * @note In case of error, the ```root``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to ```parse```
  */
-ParserResult nval(Parser* p);
+ASTNode* nval(Parser* p);
+
+/**
+ * Consumes a function call:
+ * 
+ * ```call ::= IDN '(' [ expr { ',' expr } ] ')'```
+ * 
+ * @param p The parser
+ * 
+ * @return The node of the rule
+ * 
+ * @note Errors unwind to ```parse```
+ */
+ASTNode* call(Parser* p);
 
 /**
  * Consumes a numeric literal:
@@ -159,23 +431,28 @@ ParserResult nval(Parser* p);
  * 
  * @param p The parser
  * 
- * @return The result of parsing the rule
+ * @return The node of the rule
  * 
- * @note In case of error, the ```root``` field is ```NULL```
- * and the ```err``` field contains the error
+ * @note Errors unwind to ```parse```
  */
-ParserResult nlit(Parser* p);
+ASTNode* nlit(Parser* p);
 
 
 // Public functions
 
-Parser new_parser(const LexerResult res)
+Parser new_parser(const LexerResult res, SymbolTable* symbols)
 {
     Parser p = { 
         .tok_list = res.tokens, 
         .tok_count = res.size, 
         .idx = -1, 
-        .current = NULL
+        .current = NULL,
+        .symbols = symbols,
+        .scope = NULL,
+        .pending = NULL,
+        .n_pending = 0,
+        .pending_capacity = 0,
+        .on_error = NULL,
     };
     return p;
 }
@@ -189,198 +466,520 @@ const Token* advance_parser(Parser* p)
 
 ParserResult parse(Parser* p)
 {
-    return prog(p);
+    ParserResult res;
+    jmp_buf on_error;
+
+    p->on_error = &on_error;
+    if (setjmp(on_error) == 0)
+        res.root = prog(p);
+    else
+    {
+        // Free what the unwound rules were building
+        for (int k = 0; k < p->n_pending; k++)
+            free_node(p->pending[k]);
+        if (p->scope)
+            free_scope(p);
+
+        res.root = NULL;
+        res.err = p->err;
+    }
+
+    free(p->pending);
+    p->pending = NULL;
+    p->n_pending = p->pending_capacity = 0;
+    p->on_error = NULL;
+    return res;
 }
 
 
 // Private function implementations
 
-ParserResult prog(Parser* p)
+ASTNode* prog(Parser* p)
 {
-    ParserResult res;
-
     // Advance to first token
     if (advance_parser(p) == NULL)
+        fail_parse(p, new_error(ERR_UNEXPECTED_EOF, (Position) {1, 1}));
+
+    // Consume statements
+    int count = 0;
+    while (1)
     {
-        res.root = NULL;
-        res.err = new_error(
-            InvalidSyntaxError,
-            (Position) {1, 1},
-            "Unexpected end of input"
-        );
-        return res;
+        push_node(p, stmt(p));
+        count++;
+
+        // ';' stmt, or a trailing ';'
+        if (p->current == NULL || p->current->type != TT_SEM 
+            || advance_parser(p) == NULL)
+            break;
     }
 
-    // Consume an expression
-    res = expr(p);
-    if (res.root == NULL)
-        return res;
+    // Unexpected token
+    if (p->current != NULL)
+        fail_parse(p, new_error(ERR_UNEXPECTED_TOKEN, p->current->pos));
 
     // End of program reached
-    if (p->current == NULL)
-        return res;
+    if (count == 1)
+        return pop_node(p);
+    return new_sequence_node(pop_nodes(p, count), count);
+}
 
-    // Unexpected token
-    free_node(res.root);
-    res.root = NULL;
-    res.err = new_error(
-        InvalidSyntaxError,
-        p->current->pos,
-        "Unexpected token"
-    );
+ASTNode* stmt(Parser* p)
+{
+    // fdef
+    if (is_keyword(p->current, "fun") || is_keyword(p->current, "memo"))
+        return fdef(p);
+
+    // Consume expression
+    return expr(p);
+}
+
+ASTNode* fdef(Parser* p)
+{
+    int memo = 0;
+
+    // [ 'memo' ]
+    if (is_keyword(p->current, "memo"))
+    {
+        memo = 1;
+        advance_parser(p);
+        if (p->current == NULL || !is_keyword(p->current, "fun"))
+            fail_parse(p, new_error(ERR_EXPECTED_FUN, get_parser_position(p)));
+    }
+
+    // 'fun' IDN
+    advance_parser(p);
+    if (p->current == NULL || p->current->type != TT_IDN)
+        fail_parse(p, new_error(ERR_EXPECTED_NAME, get_parser_position(p)));
+    const Token* name = p->current;
+
+    // '('
+    advance_parser(p);
+    if (p->current == NULL || p->current->type != TT_LPA)
+        fail_parse(p, new_error(ERR_EXPECTED_LPAREN, get_parser_position(p)));
+
+    // Parameters take the first slots of the function's scope. Definitions
+    // are statements, so there is no outer scope
+    p->scope = (Scope*) calloc(1, sizeof(Scope));
+
+    // [ IDN { ',' IDN } ]
+    advance_parser(p);
+    while (p->current && p->current->type == TT_IDN)
+    {
+        const Token* param = p->current;
+        int symbol = intern_symbol(p->symbols, param->value, strlen(param->value));
+        if (find_local(p->scope, symbol) != -1)
+        {
+            fail_parse(p, new_name_error(
+                ERR_DUPLICATE_PARAMETER, 
+                param->pos, 
+                param->value
+            ));
+        }
+        resolve_name(p, param);
+
+        advance_parser(p);
+        if (p->current == NULL || p->current->type != TT_COM)
+            break;
+
+        advance_parser(p);
+        if (p->current == NULL || p->current->type != TT_IDN)
+            fail_parse(p, new_error(ERR_EXPECTED_NAME, get_parser_position(p)));
+    }
+    int n_params = p->scope->count;
+
+    // ')'
+    if (p->current == NULL || p->current->type != TT_RPA)
+    {
+        fail_parse(p, new_error(
+            (n_params) ? ERR_EXPECTED_SEPARATOR : ERR_EXPECTED_RPAREN,
+            get_parser_position(p)
+        ));
+    }
+
+    // '='
+    if (advance_parser(p) == NULL || p->current->type != TT_ASG)
+        fail_parse(p, new_error(ERR_EXPECTED_ASSIGN, get_parser_position(p)));
+
+    // expr
+    const Token* op = p->current;
+    if (advance_parser(p) == NULL)
+        fail_parse(p, new_error(ERR_EXPECTED_EXPRESSION, get_next_position(op)));
+    ASTNode* body = expr(p);
+
+    int n_locals = p->scope->count;
+    free_scope(p);
+
+    // Build definition node
+    int symbol = intern_symbol(p->symbols, name->value, strlen(name->value));
+    return new_func_def_node(name, symbol, n_params, n_locals, memo, body);
+}
+
+ASTNode* expr(Parser* p)
+{
+    // IDN '=' expr
+    const Token* next = peek_parser(p);
+    if (p->current->type == TT_IDN && next && next->type == TT_ASG)
+    {
+        // Consume name and operator
+        const Token* name = p->current;
+        advance_parser(p);
+        if (advance_parser(p) == NULL)
+            fail_parse(p, new_error(ERR_EXPECTED_EXPRESSION, get_next_position(next)));
+
+        // Consume value
+        ASTNode* value = expr(p);
+
+        // Locals are typed per specialization by the typing pass
+        int slot = resolve_name(p, name);
+        if (p->scope)
+            return new_var_assign_node(name, slot, value->type, value);
+
+        // Variables take the widest type assigned to them, so the slot
+        // keeps a single type across assignments
+        Symbol* s = get_symbol(p->symbols, slot);
+        s->type = (s->assigned) ? 
+            max_priority(s->type, value->type) : value->type;
+        s->assigned = 1;
+
+        // Build assignment node
+        return new_var_assign_node(name, slot, s->type, value);
+    }
+
+    // cond
+    if (is_keyword(p->current, "if"))
+        return cond(p);
+
+    // wloop
+    if (is_keyword(p->current, "while"))
+        return wloop(p);
+
+    // floop
+    if (is_keyword(p->current, "for"))
+        return floop(p);
+
+    // Consume logical expression
+    return lor(p);
+}
+
+/**
+ * Consumes a series of clauses, each made of a keyword followed by an
+ * expression
+ * 
+ * @param p The parser
+ * @param keywords The keyword of each clause
+ * @param missing The error of each clause when its keyword is missing
+ * @param n The number of clauses
+ * @param parts Where to store the expression of each clause
+ * 
+ * @note Errors unwind to ```parse```
+ */
+void clauses(
+    Parser* p, 
+    const char* keywords[], 
+    const ErrorCode missing[], 
+    int n, 
+    ASTNode* parts[]
+)
+{
+    for (int k = 0; k < n; k++)
+    {
+        if (p->current == NULL || !is_keyword(p->current, keywords[k]))
+            fail_parse(p, new_error(missing[k], get_parser_position(p)));
+        if (advance_parser(p) == NULL)
+        {
+            fail_parse(p, new_error(
+                ERR_EXPECTED_EXPRESSION, 
+                get_next_position(p->tok_list[p->tok_count - 1])
+            ));
+        }
+        push_node(p, expr(p));
+    }
+
+    for (int k = n - 1; k >= 0; k--)
+        parts[k] = pop_node(p);
 }
 
-ParserResult expr(Parser* p)
+ASTNode* cond(Parser* p)
+{
+    ASTNode* parts[3];
+    const char* keywords[] = { "if", "then", "else" };
+    const ErrorCode missing[] = { 
+        ERR_EXPECTED_EXPRESSION, ERR_EXPECTED_THEN, ERR_EXPECTED_ELSE 
+    };
+
+    // 'if' expr 'then' expr 'else' expr
+    clauses(p, keywords, missing, 3, parts);
+
+    // Build conditional node
+    return new_cond_node(parts[0], parts[1], parts[2]);
+}
+
+ASTNode* wloop(Parser* p)
+{
+    ASTNode* parts[2];
+    const char* keywords[] = { "while", "do" };
+    const ErrorCode missing[] = { ERR_EXPECTED_EXPRESSION, ERR_EXPECTED_DO };
+
+    // 'while' expr 'do' expr
+    clauses(p, keywords, missing, 2, parts);
+
+    // Build loop node
+    return new_while_node(parts[0], parts[1]);
+}
+
+ASTNode* floop(Parser* p)
+{
+    // 'for' IDN
+    advance_parser(p);
+    if (p->current == NULL || p->current->type != TT_IDN)
+        fail_parse(p, new_error(ERR_EXPECTED_NAME, get_parser_position(p)));
+    const Token* name = p->current;
+
+    // '='
+    const Token* op = advance_parser(p);
+    if (op == NULL || op->type != TT_ASG)
+        fail_parse(p, new_error(ERR_EXPECTED_ASSIGN, get_parser_position(p)));
+
+    // expr
+    if (advance_parser(p) == NULL)
+        fail_parse(p, new_error(ERR_EXPECTED_EXPRESSION, get_next_position(op)));
+    push_node(p, expr(p));
+
+    // 'to' expr 'do' expr
+    ASTNode* parts[3];
+    const char* keywords[] = { "to", "do" };
+    const ErrorCode missing[] = { ERR_EXPECTED_TO, ERR_EXPECTED_DO };
+    clauses(p, keywords, missing, 2, parts + 1);
+    parts[0] = pop_node(p);
+
+    // The counter takes the widest type of its bounds, like an assignment
+    int slot = resolve_name(p, name);
+    if (p->scope == NULL)
+    {
+        TypePriority type = max_priority(parts[0]->type, parts[1]->type);
+        Symbol* s = get_symbol(p->symbols, slot);
+        s->type = (s->assigned) ? max_priority(s->type, type) : type;
+        s->assigned = 1;
+    }
+
+    // Build loop node
+    return new_for_node(name, slot, parts[0], parts[1], parts[2]);
+}
+
+ASTNode* lor(Parser* p)
+{
+    // Consume logical operation
+    TokenType ops[] = {TT_OR};
+    return bin_op(p, land, ops, 1, new_logic_node);
+}
+
+ASTNode* land(Parser* p)
+{
+    // Consume logical operation
+    TokenType ops[] = {TT_AND};
+    return bin_op(p, lnot, ops, 1, new_logic_node);
+}
+
+ASTNode* lnot(Parser* p)
+{
+    // 'not' lnot
+    if (p->current->type == TT_NOT)
+    {
+        // Consume operator
+        const Token* op = p->current;
+        if (advance_parser(p) == NULL)
+            fail_parse(p, new_error(ERR_EXPECTED_EXPRESSION, get_next_position(op)));
+
+        // Consume operand and build unary node
+        return new_un_op_node(op, lnot(p));
+    }
+
+    // Consume comparison
+    return comp(p);
+}
+
+ASTNode* comp(Parser* p)
+{
+    ASTNode* left = arit(p);
+    if (p->current == NULL || !is_comparison(p->current->type))
+        return left;
+
+    // Consume operator
+    const Token* op = p->current;
+    push_node(p, left);
+    if (advance_parser(p) == NULL)
+        fail_parse(p, new_error(ERR_EXPECTED_OPERAND, get_next_position(op)));
+
+    // Consume right node
+    ASTNode* right = arit(p);
+
+    // Build binary node
+    return new_bin_op_node(op, pop_node(p), right);
+}
+
+ASTNode* arit(Parser* p)
 {
     // Consume binary operation
     TokenType ops[] = {TT_ADD, TT_SUB};
-    return bin_op(p, term, ops, 2);
+    return bin_op(p, term, ops, 2, new_bin_op_node);
 }
 
-ParserResult term(Parser* p)
+ASTNode* term(Parser* p)
 {
     // Consume binary operation
     TokenType ops[] = {TT_MUL, TT_DIV, TT_MOD};
-    return bin_op(p, fact, ops, 3);
+    return bin_op(p, fact, ops, 3, new_bin_op_node);
 }
 
-ParserResult fact(Parser* p)
+ASTNode* fact(Parser* p)
 {
-    ParserResult res;
-
     // ( '+' | '-' ) fact
     if (p->current->type == TT_ADD || p->current->type == TT_SUB)
     {
         // Consume sign
         const Token* sign = p->current;
         if (advance_parser(p) == NULL)
-        {
-            res.root = NULL;
-            res.err = new_error(
-                InvalidSyntaxError,
-                get_next_position(sign),
-                "Expected expression"
-            );
-            return res;
-        }
+            fail_parse(p, new_error(ERR_EXPECTED_EXPRESSION, get_next_position(sign)));
 
-        // Consume factor
-        res = fact(p);
-        if (res.root == NULL)
-            return res;
-
-        // Build unary node
-        res.root = new_un_op_node(sign, res.root);
-        return res;
+        // Consume factor and build unary node
+        return new_un_op_node(sign, fact(p));
     }
 
     // Consume power
-    res = nval(p);
-    if (res.root == NULL)
-        return res;
+    ASTNode* base = nval(p);
 
     // '^' fact
     if (p->current && p->current->type == TT_POW)
     {
         // Consume operator
         const Token* op = p->current;
+        push_node(p, base);
         if (advance_parser(p) == NULL)
-        {
-            free_node(res.root);
-            res.root = NULL;
-            res.err = new_error(
-                InvalidSyntaxError,
-                get_next_position(op),
-                "Expected another number"
-            );
-            return res;
-        }
+            fail_parse(p, new_error(ERR_EXPECTED_OPERAND, get_next_position(op)));
 
         // Consume right node
-        ParserResult right = fact(p);
-        if (right.root == NULL)
-        {
-            free_node(res.root);
-            return right;
-        }
+        ASTNode* exponent = fact(p);
 
         // Build binary node
-        res.root = new_bin_op_node(op, res.root, right.root);
+        base = new_bin_op_node(op, pop_node(p), exponent);
     }
 
     // Correct exit
-    return res;
+    return base;
 }
 
-ParserResult nval(Parser* p)
+ASTNode* nval(Parser* p)
 {
-    ParserResult res;
-
     // '(' expr ')'
     if (p->current->type == TT_LPA)
     {
         // Consume left parenthesis
         Position pos = get_next_position(p->current);
         if (advance_parser(p) == NULL)
+            fail_parse(p, new_error(ERR_EXPECTED_EXPRESSION, pos));
+
+        // Consume expressions
+        int count = 0;
+        while (1)
         {
-            res.root = NULL;
-            res.err = new_error(
-                InvalidSyntaxError,
-                pos,
-                "Expected expression"
-            );
-            return res;
-        }
+            push_node(p, expr(p));
+            count++;
 
-        // Consume expression
-        res = expr(p);
-        if (res.root == NULL)
-            return res;
+            // ';' expr
+            if (p->current == NULL || p->current->type != TT_SEM)
+                break;
+            const Token* semicolon = p->current;
+            if (advance_parser(p) == NULL)
+            {
+                fail_parse(p, new_error(
+                    ERR_EXPECTED_EXPRESSION,
+                    get_next_position(semicolon)
+                ));
+            }
+        }
 
         // Consume right parenthesis
         pos = (p->current) ? 
             p->current->pos : get_next_position(p->tok_list[p->tok_count - 1]);
         if (p->current == NULL || p->current->type != TT_RPA)
-        {
-            free_node(res.root);
-            res.root = NULL;
-            res.err = new_error(
-                InvalidSyntaxError,
-                pos,
-                "Expected ')'"
-            );
-            return res;
-        }
+            fail_parse(p, new_error(ERR_EXPECTED_RPAREN, pos));
         advance_parser(p);
 
         // Correct exit
-        return res;
+        if (count == 1)
+            return pop_node(p);
+        return new_sequence_node(pop_nodes(p, count), count);
+    }
+
+    // call
+    const Token* next = peek_parser(p);
+    if (p->current->type == TT_IDN && next && next->type == TT_LPA)
+        return call(p);
+
+    // IDN
+    if (p->current->type == TT_IDN)
+    {
+        // Resolve the name to its slot
+        const Token* name = p->current;
+        int slot = resolve_name(p, name);
+        advance_parser(p);
+
+        TypePriority type = (p->scope) ? 
+            INT : get_symbol(p->symbols, slot)->type;
+        return new_var_access_node(name, slot, type);
     }
 
     // Consume numeric literal
     return nlit(p);
 }
 
-ParserResult nlit(Parser* p)
+ASTNode* call(Parser* p)
 {
-    ParserResult res;
+    // Consume name and left parenthesis
+    const Token* name = p->current;
+    advance_parser(p);
+    advance_parser(p);
+
+    // [ expr { ',' expr } ]
+    int n_args = 0;
+    while (p->current && p->current->type != TT_RPA)
+    {
+        push_node(p, expr(p));
+        n_args++;
+
+        // ',' expr
+        if (p->current == NULL || p->current->type != TT_COM)
+            break;
+        const Token* comma = p->current;
+        if (advance_parser(p) == NULL)
+            fail_parse(p, new_error(ERR_EXPECTED_EXPRESSION, get_next_position(comma)));
+    }
+
+    // Consume right parenthesis
+    if (p->current == NULL || p->current->type != TT_RPA)
+    {
+        fail_parse(p, new_error(
+            (n_args) ? ERR_EXPECTED_SEPARATOR : ERR_EXPECTED_RPAREN,
+            get_parser_position(p)
+        ));
+    }
+    advance_parser(p);
 
+    // Build call node
+    int symbol = intern_symbol(p->symbols, name->value, strlen(name->value));
+    return new_call_node(name, symbol, pop_nodes(p, n_args), n_args);
+}
+
+ASTNode* nlit(Parser* p)
+{
     // Consume integer or float token
     if (p->current->type == TT_INT || p->current->type == TT_FLT)
     {
         ASTNode* node = new_number_node(p->current);
         advance_parser(p);
-
-        res.root = node;
-        return res;
+        return node;
     }
 
     // Invalid token
-    res.root = NULL;
-    res.err = new_error(
-        InvalidSyntaxError,
-        p->current->pos,
-        "Expected number"
-    );
-    return res;
+    fail_parse(p, new_error(ERR_EXPECTED_NUMBER, p->current->pos));
 }
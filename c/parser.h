@@ -1,10 +1,23 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <setjmp.h>
+
 #include "lexer.h"
+#include "symbols.h"
 
 // ----- PARSER -----
 
+/**
+ * Contains the local variables of the function being parsed
+ */
+typedef struct scope
+{
+    int* symbols;           // Symbol of each frame slot, parameters first
+    int count;
+    int capacity;
+} Scope;
+
 /**
  * Contains information for the parsing of a list of tokens
  */
@@ -14,6 +27,16 @@ typedef struct parser
     int tok_count;
     int idx;
     const Token* current;
+    SymbolTable* symbols;   // Names resolved to environment slots
+    Scope* scope;           // Locals of the function being parsed, if any
+
+    // Errors unwind the rules being parsed straight to ```parse```, which
+    // frees the subtrees they were building from this stack
+    ASTNode** pending;      // Subtrees waiting for their parent node
+    int n_pending;
+    int pending_capacity;
+    jmp_buf* on_error;      // Where errors unwind to
+    Error err;              // Error being unwound
 } Parser;
 
 /**
@@ -29,10 +52,11 @@ typedef struct parser_result
  * Creates and initializes a parser with the list of tokens to parse
  * 
  * @param res The result obtained from a lexical analysis
+ * @param symbols The symbol table where names are interned
  * 
  * @return The new parser
 */
-Parser new_parser(const LexerResult res);
+Parser new_parser(const LexerResult res, SymbolTable* symbols);
 
 /**
  * Consumes a token from the list
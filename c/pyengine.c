@@ -0,0 +1,376 @@
+/**
+ * CPython extension module ```cengine```, which runs code with the C
+ * lexer, parser, typing pass and interpreter from Python, through the
+ * engines of the library (```engine.h```)
+ *
+ * A ```cengine.Session()``` keeps variables and functions between calls.
+ * ```eval(text)``` returns an ```int``` or a ```float```, and
+ * ```eval_batch(lines)``` runs several lines without holding the GIL, so
+ * separate sessions can run in parallel threads. Errors raise
+ * ```IllegalCharError```, ```InvalidSyntaxError``` or ```RuntimeError```,
+ * all subclasses of ```cengine.Error```, and the keyword arguments
+ * ```max_steps```, ```max_depth```, ```max_memory``` and ```max_seconds```
+ * limit each call, which raises ```LimitError``` (a ```RuntimeError```)
+ * when it exceeds them. ```python/tester.py --c``` runs the tests through
+ * this module
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -shared -fPIC $(python3-config --includes) -o ../python/cengine$(python3-config --extension-suffix) pyengine.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c session.c engine.c -lm -lpthread```
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "engine.h"
+
+// ----- OUTCOMES -----
+
+/**
+ * Contains the outcome of running a line of code, built without the GIL
+ */
+typedef struct outcome
+{
+    DataType* value;                        // Result (```NULL``` on error)
+    Error err;
+    char message[ENGINE_MESSAGE_LEN];       // Full description of the error
+    char details[ENGINE_MESSAGE_LEN];       // Message of the error alone
+} Outcome;
+
+
+// ----- SESSIONS -----
+
+/**
+ * Python object holding the engine of a session
+ */
+typedef struct session_object
+{
+    PyObject_HEAD
+    Engine* engine;         // Variables, functions and limits of each line
+    int busy;               // Whether a thread is running code without the GIL
+} SessionObject;
+
+/**
+ * Runs a line of code in a session, as the console does
+ *
+ * @param s The session
+ * @param text The code
+ * @param o Where to store the outcome
+ *
+ * @note It does not touch Python objects, so it can run without the GIL
+ */
+void run_line(SessionObject* s, const char* text, Outcome* o)
+{
+    o->value = engine_eval(s->engine, text);
+    if (o->value)
+        return;
+
+    o->err = s->engine->err;
+    memcpy(o->message, s->engine->message, sizeof(o->message));
+    memcpy(o->details, s->engine->details, sizeof(o->details));
+}
+
+// Exceptions of the module, indexed by ErrorType
+PyObject* ErrorTypes[3];
+
+// Base class of the exceptions of the module
+PyObject* EngineError;
+
+// Runtime error of lines that exceed the limits of their session
+PyObject* LimitError;
+
+/**
+ * Converts a value to a Python object
+ *
+ * @param value The value
+ *
+ * @return A new reference to an ```int``` or ```float```, or to ```None```
+ * for definitions
+ */
+PyObject* to_python(const DataType* value)
+{
+    switch (value->type)
+    {
+    case INT:
+        return PyLong_FromLongLong(value->value.integer);
+
+    case BIGINT:
+    {
+        char* digits = (char*) malloc(bigint_max_str_len(value->value.big) + 1);
+        bigint_to_string(value->value.big, digits);
+        PyObject* res = PyLong_FromString(digits, NULL, 10);
+        free(digits);
+        return res;
+    }
+
+    case FLOAT:
+        return PyFloat_FromDouble(value->value.decimal);
+
+    default:
+        Py_RETURN_NONE;
+    }
+}
+
+/**
+ * Raises the exception of a failed outcome
+ *
+ * @param o The outcome
+ * @param index The position of the line in its batch, or ```-1```
+ */
+void raise_error(const Outcome* o, Py_ssize_t index)
+{
+    PyObject* type = (is_limit_error(o->err)) ? LimitError : ErrorTypes[o->err.type];
+    PyObject* exc = PyObject_CallFunction(type, "s", o->message);
+    if (exc == NULL)
+        return;
+
+    PyObject* line = PyLong_FromLong(o->err.pos.row);
+    PyObject* column = PyLong_FromLong(o->err.pos.col);
+    PyObject* details = PyUnicode_FromString(o->details);
+    PyObject* position = PyLong_FromSsize_t(index);
+    PyObject_SetAttrString(exc, "line", line);
+    PyObject_SetAttrString(exc, "column", column);
+    PyObject_SetAttrString(exc, "details", details);
+    if (index >= 0)
+        PyObject_SetAttrString(exc, "index", position);
+
+    PyErr_SetObject(type, exc);
+    Py_XDECREF(line);
+    Py_XDECREF(column);
+    Py_XDECREF(details);
+    Py_XDECREF(position);
+    Py_DECREF(exc);
+}
+
+/**
+ * Claims a session for the calling thread
+ *
+ * @param s The session
+ *
+ * @return ```1``` on success, or ```0``` with an exception set if another
+ * thread is running code in it
+ */
+int acquire_session(SessionObject* s)
+{
+    if (s->busy)
+    {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "The session is running code in another thread");
+        return 0;
+    }
+    s->busy = 1;
+    return 1;
+}
+
+PyObject* Session_new(PyTypeObject* type, PyObject* args, PyObject* kwds)
+{
+    static char* kwlist[] = { "max_steps", "max_depth", "max_memory", "max_seconds", NULL };
+    long long max_steps = 0, max_memory = 0;
+    int max_depth = 0;
+    double max_seconds = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$LiLd:Session", kwlist, 
+                                     &max_steps, &max_depth, &max_memory, &max_seconds))
+        return NULL;
+
+    // Negative limits would wrap to huge ones in the unsigned fields
+    if (max_steps < 0 || max_depth < 0 || max_memory < 0 || !(max_seconds >= 0))
+    {
+        PyErr_SetString(PyExc_ValueError, "Limits cannot be negative");
+        return NULL;
+    }
+
+    SessionObject* s = (SessionObject*) type->tp_alloc(type, 0);
+    if (s == NULL)
+        return NULL;
+
+    EngineOptions options = default_engine_options();
+    options.budget = (Budget) {
+        .max_steps = (unsigned long long) max_steps,
+        .max_depth = max_depth,
+        .max_memory = (size_t) max_memory,
+        .max_seconds = max_seconds,
+    };
+    s->engine = new_engine(&options);
+    s->busy = 0;
+    return (PyObject*) s;
+}
+
+void Session_dealloc(SessionObject* s)
+{
+    free_engine(s->engine);
+    Py_TYPE(s)->tp_free((PyObject*) s);
+}
+
+PyObject* Session_eval(SessionObject* s, PyObject* args)
+{
+    const char* text;
+    if (!PyArg_ParseTuple(args, "s:eval", &text) || !acquire_session(s))
+        return NULL;
+
+    // The text belongs to the argument, which outlives the call
+    Outcome o;
+    Py_BEGIN_ALLOW_THREADS
+    run_line(s, text, &o);
+    Py_END_ALLOW_THREADS
+    s->busy = 0;
+
+    if (o.value == NULL)
+    {
+        raise_error(&o, -1);
+        return NULL;
+    }
+
+    PyObject* res = to_python(o.value);
+    free_value(o.value);
+    return res;
+}
+
+PyObject* Session_eval_batch(SessionObject* s, PyObject* args)
+{
+    PyObject* lines;
+    if (!PyArg_ParseTuple(args, "O:eval_batch", &lines))
+        return NULL;
+
+    // A tuple keeps the strings alive even if the caller's list changes
+    PyObject* items = PySequence_Tuple(lines);
+    if (items == NULL)
+        return NULL;
+
+    Py_ssize_t count = PyTuple_GET_SIZE(items);
+    const char** texts = (const char**) malloc((count + 1) * sizeof(const char*));
+    for (Py_ssize_t k = 0; k < count; k++)
+    {
+        texts[k] = PyUnicode_AsUTF8(PyTuple_GET_ITEM(items, k));
+        if (texts[k] == NULL)
+        {
+            free(texts);
+            Py_DECREF(items);
+            return NULL;
+        }
+    }
+
+    if (!acquire_session(s))
+    {
+        free(texts);
+        Py_DECREF(items);
+        return NULL;
+    }
+
+    // Lines run in order, and the batch stops at the first error
+    Outcome* outcomes = (Outcome*) malloc((count + 1) * sizeof(Outcome));
+    Py_ssize_t n_run = 0;
+    Py_BEGIN_ALLOW_THREADS
+    while (n_run < count)
+    {
+        run_line(s, texts[n_run], &outcomes[n_run]);
+        if (outcomes[n_run++].value == NULL)
+            break;
+    }
+    Py_END_ALLOW_THREADS
+    s->busy = 0;
+
+    PyObject* res = PyList_New(count);
+    for (Py_ssize_t k = 0; k < n_run; k++)
+    {
+        if (outcomes[k].value == NULL)
+        {
+            raise_error(&outcomes[k], k);
+            Py_CLEAR(res);
+            continue;
+        }
+
+        if (res)
+            PyList_SET_ITEM(res, k, to_python(outcomes[k].value));
+        free_value(outcomes[k].value);
+    }
+
+    free(outcomes);
+    free(texts);
+    Py_DECREF(items);
+    return res;
+}
+
+PyMethodDef SessionMethods[] = {
+    { "eval", (PyCFunction) Session_eval, METH_VARARGS,
+      "eval(text)\n--\n\n"
+      "Runs a line of code and returns its value as an int or a float, or "
+      "None for definitions. Raises an Error subclass if it fails" },
+    { "eval_batch", (PyCFunction) Session_eval_batch, METH_VARARGS,
+      "eval_batch(lines)\n--\n\n"
+      "Runs several lines of code in order without holding the GIL and "
+      "returns the list of their values. Stops at the first line that "
+      "fails and raises its error, with the position of the line in the "
+      "'index' attribute" },
+    { NULL, NULL, 0, NULL },
+};
+
+PyTypeObject SessionType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "cengine.Session",
+    .tp_basicsize = sizeof(SessionObject),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_doc = PyDoc_STR(
+        "Session(*, max_steps=0, max_depth=0, max_memory=0, max_seconds=0)\n--\n\n"
+        "Variables and functions shared by the lines run in it. A session "
+        "runs code in one thread at a time; separate sessions may run in "
+        "parallel. Each line may be limited to a number of evaluation "
+        "steps, of nested calls, of bytes of an integer value and of "
+        "seconds (0 for no limit, negative limits raise ValueError); lines "
+        "that exceed them raise LimitError"),
+    .tp_new = Session_new,
+    .tp_dealloc = (destructor) Session_dealloc,
+    .tp_methods = SessionMethods,
+};
+
+
+// ----- MODULE -----
+
+PyModuleDef EngineModule = {
+    PyModuleDef_HEAD_INIT,
+    .m_name = "cengine",
+    .m_doc = "C implementation of the language",
+    .m_size = -1,
+};
+
+PyMODINIT_FUNC PyInit_cengine(void)
+{
+    if (PyType_Ready(&SessionType) < 0)
+        return NULL;
+
+    PyObject* m = PyModule_Create(&EngineModule);
+    if (m == NULL)
+        return NULL;
+
+    // The exceptions mirror the error types of the Python implementation
+    const char* names[] = {
+        [IllegalCharError]      = "cengine.IllegalCharError",
+        [InvalidSyntaxError]    = "cengine.InvalidSyntaxError",
+        [RuntimeError]          = "cengine.RuntimeError",
+    };
+
+    EngineError = PyErr_NewExceptionWithDoc(
+        "cengine.Error", "Error raised by the code being run", NULL, NULL);
+    if (EngineError == NULL || PyModule_AddObjectRef(m, "Error", EngineError) < 0)
+        goto fail;
+
+    for (int k = 0; k < 3; k++)
+    {
+        ErrorTypes[k] = PyErr_NewException(names[k], EngineError, NULL);
+        if (ErrorTypes[k] == NULL
+            || PyModule_AddObjectRef(m, strchr(names[k], '.') + 1, ErrorTypes[k]) < 0)
+            goto fail;
+    }
+
+    LimitError = PyErr_NewExceptionWithDoc(
+        "cengine.LimitError", "Runtime error of a line that exceeds the limits of its session", 
+        ErrorTypes[RuntimeError], NULL);
+    if (LimitError == NULL || PyModule_AddObjectRef(m, "LimitError", LimitError) < 0)
+        goto fail;
+
+    if (PyModule_AddObjectRef(m, "Session", (PyObject*) &SessionType) < 0)
+        goto fail;
+    return m;
+
+fail:
+    Py_DECREF(m);
+    return NULL;
+}
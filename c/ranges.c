@@ -0,0 +1,165 @@
+#include "ranges.h"
+
+// ----- VALUE RANGES -----
+
+// Auxiliary functions
+
+/**
+ * Widens a computed range by one unit in the last place on each side, so
+ * that it still contains the exact result after rounding
+ * 
+ * @param r The range
+ * 
+ * @return The widened range, or the full range if a bound is undefined
+ */
+Interval round_out(Interval r)
+{
+    if (isnan(r.lo) || isnan(r.hi))
+        return full_interval();
+
+    r.lo = nextafter(r.lo, -INFINITY);
+    r.hi = nextafter(r.hi, INFINITY);
+    return r;
+}
+
+/**
+ * Obtains the range covering four candidate bounds
+ * 
+ * @return The range, or the full range if a candidate is undefined
+ */
+Interval hull(double a, double b, double c, double d)
+{
+    if (isnan(a) || isnan(b) || isnan(c) || isnan(d))
+        return full_interval();
+
+    Interval r = { fmin(fmin(a, b), fmin(c, d)), fmax(fmax(a, b), fmax(c, d)) };
+    return r;
+}
+
+/**
+ * Obtains the largest magnitude of the values of a range
+ * 
+ * @param r The range
+ * 
+ * @return The magnitude
+ */
+double magnitude(Interval r)
+{
+    return fmax(fabs(r.lo), fabs(r.hi));
+}
+
+
+// Public functions
+
+Interval full_interval(void)
+{
+    Interval r = { -INFINITY, INFINITY };
+    return r;
+}
+
+Interval point_interval(double value)
+{
+    Interval r = { value, value };
+    return r;
+}
+
+Interval rounded_interval(double value)
+{
+    return round_out(point_interval(value));
+}
+
+int excludes_zero(Interval r)
+{
+    return r.lo >= ZERO_TOLERANCE || r.hi <= -ZERO_TOLERANCE;
+}
+
+Interval interval_neg(Interval r)
+{
+    Interval n = { -r.hi, -r.lo };
+    return n;
+}
+
+Interval interval_add(Interval a, Interval b)
+{
+    Interval r = { a.lo + b.lo, a.hi + b.hi };
+    return round_out(r);
+}
+
+Interval interval_sub(Interval a, Interval b)
+{
+    Interval r = { a.lo - b.hi, a.hi - b.lo };
+    return round_out(r);
+}
+
+Interval interval_mul(Interval a, Interval b)
+{
+    return round_out(hull(a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi));
+}
+
+Interval interval_div(Interval a, Interval b)
+{
+    if (b.lo <= 0 && b.hi >= 0)
+        return full_interval();
+
+    return round_out(hull(a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi));
+}
+
+Interval interval_mod(Interval a, Interval b, TypePriority type)
+{
+    double bound;
+
+    // Integer remainders are smaller than the divisor and the dividend
+    if (is_integer(type))
+        bound = fmin(magnitude(b) - 1, magnitude(a));
+
+    // remainder() is at most half the divisor, and the dividend itself
+    // when it is smaller than that
+    else
+        bound = fmin(magnitude(b) / 2, magnitude(a));
+
+    Interval r = { -bound, bound };
+    return round_out(r);
+}
+
+Interval interval_pow(Interval a, Interval b)
+{
+    // Constant integer exponents
+    if (b.lo == b.hi && b.lo == floor(b.lo) && b.lo >= 0)
+    {
+        double n = b.lo;
+        Interval r;
+
+        if (n == 0)
+            return point_interval(1);
+
+        // Odd powers are increasing
+        if (fmod(n, 2) != 0)
+        {
+            r.lo = pow(a.lo, n);
+            r.hi = pow(a.hi, n);
+        }
+
+        // Even powers decrease up to 0 and increase afterwards
+        else
+        {
+            r.lo = (a.lo <= 0 && a.hi >= 0) ? 
+                0 : pow(fmin(fabs(a.lo), fabs(a.hi)), n);
+            r.hi = pow(magnitude(a), n);
+        }
+
+        // pow() is not guaranteed to be correctly rounded
+        return round_out(round_out(r));
+    }
+
+    // For positive bases, the power is monotonic in both operands, so
+    // its extremes are at the corners
+    if (a.lo > 0)
+    {
+        return round_out(round_out(hull(
+            pow(a.lo, b.lo), pow(a.lo, b.hi), 
+            pow(a.hi, b.lo), pow(a.hi, b.hi)
+        )));
+    }
+
+    return full_interval();
+}
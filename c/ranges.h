@@ -0,0 +1,123 @@
+#ifndef RANGES_H
+#define RANGES_H
+
+#include "base.h"
+
+// ----- VALUE RANGES -----
+
+/**
+ * Closed range of values ```[lo, hi]``` that a node may evaluate to.
+ * Bounds may be infinite
+ */
+typedef struct interval
+{
+    double lo;
+    double hi;
+} Interval;
+
+/**
+ * Obtains the range of every value
+ * 
+ * @return The range
+ */
+Interval full_interval(void);
+
+/**
+ * Obtains the range containing a single value
+ * 
+ * @param value The value
+ * 
+ * @return The range
+ */
+Interval point_interval(double value);
+
+/**
+ * Obtains the range containing a value that was rounded to a double, such
+ * as an integer of more than 53 bits: the double and its neighbours
+ * 
+ * @param value The rounded value
+ * 
+ * @return The range
+ */
+Interval rounded_interval(double value);
+
+/**
+ * Checks whether no value of a range is treated as 0 by divisions
+ * 
+ * @param r The range
+ * 
+ * @return Boolean-like value
+ */
+int excludes_zero(Interval r);
+
+/**
+ * Obtains the range of the negation of a value
+ * 
+ * @param r The range of the value
+ * 
+ * @return The range of the result
+ */
+Interval interval_neg(Interval r);
+
+/**
+ * Obtains the range of the sum of two values
+ * 
+ * @param a The range of the left operand
+ * @param b The range of the right operand
+ * 
+ * @return The range of the result
+ */
+Interval interval_add(Interval a, Interval b);
+
+/**
+ * Obtains the range of the difference of two values
+ * 
+ * @param a The range of the left operand
+ * @param b The range of the right operand
+ * 
+ * @return The range of the result
+ */
+Interval interval_sub(Interval a, Interval b);
+
+/**
+ * Obtains the range of the product of two values
+ * 
+ * @param a The range of the left operand
+ * @param b The range of the right operand
+ * 
+ * @return The range of the result
+ */
+Interval interval_mul(Interval a, Interval b);
+
+/**
+ * Obtains the range of the quotient of two values
+ * 
+ * @param a The range of the left operand
+ * @param b The range of the right operand
+ * 
+ * @return The range of the result
+ */
+Interval interval_div(Interval a, Interval b);
+
+/**
+ * Obtains the range of the remainder of two values
+ * 
+ * @param a The range of the left operand
+ * @param b The range of the right operand
+ * @param type The type of the operation
+ * 
+ * @return The range of the result
+ */
+Interval interval_mod(Interval a, Interval b, TypePriority type);
+
+/**
+ * Obtains the range of a power
+ * 
+ * @param a The range of the base
+ * @param b The range of the exponent
+ * 
+ * @return The range of the result
+ */
+Interval interval_pow(Interval a, Interval b);
+
+#endif  // RANGES_H
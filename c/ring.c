@@ -0,0 +1,242 @@
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ring.h"
+
+// ----- SHARED MEMORY RINGS -----
+
+// Auxiliary functions
+
+/**
+ * Copies bytes out of the data of a ring, wrapping around its end
+ *
+ * @param r The ring
+ * @param pos The position of the first byte
+ * @param dest Where to copy the bytes
+ * @param n The number of bytes
+ */
+void ring_copy_out(const Ring* r, uint32_t pos, char* dest, uint32_t n)
+{
+    uint32_t start = pos & (RING_LEN - 1);
+    uint32_t first = (n < RING_LEN - start) ? n : RING_LEN - start;
+    memcpy(dest, r->data + start, first);
+    memcpy(dest + first, r->data, n - first);
+}
+
+/**
+ * Copies bytes into the data of a ring, wrapping around its end
+ *
+ * @param r The ring
+ * @param pos The position of the first byte
+ * @param src The bytes
+ * @param n The number of bytes
+ */
+void ring_copy_in(Ring* r, uint32_t pos, const char* src, uint32_t n)
+{
+    uint32_t start = pos & (RING_LEN - 1);
+    uint32_t first = (n < RING_LEN - start) ? n : RING_LEN - start;
+    memcpy(r->data + start, src, first);
+    memcpy(r->data, src + first, n - first);
+}
+
+/**
+ * Lets time pass while a producer waits for the engine: it keeps checking
+ * for a while, and then sleeps until the engine writes responses
+ *
+ * @param c The connection
+ * @param seen The value of the futex word before the last check
+ * @param spins The number of checks made
+ *
+ * @return Boolean-like value, false if the engine has stopped or has
+ * closed the channel
+ */
+int ring_pause(RingClient* c, uint32_t seen, int spins)
+{
+    if (!atomic_load(&c->segment->running) || atomic_load(&c->channel->state) != CHANNEL_OPEN)
+        return 0;
+    if ((uint32_t) spins >= c->segment->spin)
+        ring_wait(&c->channel->responses, seen, &c->channel->waiting);
+    return 1;
+}
+
+
+// Public functions
+
+int ring_push_frame(Ring* r, const char* payload, uint32_t len)
+{
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (len > RING_LEN - 4 || RING_LEN - (tail - head) < 4 + len)
+        return 0;
+
+    char header[4] = {
+        (char) (len >> 24), (char) (len >> 16), (char) (len >> 8), (char) len,
+    };
+    ring_copy_in(r, tail, header, 4);
+    ring_copy_in(r, tail + 4, payload, len);
+    atomic_store_explicit(&r->tail, tail + 4 + len, memory_order_release);
+    return 1;
+}
+
+int ring_pop_frame(Ring* r, StrBuf* out)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head == tail)
+        return 0;
+
+    // The other process may write anything to the ring, so the positions
+    // and the length are checked before they are trusted
+    uint32_t used = tail - head;
+    if (used < 4 || used > RING_LEN)
+        return -1;
+
+    unsigned char header[4];
+    ring_copy_out(r, head, (char*) header, 4);
+    uint32_t len = ((uint32_t) header[0] << 24) | ((uint32_t) header[1] << 16)
+        | ((uint32_t) header[2] << 8) | header[3];
+    if (len > used - 4)
+        return -1;
+
+    char* dest = str_buf_reserve(out, len);
+    ring_copy_out(r, head + 4, dest, len);
+    str_buf_commit(out, len);
+    atomic_store_explicit(&r->head, head + 4 + len, memory_order_release);
+    return 1;
+}
+
+void ring_wait(_Atomic uint32_t* word, uint32_t seen, _Atomic uint32_t* waiting)
+{
+    struct timespec timeout = {
+        .tv_sec = RING_SLEEP_MS / 1000,
+        .tv_nsec = (RING_SLEEP_MS % 1000) * 1000000L,
+    };
+
+    // The word is shared between processes, so the futex is not private
+    atomic_store(waiting, 1);
+    syscall(SYS_futex, word, FUTEX_WAIT, seen, &timeout, NULL, 0);
+    atomic_store(waiting, 0);
+}
+
+void ring_notify(_Atomic uint32_t* word, _Atomic uint32_t* waiting)
+{
+    atomic_fetch_add(word, 1);
+    if (atomic_load(waiting))
+        syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+int ring_connect(RingClient* c, const char* name)
+{
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size != sizeof(RingSegment))
+    {
+        close(fd);
+        return 0;
+    }
+
+    void* mem = mmap(NULL, sizeof(RingSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+        return 0;
+
+    c->segment = (RingSegment*) mem;
+    c->channel = NULL;
+    if (c->segment->magic != RING_MAGIC || !atomic_load(&c->segment->running))
+    {
+        munmap(mem, sizeof(RingSegment));
+        return 0;
+    }
+
+    // Channels released by producers become free once the engine resets them
+    int closing = 1;
+    while (c->channel == NULL && closing && atomic_load(&c->segment->running))
+    {
+        closing = 0;
+        for (int k = 0; k < RING_N_CHANNELS && c->channel == NULL; k++)
+        {
+            uint32_t expected = CHANNEL_FREE;
+            if (atomic_compare_exchange_strong(&c->segment->channels[k].state, &expected, CHANNEL_OPEN))
+                c->channel = &c->segment->channels[k];
+            closing |= (expected == CHANNEL_CLOSING);
+        }
+        if (c->channel == NULL && closing)
+            sched_yield();
+    }
+
+    if (c->channel == NULL)
+    {
+        munmap(mem, sizeof(RingSegment));
+        return 0;
+    }
+
+    ring_notify(&c->segment->doorbell, &c->segment->engine_waiting);
+    return 1;
+}
+
+void ring_disconnect(RingClient* c)
+{
+    atomic_store(&c->channel->state, CHANNEL_CLOSING);
+    ring_notify(&c->segment->doorbell, &c->segment->engine_waiting);
+    munmap(c->segment, sizeof(RingSegment));
+    c->segment = NULL;
+    c->channel = NULL;
+}
+
+int ring_send(RingClient* c, const char* code, uint32_t len)
+{
+    if (len > RING_LEN - 4 || !atomic_load(&c->segment->running)
+        || atomic_load(&c->channel->state) != CHANNEL_OPEN)
+        return 0;
+
+    // A full ring empties as the engine answers, which writes responses.
+    // The word is read before each check, so a change after it is not missed
+    for (int spins = 0; ; spins++)
+    {
+        uint32_t seen = atomic_load(&c->channel->responses);
+        if (ring_push_frame(&c->channel->requests, code, len))
+            break;
+        if (!ring_pause(c, seen, spins))
+            return 0;
+    }
+
+    ring_notify(&c->segment->doorbell, &c->segment->engine_waiting);
+    return 1;
+}
+
+int ring_receive(RingClient* c, StrBuf* out)
+{
+    size_t start = out->len;
+    int popped;
+    for (int spins = 0; ; spins++)
+    {
+        uint32_t seen = atomic_load(&c->channel->responses);
+        if ((popped = ring_pop_frame(&c->channel->replies, out)) != 0)
+            break;
+        if (!ring_pause(c, seen, spins))
+            return -1;
+    }
+
+    // The engine may be waiting for room for its next response
+    ring_notify(&c->segment->doorbell, &c->segment->engine_waiting);
+
+    // Every response starts with its status
+    if (popped < 0 || out->len == start)
+        return -1;
+
+    int status = out->data[start];
+    memmove(out->data + start, out->data + start + 1, out->len - start - 1);
+    out->len--;
+    out->data[out->len] = '\0';
+    return status;
+}
@@ -0,0 +1,188 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "strbuf.h"
+
+// ----- SHARED MEMORY RINGS -----
+
+// Requests and responses are exchanged through a shared memory segment
+// made of channels. Each producer process claims a channel, with a ring
+// for its requests and a ring for their responses, whose records are the
+// frames of the server (see server.h). Both rings have a single writer
+// and a single reader, so they need no locks, and a side only makes a
+// system call to sleep when there is nothing to do, or to wake the other
+// side when it sleeps
+
+// Size of each ring, in bytes (a power of 2). Requests and responses must
+// fit in a ring with their length
+#define RING_LEN (1 << 16)
+
+// Number of channels of a segment, and so of concurrent producers
+#define RING_N_CHANNELS 16
+
+// Number of checks for new work before going to sleep, when the machine
+// has several processors. Otherwise a side sleeps right away, since it
+// would only delay the other one
+#define RING_SPIN 2000
+
+// Longest sleep, in milliseconds, before checking whether the other side
+// has stopped
+#define RING_SLEEP_MS 100
+
+// Identifies a segment of this version
+#define RING_MAGIC 0x52494e47
+
+/**
+ * States of a channel
+ */
+typedef enum channel_state
+{
+    CHANNEL_FREE,
+    CHANNEL_OPEN,           // Claimed by a producer
+    CHANNEL_CLOSING,        // Released by its producer, to be reset by the engine
+    CHANNEL_BROKEN,         // Closed by the engine after a corrupt frame, until its producer releases it
+} ChannelState;
+
+/**
+ * Contains a single-producer single-consumer queue of frames. Positions
+ * grow without bound and wrap around the data
+ */
+typedef struct ring
+{
+    _Atomic uint32_t head;  // Position of the next byte to read
+    char pad_head[60];      // Keeps the reader and the writer on separate cache lines
+    _Atomic uint32_t tail;  // Position after the last byte written
+    char pad_tail[60];
+    char data[RING_LEN];
+} Ring;
+
+/**
+ * Contains the rings of a producer
+ */
+typedef struct channel
+{
+    _Atomic uint32_t state;         // ChannelState
+    _Atomic uint32_t responses;     // Futex word, changed when responses are written
+    _Atomic uint32_t waiting;       // Whether the producer sleeps on ```responses```
+    Ring requests;
+    Ring replies;
+} Channel;
+
+/**
+ * Contains a shared memory segment
+ */
+typedef struct ring_segment
+{
+    uint32_t magic;
+    uint32_t spin;                  // Number of checks before sleeping
+    _Atomic uint32_t running;       // Whether the engine serves the segment
+    _Atomic uint32_t doorbell;      // Futex word, changed when the engine has work
+    _Atomic uint32_t engine_waiting;// Whether the engine sleeps on ```doorbell```
+    Channel channels[RING_N_CHANNELS];
+} RingSegment;
+
+/**
+ * Contains the connection of a producer to a segment
+ */
+typedef struct ring_client
+{
+    RingSegment* segment;
+    Channel* channel;
+} RingClient;
+
+/**
+ * Writes a frame to a ring, if there is room for it
+ *
+ * @param r The ring
+ * @param payload The contents of the frame
+ * @param len The length of the contents
+ *
+ * @return Boolean-like value, false if the ring is too full
+ *
+ * @note Only the writer of the ring may call it
+ */
+int ring_push_frame(Ring* r, const char* payload, uint32_t len);
+
+/**
+ * Reads the next frame of a ring, if there is one
+ *
+ * @param r The ring
+ * @param out Where to append the contents of the frame, which must be
+ * able to grow
+ *
+ * @return ```1``` if a frame was read, ```0``` if the ring is empty, or
+ * ```-1``` if the ring is corrupt: its positions or the length of its next
+ * frame cannot have been written by ```ring_push_frame```. Nothing is read
+ * from a corrupt ring
+ *
+ * @note Only the reader of the ring may call it
+ */
+int ring_pop_frame(Ring* r, StrBuf* out);
+
+/**
+ * Sleeps until a futex word differs from a value, or for a while
+ *
+ * @param word The word
+ * @param seen The value
+ * @param waiting A flag raised while sleeping, so that the other side
+ * knows it has to wake this one
+ */
+void ring_wait(_Atomic uint32_t* word, uint32_t seen, _Atomic uint32_t* waiting);
+
+/**
+ * Changes a futex word and wakes the side sleeping on it, if it sleeps
+ *
+ * @param word The word
+ * @param waiting The flag of the side that may sleep on it
+ */
+void ring_notify(_Atomic uint32_t* word, _Atomic uint32_t* waiting);
+
+/**
+ * Connects a producer to a segment created by an engine, claiming one of
+ * its channels
+ *
+ * @param c Where to store the connection
+ * @param name The name of the segment
+ *
+ * @return Boolean-like value, false if the segment cannot be opened, is not
+ * served or has no free channels
+ *
+ * @note Remember to call ```ring_disconnect``` afterwards
+ */
+int ring_connect(RingClient* c, const char* name);
+
+/**
+ * Releases the channel of a producer and disconnects from the segment
+ *
+ * @param c The connection
+ */
+void ring_disconnect(RingClient* c);
+
+/**
+ * Sends a request, waiting for room if the request ring is full
+ *
+ * @param c The connection
+ * @param code The code
+ * @param len The length of the code
+ *
+ * @return Boolean-like value, false if the request does not fit in a ring,
+ * or the engine has stopped or has closed the channel
+ */
+int ring_send(RingClient* c, const char* code, uint32_t len);
+
+/**
+ * Receives the response to the oldest request without one, waiting for
+ * it if needed
+ *
+ * @param c The connection
+ * @param out Where to append what the console would print for the request
+ *
+ * @return The ResponseStatus of the request, or ```-1``` if the engine
+ * has stopped or has closed the channel, or the response is corrupt
+ */
+int ring_receive(RingClient* c, StrBuf* out);
+
+#endif  // RING_H
@@ -0,0 +1,144 @@
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "script.h"
+
+// ----- SCRIPTS -----
+
+// Auxiliary functions
+
+/**
+ * Releases the pages of a script before a position, which will not be
+ * read again. The file is mapped read-only, so they are dropped from
+ * memory instead of written back
+ *
+ * @param s The script
+ * @param pos The position
+ */
+void release_script(Script* s, int pos)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    int end = pos - pos % page;
+    if (end - s->released < SCRIPT_RELEASE_LEN)
+        return;
+
+    madvise((char*) s->text + s->released, end - s->released, MADV_DONTNEED);
+    s->released = end;
+}
+
+
+// Public functions
+
+int open_script(Script* s, const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    // Positions in the text are ints
+    if (st.st_size > INT_MAX)
+    {
+        close(fd);
+        errno = EFBIG;
+        return 0;
+    }
+
+    *s = (Script) {
+        .text = "",
+        .size = st.st_size,
+        .pos = 0,
+        .next = { 1, 1 },
+        .released = 0,
+    };
+
+    // Empty files cannot be mapped
+    if (s->size > 0)
+    {
+        void* text = mmap(NULL, s->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED)
+        {
+            close(fd);
+            return 0;
+        }
+        madvise(text, s->size, MADV_SEQUENTIAL);
+        s->text = (const char*) text;
+    }
+
+    // The mapping stays valid after the file is closed
+    close(fd);
+    return 1;
+}
+
+void close_script(Script* s)
+{
+    if (s->size > 0)
+        munmap((void*) s->text, s->size);
+    s->text = NULL;
+}
+
+int next_statement(Script* s, Lexer* l)
+{
+    release_script(s, s->pos);
+
+    while (s->pos < s->size)
+    {
+        int start = s->pos, depth = 0, empty = 1;
+        Position pos = s->next;
+
+        // Find the separator that ends the statement
+        int end = start;
+        for (; end < s->size; end++)
+        {
+            char c = s->text[end];
+            if (c == '(')
+                depth++;
+            else if (c == ')')
+                depth--;
+            else if (depth <= 0 && (c == ';' || c == '\n'))
+                break;
+
+            if (c == '\n')
+            {
+                s->next.row++;
+                s->next.col = 1;
+            }
+            else
+                s->next.col++;
+
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+                empty = 0;
+        }
+
+        // Skip the separator
+        s->pos = end;
+        if (end < s->size)
+        {
+            s->pos++;
+            if (s->text[end] == '\n')
+            {
+                s->next.row++;
+                s->next.col = 1;
+            }
+            else
+                s->next.col++;
+        }
+
+        if (!empty)
+        {
+            *l = new_sub_lexer(s->text, start, end, pos);
+            return 1;
+        }
+    }
+    return 0;
+}
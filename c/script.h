@@ -0,0 +1,59 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+#include "lexer.h"
+
+// ----- SCRIPTS -----
+
+// Length of text (in characters) run between releases of the pages of a
+// script that have already been run
+#define SCRIPT_RELEASE_LEN (16 << 20)
+
+/**
+ * Contains a script file mapped into memory, which is run one statement
+ * at a time
+ */
+typedef struct script
+{
+    const char* text;       // Contents of the file (not null-terminated)
+    int size;
+    int pos;                // Start of the next statement
+    Position next;          // Row and column of the start of the next statement
+    int released;           // Length of the prefix whose pages were released
+} Script;
+
+/**
+ * Maps a script file into memory
+ *
+ * @param s Where to store the script
+ * @param path The path of the file
+ *
+ * @return Boolean-like value, with ```errno``` set on failure
+ *
+ * @note Remember to call ```close_script``` afterwards
+ */
+int open_script(Script* s, const char* path);
+
+/**
+ * Unmaps a script file
+ *
+ * @param s The script
+ */
+void close_script(Script* s);
+
+/**
+ * Finds the next statement of a script. Statements are separated by
+ * ```';'``` or by newlines outside parentheses, which may be CRLF line
+ * endings, and empty ones are skipped
+ *
+ * @param s The script
+ * @param l Where to store a lexer for the statement
+ *
+ * @return Boolean-like value, false once the script has been run
+ *
+ * @note The pages of the statements before the one found may be released,
+ * so only the text of the latest statement is kept in memory
+ */
+int next_statement(Script* s, Lexer* l);
+
+#endif  // SCRIPT_H
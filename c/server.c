@@ -0,0 +1,707 @@
+#define _GNU_SOURCE     // accept4
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.h"
+
+// ----- SERVER -----
+
+/**
+ * Contains the state of a client connected to the server
+ */
+typedef struct connection Connection;
+struct connection
+{
+    int fd;
+    Session session;
+    char* in;               // Bytes received and not yet handled
+    size_t in_len;
+    size_t in_cap;
+    StrBuf out;             // Responses not yet sent
+    size_t out_pos;         // Bytes of ```out``` already sent
+    int writing;            // Whether it waits for the socket to take more bytes
+    int eof;                // Whether the client has stopped sending
+    Connection* prev;
+    Connection* next;
+};
+
+/**
+ * Contains the state of a server
+ */
+typedef struct server
+{
+    int epoll_fd;
+    int listen_fd;
+    int signal_fd;
+    Connection* connections;
+    ThreadPool* pool;
+    int n_threads;
+    const Budget* budget;   // Limits of the requests of every session
+} Server;
+
+/**
+ * Contains the state of the engine for a channel of a shared memory segment
+ */
+typedef struct channel_server
+{
+    Session session;
+    int open;               // Whether the session belongs to a producer
+    StrBuf code;            // Request being answered
+    StrBuf out;             // Response frame waiting for room in the ring
+} ChannelServer;
+
+// Auxiliary functions
+
+/**
+ * Reads the length of a frame
+ *
+ * @param p The first byte of the length
+ *
+ * @return The length
+ */
+uint32_t read_frame_length(const char* p)
+{
+    const unsigned char* u = (const unsigned char*) p;
+    return ((uint32_t) u[0] << 24) | ((uint32_t) u[1] << 16)
+        | ((uint32_t) u[2] << 8) | u[3];
+}
+
+/**
+ * Writes the length of a frame
+ *
+ * @param p Where to write the length
+ * @param len The length
+ */
+void write_frame_length(char* p, uint32_t len)
+{
+    p[0] = (char) (len >> 24);
+    p[1] = (char) (len >> 16);
+    p[2] = (char) (len >> 8);
+    p[3] = (char) len;
+}
+
+/**
+ * Runs a request and appends its response frame to a buffer
+ *
+ * @param s The session of the client
+ * @param code The code of the request
+ * @param len The length of the code
+ * @param out The buffer
+ */
+void answer_request(Session* s, const char* code, size_t len, StrBuf* out)
+{
+    // The length and status are filled once the output is known
+    size_t start = out->len;
+    str_buf_append(out, "\0\0\0\0\0", 5);
+
+    Lexer l = new_sub_lexer(code, 0, (int) len, (Position) { 1, 1 });
+    int ok = run_code(s, &l, out);
+
+    write_frame_length(out->data + start, out->len - start - 4);
+    out->data[start + 4] = (char) ((ok) ? RESPONSE_OK : RESPONSE_ERROR);
+}
+
+/**
+ * Runs the complete requests received from a client, and keeps the rest
+ *
+ * @param s The session of the client
+ * @param in The bytes received
+ * @param in_len The number of bytes received, which is updated
+ * @param out Where to append the responses
+ *
+ * @return Boolean-like value, false if a request is too large
+ */
+int answer_requests(Session* s, char* in, size_t* in_len, StrBuf* out)
+{
+    size_t pos = 0;
+    while (*in_len - pos >= 4)
+    {
+        uint32_t len = read_frame_length(in + pos);
+        if (len > SERVER_MAX_REQUEST)
+            return 0;
+        if (*in_len - pos - 4 < len)
+            break;
+
+        answer_request(s, in + pos + 4, len, out);
+        pos += 4 + len;
+    }
+
+    memmove(in, in + pos, *in_len - pos);
+    *in_len -= pos;
+    return 1;
+}
+
+/**
+ * Selects the events a connection waits for: more requests, or room to
+ * send its pending responses
+ *
+ * @param srv The server
+ * @param c The connection
+ * @param writing Whether it has responses pending
+ */
+void watch_connection(Server* srv, Connection* c, int writing)
+{
+    if (c->writing == writing)
+        return;
+
+    // Clients that do not read their responses are not read either
+    struct epoll_event ev = {
+        .events = (writing) ? EPOLLOUT : EPOLLIN,
+        .data.ptr = c,
+    };
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->writing = writing;
+}
+
+/**
+ * Sends as many pending responses of a connection as the socket takes
+ *
+ * @param c The connection
+ *
+ * @return ```1``` if every response was sent, ```0``` if some are
+ * pending, or ```-1``` on error
+ */
+int send_responses(Connection* c)
+{
+    while (c->out_pos < c->out.len)
+    {
+        ssize_t n = send(c->fd, c->out.data + c->out_pos,
+                         c->out.len - c->out_pos, MSG_NOSIGNAL);
+        if (n < 0)
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        c->out_pos += n;
+    }
+
+    clear_str_buf(&c->out);
+    c->out_pos = 0;
+    return 1;
+}
+
+/**
+ * Closes a connection and frees its session
+ *
+ * @param srv The server
+ * @param c The connection
+ */
+void close_connection(Server* srv, Connection* c)
+{
+    if (c->prev)
+        c->prev->next = c->next;
+    else
+        srv->connections = c->next;
+    if (c->next)
+        c->next->prev = c->prev;
+
+    close(c->fd);
+    free_session(&c->session);
+    free_str_buf(&c->out);
+    free(c->in);
+    free(c);
+}
+
+/**
+ * Accepts the pending clients of a server
+ *
+ * @param srv The server
+ */
+void accept_connections(Server* srv)
+{
+    while (1)
+    {
+        int fd = accept4(srv->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+            return;
+
+        Connection* c = (Connection*) malloc(sizeof(Connection));
+        *c = (Connection) {
+            .fd = fd,
+            .session = new_session(srv->pool, srv->n_threads),
+            .in = (char*) malloc(SERVER_READ_LEN),
+            .in_len = 0,
+            .in_cap = SERVER_READ_LEN,
+            .out = new_str_buf(256),
+            .out_pos = 0,
+            .writing = 0,
+            .eof = 0,
+            .prev = NULL,
+            .next = srv->connections,
+        };
+        c->session.budget = *srv->budget;
+        if (srv->connections)
+            srv->connections->prev = c;
+        srv->connections = c;
+
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = c };
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+/**
+ * Handles the events of a connection: reads and runs its requests, and
+ * sends their responses
+ *
+ * @param srv The server
+ * @param c The connection
+ * @param events The events
+ *
+ * @return Boolean-like value, false if the connection must be closed
+ */
+int handle_connection(Server* srv, Connection* c, uint32_t events)
+{
+    if (events & EPOLLIN)
+    {
+        if (c->in_cap - c->in_len < SERVER_READ_LEN)
+        {
+            c->in_cap = c->in_len + SERVER_READ_LEN;
+            c->in = (char*) realloc(c->in, c->in_cap);
+        }
+
+        // A single read per event keeps busy clients from starving the rest
+        ssize_t n = read(c->fd, c->in + c->in_len, SERVER_READ_LEN);
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            return 0;
+        if (n == 0)
+            c->eof = 1;
+        if (n > 0)
+            c->in_len += n;
+
+        if (!answer_requests(&c->session, c->in, &c->in_len, &c->out))
+            return 0;
+    }
+    else if (events & (EPOLLERR | EPOLLHUP) && !(events & EPOLLOUT))
+        return 0;
+
+    // Responses are sent before the connection closes after a half-close
+    int sent = send_responses(c);
+    if (sent < 0)
+        return 0;
+    if (sent && c->eof)
+        return 0;
+
+    watch_connection(srv, c, !sent);
+    return 1;
+}
+
+/**
+ * Opens a listening Unix domain socket
+ *
+ * @param path The path of the socket
+ *
+ * @return The socket, or ```-1``` with ```errno``` set
+ */
+int listen_unix(const char* path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0
+        || listen(fd, SOMAXCONN) < 0)
+    {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Reads exactly a number of bytes from a file descriptor
+ *
+ * @param fd The file descriptor
+ * @param buf Where to store the bytes
+ * @param len The number of bytes
+ *
+ * @return The number of bytes read, which is less than ```len``` only at
+ * the end of the input, or ```-1``` on error
+ */
+ssize_t read_full(int fd, char* buf, size_t len)
+{
+    size_t pos = 0;
+    while (pos < len)
+    {
+        ssize_t n = read(fd, buf + pos, len - pos);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            break;
+        pos += n;
+    }
+    return pos;
+}
+
+/**
+ * Writes a number of bytes to a file descriptor
+ *
+ * @param fd The file descriptor
+ * @param buf The bytes
+ * @param len The number of bytes
+ *
+ * @return Boolean-like value, false on error
+ */
+int write_full(int fd, const char* buf, size_t len)
+{
+    size_t pos = 0;
+    while (pos < len)
+    {
+        ssize_t n = write(fd, buf + pos, len - pos);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            return 0;
+        pos += n;
+    }
+    return 1;
+}
+
+/**
+ * Answers the requests of a channel of a shared memory segment
+ *
+ * @param cs The state of the channel
+ * @param ch The channel
+ *
+ * @return Boolean-like value, false if there was nothing to do
+ */
+int serve_channel(ChannelServer* cs, Channel* ch)
+{
+    int progress = 0;
+
+    // A response without room in the last round goes first
+    if (cs->out.len > 0)
+    {
+        if (!ring_push_frame(&ch->replies, cs->out.data + 4, cs->out.len - 4))
+            return 0;
+        clear_str_buf(&cs->out);
+        progress = 1;
+    }
+
+    for (int k = 0; k < RING_BATCH; k++)
+    {
+        clear_str_buf(&cs->code);
+        int popped = ring_pop_frame(&ch->requests, &cs->code);
+        if (popped == 0)
+            break;
+
+        // A corrupt ring cannot be resynchronized, so the channel is
+        // closed until its producer releases it
+        if (popped < 0)
+        {
+            free_session(&cs->session);
+            cs->open = 0;
+            clear_str_buf(&cs->out);
+            atomic_store(&ch->state, CHANNEL_BROKEN);
+            ring_notify(&ch->responses, &ch->waiting);
+            return 1;
+        }
+
+        answer_request(&cs->session, cs->code.data, cs->code.len, &cs->out);
+        progress = 1;
+
+        // Responses cannot be split, so one that never fits is replaced
+        if (cs->out.len > RING_LEN)
+        {
+            clear_str_buf(&cs->out);
+            str_buf_append(&cs->out, "\0\0\0\0", 4);
+            str_buf_append_char(&cs->out, (char) RESPONSE_ERROR);
+            str_buf_append_str(&cs->out, "Response too large for the ring\n");
+            write_frame_length(cs->out.data, cs->out.len - 4);
+        }
+
+        if (!ring_push_frame(&ch->replies, cs->out.data + 4, cs->out.len - 4))
+            break;
+        clear_str_buf(&cs->out);
+    }
+
+    // Answered requests also leave room for more of them
+    if (progress)
+        ring_notify(&ch->responses, &ch->waiting);
+    return progress;
+}
+
+/**
+ * Opens or closes the session of a channel when its producer claims or
+ * releases it
+ *
+ * @param cs The state of the channel
+ * @param ch The channel
+ * @param pool The workers for huge expressions
+ * @param n_threads The number of threads used to lex huge requests
+ * @param budget The limits of each request
+ *
+ * @return Boolean-like value, false if the channel did not change
+ */
+int update_channel(ChannelServer* cs, Channel* ch, ThreadPool* pool, int n_threads, 
+                   const Budget* budget)
+{
+    uint32_t state = atomic_load(&ch->state);
+    if (state == CHANNEL_OPEN && !cs->open)
+    {
+        cs->session = new_session(pool, n_threads);
+        cs->session.budget = *budget;
+        cs->open = 1;
+        return 1;
+    }
+
+    if (state == CHANNEL_CLOSING)
+    {
+        if (cs->open)
+            free_session(&cs->session);
+        cs->open = 0;
+        clear_str_buf(&cs->out);
+        atomic_store(&ch->requests.head, 0);
+        atomic_store(&ch->requests.tail, 0);
+        atomic_store(&ch->replies.head, 0);
+        atomic_store(&ch->replies.tail, 0);
+        atomic_store(&ch->state, CHANNEL_FREE);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Checks whether the process has received ```SIGINT``` or ```SIGTERM```,
+ * which are blocked while serving
+ *
+ * @return Boolean-like value
+ */
+int stop_requested()
+{
+    sigset_t pending;
+    sigpending(&pending);
+    return sigismember(&pending, SIGINT) || sigismember(&pending, SIGTERM);
+}
+
+
+// Public functions
+
+int serve_socket(const char* path, ThreadPool* pool, int n_threads, const Budget* budget)
+{
+    Server srv = {
+        .epoll_fd = -1,
+        .listen_fd = -1,
+        .signal_fd = -1,
+        .connections = NULL,
+        .pool = pool,
+        .n_threads = n_threads,
+        .budget = budget,
+    };
+
+    // Termination signals are read as events, so the socket is removed
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+    srv.listen_fd = listen_unix(path);
+    srv.signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    srv.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (srv.listen_fd < 0 || srv.signal_fd < 0 || srv.epoll_fd < 0)
+    {
+        fprintf(stderr, "Cannot serve on '%s': %s\n", path, strerror(errno));
+        if (srv.listen_fd >= 0)
+            close(srv.listen_fd);
+        if (srv.signal_fd >= 0)
+            close(srv.signal_fd);
+        if (srv.epoll_fd >= 0)
+            close(srv.epoll_fd);
+        return 0;
+    }
+
+    // The listening and signal descriptors are told apart by address
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &srv.listen_fd };
+    epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.listen_fd, &ev);
+    ev.data.ptr = &srv.signal_fd;
+    epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.signal_fd, &ev);
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    int stop = 0;
+    while (!stop)
+    {
+        int n = epoll_wait(srv.epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            break;
+
+        for (int k = 0; k < n; k++)
+        {
+            void* source = events[k].data.ptr;
+            if (source == &srv.listen_fd)
+                accept_connections(&srv);
+            else if (source == &srv.signal_fd)
+                stop = 1;
+            else if (!handle_connection(&srv, (Connection*) source, events[k].events))
+                close_connection(&srv, (Connection*) source);
+        }
+    }
+
+    while (srv.connections)
+        close_connection(&srv, srv.connections);
+    close(srv.epoll_fd);
+    close(srv.signal_fd);
+    close(srv.listen_fd);
+    unlink(path);
+    return 1;
+}
+
+int serve_pipes(int in_fd, int out_fd, ThreadPool* pool, int n_threads, const Budget* budget)
+{
+    Session s = new_session(pool, n_threads);
+    s.budget = *budget;
+    StrBuf out = new_str_buf(256);
+    char* code = NULL;
+    int ok = 1;
+
+    // A closed reader ends the loop through the failed write
+    signal(SIGPIPE, SIG_IGN);
+
+    while (1)
+    {
+        char header[4];
+        ssize_t n = read_full(in_fd, header, 4);
+        if (n == 0)
+            break;
+        if (n < 4)
+        {
+            ok = 0;
+            break;
+        }
+
+        uint32_t len = read_frame_length(header);
+        if (len > SERVER_MAX_REQUEST)
+        {
+            ok = 0;
+            break;
+        }
+
+        code = (char*) realloc(code, len + 1);
+        if (read_full(in_fd, code, len) != (ssize_t) len)
+        {
+            ok = 0;
+            break;
+        }
+
+        answer_request(&s, code, len, &out);
+        if (!write_full(out_fd, out.data, out.len))
+        {
+            ok = 0;
+            break;
+        }
+        clear_str_buf(&out);
+    }
+
+    free(code);
+    free_str_buf(&out);
+    free_session(&s);
+    return ok;
+}
+
+int serve_ring(const char* name, ThreadPool* pool, int n_threads, const Budget* budget)
+{
+    // A segment left by an engine that did not stop cleanly is replaced
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, sizeof(RingSegment)) < 0)
+    {
+        fprintf(stderr, "Cannot create the segment '%s': %s\n", name, strerror(errno));
+        if (fd >= 0)
+        {
+            close(fd);
+            shm_unlink(name);
+        }
+        return 0;
+    }
+
+    // The new segment is filled with zeros: every channel is free and empty
+    RingSegment* seg = (RingSegment*) mmap(NULL, sizeof(RingSegment),
+        PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (seg == MAP_FAILED)
+    {
+        fprintf(stderr, "Cannot map the segment '%s': %s\n", name, strerror(errno));
+        shm_unlink(name);
+        return 0;
+    }
+    seg->magic = RING_MAGIC;
+    seg->spin = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? RING_SPIN : 0;
+    atomic_store(&seg->running, 1);
+
+    ChannelServer* servers = (ChannelServer*) malloc(RING_N_CHANNELS * sizeof(ChannelServer));
+    for (int k = 0; k < RING_N_CHANNELS; k++)
+    {
+        servers[k].open = 0;
+        servers[k].code = new_str_buf(256);
+        servers[k].out = new_str_buf(256);
+    }
+
+    // Termination signals stay pending until they are checked
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, NULL);
+
+    int spins = 0, rounds = 0;
+    while (1)
+    {
+        // Read before the checks, so a change after them is not missed
+        uint32_t seen = atomic_load(&seg->doorbell);
+        int progress = 0;
+        for (int k = 0; k < RING_N_CHANNELS; k++)
+        {
+            progress |= update_channel(&servers[k], &seg->channels[k], pool, n_threads, budget);
+            if (servers[k].open)
+                progress |= serve_channel(&servers[k], &seg->channels[k]);
+        }
+
+        if (progress)
+        {
+            spins = 0;
+            if (++rounds % RING_SIGNAL_ROUNDS == 0 && stop_requested())
+                break;
+            continue;
+        }
+
+        if ((uint32_t) ++spins < seg->spin)
+            continue;
+        if (stop_requested())
+            break;
+        ring_wait(&seg->doorbell, seen, &seg->engine_waiting);
+    }
+
+    // Producers waiting for responses find out that the engine stopped
+    atomic_store(&seg->running, 0);
+    for (int k = 0; k < RING_N_CHANNELS; k++)
+    {
+        ring_notify(&seg->channels[k].responses, &seg->channels[k].waiting);
+        if (servers[k].open)
+            free_session(&servers[k].session);
+        free_str_buf(&servers[k].code);
+        free_str_buf(&servers[k].out);
+    }
+    free(servers);
+    munmap(seg, sizeof(RingSegment));
+    shm_unlink(name);
+    return 1;
+}
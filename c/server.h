@@ -0,0 +1,84 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "session.h"
+#include "ring.h"
+
+// ----- SERVER -----
+
+// Requests and responses are frames: a 4-byte big-endian length followed
+// by that many bytes. A request holds code, as a console line would. A
+// response holds a ResponseStatus byte followed by what the console would
+// print for the code: its value and a newline, nothing for definitions,
+// or the error message
+
+// Largest request accepted, in bytes. Larger ones close the connection
+#define SERVER_MAX_REQUEST (16 << 20)
+
+// Size of each read from a connection
+#define SERVER_READ_LEN (64 * 1024)
+
+// Largest number of events handled per wait
+#define SERVER_MAX_EVENTS 64
+
+// Largest number of requests of a channel answered in a row, before
+// moving to the next channel
+#define RING_BATCH 64
+
+// Number of busy rounds over the channels between checks for signals
+#define RING_SIGNAL_ROUNDS 4096
+
+/**
+ * Outcomes of a request
+ */
+typedef enum response_status
+{
+    RESPONSE_OK,
+    RESPONSE_ERROR,
+} ResponseStatus;
+
+/**
+ * Serves requests on a Unix domain socket until the process receives
+ * ```SIGINT``` or ```SIGTERM```. Each connection has its own session,
+ * which persists between its requests. Requests are run one at a time
+ * on the calling thread, in the order they arrive
+ *
+ * @param path The path of the socket, which is replaced if it exists
+ * @param pool The workers for huge expressions, shared by the sessions
+ * @param n_threads The number of threads used to lex huge requests
+ * @param budget The limits of each request
+ *
+ * @return Boolean-like value, false if the socket cannot be set up
+ */
+int serve_socket(const char* path, ThreadPool* pool, int n_threads, const Budget* budget);
+
+/**
+ * Serves requests read from a file descriptor, with a single session,
+ * until it is closed
+ *
+ * @param in_fd Where to read the requests
+ * @param out_fd Where to write the responses
+ * @param pool The workers for huge expressions
+ * @param n_threads The number of threads used to lex huge requests
+ * @param budget The limits of each request
+ *
+ * @return Boolean-like value, false on a read, write or framing error
+ */
+int serve_pipes(int in_fd, int out_fd, ThreadPool* pool, int n_threads, const Budget* budget);
+
+/**
+ * Serves requests written to a shared memory segment (see ring.h) until
+ * the process receives ```SIGINT``` or ```SIGTERM```. Each channel has its
+ * own session while a producer holds it. Requests are answered in batches
+ * on the calling thread
+ *
+ * @param name The name of the segment, which is replaced if it exists
+ * @param pool The workers for huge expressions, shared by the sessions
+ * @param n_threads The number of threads used to lex huge requests
+ * @param budget The limits of each request
+ *
+ * @return Boolean-like value, false if the segment cannot be set up
+ */
+int serve_ring(const char* name, ThreadPool* pool, int n_threads, const Budget* budget);
+
+#endif  // SERVER_H
@@ -0,0 +1,136 @@
+#include "session.h"
+#include "parser.h"
+#include "typing.h"
+#include "fusion.h"
+
+// ----- SESSIONS -----
+
+Session new_session(ThreadPool* pool, int n_threads)
+{
+    return (Session) {
+        .symbols = new_symbol_table(),
+        .env = new_environment(),
+        .functions = new_function_table(),
+        .pool = pool,
+        .n_threads = n_threads,
+        .budget = { 0 },
+    };
+}
+
+void free_session(Session* s)
+{
+    free_function_table(&s->functions);
+    free_environment(&s->env);
+    free_symbol_table(&s->symbols);
+}
+
+ASTNode* build_code(Session* s, Lexer* l, LexerResult* lr, Error* err)
+{
+    *lr = tokenize_parallel(l, s->n_threads);
+
+    if (lr->tokens == NULL && lr->size != 0)
+    {
+        *err = lr->err;
+        return NULL;
+    }
+
+    Parser p = new_parser(*lr, &s->symbols);
+    ParserResult pr = parse(&p);
+    if (pr.root)
+        pr = check_types(pr.root, &s->symbols, &s->env, &s->functions);
+
+    if (pr.root == NULL)
+    {
+        *err = pr.err;
+        return NULL;
+    }
+
+    return fuse_operations(pr.root);
+}
+
+Result eval_code(Session* s, ASTNode* root)
+{
+    Interpreter i = new_interpreter(root, &s->env);
+    if (s->pool && plan_forks(root))
+        i.pool = s->pool;
+    set_budget(&i, &s->budget);
+    return interpret(&i);
+}
+
+ASTNode* compile_code(Session* s, Lexer* l, LexerResult* lr, StrBuf* out)
+{
+    Error err;
+    ASTNode* root = build_code(s, l, lr, &err);
+    if (root == NULL)
+    {
+        format_error(out, err);
+        free_lexer_result(lr);
+    }
+    return root;
+}
+
+int run_code(Session* s, Lexer* l, StrBuf* out)
+{
+    LexerResult lr;
+    ASTNode* root = compile_code(s, l, &lr, out);
+    if (root == NULL)
+        return 0;
+
+    Result r = eval_code(s, root);
+
+    if (r.result == NULL)
+    {
+        format_error(out, r.err);
+        free_lexer_result(&lr);
+        free_node(root);
+        return 0;
+    }
+
+    // Definitions have no value to show
+    if (r.result->type != NONE)
+    {
+        format_value(out, r.result);
+        str_buf_append_char(out, '\n');
+    }
+
+    free_value(r.result);
+    free_lexer_result(&lr);
+    free_node(root);
+    return 1;
+}
+
+int parse_budget(const char* spec, Budget* budget)
+{
+    *budget = (Budget) { 0 };
+    while (*spec)
+    {
+        const char* value = strchr(spec, '=');
+        if (value == NULL)
+            return 0;
+        value++;
+
+        // The parsers below would accept a sign, and wrap a negative count
+        if ((*value < '0' || *value > '9') && *value != '.')
+            return 0;
+
+        char* end;
+        size_t len = value - spec - 1;
+        if (len == 5 && strncmp(spec, "steps", len) == 0)
+            budget->max_steps = strtoull(value, &end, 10);
+        else if (len == 5 && strncmp(spec, "depth", len) == 0)
+            budget->max_depth = (int) strtol(value, &end, 10);
+        else if (len == 6 && strncmp(spec, "memory", len) == 0)
+            budget->max_memory = strtoull(value, &end, 10);
+        else if (len == 4 && strncmp(spec, "time", len) == 0)
+            budget->max_seconds = strtod(value, &end);
+        else
+            return 0;
+
+        if (end == value || (*end != ',' && *end != '\0'))
+            return 0;
+        spec = (*end == ',') ? end + 1 : end;
+        if (*end == ',' && *spec == '\0')
+            return 0;
+    }
+    return 1;
+}
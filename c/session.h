@@ -0,0 +1,115 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "lexer.h"
+#include "symbols.h"
+#include "interpreter.h"
+#include "parallel.h"
+
+// ----- SESSIONS -----
+
+/**
+ * Contains the variables and functions shared by the code run in a
+ * console, script or server connection
+ */
+typedef struct session
+{
+    SymbolTable symbols;
+    Environment env;
+    FunctionTable functions;
+    ThreadPool* pool;       // Workers for huge expressions (```NULL``` to run sequentially)
+    int n_threads;          // Threads used to lex huge texts
+    Budget budget;          // Limits of each line, statement, request or row (none by default)
+} Session;
+
+/**
+ * Creates an empty session
+ *
+ * @param pool The workers for huge expressions, or ```NULL```
+ * @param n_threads The number of threads used to lex huge texts
+ *
+ * @return The new session
+ *
+ * @note Remember to call ```free_session``` afterwards
+ * @note The pool is not owned by the session, and several sessions may
+ * share it as long as they run code one at a time
+ */
+Session new_session(ThreadPool* pool, int n_threads);
+
+/**
+ * Frees the variables and functions of a session
+ *
+ * @param s The session
+ */
+void free_session(Session* s);
+
+/**
+ * Lexes, parses and types a line or statement, which is left ready to be
+ * interpreted with the environment of the session
+ *
+ * @param s The session
+ * @param l The lexer of the code
+ * @param lr Where to store the tokens, which the AST refers to
+ * @param err Where to store the error, if any
+ *
+ * @return The root of the AST, or ```NULL``` if the code has an error
+ *
+ * @note Remember to call ```free_lexer_result``` afterwards, even if
+ * there was an error, since the names mentioned by the error belong to
+ * the tokens, and ```free_node``` unless there was an error
+ */
+ASTNode* build_code(Session* s, Lexer* l, LexerResult* lr, Error* err);
+
+/**
+ * Interprets the AST of a line or statement with the environment, the
+ * workers and the limits of the session
+ *
+ * @param s The session
+ * @param root The root of the AST, as returned by ```build_code```
+ *
+ * @return The result of the code
+ */
+Result eval_code(Session* s, ASTNode* root);
+
+/**
+ * Lexes, parses and types a line or statement, as ```build_code``` does,
+ * and writes its error, if any
+ *
+ * @param s The session
+ * @param l The lexer of the code
+ * @param lr Where to store the tokens, which the AST refers to
+ * @param out Where to write the error, if any
+ *
+ * @return The root of the AST, or ```NULL``` if the code has an error
+ *
+ * @note Remember to call ```free_node``` and ```free_lexer_result```
+ * afterwards, unless there was an error
+ */
+ASTNode* compile_code(Session* s, Lexer* l, LexerResult* lr, StrBuf* out);
+
+/**
+ * Runs a line or statement and writes its value, or its error, as the
+ * console shows them
+ *
+ * @param s The session
+ * @param l The lexer of the code
+ * @param out Where to write the value or the error
+ *
+ * @return Boolean-like value, false if the code failed
+ */
+int run_code(Session* s, Lexer* l, StrBuf* out);
+
+/**
+ * Reads the limits of evaluations from a list such as
+ * ```steps=1000000,depth=100,memory=1048576,time=0.5```. Memory is given
+ * in bytes and time in seconds
+ *
+ * @param spec The list
+ * @param budget Where to store the limits
+ *
+ * @return Boolean-like value, false if the list is not valid, such as
+ * one with unknown names, missing or negative values or extra characters
+ */
+int parse_budget(const char* spec, Budget* budget);
+
+#endif  // SESSION_H
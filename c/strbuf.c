@@ -0,0 +1,152 @@
+#include "strbuf.h"
+
+// ----- STRING BUFFERS -----
+
+// Auxiliary functions
+
+/**
+ * Null-terminates the contents of a buffer if there is room for it
+ *
+ * @param b The buffer
+ */
+void terminate_str_buf(StrBuf* b)
+{
+    if (b->len < b->cap)
+        b->data[b->len] = '\0';
+}
+
+
+// Public functions
+
+StrBuf new_str_buf(size_t capacity)
+{
+    StrBuf b = {
+        .data = (char*) malloc(capacity + 1),
+        .len = 0,
+        .cap = capacity + 1,
+        .mode = BUF_GROWABLE,
+        .stream = NULL,
+        .truncated = 0,
+    };
+    terminate_str_buf(&b);
+    return b;
+}
+
+StrBuf new_fixed_str_buf(char* data, size_t capacity)
+{
+    StrBuf b = {
+        .data = data,
+        .len = 0,
+        .cap = capacity,
+        .mode = BUF_FIXED,
+        .stream = NULL,
+        .truncated = 0,
+    };
+    terminate_str_buf(&b);
+    return b;
+}
+
+StrBuf new_stream_str_buf(FILE* stream, char* data, size_t capacity)
+{
+    StrBuf b = {
+        .data = data,
+        .len = 0,
+        .cap = capacity,
+        .mode = BUF_STREAM,
+        .stream = stream,
+        .truncated = 0,
+    };
+    return b;
+}
+
+char* str_buf_reserve(StrBuf* b, size_t n)
+{
+    // Keep room for the null terminator
+    if (b->len + n < b->cap)
+        return b->data + b->len;
+
+    switch (b->mode)
+    {
+    case BUF_GROWABLE:
+    {
+        size_t cap = b->cap * 2;
+        if (cap < b->len + n + 1)
+            cap = b->len + n + 1;
+        b->data = (char*) realloc(b->data, cap);
+        b->cap = cap;
+        return b->data + b->len;
+    }
+
+    case BUF_STREAM:
+        flush_str_buf(b);
+        return (n < b->cap) ? b->data : NULL;
+
+    default:
+        return NULL;
+    }
+}
+
+void str_buf_commit(StrBuf* b, size_t n)
+{
+    b->len += n;
+    terminate_str_buf(b);
+}
+
+int str_buf_append(StrBuf* b, const char* s, size_t n)
+{
+    char* p = str_buf_reserve(b, n);
+    if (p)
+    {
+        memcpy(p, s, n);
+        str_buf_commit(b, n);
+        return (int) n;
+    }
+
+    // Blocks larger than a batch writer go straight to the stream
+    if (b->mode == BUF_STREAM)
+        return (int) fwrite(s, 1, n, b->stream);
+
+    // Keep whatever fits in a fixed buffer
+    size_t room = (b->cap > b->len) ? b->cap - b->len - 1 : 0;
+    memcpy(b->data + b->len, s, room);
+    str_buf_commit(b, room);
+    b->truncated = 1;
+    return (int) room;
+}
+
+int str_buf_append_str(StrBuf* b, const char* s)
+{
+    return str_buf_append(b, s, strlen(s));
+}
+
+int str_buf_append_char(StrBuf* b, char c)
+{
+    return str_buf_append(b, &c, 1);
+}
+
+int flush_str_buf(StrBuf* b)
+{
+    if (b->mode != BUF_STREAM || b->len == 0)
+        return 0;
+
+    size_t written = fwrite(b->data, 1, b->len, b->stream);
+    int failed = (written != b->len);
+    b->len = 0;
+    return failed ? EOF : fflush(b->stream);
+}
+
+void clear_str_buf(StrBuf* b)
+{
+    b->len = 0;
+    b->truncated = 0;
+    terminate_str_buf(b);
+}
+
+void free_str_buf(StrBuf* b)
+{
+    flush_str_buf(b);
+    if (b->mode == BUF_GROWABLE)
+        free(b->data);
+    b->data = NULL;
+    b->len = b->cap = 0;
+}
@@ -0,0 +1,148 @@
+#ifndef STRBUF_H
+#define STRBUF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ----- STRING BUFFERS -----
+
+/**
+ * Behaviour of a buffer when it runs out of room
+ */
+typedef enum str_buf_mode
+{
+    BUF_GROWABLE,       // Reallocates its heap storage
+    BUF_FIXED,          // Truncates the output (caller-provided storage)
+    BUF_STREAM,         // Flushes its contents to a stream (batch writer)
+} StrBufMode;
+
+/**
+ * Output buffer for formatted text
+ */
+typedef struct str_buf
+{
+    char* data;
+    size_t len;         // Number of characters stored
+    size_t cap;         // Size of the storage
+    StrBufMode mode;
+    FILE* stream;       // Destination of ```BUF_STREAM``` buffers
+    int truncated;      // Set when a ```BUF_FIXED``` buffer drops output
+} StrBuf;
+
+/**
+ * Creates a buffer that grows on demand
+ *
+ * @param capacity Initial capacity
+ *
+ * @return The new buffer
+ *
+ * @note Remember to call ```free_str_buf``` afterwards
+ */
+StrBuf new_str_buf(size_t capacity);
+
+/**
+ * Creates a buffer over caller-provided storage. Output that does not fit
+ * is dropped and the ```truncated``` flag is set
+ *
+ * @param data The storage
+ * @param capacity The size of the storage
+ *
+ * @return The new buffer
+ *
+ * @note The contents are always null-terminated
+ */
+StrBuf new_fixed_str_buf(char* data, size_t capacity);
+
+/**
+ * Creates a batch writer, which writes its contents to a stream in
+ * blocks, whenever it becomes full or is flushed
+ *
+ * @param stream The destination stream
+ * @param data The storage
+ * @param capacity The size of the storage
+ *
+ * @return The new buffer
+ *
+ * @note Remember to call ```flush_str_buf``` or ```free_str_buf``` afterwards
+ */
+StrBuf new_stream_str_buf(FILE* stream, char* data, size_t capacity);
+
+/**
+ * Obtains room to write characters directly into a buffer
+ *
+ * @param b The buffer
+ * @param n The number of characters to write
+ *
+ * @return A pointer to the room, or ```NULL``` if the buffer cannot hold
+ * ```n``` contiguous characters
+ *
+ * @note Call ```str_buf_commit``` with the number of characters written
+ */
+char* str_buf_reserve(StrBuf* b, size_t n);
+
+/**
+ * Adds the characters written after ```str_buf_reserve``` to a buffer
+ *
+ * @param b The buffer
+ * @param n The number of characters written
+ */
+void str_buf_commit(StrBuf* b, size_t n);
+
+/**
+ * Appends characters to a buffer
+ *
+ * @param b The buffer
+ * @param s The characters
+ * @param n The number of characters
+ *
+ * @return The number of characters appended
+ */
+int str_buf_append(StrBuf* b, const char* s, size_t n);
+
+/**
+ * Appends a null-terminated string to a buffer
+ *
+ * @param b The buffer
+ * @param s The string
+ *
+ * @return The number of characters appended
+ */
+int str_buf_append_str(StrBuf* b, const char* s);
+
+/**
+ * Appends a character to a buffer
+ *
+ * @param b The buffer
+ * @param c The character
+ *
+ * @return The number of characters appended
+ */
+int str_buf_append_char(StrBuf* b, char c);
+
+/**
+ * Writes the contents of a ```BUF_STREAM``` buffer to its stream
+ *
+ * @param b The buffer
+ *
+ * @return ```0``` on success, ```EOF``` on write error
+ *
+ * @note Other buffers are left untouched
+ */
+int flush_str_buf(StrBuf* b);
+
+/**
+ * Removes the contents of a buffer
+ *
+ * @param b The buffer
+ */
+void clear_str_buf(StrBuf* b);
+
+/**
+ * Flushes a buffer and frees the memory it allocated
+ *
+ * @param b The buffer
+ */
+void free_str_buf(StrBuf* b);
+
+#endif  // STRBUF_H
@@ -0,0 +1,145 @@
+#include "symbols.h"
+
+// ----- SYMBOLS -----
+
+// Initial number of symbols and index buckets
+#define SYMBOL_TABLE_INIT_CAP 16
+
+// Auxiliary functions
+
+/**
+ * Hashes a name (FNV-1a)
+ *
+ * @param name The name
+ * @param len The length of the name
+ *
+ * @return The hash of the name
+ */
+uint32_t hash_name(const char* name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char) name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * Obtains the bucket where a name is indexed, or the empty bucket where
+ * it should be indexed
+ *
+ * @param t The table
+ * @param name The name
+ * @param len The length of the name
+ * @param hash The hash of the name
+ *
+ * @return The position of the bucket
+ */
+int find_bucket(const SymbolTable* t, const char* name, size_t len, uint32_t hash)
+{
+    int mask = t->n_buckets - 1;
+    int b = (int) (hash & mask);
+
+    while (t->buckets[b] != -1)
+    {
+        const Symbol* s = &t->symbols[t->buckets[b]];
+        if (s->hash == hash && strncmp(s->name, name, len) == 0
+            && s->name[len] == '\0')
+            return b;
+        b = (b + 1) & mask;
+    }
+
+    return b;
+}
+
+/**
+ * Doubles the number of buckets of a table, reindexing its symbols
+ *
+ * @param t The table
+ */
+void grow_buckets(SymbolTable* t)
+{
+    free(t->buckets);
+    t->n_buckets *= 2;
+    t->buckets = (int*) malloc(t->n_buckets * sizeof(int));
+    memset(t->buckets, -1, t->n_buckets * sizeof(int));
+
+    int mask = t->n_buckets - 1;
+    for (int id = 0; id < t->count; id++)
+    {
+        int b = (int) (t->symbols[id].hash & mask);
+        while (t->buckets[b] != -1)
+            b = (b + 1) & mask;
+        t->buckets[b] = id;
+    }
+}
+
+
+// Public functions
+
+SymbolTable new_symbol_table(void)
+{
+    SymbolTable t = {
+        .symbols = (Symbol*) malloc(SYMBOL_TABLE_INIT_CAP * sizeof(Symbol)),
+        .count = 0,
+        .capacity = SYMBOL_TABLE_INIT_CAP,
+        .buckets = (int*) malloc(SYMBOL_TABLE_INIT_CAP * sizeof(int)),
+        .n_buckets = SYMBOL_TABLE_INIT_CAP,
+    };
+    memset(t.buckets, -1, t.n_buckets * sizeof(int));
+    return t;
+}
+
+int intern_symbol(SymbolTable* t, const char* name, size_t len)
+{
+    uint32_t hash = hash_name(name, len);
+    int b = find_bucket(t, name, len, hash);
+    if (t->buckets[b] != -1)
+        return t->buckets[b];
+
+    // New symbol
+    if (t->count == t->capacity)
+    {
+        t->capacity *= 2;
+        t->symbols = (Symbol*) realloc(t->symbols, t->capacity * sizeof(Symbol));
+    }
+
+    int id = t->count++;
+    Symbol* s = &t->symbols[id];
+    s->name = (char*) malloc(len + 1);
+    memcpy(s->name, name, len);
+    s->name[len] = '\0';
+    s->hash = hash;
+    s->type = INT;
+    s->assigned = 0;
+    t->buckets[b] = id;
+
+    // Keep the load factor at or below 1/2
+    if (2 * t->count > t->n_buckets)
+        grow_buckets(t);
+
+    return id;
+}
+
+int find_symbol(const SymbolTable* t, const char* name, size_t len)
+{
+    return t->buckets[find_bucket(t, name, len, hash_name(name, len))];
+}
+
+Symbol* get_symbol(const SymbolTable* t, int id)
+{
+    return &t->symbols[id];
+}
+
+void free_symbol_table(SymbolTable* t)
+{
+    for (int id = 0; id < t->count; id++)
+        free(t->symbols[id].name);
+    free(t->symbols);
+    free(t->buckets);
+    t->symbols = NULL;
+    t->buckets = NULL;
+    t->count = t->capacity = t->n_buckets = 0;
+}
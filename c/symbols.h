@@ -0,0 +1,81 @@
+#ifndef SYMBOLS_H
+#define SYMBOLS_H
+
+#include "base.h"
+
+// ----- SYMBOLS -----
+
+/**
+ * Contains the compile-time information of an interned name
+ */
+typedef struct symbol
+{
+    char* name;
+    uint32_t hash;
+    TypePriority type;  // Widest type assigned to the symbol
+    int assigned;       // Whether an assignment to the symbol has been parsed
+} Symbol;
+
+/**
+ * Maps names to dense identifiers, which are also their environment slots
+ */
+typedef struct symbol_table
+{
+    Symbol* symbols;    // Symbols, indexed by identifier
+    int count;
+    int capacity;
+    int* buckets;       // Open-addressing index of identifiers (-1 if empty)
+    int n_buckets;      // Always a power of 2
+} SymbolTable;
+
+/**
+ * Creates an empty symbol table
+ *
+ * @return The new table
+ *
+ * @note Remember to call ```free_symbol_table``` afterwards
+ */
+SymbolTable new_symbol_table(void);
+
+/**
+ * Obtains the identifier of a name, adding it to the table if needed
+ *
+ * @param t The table
+ * @param name The name
+ * @param len The length of the name
+ *
+ * @return The identifier of the name
+ */
+int intern_symbol(SymbolTable* t, const char* name, size_t len);
+
+/**
+ * Obtains the identifier of a name without adding it to the table
+ *
+ * @param t The table
+ * @param name The name
+ * @param len The length of the name
+ *
+ * @return The identifier of the name, or ```-1``` if it is not in the table
+ */
+int find_symbol(const SymbolTable* t, const char* name, size_t len);
+
+/**
+ * Obtains the information of a symbol
+ *
+ * @param t The table
+ * @param id The identifier of the symbol
+ *
+ * @return The symbol
+ *
+ * @note The pointer is invalidated when new names are interned
+ */
+Symbol* get_symbol(const SymbolTable* t, int id);
+
+/**
+ * Frees the memory used by a symbol table
+ *
+ * @param t The table
+ */
+void free_symbol_table(SymbolTable* t);
+
+#endif  // SYMBOLS_H
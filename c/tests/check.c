@@ -0,0 +1,32 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "check.h"
+
+// ----- TEST CHECKS -----
+
+int n_failed = 0;
+
+// Public functions
+
+void check(const char* name, int ok)
+{
+    printf("%-40s %s\n", name, ok ? "ok" : "FAILED");
+    n_failed += !ok;
+}
+
+int temp_file(char* path, const char* suffix, const char* text)
+{
+    snprintf(path, CHECK_PATH_LEN, "/tmp/mc_test_XXXXXX%s", suffix);
+    int fd = mkstemps(path, (int) strlen(suffix));
+    if (fd < 0)
+        return 0;
+
+    size_t len = strlen(text);
+    int ok = write(fd, text, len) == (ssize_t) len;
+    close(fd);
+    if (!ok)
+        unlink(path);
+    return ok;
+}
@@ -0,0 +1,39 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// ----- TEST CHECKS -----
+
+// Helpers shared by the tests, whose build commands add tests/check.c
+
+// Room for the path of a temporary file
+#define CHECK_PATH_LEN 64
+
+// Number of failed checks
+extern int n_failed;
+
+/**
+ * Reports the outcome of a check
+ *
+ * @param name The name of the check
+ * @param ok Whether it passed
+ */
+void check(const char* name, int ok);
+
+/**
+ * Creates a temporary file with a name of its own, so that tests run in
+ * parallel do not share their files
+ *
+ * @param path Where to store the path of the file, with room for
+ * ```CHECK_PATH_LEN``` characters
+ * @param suffix The end of the name, such as ```.csv```
+ * @param text The contents of the file
+ *
+ * @return Boolean-like value, false if the file cannot be created
+ *
+ * @note Remember to call ```unlink``` afterwards
+ */
+int temp_file(char* path, const char* suffix, const char* text);
+
+#endif  // CHECK_H
@@ -0,0 +1,90 @@
+/**
+ * Tests of the types of CSV columns: a column is read as decimals if any
+ * of its values is a decimal, unless its binding gives another type
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o test_columns tests/test_columns.c tests/check.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c session.c columns.c -lm -lpthread```
+ */
+
+#include <unistd.h>
+
+#include "../columns.h"
+#include "check.h"
+
+/**
+ * Evaluates an expression over a CSV column and compares the output
+ * column, one value per line, with the expected one
+ *
+ * @param name The name of the check
+ * @param code The expression
+ * @param spec The binding of the input column
+ * @param expected The output column, or ```NULL``` if the evaluation
+ * must fail
+ */
+void check_columns(const char* name, const char* code, const char* spec, const char* expected)
+{
+    char path[CHECK_PATH_LEN];
+    ColumnInput input;
+    ColumnOutput output;
+    int ok = 0;
+
+    if (temp_file(path, ".csv", "") && open_column_input(&input, spec))
+    {
+        if (open_column_output(&output, path))
+        {
+            Session s = new_session(NULL, 1);
+            StrBuf out = new_str_buf(64);
+            Lexer l = new_lexer(code);
+            ok = run_columns(&s, &l, &input, 1, &output, &out);
+            close_column_output(&output);
+            free_str_buf(&out);
+            free_session(&s);
+        }
+        close_column_input(&input);
+    }
+
+    if (ok && expected != NULL)
+    {
+        char text[256] = { 0 };
+        FILE* f = fopen(path, "r");
+        size_t n = fread(text, 1, sizeof(text) - 1, f);
+        fclose(f);
+        ok = (n == strlen(expected) && strcmp(text, expected) == 0);
+    }
+    else
+        ok = (expected == NULL) ? !ok : 0;
+
+    check(name, ok);
+    unlink(path);
+}
+
+int main()
+{
+    char mixed[CHECK_PATH_LEN], ints[CHECK_PATH_LEN];
+    if (!temp_file(mixed, ".csv", "x,y\n1,10\n2.5,20\n\n3,30\n")
+        || !temp_file(ints, ".csv", "x\n1\n2\n"))
+        return 1;
+
+    char spec[128];
+    snprintf(spec, sizeof(spec), "x=%s", mixed);
+    check_columns("mixed column read as decimals", "x * 2", spec, "2.0\n5.0\n6.0\n");
+
+    snprintf(spec, sizeof(spec), "x=%s", ints);
+    check_columns("integer column", "x * 2", spec, "2\n4\n");
+
+    snprintf(spec, sizeof(spec), "x:f64=%s", ints);
+    check_columns("integer column bound as f64", "x * 2", spec, "2.0\n4.0\n");
+
+    snprintf(spec, sizeof(spec), "x:i64=%s", mixed);
+    check_columns("mixed column bound as i64", "x * 2", spec, NULL);
+
+    snprintf(spec, sizeof(spec), "v=%s:y", mixed);
+    check_columns("other field of a mixed file", "v + 1", spec, "11\n21\n31\n");
+
+    snprintf(spec, sizeof(spec), "x:u8=%s", ints);
+    check_columns("unknown type", "x", spec, NULL);
+
+    unlink(mixed);
+    unlink(ints);
+    return n_failed != 0;
+}
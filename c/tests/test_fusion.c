@@ -0,0 +1,92 @@
+/**
+ * Tests of the kernels of fused operations on doubles, which must give
+ * the values of the operations they replace, bit for bit, even where the
+ * compiler could turn a product and a sum into a fused multiply-add
+ *
+ * Build from the ```c``` directory with (```-march=native``` lets the
+ * compiler use the multiply-adds of the processor, if it has them):
+ * ```gcc -O2 -march=native -o test_fusion tests/test_fusion.c tests/check.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c -lm -lpthread```
+ */
+
+#include "../lexer.h"
+#include "../parser.h"
+#include "../interpreter.h"
+#include "../typing.h"
+#include "../fusion.h"
+#include "check.h"
+
+/**
+ * Evaluates a program whose last statement is a float expression
+ *
+ * @param text The program
+ * @param fuse Whether the operations are fused
+ * @param kernel Where to store whether the last statement became a fused
+ * node
+ *
+ * @return The value of the program, or NaN if it failed
+ */
+double evaluate(const char* text, int fuse, int* kernel)
+{
+    SymbolTable symbols = new_symbol_table();
+    Environment env = new_environment();
+    FunctionTable functions = new_function_table();
+
+    Lexer l = new_lexer(text);
+    LexerResult lr = tokenize(&l);
+    Parser p = new_parser(lr, &symbols);
+    ParserResult pr = parse(&p);
+    ASTNode* ast = check_types(pr.root, &symbols, &env, &functions).root;
+    if (fuse)
+        ast = fuse_operations(ast);
+
+    const SequenceNode* sequence = &ast->data.sequence;
+    *kernel = sequence->items[sequence->count - 1]->class == Fused;
+
+    Interpreter i = new_interpreter(ast, &env);
+    Result r = interpret(&i);
+    double value = NAN;
+    if (r.result)
+    {
+        value = r.result->value.decimal;
+        free_value(r.result);
+    }
+
+    free_node(ast);
+    free_lexer_result(&lr);
+    free_function_table(&functions);
+    free_environment(&env);
+    free_symbol_table(&symbols);
+    return value;
+}
+
+/**
+ * Compares the value of a program with its operations fused and not
+ *
+ * @param name The name of the check
+ * @param text The program
+ * @param expected The value
+ */
+void check_kernel(const char* name, const char* text, double expected)
+{
+    int kernel, unfused_kernel;
+    double fused = evaluate(text, 1, &kernel);
+    double unfused = evaluate(text, 0, &unfused_kernel);
+
+    check(name, kernel && !unfused_kernel
+          && memcmp(&fused, &unfused, sizeof(double)) == 0
+          && fused == expected);
+}
+
+int main()
+{
+    // 0.1 * 10 rounds to 1, while a multiply-add would keep its error
+    check_kernel("a * b - c",
+        "a = 0.1; b = 10.0; c = 1.0; a * b - c", 0.0);
+    check_kernel("c - a * b",
+        "a = 0.1; b = 10.0; c = 1.0; c - a * b", 0.0);
+    check_kernel("a * b + c",
+        "a = 0.1; b = 10.0; c = -1.0; a * b + c", 0.0);
+    check_kernel("a * b - c * d",
+        "a = 0.1; b = 10.0; c = 1.0; d = 1.0; a * b - c * d", 0.0);
+    return n_failed != 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * Tests of the limits of evaluations: code that exceeds a limit must fail
+ * with its error and leave the session usable, and malformed lists of
+ * limits must be rejected
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o test_limits tests/test_limits.c tests/check.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c session.c -lm -lpthread```
+ */
+
+#include "../session.h"
+#include "check.h"
+
+/**
+ * Runs a line in a session and compares what it writes with the expected
+ * output
+ *
+ * @param s The session
+ * @param code The line
+ * @param expected The output, or its end for errors, whose positions vary
+ *
+ * @return Boolean-like value, false if the output differs
+ */
+int run_line(Session* s, const char* code, const char* expected)
+{
+    StrBuf out = new_str_buf(64);
+    Lexer l = new_lexer(code);
+    run_code(s, &l, &out);
+
+    size_t len = strlen(expected);
+    int ok = out.len >= len && strcmp(out.data + out.len - len, expected) == 0;
+    free_str_buf(&out);
+    return ok;
+}
+
+/**
+ * Runs a line with some limits, and checks what it writes and the session
+ * afterwards: the variables and functions defined before stay, and new
+ * code runs
+ *
+ * @param name The name of the check
+ * @param limits The list of limits
+ * @param code The line, which usually exceeds them
+ * @param output The message of its error, or its value
+ */
+void check_limit(const char* name, const char* limits, const char* code, const char* output)
+{
+    char expected[64];
+    snprintf(expected, sizeof(expected), "%s\n", output);
+
+    Session s = new_session(NULL, 1);
+    int ok = parse_budget(limits, &s.budget)
+        && run_line(&s, "x = 2", "2\n")
+        && run_line(&s, "fun f(n) = if n then f(n - 1) + 1 else 0", "")
+        && run_line(&s, code, expected)
+        && run_line(&s, "x + f(3)", "5\n")
+        && run_line(&s, code, expected);
+    free_session(&s);
+    check(name, ok);
+}
+
+int main()
+{
+    check_limit("steps in a loop", "steps=10000",
+        "s = 0; for k = 1 to 1000000 do s = s + k", "Step limit exceeded");
+    check_limit("depth of recursion", "depth=50",
+        "f(100)", "Depth limit exceeded");
+    check_limit("memory of a big integer", "memory=1024",
+        "3 ^ 100000", "Memory limit exceeded");
+    check_limit("time of a loop", "time=0.05",
+        "s = 0; for k = 1 to 10000000000 do s = s + k", "Time limit exceeded");
+    check_limit("within every limit", "steps=100000,depth=50,memory=1024,time=5",
+        "f(40) + 3 ^ 10", "59089");
+
+    Budget budget;
+    check("valid list of limits", parse_budget("steps=5,depth=3,memory=64,time=.5", &budget)
+          && budget.max_steps == 5 && budget.max_depth == 3
+          && budget.max_memory == 64 && budget.max_seconds == 0.5);
+    check("empty list of limits", parse_budget("", &budget) && budget.max_steps == 0);
+    check("unknown limit", !parse_budget("steps=5,loops=3", &budget));
+    check("limit without value", !parse_budget("steps=", &budget));
+    check("limit without '='", !parse_budget("steps", &budget));
+    check("negative limit", !parse_budget("steps=-1", &budget));
+    check("extra characters", !parse_budget("depth=3x", &budget));
+    check("trailing separator", !parse_budget("time=1,", &budget));
+    return n_failed != 0;
+}
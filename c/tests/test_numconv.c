@@ -0,0 +1,41 @@
+/**
+ * Tests of the shortest formatting of doubles, which must pick the
+ * nearest digits, and the even ones when two are equally near, as
+ * Python's ```repr``` does
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o test_numconv tests/test_numconv.c tests/check.c numconv.c -lm```
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../numconv.h"
+#include "check.h"
+
+/**
+ * Formats a double and compares the text with the expected one
+ *
+ * @param name The name of the check
+ * @param value The double
+ * @param expected The text
+ */
+void check_format(const char* name, double value, const char* expected)
+{
+    char buf[MAX_DBL_STR_LEN + 1];
+    format_double(value, buf);
+    check(name, strcmp(buf, expected) == 0);
+}
+
+int main()
+{
+    check_format("Short values", 0.1, "0.1");
+    check_format("Seventeen digits", 1.0 / 3, "0.3333333333333333");
+    check_format("Nearest of several digits", 1.6827199780939912e+90, "1.6827199780939912e+90");
+    check_format("Tie rounded down to even", 195752693272994.125, "195752693272994.12");
+    check_format("Tie rounded up to even", 156917603332801.375, "156917603332801.38");
+    check_format("Tie with more decimals", 29604347049884.0625, "29604347049884.062");
+    check_format("Smallest normal", 2.2250738585072014e-308, "2.2250738585072014e-308");
+    check_format("Smallest subnormal", 5e-324, "5e-324");
+    return n_failed != 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * Tests of the shared memory rings against frames that a buggy or hostile
+ * peer may write: corrupt frames must be rejected without reading past
+ * the ring, and the engine must close the channel of a producer that
+ * writes one while it keeps serving the others
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o test_ring tests/test_ring.c tests/check.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c session.c ring.c server.c -lm -lpthread```
+ */
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../ring.h"
+#include "../server.h"
+#include "check.h"
+
+// Number of attempts to connect to the engine, 10 ms apart
+#define N_ATTEMPTS 200
+
+/**
+ * Writes the header of a frame to a ring without its contents, as a peer
+ * that does not use ```ring_push_frame``` could
+ *
+ * @param r The ring
+ * @param len The length written in the header
+ * @param n_bytes The number of bytes the tail moves forward
+ */
+void write_header(Ring* r, uint32_t len, uint32_t n_bytes)
+{
+    uint32_t tail = atomic_load(&r->tail);
+    for (int k = 0; k < 4; k++)
+        r->data[(tail + k) & (RING_LEN - 1)] = (char) (len >> (24 - 8 * k));
+    atomic_store(&r->tail, tail + n_bytes);
+}
+
+/**
+ * Checks that a ring rejects corrupt frames, leaving them unread
+ */
+void test_frames()
+{
+    Ring* r = (Ring*) calloc(1, sizeof(Ring));
+    StrBuf out = new_str_buf(16);
+
+    check("empty ring", ring_pop_frame(r, &out) == 0);
+
+    ring_push_frame(r, "abc", 3);
+    check("valid frame", ring_pop_frame(r, &out) == 1 && out.len == 3
+          && memcmp(out.data, "abc", 3) == 0);
+
+    // The length claims more bytes than were written
+    clear_str_buf(&out);
+    write_header(r, 0xFFFFFFF0, 8);
+    uint32_t head = atomic_load(&r->head);
+    check("length past the tail", ring_pop_frame(r, &out) == -1
+          && out.len == 0 && atomic_load(&r->head) == head);
+
+    // The tail is further than the size of the ring
+    atomic_store(&r->tail, head + RING_LEN + 4);
+    check("tail past the ring", ring_pop_frame(r, &out) == -1 && out.len == 0);
+
+    // Less than a header
+    atomic_store(&r->tail, head + 2);
+    check("partial header", ring_pop_frame(r, &out) == -1 && out.len == 0);
+
+    free_str_buf(&out);
+    free(r);
+}
+
+/**
+ * Checks that a producer rejects a response without its status byte
+ */
+void test_empty_response()
+{
+    RingSegment* seg = (RingSegment*) calloc(1, sizeof(RingSegment));
+    seg->magic = RING_MAGIC;
+    atomic_store(&seg->running, 1);
+    atomic_store(&seg->channels[0].state, CHANNEL_OPEN);
+
+    RingClient c = { .segment = seg, .channel = &seg->channels[0] };
+    StrBuf out = new_str_buf(16);
+    ring_push_frame(&c.channel->replies, "", 0);
+    check("empty response", ring_receive(&c, &out) == -1 && out.len == 0);
+
+    free_str_buf(&out);
+    free(seg);
+}
+
+/**
+ * Sends a request to the engine and checks its response
+ *
+ * @param c The connection
+ * @param code The code
+ * @param expected What the console would print for it
+ *
+ * @return Boolean-like value, false if it failed
+ */
+int request(RingClient* c, const char* code, const char* expected)
+{
+    StrBuf out = new_str_buf(16);
+    int ok = ring_send(c, code, strlen(code)) && ring_receive(c, &out) == RESPONSE_OK
+        && strcmp(out.data, expected) == 0;
+    free_str_buf(&out);
+    return ok;
+}
+
+/**
+ * Checks that an engine closes the channel of a producer that writes a
+ * corrupt frame, and keeps serving new producers
+ */
+void test_engine()
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/mc_test_ring_%d", (int) getpid());
+
+    pid_t engine = fork();
+    if (engine == 0)
+    {
+        Budget budget = { 0 };
+        _exit(serve_ring(name, NULL, 1, &budget) ? 0 : 1);
+    }
+
+    RingClient c;
+    int connected = 0;
+    for (int k = 0; k < N_ATTEMPTS && !connected; k++)
+    {
+        connected = ring_connect(&c, name);
+        if (!connected)
+            usleep(10000);
+    }
+    check("connection", connected);
+    if (!connected)
+    {
+        kill(engine, SIGTERM);
+        waitpid(engine, NULL, 0);
+        return;
+    }
+
+    check("request before the corrupt frame", request(&c, "x = 1 + 2", "3\n"));
+
+    write_header(&c.channel->requests, 1 << 30, 8);
+    ring_notify(&c.segment->doorbell, &c.segment->engine_waiting);
+    StrBuf out = new_str_buf(16);
+    check("corrupt request closes the channel", ring_receive(&c, &out) == -1
+          && atomic_load(&c.channel->state) == CHANNEL_BROKEN);
+    check("requests to a closed channel fail", !ring_send(&c, "1", 1));
+    free_str_buf(&out);
+    ring_disconnect(&c);
+
+    connected = ring_connect(&c, name);
+    check("new producer after the corrupt frame", connected && request(&c, "2 * 3", "6\n"));
+    if (connected)
+        ring_disconnect(&c);
+
+    int status;
+    kill(engine, SIGTERM);
+    waitpid(engine, &status, 0);
+    check("engine stops cleanly", WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main()
+{
+    test_frames();
+    test_empty_response();
+    test_engine();
+    return n_failed != 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * Tests of scripts run statement by statement, with LF and with CRLF
+ * line endings, which must give the same values and error positions
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o test_script tests/test_script.c tests/check.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c session.c script.c -lm -lpthread```
+ */
+
+#include <unistd.h>
+
+#include "../session.h"
+#include "../script.h"
+#include "check.h"
+
+/**
+ * Runs a script as the console does and compares what it writes with the
+ * expected output
+ *
+ * @param name The name of the check
+ * @param text The contents of the script
+ * @param expected The values and the error the script writes
+ */
+void check_script(const char* name, const char* text, const char* expected)
+{
+    char path[CHECK_PATH_LEN];
+    Script script;
+    StrBuf out = new_str_buf(64);
+    int ok = temp_file(path, ".mc", text) && open_script(&script, path);
+    if (ok)
+    {
+        Session s = new_session(NULL, 1);
+        Lexer l;
+        while (next_statement(&script, &l) && run_code(&s, &l, &out))
+            continue;
+        free_session(&s);
+        close_script(&script);
+    }
+
+    check(name, ok && strcmp(out.data, expected) == 0);
+    free_str_buf(&out);
+    unlink(path);
+}
+
+int main()
+{
+    const char* expected = "2\n6\n8\nRuntime error at line 6, column 1: Undefined variable 'z'\n";
+
+    check_script("LF line endings",
+        "x = 2\ny = x * 3\n\n(x +\n y)\nz\n", expected);
+    check_script("CRLF line endings",
+        "x = 2\r\ny = x * 3\r\n\r\n(x +\r\n y)\r\nz\r\n", expected);
+    check_script("CRLF with several statements a line",
+        "x = 2\r\ny = x * 3; x + y\r\n", "2\n6\n8\n");
+    return n_failed != 0;
+}
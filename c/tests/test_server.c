@@ -0,0 +1,286 @@
+/**
+ * Tests of the server: requests and responses are length-prefixed frames,
+ * each client has a session of its own, oversized and truncated requests
+ * end the connection, and responses are still sent after a client
+ * half-closes it
+ *
+ * Build from the ```c``` directory with:
+ * ```gcc -O2 -o test_server tests/test_server.c tests/check.c bigint.c numconv.c strbuf.c symbols.c base.c value.c lexer.c parser.c ranges.c functions.c builtins.c licm.c typing.c fusion.c parallel.c interpreter.c session.c ring.c server.c -lm -lpthread```
+ */
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../server.h"
+#include "check.h"
+
+// Number of attempts to connect to the server, 10 ms apart
+#define N_ATTEMPTS 200
+
+/**
+ * Appends a frame to a buffer
+ *
+ * @param b The buffer
+ * @param len The length written in the header
+ * @param payload The contents, of which up to ```len``` bytes are written
+ */
+void append_frame(StrBuf* b, uint32_t len, const char* payload)
+{
+    char header[4] = {
+        (char) (len >> 24), (char) (len >> 16), (char) (len >> 8), (char) len,
+    };
+    str_buf_append(b, header, 4);
+    size_t n = strlen(payload);
+    str_buf_append(b, payload, (n < len) ? n : len);
+}
+
+/**
+ * Appends a request to a buffer
+ *
+ * @param b The buffer
+ * @param code The code of the request
+ */
+void append_request(StrBuf* b, const char* code)
+{
+    append_frame(b, (uint32_t) strlen(code), code);
+}
+
+/**
+ * Reads a response frame
+ *
+ * @param fd Where to read it
+ * @param text Where to store what the console would print, null-terminated
+ * @param cap The room in ```text```
+ *
+ * @return The ResponseStatus, or ```-1``` if there is no complete frame
+ */
+int read_response(int fd, char* text, size_t cap)
+{
+    unsigned char header[4];
+    size_t pos = 0;
+    ssize_t n;
+    while (pos < 4 && (n = read(fd, header + pos, 4 - pos)) > 0)
+        pos += n;
+    if (pos < 4)
+        return -1;
+
+    uint32_t len = ((uint32_t) header[0] << 24) | ((uint32_t) header[1] << 16)
+        | ((uint32_t) header[2] << 8) | header[3];
+    if (len == 0 || len > cap)
+        return -1;
+
+    for (pos = 0; pos < len && (n = read(fd, text + pos, len - pos)) > 0; )
+        pos += n;
+    if (pos < len)
+        return -1;
+
+    int status = text[0];
+    memmove(text, text + 1, len - 1);
+    text[len - 1] = '\0';
+    return status;
+}
+
+/**
+ * Checks the next response of a stream
+ *
+ * @param fd Where to read it
+ * @param status The expected ResponseStatus
+ * @param expected The expected output, or its end for errors
+ *
+ * @return Boolean-like value
+ */
+int expect_response(int fd, int status, const char* expected)
+{
+    char text[256];
+    if (read_response(fd, text, sizeof(text)) != status)
+        return 0;
+
+    size_t len = strlen(text), n = strlen(expected);
+    return len >= n && strcmp(text + len - n, expected) == 0;
+}
+
+/**
+ * Serves some bytes with ```serve_pipes```, as a client that writes them
+ * and then closes its end
+ *
+ * @param input The bytes
+ * @param responses Where to store the end of the pipe of the responses
+ *
+ * @return What ```serve_pipes``` returned
+ */
+int serve_bytes(const StrBuf* input, int* responses)
+{
+    int in[2], out[2];
+    if (pipe(in) < 0 || pipe(out) < 0)
+        return -1;
+
+    // The requests and responses of the tests fit in the pipes
+    write(in[1], input->data, input->len);
+    close(in[1]);
+
+    Budget budget = { 0 };
+    int ok = serve_pipes(in[0], out[1], NULL, 1, &budget);
+    close(in[0]);
+    close(out[1]);
+    *responses = out[0];
+    return ok;
+}
+
+/**
+ * Checks the frames of ```serve_pipes```, with one session per stream
+ */
+void test_pipes()
+{
+    StrBuf input = new_str_buf(64);
+    int fd;
+
+    append_request(&input, "x = 2");
+    append_request(&input, "fun f(n) = n * 2");
+    append_request(&input, "f(x + 1)");
+    append_request(&input, "1 / 0");
+    append_request(&input, "x");
+    check("stream served to its end", serve_bytes(&input, &fd) == 1);
+    check("value", expect_response(fd, RESPONSE_OK, "2\n"));
+    check("definition", expect_response(fd, RESPONSE_OK, ""));
+    check("names persist in a session", expect_response(fd, RESPONSE_OK, "6\n"));
+    check("error", expect_response(fd, RESPONSE_ERROR, "Division by 0\n"));
+    check("session survives an error", expect_response(fd, RESPONSE_OK, "2\n"));
+    check("no response left", read_response(fd, NULL, 0) == -1);
+    close(fd);
+
+    clear_str_buf(&input);
+    append_request(&input, "x");
+    serve_bytes(&input, &fd);
+    check("variables do not cross sessions",
+          expect_response(fd, RESPONSE_ERROR, "Undefined variable 'x'\n"));
+    close(fd);
+
+    clear_str_buf(&input);
+    append_request(&input, "1 + 1");
+    append_frame(&input, SERVER_MAX_REQUEST + 1, "2");
+    append_request(&input, "3");
+    check("oversized request fails", serve_bytes(&input, &fd) == 0);
+    check("requests before it are answered", expect_response(fd, RESPONSE_OK, "2\n"));
+    check("requests after it are not", read_response(fd, NULL, 0) == -1);
+    close(fd);
+
+    clear_str_buf(&input);
+    append_request(&input, "4");
+    append_frame(&input, 10, "1 +");
+    check("truncated request fails", serve_bytes(&input, &fd) == 0);
+    check("request before it is answered", expect_response(fd, RESPONSE_OK, "4\n"));
+    close(fd);
+
+    clear_str_buf(&input);
+    str_buf_append(&input, "\0\0", 2);
+    check("truncated length fails", serve_bytes(&input, &fd) == 0);
+    close(fd);
+
+    free_str_buf(&input);
+}
+
+/**
+ * Connects to a server, retrying while it starts
+ *
+ * @param path The path of its socket
+ *
+ * @return The connection, or ```-1```
+ */
+int connect_unix(const char* path)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    for (int k = 0; k < N_ATTEMPTS; k++)
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) == 0)
+            return fd;
+        close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+/**
+ * Sends the requests in a buffer
+ *
+ * @param fd The connection
+ * @param b The buffer, which is cleared
+ */
+void send_requests(int fd, StrBuf* b)
+{
+    write(fd, b->data, b->len);
+    clear_str_buf(b);
+}
+
+/**
+ * Checks the sessions of the clients of ```serve_socket```, and how it
+ * ends their connections
+ */
+void test_socket()
+{
+    char path[CHECK_PATH_LEN];
+    if (!temp_file(path, ".sock", ""))
+    {
+        check("socket path", 0);
+        return;
+    }
+
+    pid_t server = fork();
+    if (server == 0)
+    {
+        Budget budget = { 0 };
+        _exit(serve_socket(path, NULL, 1, &budget) ? 0 : 1);
+    }
+
+    int a = connect_unix(path);
+    int b = (a >= 0) ? connect_unix(path) : -1;
+    check("connections", a >= 0 && b >= 0);
+    if (a >= 0 && b >= 0)
+    {
+        StrBuf input = new_str_buf(64);
+        append_request(&input, "x = 5");
+        send_requests(a, &input);
+        check("first client", expect_response(a, RESPONSE_OK, "5\n"));
+
+        append_request(&input, "x");
+        send_requests(b, &input);
+        check("clients have separate sessions",
+              expect_response(b, RESPONSE_ERROR, "Undefined variable 'x'\n"));
+
+        // Both requests arrive in a single read
+        append_request(&input, "x * 2");
+        append_request(&input, "x + 1");
+        send_requests(a, &input);
+        shutdown(a, SHUT_WR);
+        check("responses after a half-close", expect_response(a, RESPONSE_OK, "10\n")
+              && expect_response(a, RESPONSE_OK, "6\n"));
+        check("connection closed after them", read_response(a, NULL, 0) == -1);
+
+        append_frame(&input, SERVER_MAX_REQUEST + 1, "1");
+        send_requests(b, &input);
+        check("oversized request closes the connection", read_response(b, NULL, 0) == -1);
+        free_str_buf(&input);
+    }
+    if (a >= 0)
+        close(a);
+    if (b >= 0)
+        close(b);
+
+    int status;
+    kill(server, SIGTERM);
+    waitpid(server, &status, 0);
+    check("server stops cleanly", WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    check("socket removed", access(path, F_OK) != 0);
+}
+
+int main()
+{
+    test_pipes();
+    test_socket();
+    return n_failed != 0;
+}
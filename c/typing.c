@@ -0,0 +1,844 @@
+#include "typing.h"
+#include "ranges.h"
+#include "builtins.h"
+#include "licm.h"
+
+// ----- TYPING -----
+
+/**
+ * Contains the implementations of an operator for each kind of operand
+ */
+typedef struct op_impls
+{
+    Opcode integer;         // Implementation for integer operands
+    Opcode decimal;         // Implementation for float operands
+    ErrorCode missing;      // Error when the type has no implementation
+} OpImpls;
+
+/**
+ * Provides the implementations of each unary operator
+ */
+const OpImpls UnaryOpImpls[] = {
+    [TT_ADD] = { OP_POS_INT, OP_POS_FLOAT, ERR_NO_POSITIVE },
+    [TT_SUB] = { OP_NEG_INT, OP_NEG_FLOAT, ERR_NO_NEGATIVE },
+    [TT_NOT] = { OP_NOT_INT, OP_NOT_FLOAT, ERR_NO_NOT },
+};
+
+/**
+ * Provides the implementations of each binary operator
+ */
+const OpImpls BinaryOpImpls[] = {
+    [TT_ADD] = { OP_ADD_INT, OP_ADD_FLOAT, ERR_NO_ADDITION },
+    [TT_SUB] = { OP_SUB_INT, OP_SUB_FLOAT, ERR_NO_SUBTRACTION },
+    [TT_MUL] = { OP_MUL_INT, OP_MUL_FLOAT, ERR_NO_MULTIPLICATION },
+    [TT_DIV] = { OP_NONE,    OP_DIV_FLOAT, ERR_NO_DIVISION },
+    [TT_MOD] = { OP_MOD_INT, OP_MOD_FLOAT, ERR_NO_MODULE },
+    [TT_POW] = { OP_POW_INT, OP_POW_FLOAT, ERR_NO_POWER },
+    [TT_LT]  = { OP_LT_INT,  OP_LT_FLOAT,  ERR_NO_COMPARISON },
+    [TT_LE]  = { OP_LE_INT,  OP_LE_FLOAT,  ERR_NO_COMPARISON },
+    [TT_GT]  = { OP_GT_INT,  OP_GT_FLOAT,  ERR_NO_COMPARISON },
+    [TT_GE]  = { OP_GE_INT,  OP_GE_FLOAT,  ERR_NO_COMPARISON },
+    [TT_EQ]  = { OP_EQ_INT,  OP_EQ_FLOAT,  ERR_NO_COMPARISON },
+    [TT_NE]  = { OP_NE_INT,  OP_NE_FLOAT,  ERR_NO_COMPARISON },
+};
+
+/**
+ * Contains the state of the typing pass
+ */
+typedef struct type_checker
+{
+    const SymbolTable* symbols;
+    Environment* env;
+    FunctionTable* functions;
+    Specialization* spec;       // Specialization being typed (```NULL``` at top level)
+    int widened;                // Whether the types of ```spec``` changed
+    Specialization** session;   // Specializations typed since the outermost call
+    int n_session;
+    int depth;                  // Number of specializations being typed
+    int changed;                // Whether an assumption read in the session changed
+    Error err;
+} TypeChecker;
+
+// Auxiliary functions
+
+/**
+ * Selects the implementation of an operator for the type of its operands
+ * 
+ * @param c The type checker
+ * @param impls The implementations of the operators, indexed by token type
+ * @param n_impls The number of entries in ```impls```
+ * @param op The operator
+ * @param type The type of the operands
+ * @param node The operation node
+ * @param opcode Where to store the implementation
+ * 
+ * @return ```1``` on success, or ```0``` if there is no implementation
+ */
+int select_opcode(
+    TypeChecker* c, 
+    const OpImpls impls[], 
+    int n_impls, 
+    TokenType op, 
+    TypePriority type, 
+    const ASTNode* node, 
+    Opcode* opcode
+)
+{
+    if ((int) op >= n_impls 
+        || (impls[op].integer == OP_NONE && impls[op].decimal == OP_NONE))
+    {
+        c->err = new_error(ERR_UNKNOWN_OPERATOR, node->pos);
+        return 0;
+    }
+
+    if (is_integer(type))
+        *opcode = impls[op].integer;
+    else if (type == FLOAT)
+        *opcode = impls[op].decimal;
+    else
+        *opcode = OP_NONE;
+
+    if (*opcode == OP_NONE)
+    {
+        c->err = new_type_error(impls[op].missing, node->pos, type);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Inserts a conversion node over an operand whose type differs from the
+ * type required by its parent
+ * 
+ * @param c The type checker
+ * @param operand The operand, which is replaced by the conversion node
+ * @param type The required type
+ * 
+ * @return ```1``` on success, or ```0``` if the operand cannot be converted
+ */
+int convert_operand(TypeChecker* c, ASTNode** operand, TypePriority type)
+{
+    TypePriority from = (*operand)->type;
+
+    // Integer representations are handled by the operations themselves
+    if (from == type || (is_integer(from) && is_integer(type)))
+        return 1;
+
+    if (!is_integer(from) || type != FLOAT)
+    {
+        c->err = new_conversion_error((*operand)->pos, from, type);
+        return 0;
+    }
+
+    *operand = new_convert_node(*operand, type);
+    return 1;
+}
+
+/**
+ * Allocates the environment slot of a variable and converts the value it
+ * holds if the variable has been widened since it was stored
+ * 
+ * @param c The type checker
+ * @param slot The slot
+ * @param type The type of the variable
+ */
+void bind_slot(TypeChecker* c, int slot, TypePriority type)
+{
+    reserve_environment(c->env, slot + 1);
+
+    Value value = c->env->slots[slot];
+    if (value != VALUE_UNSET && type == FLOAT && !is_float_value(value))
+    {
+        c->env->slots[slot] = box_data(promote(unbox_data(value), FLOAT));
+        release_value(value);
+    }
+}
+
+/**
+ * Obtains the type of a variable after assigning it a value, widening
+ * the variable if required
+ * 
+ * @param c The type checker
+ * @param slot The slot of the variable
+ * @param type The type of the value
+ * 
+ * @return The type of the variable
+ */
+TypePriority assign_slot(TypeChecker* c, int slot, TypePriority type)
+{
+    if (c->spec == NULL)
+    {
+        // Globals take the widest type assigned to them in the parser
+        type = get_symbol(c->symbols, slot)->type;
+        bind_slot(c, slot, type);
+        return type;
+    }
+
+    // Locals take the widest type assigned to them
+    TypePriority* local = &c->spec->locals[slot];
+    if (max_priority(*local, type) != *local)
+    {
+        *local = max_priority(*local, type);
+        c->widened = 1;
+    }
+    return *local;
+}
+
+/**
+ * Obtains the implementation of a division or remainder that skips the
+ * zero check of its divisor
+ * 
+ * @param opcode The checked implementation
+ * 
+ * @return The unchecked implementation, or ```opcode``` if there is none
+ */
+Opcode unchecked_opcode(Opcode opcode)
+{
+    switch (opcode)
+    {
+    case OP_DIV_FLOAT:
+        return OP_DIV_FLOAT_UNCHECKED;
+
+    case OP_MOD_INT:
+        return OP_MOD_INT_UNCHECKED;
+
+    case OP_MOD_FLOAT:
+        return OP_MOD_FLOAT_UNCHECKED;
+
+    default:
+        return opcode;
+    }
+}
+
+/**
+ * Obtains the range of values of a binary operation from the ranges of
+ * its operands
+ * 
+ * @param node The binary operation node
+ * @param left The range of the left operand
+ * @param right The range of the right operand
+ * 
+ * @return The range of the operation
+ */
+Interval binary_range(const ASTNode* node, Interval left, Interval right)
+{
+    switch (node->data.binary.op->type)
+    {
+    case TT_ADD:
+        return interval_add(left, right);
+
+    case TT_SUB:
+        return interval_sub(left, right);
+
+    case TT_MUL:
+        return interval_mul(left, right);
+
+    case TT_DIV:
+        return interval_div(left, right);
+
+    case TT_MOD:
+        return interval_mod(left, right, node->type);
+
+    case TT_POW:
+        return interval_pow(left, right);
+
+    default:
+        // Comparisons evaluate to 0 or 1
+        if (is_comparison(node->data.binary.op->type))
+            return (Interval) { 0, 1 };
+        return full_interval();
+    }
+}
+
+/**
+ * Obtains the range of values of a call to a built-in function from the
+ * ranges of its arguments
+ * 
+ * @param id The function
+ * @param args The ranges of the arguments
+ * 
+ * @return The range of the call
+ */
+Interval builtin_range(BuiltinId id, const Interval* args)
+{
+    Interval r = full_interval();
+    switch (id)
+    {
+    case BI_SQRT:
+        r.lo = 0;
+        break;
+
+    case BI_EXP:
+        // The bound is rounded down, and results may underflow to 0
+        r.lo = fmax(nextafter(exp(args[0].lo), -INFINITY), 0);
+        break;
+
+    case BI_SIN:
+    case BI_COS:
+        r.lo = -1;
+        r.hi = 1;
+        break;
+
+    case BI_ABS:
+        r.lo = (args[0].lo > 0) ? args[0].lo : 
+               (args[0].hi < 0) ? -args[0].hi : 0;
+        r.hi = fmax(fabs(args[0].lo), fabs(args[0].hi));
+        break;
+
+    case BI_MIN:
+        r.lo = fmin(args[0].lo, args[1].lo);
+        r.hi = fmin(args[0].hi, args[1].hi);
+        break;
+
+    case BI_MAX:
+        r.lo = fmax(args[0].lo, args[1].lo);
+        r.hi = fmax(args[0].hi, args[1].hi);
+        break;
+
+    case BI_FLOOR:
+        r.lo = floor(args[0].lo);
+        r.hi = floor(args[0].hi);
+        break;
+
+    default:
+        break;
+    }
+    return r;
+}
+
+/**
+ * Marks the calls whose value is returned by a function body
+ * 
+ * @param body The body
+ */
+void mark_tail_calls(ASTNode* body)
+{
+    if (body->class == Call)
+        body->data.call.tail = 1;
+    else if (body->class == Cond)
+    {
+        mark_tail_calls(body->data.cond.if_true);
+        mark_tail_calls(body->data.cond.if_false);
+    }
+    else if (body->class == Sequence)
+        mark_tail_calls(body->data.sequence.items[body->data.sequence.count - 1]);
+}
+
+/**
+ * Checks whether a node may be evaluated even when its value is not
+ * needed: it is small, has no side effects and cannot fail
+ * 
+ * @param c The type checker
+ * @param node The node
+ * @param budget The number of nodes left, which is decremented
+ * 
+ * @return Boolean-like value
+ */
+int is_unconditional(const TypeChecker* c, const ASTNode* node, int* budget)
+{
+    if (--(*budget) < 0)
+        return 0;
+
+    switch (node->class)
+    {
+    case Number:
+        return 1;
+
+    case VarAccess:
+        // Parameters are always bound, and assigned globals stay assigned
+        if (c->spec)
+            return node->data.access.slot < c->spec->function->n_params;
+        return c->env->slots[node->data.access.slot] != VALUE_UNSET;
+
+    case Convert:
+        return is_unconditional(c, node->data.convert.value, budget);
+
+    case UnOp:
+        return is_unconditional(c, node->data.unary.value, budget);
+
+    case BinOp:
+        switch (node->data.binary.opcode)
+        {
+        case OP_DIV_FLOAT:
+        case OP_MOD_INT:
+        case OP_MOD_FLOAT:
+        case OP_POW_INT:
+        case OP_POW_FLOAT:
+            // May fail, or be expensive on big integers
+            return 0;
+
+        default:
+            return is_unconditional(c, node->data.binary.left, budget)
+                && is_unconditional(c, node->data.binary.right, budget);
+        }
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Discards the bodies typed in the current session
+ * 
+ * @param c The type checker
+ */
+void reset_session(TypeChecker* c)
+{
+    for (int k = 0; k < c->n_session; k++)
+        reset_specialization(c->session[k]);
+    c->n_session = 0;
+}
+
+// Private function declarations
+
+int check_node(TypeChecker* c, ASTNode* node, Interval* range);
+
+/**
+ * Lowers a call to a built-in function, converting its arguments as
+ * required by the function
+ * 
+ * @param c The type checker
+ * @param node The call node
+ * @param id The function
+ * @param range Where to store the range of values of the call
+ * 
+ * @return ```1``` on success, or ```0``` in case of error
+ */
+int check_builtin(TypeChecker* c, ASTNode* node, BuiltinId id, Interval* range)
+{
+    CallNode* call = &node->data.call;
+    const Builtin* b = &Builtins[id];
+    if (call->n_args != b->n_args)
+    {
+        c->err = new_name_error(ERR_WRONG_ARGUMENTS, node->pos, call->name->value);
+        return 0;
+    }
+
+    Interval args[2];
+    TypePriority type = INT;
+    for (int k = 0; k < call->n_args; k++)
+    {
+        if (!check_node(c, call->args[k], &args[k]))
+            return 0;
+        type = max_priority(type, call->args[k]->type);
+    }
+
+    call->builtin = id;
+    *range = builtin_range(id, args);
+    switch (b->result)
+    {
+    case RESULT_FLOAT:
+        node->type = FLOAT;
+        break;
+
+    case RESULT_WIDEST:
+        node->type = type;
+        break;
+
+    case RESULT_INT:
+        // The argument is rounded by the function itself
+        node->type = INT;
+        return 1;
+    }
+
+    for (int k = 0; k < call->n_args; k++)
+    {
+        if (!convert_operand(c, &call->args[k], node->type))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Types the body of a specialization until its return and local types
+ * are stable
+ * 
+ * @param c The type checker
+ * @param spec The specialization
+ * 
+ * @return ```1``` on success, or ```0``` in case of error
+ */
+int type_specialization(TypeChecker* c, Specialization* spec)
+{
+    Specialization* outer = c->spec;
+    int outer_widened = c->widened;
+    c->spec = spec;
+    spec->state = SPEC_TYPING;
+
+    ASTNode* body;
+    int ok;
+    do
+    {
+        c->widened = 0;
+        body = clone_node(spec->function->body, NULL);
+
+        Interval range;
+        ok = check_node(c, body, &range);
+        if (ok)
+        {
+            // Integer representations are not part of the signature
+            TypePriority type = is_integer(body->type) ? INT : body->type;
+            if (max_priority(spec->ret, type) != spec->ret)
+            {
+                spec->ret = max_priority(spec->ret, type);
+                c->widened = 1;
+            }
+        }
+
+        // Callers typed with the previous assumptions must be typed again
+        if (ok && c->widened && spec->used)
+            c->changed = 1;
+
+        if (!ok || c->widened)
+            free_node(body);
+    } while (ok && c->widened);
+
+    if (ok)
+    {
+        convert_operand(c, &body, spec->ret);
+        mark_tail_calls(body);
+        spec->body = body;
+        spec->state = SPEC_READY;
+    }
+    else
+        spec->state = SPEC_NEW;
+
+    c->spec = outer;
+    c->widened = outer_widened;
+    return ok;
+}
+
+/**
+ * Obtains the typed specialization of a function for some argument types.
+ * Specializations being typed are returned as they are, and their current
+ * types are used as assumptions. When the outermost specialization is
+ * done, the whole session is typed again until no assumption changes
+ * 
+ * @param c The type checker
+ * @param f The function
+ * @param params The types of the arguments
+ * 
+ * @return The specialization, or ```NULL``` in case of error
+ */
+Specialization* specialize(TypeChecker* c, Function* f, const TypePriority* params)
+{
+    Specialization* spec = get_specialization(f, params);
+    if (spec->state == SPEC_TYPING)
+        spec->used = 1;
+    if (spec->state != SPEC_NEW)
+        return spec;
+
+    int ok;
+    do
+    {
+        c->changed = 0;
+        c->session = (Specialization**) realloc(
+            c->session, (c->n_session + 1) * sizeof(Specialization*));
+        c->session[c->n_session++] = spec;
+
+        c->depth++;
+        ok = type_specialization(c, spec);
+        c->depth--;
+
+        if (c->depth > 0)
+            return (ok) ? spec : NULL;
+
+        // Types only widen, so the session converges
+        if (!ok || c->changed)
+            reset_session(c);
+    } while (ok && c->changed);
+
+    c->n_session = 0;
+    return (ok) ? spec : NULL;
+}
+
+/**
+ * Lowers a node and its children
+ * 
+ * @param c The type checker
+ * @param node The node
+ * @param range Where to store the range of values of the node
+ * 
+ * @return ```1``` on success, or ```0``` in case of error
+ */
+int check_node(TypeChecker* c, ASTNode* node, Interval* range)
+{
+    switch (node->class)
+    {
+    case Number:
+    {
+        const DataValue* literal = &node->data.number.literal;
+        // Literals are not negative, and those beyond 2^53 are rounded
+        // when converted to doubles
+        if (node->type == INT && literal->integer <= (1ll << 53))
+            *range = point_interval((double) literal->integer);
+        else if (node->type == INT)
+            *range = rounded_interval((double) literal->integer);
+        else if (node->type == BIGINT)
+            *range = rounded_interval(bigint_to_double(literal->big));
+        else
+            *range = point_interval(literal->decimal);
+        return 1;
+    }
+
+    case UnOp:
+    {
+        UnOpNode* unary = &node->data.unary;
+        if (!check_node(c, unary->value, range))
+            return 0;
+
+        if (unary->sign->type == TT_SUB)
+            *range = interval_neg(*range);
+        else if (unary->sign->type == TT_NOT)
+            *range = (Interval) { 0, 1 };
+
+        node->type = (unary->sign->type == TT_NOT) ? INT : unary->value->type;
+        return select_opcode(c, UnaryOpImpls, 
+                             sizeof(UnaryOpImpls) / sizeof(OpImpls), 
+                             unary->sign->type, unary->value->type, 
+                             node, &unary->opcode);
+    }
+
+    case BinOp:
+    {
+        BinOpNode* binary = &node->data.binary;
+        Interval left, right;
+        if (!check_node(c, binary->left, &left) 
+            || !check_node(c, binary->right, &right))
+            return 0;
+
+        infer_type(node);
+        *range = binary_range(node, left, right);
+
+        // Comparisons take operands of a common type and return INT
+        TypePriority type = (is_comparison(binary->op->type)) ? 
+            max_priority(binary->left->type, binary->right->type) : node->type;
+        if (!convert_operand(c, &binary->left, type)
+            || !convert_operand(c, &binary->right, type)
+            || !select_opcode(c, BinaryOpImpls, 
+                              sizeof(BinaryOpImpls) / sizeof(OpImpls), 
+                              binary->op->type, type, node, &binary->opcode))
+            return 0;
+
+        // Divisors proven to never be 0 need no runtime check
+        if (excludes_zero(right))
+            binary->opcode = unchecked_opcode(binary->opcode);
+        return 1;
+    }
+
+    case VarAccess:
+        *range = full_interval();
+        if (c->spec)
+        {
+            node->type = c->spec->locals[node->data.access.slot];
+            return 1;
+        }
+
+        node->type = get_symbol(c->symbols, node->data.access.slot)->type;
+        bind_slot(c, node->data.access.slot, node->type);
+        return 1;
+
+    case VarAssign:
+    {
+        VarAssignNode* assign = &node->data.assign;
+        if (!check_node(c, assign->value, range))
+            return 0;
+
+        node->type = assign_slot(c, assign->slot, assign->value->type);
+        return convert_operand(c, &assign->value, node->type);
+    }
+
+    case Convert:
+        return check_node(c, node->data.convert.value, range);
+
+    case FuncDef:
+        *range = full_interval();
+        define_function(c->functions, node);
+        node->type = NONE;
+        return 1;
+
+    case Call:
+    {
+        CallNode* call = &node->data.call;
+        *range = full_interval();
+
+        // User functions shadow the built-in ones
+        Function* f = find_function(c->functions, call->symbol);
+        if (f == NULL)
+        {
+            int builtin = find_builtin(call->name->value);
+            if (builtin >= 0)
+                return check_builtin(c, node, (BuiltinId) builtin, range);
+        }
+
+        if (f == NULL || call->n_args != f->n_params)
+        {
+            c->err = new_name_error(
+                (f) ? ERR_WRONG_ARGUMENTS : ERR_UNDEFINED_FUNCTION, 
+                node->pos, 
+                call->name->value
+            );
+            return 0;
+        }
+
+        // Integer representations are not part of the signature
+        TypePriority* params = (TypePriority*) malloc(
+            (call->n_args + 1) * sizeof(TypePriority));
+        for (int k = 0; k < call->n_args; k++)
+        {
+            Interval arg;
+            if (!check_node(c, call->args[k], &arg))
+            {
+                free(params);
+                return 0;
+            }
+            params[k] = is_integer(call->args[k]->type) ? 
+                INT : call->args[k]->type;
+        }
+
+        call->spec = specialize(c, f, params);
+        free(params);
+        if (call->spec == NULL)
+            return 0;
+
+        // Parameters may have been widened by assignments in the body
+        for (int k = 0; k < call->n_args; k++)
+        {
+            if (!convert_operand(c, &call->args[k], call->spec->locals[k]))
+                return 0;
+        }
+
+        node->type = call->spec->ret;
+        return 1;
+    }
+
+    case Sequence:
+    {
+        SequenceNode* sequence = &node->data.sequence;
+        for (int k = 0; k < sequence->count; k++)
+        {
+            if (!check_node(c, sequence->items[k], range))
+                return 0;
+        }
+        node->type = sequence->items[sequence->count - 1]->type;
+        return 1;
+    }
+
+    case Logic:
+    {
+        Interval left, right;
+        if (!check_node(c, node->data.logic.left, &left)
+            || !check_node(c, node->data.logic.right, &right))
+            return 0;
+
+        *range = (Interval) { 0, 1 };
+        return 1;
+    }
+
+    case Cond:
+    {
+        CondNode* cond = &node->data.cond;
+        Interval test, if_true, if_false;
+        if (!check_node(c, cond->cond, &test)
+            || !check_node(c, cond->if_true, &if_true)
+            || !check_node(c, cond->if_false, &if_false))
+            return 0;
+
+        node->type = max_priority(cond->if_true->type, cond->if_false->type);
+        *range = (Interval) { 
+            fmin(if_true.lo, if_false.lo), 
+            fmax(if_true.hi, if_false.hi) 
+        };
+        if (!convert_operand(c, &cond->if_true, node->type)
+            || !convert_operand(c, &cond->if_false, node->type))
+            return 0;
+
+        // Small branches are cheaper to evaluate than to branch on
+        int budget = SELECT_MAX_NODES;
+        int select = is_unconditional(c, cond->if_true, &budget);
+        budget = SELECT_MAX_NODES;
+        cond->select = select && is_unconditional(c, cond->if_false, &budget);
+        return 1;
+    }
+
+    case While:
+    {
+        WhileNode* loop = &node->data.loop;
+        Interval test, body;
+        if (!check_node(c, loop->cond, &test) 
+            || !check_node(c, loop->body, &body))
+            return 0;
+
+        // Loops without iterations evaluate to 0
+        node->type = loop->body->type;
+        *range = (Interval) { fmin(body.lo, 0), fmax(body.hi, 0) };
+        hoist_invariants(node);
+        return 1;
+    }
+
+    case For:
+    {
+        ForNode* loop = &node->data.range;
+        Interval start, end, body;
+        if (!check_node(c, loop->start, &start) 
+            || !check_node(c, loop->end, &end))
+            return 0;
+
+        // The counter takes the type of the variable it is stored in
+        TypePriority type = assign_slot(c, loop->slot, 
+            max_priority(loop->start->type, loop->end->type));
+        if (!convert_operand(c, &loop->start, type)
+            || !convert_operand(c, &loop->end, type)
+            || !check_node(c, loop->body, &body))
+            return 0;
+
+        node->type = loop->body->type;
+        *range = (Interval) { fmin(body.lo, 0), fmax(body.hi, 0) };
+        hoist_invariants(node);
+        return 1;
+    }
+
+    case Invariant:
+        return check_node(c, node->data.invariant.value, range);
+
+    default:
+        c->err = new_error(ERR_UNKNOWN_NODE, node->pos);
+        return 0;
+    }
+}
+
+
+// Public functions
+
+ParserResult check_types(
+    ASTNode* root, 
+    const SymbolTable* symbols, 
+    Environment* env, 
+    FunctionTable* functions
+)
+{
+    ParserResult res;
+    TypeChecker c = { 
+        .symbols = symbols, 
+        .env = env, 
+        .functions = functions, 
+        .spec = NULL, 
+        .session = NULL, 
+        .n_session = 0, 
+        .depth = 0, 
+    };
+    Interval range;
+
+    int ok = check_node(&c, root, &range);
+    free(c.session);
+    if (!ok)
+    {
+        free_node(root);
+        res.root = NULL;
+        res.err = c.err;
+        return res;
+    }
+
+    res.root = root;
+    return res;
+}
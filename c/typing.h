@@ -0,0 +1,51 @@
+#ifndef TYPING_H
+#define TYPING_H
+
+#include "parser.h"
+#include "interpreter.h"
+#include "functions.h"
+
+// ----- TYPING -----
+
+// Largest branch (in nodes) of a conditional that may be evaluated
+// unconditionally and selected without branching
+#define SELECT_MAX_NODES 8
+
+/**
+ * Performs the typing pass over an AST, which lowers it to the typed form
+ * run by the interpreter:
+ * 
+ * - Variable nodes take the final type of their symbols, and the types of
+ * the operations are inferred again from them
+ * - Explicit conversion nodes are inserted wherever an operand must be
+ * promoted
+ * - The implementation of each operation is selected for its type. Divisions
+ * and remainders whose divisor is proven to never be 0 by a value range
+ * analysis use implementations without the zero check
+ * - The environment slots used by the AST are allocated, and values stored
+ * before their variable was widened are converted
+ * - Conditionals whose branches are small, have no side effects and cannot
+ * fail are marked to evaluate both branches and select the result
+ * - Function definitions are added to the function table, and each call
+ * is bound to a specialization of its callee for the types of its
+ * arguments. Specializations are typed on first use, iterating until their
+ * return and local types are stable
+ * 
+ * @param root The root of the AST
+ * @param symbols The symbol table the AST was parsed with
+ * @param env The environment the AST will be run with
+ * @param functions The functions defined in the session
+ * 
+ * @return The result of the pass
+ * 
+ * @note In case of error, the AST is freed, the ```root``` field is
+ * ```NULL``` and the ```err``` field contains the error
+ */
+ParserResult check_types(
+    ASTNode* root, 
+    const SymbolTable* symbols, 
+    Environment* env, 
+    FunctionTable* functions
+);
+
+#endif  // TYPING_H
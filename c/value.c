@@ -0,0 +1,175 @@
+#include "value.h"
+
+// ----- VALUES -----
+
+// Auxiliary functions
+
+/**
+ * Obtains the tag of a value
+ *
+ * @param v The value
+ *
+ * @return The top 16 bits of the value
+ */
+unsigned value_tag(Value v)
+{
+    return (unsigned) (v >> VALUE_PAYLOAD_BITS);
+}
+
+/**
+ * Stores a pointer to data in a value
+ *
+ * @param data The data, whose ownership is transferred
+ *
+ * @return The value
+ */
+Value box_pointer(DataType* data)
+{
+    return ((Value) VALUE_TAG_BOXED << VALUE_PAYLOAD_BITS) | (Value) (uintptr_t) data;
+}
+
+/**
+ * Obtains the data a value points to
+ *
+ * @param v The value, which must be stored as a pointer
+ *
+ * @return The data
+ */
+DataType* unbox_pointer(Value v)
+{
+    return (DataType*) (uintptr_t) (v & (((Value) 1 << VALUE_PAYLOAD_BITS) - 1));
+}
+
+
+// Public functions
+
+Value box_float(double decimal)
+{
+    Value v;
+    memcpy(&v, &decimal, sizeof(v));
+
+    // NaNs that look like tagged values lose their payload, which cannot
+    // be observed
+    if (v >= VALUE_MIN_TAGGED)
+        v = (Value) 0xFFF8 << VALUE_PAYLOAD_BITS;
+    return v;
+}
+
+Value box_int(int64_t integer)
+{
+    const int64_t limit = (int64_t) 1 << (VALUE_PAYLOAD_BITS - 1);
+    if (integer < -limit || integer >= limit)
+        return box_pointer(new_int(integer));
+
+    Value payload = (Value) integer & (((Value) 1 << VALUE_PAYLOAD_BITS) - 1);
+    return ((Value) VALUE_TAG_INT << VALUE_PAYLOAD_BITS) | payload;
+}
+
+Value box_data(DataType* data)
+{
+    Value v;
+    switch (data->type)
+    {
+    case INT:
+        v = box_int(data->value.integer);
+        break;
+
+    case FLOAT:
+        v = box_float(data->value.decimal);
+        break;
+
+    default:
+        return box_pointer(data);
+    }
+
+    free_value(data);
+    return v;
+}
+
+Value box_copy(const DataType* data)
+{
+    switch (data->type)
+    {
+    case INT:
+        return box_int(data->value.integer);
+
+    case FLOAT:
+        return box_float(data->value.decimal);
+
+    default:
+        return box_pointer(copy_value(data));
+    }
+}
+
+int is_float_value(Value v)
+{
+    return v < VALUE_MIN_TAGGED;
+}
+
+int is_small_int_value(Value v)
+{
+    return value_tag(v) == VALUE_TAG_INT;
+}
+
+int is_boxed_value(Value v)
+{
+    return value_tag(v) == VALUE_TAG_BOXED;
+}
+
+double unbox_float(Value v)
+{
+    double decimal;
+    memcpy(&decimal, &v, sizeof(decimal));
+    return decimal;
+}
+
+int64_t unbox_small_int(Value v)
+{
+    // The payload is sign-extended from its top bit
+    const int shift = 64 - VALUE_PAYLOAD_BITS;
+    return (int64_t) (v << shift) >> shift;
+}
+
+const DataType* view_value(Value v, DataType* view)
+{
+    if (is_boxed_value(v))
+        return unbox_pointer(v);
+
+    if (is_float_value(v))
+    {
+        view->type = FLOAT;
+        view->value.decimal = unbox_float(v);
+    }
+    else
+    {
+        view->type = INT;
+        view->value.integer = unbox_small_int(v);
+    }
+    return view;
+}
+
+DataType* unbox_data(Value v)
+{
+    if (is_float_value(v))
+        return new_float(unbox_float(v));
+    if (is_small_int_value(v))
+        return new_int(unbox_small_int(v));
+    return copy_value(unbox_pointer(v));
+}
+
+Value copy_boxed(Value v)
+{
+    return (is_boxed_value(v)) ? box_pointer(copy_value(unbox_pointer(v))) : v;
+}
+
+void release_value(Value v)
+{
+    if (is_boxed_value(v))
+        free_value(unbox_pointer(v));
+}
+
+void unset_values(Value* values, int n)
+{
+    for (int k = 0; k < n; k++)
+        values[k] = VALUE_UNSET;
+}
@@ -0,0 +1,177 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include "base.h"
+
+// ----- VALUES -----
+
+// Values stored by the interpreter (variables, call frames, loop
+// invariants and cached results) are NaN-boxed into 8 bytes. Doubles are
+// stored as they are. The negative quiet NaNs whose top 16 bits are
+// 0xFFF9 or more, which no operation produces, hold the other values
+// after a tag:
+//
+// - ```INT``` values of 48 bits, in two's complement
+// - Pointers to a ```DataType```, for wider ```INT``` values and for
+// ```BIGINT``` values (user-space pointers take 48 bits)
+// - The unassigned value
+//
+// So checking the type of a value is a bit test, and only wide integers
+// are allocated
+
+/**
+ * Contains a NaN-boxed value
+ */
+typedef uint64_t Value;
+
+// Number of bits of the payload of a tagged value
+#define VALUE_PAYLOAD_BITS 48
+
+// Tags, in the top 16 bits
+#define VALUE_TAG_INT 0xFFF9
+#define VALUE_TAG_BOXED 0xFFFA
+#define VALUE_TAG_UNSET 0xFFFB
+
+// Smallest tagged value. Lower values are doubles
+#define VALUE_MIN_TAGGED ((Value) VALUE_TAG_INT << VALUE_PAYLOAD_BITS)
+
+// Value of unassigned variables
+#define VALUE_UNSET ((Value) VALUE_TAG_UNSET << VALUE_PAYLOAD_BITS)
+
+/**
+ * Stores a double in a value
+ *
+ * @param decimal The double
+ *
+ * @return The value
+ */
+Value box_float(double decimal);
+
+/**
+ * Stores an integer in a value
+ *
+ * @param integer The integer
+ *
+ * @return The value
+ *
+ * @note Integers wider than the payload are allocated, so remember to
+ * call ```release_value``` afterwards
+ */
+Value box_int(int64_t integer);
+
+/**
+ * Stores data in a value, freeing it unless it has to be allocated
+ *
+ * @param data The data, whose ownership is transferred
+ *
+ * @return The value
+ *
+ * @note Remember to call ```release_value``` afterwards
+ */
+Value box_data(DataType* data);
+
+/**
+ * Stores a copy of data in a value
+ *
+ * @param data The data
+ *
+ * @return The value
+ *
+ * @note Remember to call ```release_value``` afterwards
+ */
+Value box_copy(const DataType* data);
+
+/**
+ * Checks whether a value is a double
+ *
+ * @param v The value
+ *
+ * @return Boolean-like value
+ */
+int is_float_value(Value v);
+
+/**
+ * Checks whether a value is an integer stored in its payload
+ *
+ * @param v The value
+ *
+ * @return Boolean-like value
+ */
+int is_small_int_value(Value v);
+
+/**
+ * Checks whether a value is stored as a pointer to data
+ *
+ * @param v The value
+ *
+ * @return Boolean-like value
+ */
+int is_boxed_value(Value v);
+
+/**
+ * Obtains the double of a value
+ *
+ * @param v The value, which must be a double
+ *
+ * @return The double
+ */
+double unbox_float(Value v);
+
+/**
+ * Obtains the integer of a value
+ *
+ * @param v The value, which must be an integer stored in its payload
+ *
+ * @return The integer
+ */
+int64_t unbox_small_int(Value v);
+
+/**
+ * Obtains the data of a value
+ *
+ * @param v The value, which must not be unassigned
+ * @param view Storage for the data of values that are not stored as a
+ * pointer
+ *
+ * @return The data, which is either ```view``` or owned by the value
+ */
+const DataType* view_value(Value v, DataType* view);
+
+/**
+ * Obtains a copy of the data of a value
+ *
+ * @param v The value, which must not be unassigned
+ *
+ * @return The copy
+ *
+ * @note Remember to call ```free_value``` afterwards
+ */
+DataType* unbox_data(Value v);
+
+/**
+ * Copies a value
+ *
+ * @param v The value
+ *
+ * @return The copy, which only differs from ```v``` if it is allocated
+ *
+ * @note Remember to call ```release_value``` afterwards
+ */
+Value copy_boxed(Value v);
+
+/**
+ * Frees the memory used by a value, if any
+ *
+ * @param v The value
+ */
+void release_value(Value v);
+
+/**
+ * Fills an array with unassigned values
+ *
+ * @param values The array
+ * @param n The number of values
+ */
+void unset_values(Value* values, int n);
+
+#endif  // VALUE_H
@@ -1,24 +1,44 @@
 
 from abc import ABC, abstractmethod
 from dataclasses import dataclass
-from typing import Any, Tuple, Union
+from typing import Any, List, Tuple, Union
 
 # ----- TOKENS -----
 
 DIGITS = '0123456789'
+NAME_START = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_'
+NAME_CHARS = NAME_START + DIGITS
+KEYWORDS = ('fun', 'memo', 'if', 'then', 'else', 'while', 'for', 'to', 'do')
 
 TT_INT = 'INT'
 TT_FLT = 'FLOAT'
+TT_IDN = 'IDENTIFIER'
+TT_KEY = 'KEYWORD'
 TT_ADD = 'PLUS'
 TT_SUB = 'MINUS'
 TT_MUL = 'STAR'
 TT_DIV = 'SLASH'
 TT_MOD = 'PERCENT'
 TT_POW = 'CARET'
+TT_ASG = 'EQUALS'
+TT_LT = 'LT'
+TT_LE = 'LE'
+TT_GT = 'GT'
+TT_GE = 'GE'
+TT_EQ = 'EQ'
+TT_NE = 'NE'
+TT_AND = 'AND'
+TT_OR = 'OR'
+TT_NOT = 'NOT'
 TT_LPA = 'LPAREN'
 TT_RPA = 'RPAREN'
+TT_COM = 'COMMA'
+TT_SEM = 'SEMICOLON'
 TT_EOF = 'EOF'
 
+COMPARISONS = (TT_LT, TT_LE, TT_GT, TT_GE, TT_EQ, TT_NE)
+WORD_OPERATORS = {'and': TT_AND, 'or': TT_OR, 'not': TT_NOT}
+
 class Token:
     def __init__(self, position: Tuple[int, int], tok_type: str, value: str = None) -> None:
         self.pos = position
@@ -27,7 +47,12 @@ class Token:
 
     def get_next_position(self) -> Tuple[int, int]:
         line, col = self.pos
-        col += len(self.value) if self.value else 1
+        if self.value:
+            col += len(self.value)
+        elif self.type in COMPARISONS and self.type not in (TT_LT, TT_GT):
+            col += 2
+        else:
+            col += 1
         return line, col
 
     def __repr__(self) -> str:
@@ -79,6 +104,11 @@ class TypePromotion:
     @classmethod
     def max(cls, type1: str, type2: str) -> str:
         return cls.priorities[max(cls.priorities.index(type1), cls.priorities.index(type2))]
+
+# Rules for the type of the result of a built-in function
+RESULT_FLOAT = 'FLOAT'      # Arguments are converted to FLOAT
+RESULT_WIDEST = 'WIDEST'    # Arguments are converted to the widest of their types
+RESULT_INT = 'INT'          # Integer result, whatever the type of the argument
     
 
 # ----- NODES -----
@@ -91,6 +121,9 @@ class ASTNode:
     def __repr__(self) -> str:
         pass
 
+    def is_non_negative(self) -> bool:
+        return False
+
 class NumberNode(ASTNode):
     def __init__(self, number: Token) -> None:
         super().__init__(number.type, number.pos)
@@ -98,16 +131,24 @@ class NumberNode(ASTNode):
 
     def __repr__(self) -> str:
         return f"{self.number}"
+
+    def is_non_negative(self) -> bool:
+        return True
     
 class UnOpNode(ASTNode):
     def __init__(self, sign: Token, value: ASTNode) -> None:
-        super().__init__(value.type, sign.pos)
+        super().__init__(TT_INT if sign.type == TT_NOT else value.type, sign.pos)
         self.sign = sign
         self.value = value
 
     def __repr__(self) -> str:
         return f"(SIGN:{self.sign}, {self.value})"
 
+    def is_non_negative(self) -> bool:
+        if self.sign.type == TT_NOT:
+            return True
+        return self.sign.type == TT_ADD and self.value.is_non_negative()
+
 class BinOpNode(ASTNode):
     def __init__(self, op: Token, left: ASTNode, right: ASTNode) -> None:
         super().__init__(left.type, left.pos)
@@ -119,11 +160,152 @@ class BinOpNode(ASTNode):
     def __repr__(self) -> str:
         return f"{self.op}({self.left}, {self.right})"
     
+    def is_non_negative(self) -> bool:
+        if self.op.type in (TT_ADD, TT_MUL, TT_DIV):
+            return self.left.is_non_negative() and self.right.is_non_negative()
+        if self.op.type == TT_MOD:
+            return self.type == TT_INT and self.left.is_non_negative()
+        if self.op.type == TT_POW:
+            return self.left.is_non_negative()
+        # Comparisons evaluate to 0 or 1
+        return self.op.type in COMPARISONS
+    
     def infer_type(self) -> None:
-        if self.left.type != self.right.type:
-            self.type = TypePromotion.max(self.left.type, self.right.type)
+        self.type = self.result_type(self.left.type, self.right.type)
+
+    def result_type(self, left_type: str, right_type: str) -> str:
+        result_type = TypePromotion.max(left_type, right_type)
+        if self.op.type in COMPARISONS:
+            result_type = TT_INT
         if self.op.type == TT_DIV:
-            self.type = TT_FLT
+            result_type = TT_FLT
+        # Integer powers are only kept as integers for non-negative exponents
+        if self.op.type == TT_POW and result_type == TT_INT \
+        and not self.right.is_non_negative():
+            result_type = TT_FLT
+        return result_type
+
+class VarAccessNode(ASTNode):
+    def __init__(self, name: Token, var_type: str) -> None:
+        super().__init__(var_type, name.pos)
+        self.name = name
+
+    def __repr__(self) -> str:
+        return f"{self.name}"
+
+class VarAssignNode(ASTNode):
+    def __init__(self, name: Token, value: ASTNode, var_type: str) -> None:
+        super().__init__(var_type, name.pos)
+        self.name = name
+        self.value = value
+
+    def __repr__(self) -> str:
+        return f"(SET:{self.name}, {self.value})"
+
+    def is_non_negative(self) -> bool:
+        return self.value.is_non_negative()
+
+class FuncDefNode(ASTNode):
+    def __init__(self, name: Token, params: List[Token], body: ASTNode, memo: bool) -> None:
+        super().__init__(None, name.pos)
+        self.name = name
+        self.params = params
+        self.body = body
+        self.memo = memo
+
+    def __repr__(self) -> str:
+        kind = "MEMO" if self.memo else "FUN"
+        return f"({kind}:{self.name}({', '.join(map(str, self.params))}), {self.body})"
+
+class CallNode(ASTNode):
+    def __init__(self, name: Token, args: List[ASTNode]) -> None:
+        # The type is only known once the callee runs
+        super().__init__(TT_INT, name.pos)
+        self.name = name
+        self.args = args
+        self.tail = False
+        # Built-in function run by the last evaluation (None if none)
+        self.builtin = None
+
+    def __repr__(self) -> str:
+        return f"{self.name}({', '.join(map(str, self.args))})"
+
+    def is_non_negative(self) -> bool:
+        if self.builtin is None:
+            return False
+        if self.builtin.non_negative:
+            return True
+        # abs, min, max and floor keep the sign of non-negative arguments
+        return self.builtin.result != RESULT_FLOAT \
+            and all(arg.is_non_negative() for arg in self.args)
+
+class SequenceNode(ASTNode):
+    def __init__(self, items: List[ASTNode]) -> None:
+        super().__init__(items[-1].type, items[0].pos)
+        self.items = items
+
+    def __repr__(self) -> str:
+        return f"{{{'; '.join(map(str, self.items))}}}"
+
+    def is_non_negative(self) -> bool:
+        return self.items[-1].is_non_negative()
+
+class LogicNode(ASTNode):
+    def __init__(self, op: Token, left: ASTNode, right: ASTNode) -> None:
+        # The right operand is only evaluated when the left one does not
+        # decide the result
+        super().__init__(TT_INT, left.pos)
+        self.op = op
+        self.left = left
+        self.right = right
+
+    def __repr__(self) -> str:
+        return f"{self.op}({self.left}, {self.right})"
+
+    def is_non_negative(self) -> bool:
+        return True
+
+class CondNode(ASTNode):
+    def __init__(self, cond: ASTNode, if_true: ASTNode, if_false: ASTNode) -> None:
+        super().__init__(TypePromotion.max(if_true.type, if_false.type), cond.pos)
+        self.cond = cond
+        self.if_true = if_true
+        self.if_false = if_false
+
+    def __repr__(self) -> str:
+        return f"(IF:{self.cond}, {self.if_true}, {self.if_false})"
+
+    def is_non_negative(self) -> bool:
+        return self.if_true.is_non_negative() and self.if_false.is_non_negative()
+
+class WhileNode(ASTNode):
+    def __init__(self, cond: ASTNode, body: ASTNode) -> None:
+        # The value is the last iteration's, or 0 if there is none
+        super().__init__(body.type, cond.pos)
+        self.cond = cond
+        self.body = body
+
+    def __repr__(self) -> str:
+        return f"(WHILE:{self.cond}, {self.body})"
+
+    def is_non_negative(self) -> bool:
+        return self.body.is_non_negative()
+
+class ForNode(ASTNode):
+    def __init__(self, name: Token, start: ASTNode, end: ASTNode, body: ASTNode, var_type: str) -> None:
+        # The counter goes from start to end (inclusive) in steps of 1
+        super().__init__(body.type, name.pos)
+        self.name = name
+        self.start = start
+        self.end = end
+        self.body = body
+        self.var_type = var_type
+
+    def __repr__(self) -> str:
+        return f"(FOR:{self.name}, {self.start}, {self.end}, {self.body})"
+
+    def is_non_negative(self) -> bool:
+        return self.body.is_non_negative()
 
 
 # ----- ERRORS -----
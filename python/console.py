@@ -2,20 +2,31 @@ from lexer import Lexer
 from parser_ import Parser
 from interpreter import Interpreter
 
+# Variables and functions persist across lines
+symbols, env, functions = {}, {}, {}
+
 print("Type 'q' or 'Quit' to quit.")
 while True:
     text = input("mc > ")
     if text.strip().lower() in ('q', 'quit'):
         break
+    # Statistics of the result caches
+    if text.strip() == ':memo':
+        for name, function in functions.items():
+            if function.cache:
+                print(f"{name}: {function.cache}")
+        continue
     tokens, err = Lexer(text).tokenize()
     if err:
         print(err)
         continue
     # print("Tokens:", tokens)
-    ast, err = Parser(tokens).parse()
+    ast, err = Parser(tokens, symbols).parse()
     if err:
         print(err)
         continue
     # print("Abstract Syntax Tree:", ast)
-    result, err = Interpreter(ast).interpret()
-    print(err if err else result)
+    result, err = Interpreter(ast, env, functions).interpret()
+    # Definitions have no value to show
+    if err or result is not None:
+        print(err if err else result)
@@ -1,11 +1,99 @@
 import math
+import sys
+from typing import Callable
 from base import *
 
+# ----- FUNCTIONS -----
+
+MEMO_CACHE_SIZE = 1024
+MAX_CALL_DEPTH = 1000
+
+# Each call nests a few visits
+sys.setrecursionlimit(max(sys.getrecursionlimit(), 16 * MAX_CALL_DEPTH))
+
+class MemoCache:
+    """
+    Results of the calls to a function. Each key has a single possible
+    entry, so a colliding key replaces the previous one
+    """
+    def __init__(self) -> None:
+        self.entries = [None] * MEMO_CACHE_SIZE
+        self.count = self.hits = self.misses = self.evictions = 0
+
+    def lookup(self, key: tuple) -> DataType:
+        entry = self.entries[hash(key) % MEMO_CACHE_SIZE]
+        if entry and entry[0] == key:
+            self.hits += 1
+            return type(entry[1])(entry[1].value)
+        self.misses += 1
+        return None
+
+    def store(self, key: tuple, result: DataType) -> None:
+        slot = hash(key) % MEMO_CACHE_SIZE
+        if self.entries[slot]:
+            self.evictions += 1
+        else:
+            self.count += 1
+        self.entries[slot] = (key, type(result)(result.value))
+
+    def clear(self) -> None:
+        self.entries = [None] * MEMO_CACHE_SIZE
+        self.count = 0
+
+    def __repr__(self) -> str:
+        return f"{self.hits} hits, {self.misses} misses, " \
+            f"{self.evictions} evictions, {self.count} entries"
+
+class Function:
+    def __init__(self, node: FuncDefNode) -> None:
+        self.node = node
+        self.cache = MemoCache() if node.memo else None
+
+
+# ----- BUILT-IN FUNCTIONS -----
+
+def exp(x: float) -> float:
+    try:
+        return math.exp(x)
+    except OverflowError:
+        return math.inf
+
+@dataclass
+class Builtin:
+    n_args: int
+    # Rule for the type of the result
+    result: str
+    # Whether the result is never negative
+    non_negative: bool
+    function: Callable
+
+BUILTINS = {
+    'sqrt': Builtin(1, RESULT_FLOAT, True, math.sqrt),
+    'exp': Builtin(1, RESULT_FLOAT, True, exp),
+    'log': Builtin(1, RESULT_FLOAT, False, math.log),
+    'sin': Builtin(1, RESULT_FLOAT, False, math.sin),
+    'cos': Builtin(1, RESULT_FLOAT, False, math.cos),
+    'abs': Builtin(1, RESULT_WIDEST, True, abs),
+    'min': Builtin(2, RESULT_WIDEST, False, min),
+    'max': Builtin(2, RESULT_WIDEST, False, max),
+    'floor': Builtin(1, RESULT_INT, False, math.floor),
+}
+
+
 # ----- INTERPRETER -----
 
 class Interpreter:
-    def __init__(self, ast: ASTNode) -> None:
+    def __init__(self, ast: ASTNode, env: dict = None, functions: dict = None) -> None:
         self.ast = ast
+        # Values of the variables
+        self.env = env if env is not None else {}
+        # Functions, by name
+        self.functions = functions if functions is not None else {}
+        # Variables of the function being run (None at top level)
+        self.frame = None
+        self.depth = 0
+        # Tail call left to the caller's loop
+        self.pending = None
 
     def interpret(self) -> Tuple[DataType, Error]:
         """
@@ -20,6 +108,24 @@ class Interpreter:
             return self.visit_UnOpNode(node)
         elif type(node) is BinOpNode:
             return self.visit_BinOpNode(node)
+        elif type(node) is VarAccessNode:
+            return self.visit_VarAccessNode(node)
+        elif type(node) is VarAssignNode:
+            return self.visit_VarAssignNode(node)
+        elif type(node) is FuncDefNode:
+            return self.visit_FuncDefNode(node)
+        elif type(node) is CallNode:
+            return self.visit_CallNode(node)
+        elif type(node) is SequenceNode:
+            return self.visit_SequenceNode(node)
+        elif type(node) is LogicNode:
+            return self.visit_LogicNode(node)
+        elif type(node) is CondNode:
+            return self.visit_CondNode(node)
+        elif type(node) is WhileNode:
+            return self.visit_WhileNode(node)
+        elif type(node) is ForNode:
+            return self.visit_ForNode(node)
         else:
             return None, RuntimeError(
                 node.pos,
@@ -41,7 +147,11 @@ class Interpreter:
         value, err = self.visit(node.value)
         if err:
             return None, err
-        
+
+        if node.sign.type == TT_NOT:
+            return Int(int(not value.value)), None
+
+        node.type = value.type
         if node.sign.type == TT_ADD:
             return self.pos(value, node)
         if node.sign.type == TT_SUB:
@@ -50,11 +160,21 @@ class Interpreter:
         return value, None
     
     def visit_BinOpNode(self, node: BinOpNode) -> Tuple[DataType, Error]:
-        left, err = self.visit_node_with_promotion(node.left, node.type)
+        left, err = self.visit(node.left)
         if err:
             return None, err
 
-        right, err = self.visit_node_with_promotion(node.right, node.type)
+        right, err = self.visit(node.right)
+        if err:
+            return None, err
+
+        # Calls and function bodies are only typed by their values
+        node.type = node.result_type(left.type, right.type)
+        left, err = self.promote(left, node.left, node.type)
+        if err:
+            return None, err
+
+        right, err = self.promote(right, node.right, node.type)
         if err:
             return None, err
         
@@ -70,12 +190,249 @@ class Interpreter:
             return self.mod(left, right, node)
         if node.op.type == TT_POW:
             return self.pow(left, right, node)
+        if node.op.type in COMPARISONS:
+            return self.compare(left, right, node)
         
         return None, RuntimeError(
             node.pos,
             f"Unknown operator: {node.op.type}"
         )
         
+    def visit_VarAccessNode(self, node: VarAccessNode) -> Tuple[DataType, Error]:
+        scope = self.env if self.frame is None else self.frame
+        value = scope.get(node.name.value)
+        if value is None:
+            return None, RuntimeError(
+                node.pos,
+                f"Undefined variable '{node.name.value}'"
+            )
+
+        # Values stored before the variable was widened
+        if self.frame is None:
+            value, _ = self.promote(value, node, node.type)
+
+        return type(value)(value.value), None
+
+    def visit_VarAssignNode(self, node: VarAssignNode) -> Tuple[DataType, Error]:
+        value, err = self.visit(node.value)
+        if err:
+            return None, err
+
+        scope = self.env
+        if self.frame is None:
+            value, err = self.promote(value, node.value, node.type)
+            if err:
+                return None, err
+        else:
+            scope = self.frame
+
+        scope[node.name.value] = type(value)(value.value)
+        return value, None
+
+    def visit_FuncDefNode(self, node: FuncDefNode) -> Tuple[DataType, Error]:
+        # Cached results may depend on the previous definition
+        for function in self.functions.values():
+            if function.cache:
+                function.cache.clear()
+
+        self.functions[node.name.value] = Function(node)
+        return None, None
+
+    def visit_CallNode(self, node: CallNode) -> Tuple[DataType, Error]:
+        # User functions shadow the built-in ones
+        function = self.functions.get(node.name.value)
+        node.builtin = BUILTINS.get(node.name.value) if function is None else None
+        if node.builtin:
+            return self.call_builtin(node)
+        if function is None:
+            return None, RuntimeError(
+                node.pos,
+                f"Undefined function '{node.name.value}'"
+            )
+        if len(node.args) != len(function.node.params):
+            return None, RuntimeError(
+                node.pos,
+                f"Wrong number of arguments for '{node.name.value}'"
+            )
+
+        args = []
+        for arg in node.args:
+            value, err = self.visit(arg)
+            if err:
+                return None, err
+            args.append(value)
+
+        # Tail calls are run by the caller's loop, so they use no stack
+        if node.tail:
+            self.pending = (function, args)
+            return None, None
+
+        if self.depth == MAX_CALL_DEPTH:
+            return None, RuntimeError(
+                node.pos,
+                "Maximum recursion depth exceeded"
+            )
+
+        self.depth += 1
+        result, err = self.call(function, args)
+        self.depth -= 1
+        return result, err
+
+    def visit_SequenceNode(self, node: SequenceNode) -> Tuple[DataType, Error]:
+        for item in node.items:
+            result, err = self.visit(item)
+            if err:
+                return None, err
+        return result, None
+
+    def call_builtin(self, node: CallNode) -> Tuple[DataType, Error]:
+        builtin = node.builtin
+        if len(node.args) != builtin.n_args:
+            return None, RuntimeError(
+                node.pos,
+                f"Wrong number of arguments for '{node.name.value}'"
+            )
+
+        args = []
+        for arg in node.args:
+            value, err = self.visit(arg)
+            if err:
+                return None, err
+            args.append(value)
+
+        if builtin.result == RESULT_INT:
+            if args[0].type == TT_INT:
+                return args[0], None
+            try:
+                return Int(builtin.function(args[0].value)), None
+            except (OverflowError, ValueError):
+                return None, RuntimeError(
+                    node.pos,
+                    f"Unable to convert from {TT_FLT} to {TT_INT}"
+                )
+
+        node.type = TT_FLT
+        if builtin.result == RESULT_WIDEST:
+            node.type = args[0].type
+            for arg in args[1:]:
+                node.type = TypePromotion.max(node.type, arg.type)
+        for k in range(len(args)):
+            args[k], err = self.promote(args[k], node.args[k], node.type)
+            if err:
+                return None, err
+
+        try:
+            result = builtin.function(*(arg.value for arg in args))
+        except ValueError:
+            return None, RuntimeError(
+                node.pos,
+                f"Math domain error in '{node.name.value}'"
+            )
+        return (Int if node.type == TT_INT else Float)(result), None
+
+    def visit_LogicNode(self, node: LogicNode) -> Tuple[DataType, Error]:
+        left, err = self.visit(node.left)
+        if err:
+            return None, err
+
+        # The right operand is not evaluated when the left one decides
+        truth = bool(left.value)
+        if truth == (node.op.type == TT_OR):
+            return Int(int(truth)), None
+
+        right, err = self.visit(node.right)
+        if err:
+            return None, err
+        return Int(int(bool(right.value))), None
+
+    def visit_CondNode(self, node: CondNode) -> Tuple[DataType, Error]:
+        cond, err = self.visit(node.cond)
+        if err:
+            return None, err
+
+        value, err = self.visit(node.if_true if cond.value else node.if_false)
+        if err or value is None:
+            # Tail calls leave no value
+            return value, err
+        return self.promote(value, node, node.type)
+
+    def visit_WhileNode(self, node: WhileNode) -> Tuple[DataType, Error]:
+        # Loops without iterations evaluate to 0
+        value = Float(0.0) if node.type == TT_FLT else Int(0)
+        while True:
+            cond, err = self.visit(node.cond)
+            if err:
+                return None, err
+            if not cond.value:
+                return value, None
+
+            value, err = self.visit(node.body)
+            if err:
+                return None, err
+
+    def visit_ForNode(self, node: ForNode) -> Tuple[DataType, Error]:
+        start, err = self.visit(node.start)
+        if err:
+            return None, err
+        end, err = self.visit(node.end)
+        if err:
+            return None, err
+
+        # The counter takes the type of the variable it is stored in
+        counter_type = node.var_type if self.frame is None \
+            else TypePromotion.max(start.type, end.type)
+        counter, err = self.promote(start, node, counter_type)
+        if err:
+            return None, err
+
+        scope = self.env if self.frame is None else self.frame
+        value = Float(0.0) if node.type == TT_FLT else Int(0)
+        while counter.value <= end.value:
+            scope[node.name.value] = type(counter)(counter.value)
+            value, err = self.visit(node.body)
+            if err:
+                return None, err
+            # Float counters stop once they are too large to be incremented
+            if counter.value + 1 == counter.value:
+                break
+            counter = type(counter)(counter.value + 1)
+        return value, None
+
+    def call(self, function: Function, args: List[DataType]) -> Tuple[DataType, Error]:
+        """
+        Run a call and the chain of tail calls it makes. Results of memoized
+        functions are stored for every call of the chain
+        """
+        saved = self.frame
+        keys = []
+
+        while True:
+            cache = function.cache
+            if cache:
+                key = tuple((arg.type, arg.value) for arg in args)
+                result = cache.lookup(key)
+                if result is not None:
+                    break
+                keys.append((cache, key))
+
+            self.frame = {param.value: arg for param, arg in zip(function.node.params, args)}
+            result, err = self.visit(function.node.body)
+            self.frame = saved
+            if err:
+                self.pending = None
+                return None, err
+
+            if self.pending is None:
+                break
+
+            # Continue with the tail call
+            function, args = self.pending
+            self.pending = None
+
+        for cache, key in keys:
+            cache.store(key, result)
+        return result, None
+
     def pos(self, value: DataType, node: UnOpNode) -> Tuple[DataType, Error]:
         if node.type in (TT_INT, TT_FLT):
             value.value = +value.value
@@ -174,21 +531,33 @@ class Interpreter:
             f"No power method defined for type {node.type}"
         )
 
+    def compare(self, left: DataType, right: DataType, node: BinOpNode) -> Tuple[DataType, Error]:
+        if node.op.type == TT_LT:
+            return Int(int(left.value < right.value)), None
+        if node.op.type == TT_LE:
+            return Int(int(left.value <= right.value)), None
+        if node.op.type == TT_GT:
+            return Int(int(left.value > right.value)), None
+        if node.op.type == TT_GE:
+            return Int(int(left.value >= right.value)), None
+        if node.op.type == TT_EQ:
+            return Int(int(left.value == right.value)), None
+        return Int(int(left.value != right.value)), None
+
     def isZero(self, value: DataType) -> bool:
         return math.isclose(float(value.value), 0.0, rel_tol=1e-9)
     
-    def visit_node_with_promotion(self, node: ASTNode, type: str) -> Tuple[DataType, Error]:
-        value, err = self.visit(node)
-        if err:
-            return None, err
-        
-        if node.type != type:
-            value = value.promote(type)
-            if value is None:
+    def promote(self, value: DataType, node: ASTNode, type: str) -> Tuple[DataType, Error]:
+        # Values are only widened: calls may return wider values than
+        # their static type
+        if value.type != type and TypePromotion.max(value.type, type) == type:
+            promoted = value.promote(type)
+            if promoted is None:
                 return None, RuntimeError(
                     node.pos,
-                    f"Unable to convert from {node.type} to {type}"
+                    f"Unable to convert from {value.type} to {type}"
                 )
+            value = promoted
         
         return value, None
         
\ No newline at end of file
@@ -43,13 +43,36 @@ class Lexer:
         else:
             return None
 
+    def get_identifier(self) -> Token:
+        pos = self.get_current_pos()
+        value = ''
+
+        while self.current_char != None and self.current_char in NAME_CHARS:
+            value += self.current_char
+            self.advance()
+
+        if value in WORD_OPERATORS:
+            return Token(pos, WORD_OPERATORS[value], value)
+        if value in KEYWORDS:
+            return Token(pos, TT_KEY, value)
+        return Token(pos, TT_IDN, value)
+
+    def get_comparison(self, single: str, with_equals: str) -> Token:
+        pos = self.get_current_pos()
+        self.advance()
+        if self.current_char != '=':
+            return Token(pos, single)
+
+        self.advance()
+        return Token(pos, with_equals)
+
     def tokenize(self) -> Tuple[List[Token], Error]:
         tokens = []
 
         while self.current_char != None:
 
-            # Ignore whitespace
-            if self.current_char in ' \t':
+            # Ignore whitespace, including the '\r' of CRLF line endings
+            if self.current_char in ' \t\r':
                 self.advance()
 
             # Update row and column on newline
@@ -82,6 +105,21 @@ class Lexer:
                 tokens.append(Token(self.get_current_pos(), TT_POW))
                 self.advance()
 
+            elif self.current_char == '=':
+                tokens.append(self.get_comparison(TT_ASG, TT_EQ))
+
+            # Comparison operators
+
+            elif self.current_char == '<':
+                tokens.append(self.get_comparison(TT_LT, TT_LE))
+
+            elif self.current_char == '>':
+                tokens.append(self.get_comparison(TT_GT, TT_GE))
+
+            # '!' is only valid as part of '!='
+            elif self.current_char == '!' and self.text[self.pos + 1:self.pos + 2] == '=':
+                tokens.append(self.get_comparison(TT_NE, TT_NE))
+
             elif self.current_char == '(':
                 tokens.append(Token(self.get_current_pos(), TT_LPA))
                 self.advance()
@@ -90,6 +128,14 @@ class Lexer:
                 tokens.append(Token(self.get_current_pos(), TT_RPA))
                 self.advance()
 
+            elif self.current_char == ',':
+                tokens.append(Token(self.get_current_pos(), TT_COM))
+                self.advance()
+
+            elif self.current_char == ';':
+                tokens.append(Token(self.get_current_pos(), TT_SEM))
+                self.advance()
+
             # Literals
 
             # Numbers
@@ -99,6 +145,10 @@ class Lexer:
                     return None, IllegalCharError(self.get_current_pos(), "Not a valid number format")
                 tokens.append(tok)
 
+            # Names
+            elif self.current_char in NAME_START:
+                tokens.append(self.get_identifier())
+
             else:
                 return None, IllegalCharError(self.get_current_pos(), f"Invalid character '{self.current_char}'")
 
@@ -1,15 +1,19 @@
 
-from typing import List, Callable
+from typing import Dict, List, Callable
 from base import *
 
 
 # ----- PARSER -----
 
 class Parser:
-    def __init__(self, tokens: List[Token]) -> None:
+    def __init__(self, tokens: List[Token], symbols: Dict[str, str] = None) -> None:
         self.tokens = tokens
         self.idx = -1
         self.current_tok = None
+        # Widest type assigned to each variable
+        self.symbols = symbols if symbols is not None else {}
+        # Parameters of the function being parsed, if any
+        self.scope = None
 
     def advance(self) -> Token:
         self.idx += 1
@@ -26,7 +30,7 @@ class Parser:
         """
         Consume the program (root of the grammar)
 
-        `prog ::= expr`
+        `prog ::= stmt { ';' stmt } [ ';' ]`
         """
         
         # Advance to first token
@@ -36,14 +40,22 @@ class Parser:
                 "Unexpected end of input"
             )
         
-        # Consume an expression
-        expr, err = self.expr()
-        if err:
-            return None, err
+        # Consume statements
+        items = []
+        while True:
+            stmt, err = self.stmt()
+            if err:
+                return None, err
+            items.append(stmt)
+
+            # ';' stmt, or a trailing ';'
+            if self.current_tok == None or self.current_tok.type != TT_SEM \
+            or self.advance() == None:
+                break
         
         # End of program reached
         if self.current_tok == None:
-            return expr, None
+            return (items[0] if len(items) == 1 else SequenceNode(items)), None
         
         # Unexpected token
         return None, InvalidSyntaxError(
@@ -51,11 +63,291 @@ class Parser:
             f"Unexpected token '{self.current_tok}'"
         )
     
+    def stmt(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a statement
+
+        `stmt ::= fdef | expr`
+        """
+        if self._is_keyword('fun') or self._is_keyword('memo'):
+            return self.fdef()
+
+        # Consume expression
+        return self.expr()
+
+    def fdef(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a function definition
+
+        `fdef ::= [ 'memo' ] 'fun' IDN '(' [ IDN { ',' IDN } ] ')' '=' expr`
+        """
+
+        # [ 'memo' ]
+        memo = self._is_keyword('memo')
+        if memo:
+            self.advance()
+            if not self._is_keyword('fun'):
+                return None, InvalidSyntaxError(self._position(), "Expected 'fun'")
+
+        # 'fun' IDN
+        self.advance()
+        if self.current_tok == None or self.current_tok.type != TT_IDN:
+            return None, InvalidSyntaxError(self._position(), "Expected identifier")
+        name = self.current_tok
+
+        # '('
+        self.advance()
+        if self.current_tok == None or self.current_tok.type != TT_LPA:
+            return None, InvalidSyntaxError(self._position(), "Expected '('")
+
+        # [ IDN { ',' IDN } ]
+        params = []
+        self.advance()
+        while self.current_tok and self.current_tok.type == TT_IDN:
+            param = self.current_tok
+            if param.value in [p.value for p in params]:
+                return None, InvalidSyntaxError(
+                    param.pos,
+                    f"Duplicate parameter '{param.value}'"
+                )
+            params.append(param)
+
+            self.advance()
+            if self.current_tok == None or self.current_tok.type != TT_COM:
+                break
+
+            self.advance()
+            if self.current_tok == None or self.current_tok.type != TT_IDN:
+                return None, InvalidSyntaxError(self._position(), "Expected identifier")
+
+        # ')'
+        if self.current_tok == None or self.current_tok.type != TT_RPA:
+            return None, InvalidSyntaxError(
+                self._position(),
+                "Expected ',' or ')'" if params else "Expected ')'"
+            )
+
+        # '='
+        if self.advance() == None or self.current_tok.type != TT_ASG:
+            return None, InvalidSyntaxError(self._position(), "Expected '='")
+
+        # expr
+        op = self.current_tok
+        if self.advance() == None:
+            return None, InvalidSyntaxError(op.get_next_position(), "Expected expression")
+
+        outer, self.scope = self.scope, params
+        body, err = self.expr()
+        self.scope = outer
+        if err:
+            return None, err
+
+        # Calls returned by the body run in the caller's loop
+        self._mark_tail_calls(body)
+
+        # Correct exit
+        return FuncDefNode(name, params, body, memo), None
+
     def expr(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume an expression
+
+        `expr ::= IDN '=' expr | cond | wloop | floop | lor`
+        """
+
+        # IDN '=' expr
+        next_tok = self._peek()
+        if self.current_tok.type == TT_IDN and next_tok and next_tok.type == TT_ASG:
+
+            # Consume name and operator
+            name = self.current_tok
+            self.advance()
+            if self.advance() == None:
+                return None, InvalidSyntaxError(
+                    next_tok.get_next_position(),
+                    "Expected expression"
+                )
+
+            # Consume value
+            value, err = self.expr()
+            if err:
+                return None, err
+
+            # Locals are typed by the values they receive
+            if self.scope is not None:
+                return VarAssignNode(name, value, value.type), None
+
+            # Variables take the widest type assigned to them
+            var_type = value.type
+            if name.value in self.symbols:
+                var_type = TypePromotion.max(self.symbols[name.value], var_type)
+            self.symbols[name.value] = var_type
+
+            # Correct exit
+            return VarAssignNode(name, value, var_type), None
+
+        # cond
+        if self._is_keyword('if'):
+            return self.cond()
+
+        # wloop
+        if self._is_keyword('while'):
+            return self.wloop()
+
+        # floop
+        if self._is_keyword('for'):
+            return self.floop()
+
+        # Consume logical expression
+        return self.lor()
+
+    def cond(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a conditional expression
+
+        `cond ::= 'if' expr 'then' expr 'else' expr`
+        """
+        parts, err = self._clauses((('if', "Expected expression"),
+                                    ('then', "Expected 'then'"), 
+                                    ('else', "Expected 'else'")))
+        if err:
+            return None, err
+
+        # Correct exit
+        return CondNode(*parts), None
+
+    def wloop(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a while loop
+
+        `wloop ::= 'while' expr 'do' expr`
+        """
+        parts, err = self._clauses((('while', "Expected expression"),
+                                    ('do', "Expected 'do'")))
+        if err:
+            return None, err
+
+        # Correct exit
+        return WhileNode(*parts), None
+
+    def floop(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a for loop
+
+        `floop ::= 'for' IDN '=' expr 'to' expr 'do' expr`
+        """
+
+        # 'for' IDN
+        if self.advance() == None or self.current_tok.type != TT_IDN:
+            return None, InvalidSyntaxError(self._position(), "Expected identifier")
+        name = self.current_tok
+
+        # '='
+        op = self.advance()
+        if op == None or op.type != TT_ASG:
+            return None, InvalidSyntaxError(self._position(), "Expected '='")
+
+        # expr
+        if self.advance() == None:
+            return None, InvalidSyntaxError(op.get_next_position(), "Expected expression")
+        start, err = self.expr()
+        if err:
+            return None, err
+
+        # 'to' expr 'do' expr
+        parts, err = self._clauses((('to', "Expected 'to'"), ('do', "Expected 'do'")))
+        if err:
+            return None, err
+        end, body = parts
+
+        # The counter takes the widest type of its bounds, like an assignment
+        var_type = TypePromotion.max(start.type, end.type)
+        if self.scope is None:
+            if name.value in self.symbols:
+                var_type = TypePromotion.max(self.symbols[name.value], var_type)
+            self.symbols[name.value] = var_type
+
+        # Correct exit
+        return ForNode(name, start, end, body, var_type), None
+
+    def lor(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a disjunction
+
+        `lor ::= land { 'or' land }`
+        """
+        # Consume logical operation
+        return self._bin_op(self.land, (TT_OR,), LogicNode)
+
+    def land(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a conjunction
+
+        `land ::= lnot { 'and' lnot }`
+        """
+        # Consume logical operation
+        return self._bin_op(self.lnot, (TT_AND,), LogicNode)
+
+    def lnot(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a logical negation
+
+        `lnot ::= 'not' lnot | comp`
+        """
+
+        # 'not' lnot
+        if self.current_tok.type == TT_NOT:
+
+            # Consume operator
+            op = self.current_tok
+            if self.advance() == None:
+                return None, InvalidSyntaxError(
+                    op.get_next_position(),
+                    "Expected expression"
+                )
+
+            # Consume operand
+            node, err = self.lnot()
+            if err:
+                return None, err
+
+            # Correct exit
+            return UnOpNode(op, node), None
+
+        # Consume comparison
+        return self.comp()
+
+    def comp(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a comparison (not associative)
+
+        `comp ::= arit [ ( '<' | '<=' | '>' | '>=' | '==' | '!=' ) arit ]`
+        """
+        left, err = self.arit()
+        if err or self.current_tok == None or self.current_tok.type not in COMPARISONS:
+            return left, err
+
+        # Consume operator
+        op = self.current_tok
+        if self.advance() == None:
+            return None, InvalidSyntaxError(
+                op.get_next_position(),
+                f"Expected another number"
+            )
+
+        # Consume right node
+        right, err = self.arit()
+        if err:
+            return None, err
+
+        # Correct exit
+        return BinOpNode(op, left, right), None
+
+    def arit(self) -> Tuple[ASTNode, Error]:
         """
         Consume a math expression
 
-        `expr ::= term { ('+' | '-') term }`
+        `arit ::= term { ('+' | '-') term }`
         """
         # Consume binary operation
         return self._bin_op(self.term, (TT_ADD, TT_SUB))
@@ -126,7 +418,7 @@ class Parser:
         """
         Consume a numeric value
         
-        `nval ::= '(' expr ')' | nlit`
+        `nval ::= '(' expr { ';' expr } ')' | call | IDN | nlit`
         """
         
         # '(' expr ')'
@@ -140,10 +432,24 @@ class Parser:
                     "Expected expression"
                 )
 
-            # Consume expression
-            expr, err = self.expr()
-            if err:
-                return None, err
+            # Consume expressions
+            items = []
+            while True:
+                item, err = self.expr()
+                if err:
+                    return None, err
+                items.append(item)
+
+                # ';' expr
+                if self.current_tok == None or self.current_tok.type != TT_SEM:
+                    break
+                semicolon = self.current_tok
+                if self.advance() == None:
+                    return None, InvalidSyntaxError(
+                        semicolon.get_next_position(),
+                        "Expected expression"
+                    )
+            expr = items[0] if len(items) == 1 else SequenceNode(items)
             
             # Consume right parenthesis
             pos = self.current_tok.pos if self.current_tok \
@@ -157,10 +463,66 @@ class Parser:
 
             # Correct exit
             return expr, None
+
+        # call
+        next_tok = self._peek()
+        if self.current_tok.type == TT_IDN and next_tok and next_tok.type == TT_LPA:
+            return self.call()
+
+        # IDN
+        if self.current_tok.type == TT_IDN:
+            name = self.current_tok
+            self.advance()
+
+            # Correct exit
+            var_type = TT_INT if self.scope is not None \
+                else self.symbols.get(name.value, TT_INT)
+            return VarAccessNode(name, var_type), None
         
         # Consume numeric literal
         return self.nlit()
 
+    def call(self) -> Tuple[ASTNode, Error]:
+        """
+        Consume a function call
+
+        `call ::= IDN '(' [ expr { ',' expr } ] ')'`
+        """
+
+        # Consume name and left parenthesis
+        name = self.current_tok
+        self.advance()
+        self.advance()
+
+        # [ expr { ',' expr } ]
+        args = []
+        while self.current_tok and self.current_tok.type != TT_RPA:
+            arg, err = self.expr()
+            if err:
+                return None, err
+            args.append(arg)
+
+            # ',' expr
+            if self.current_tok == None or self.current_tok.type != TT_COM:
+                break
+            comma = self.current_tok
+            if self.advance() == None:
+                return None, InvalidSyntaxError(
+                    comma.get_next_position(),
+                    "Expected expression"
+                )
+
+        # Consume right parenthesis
+        if self.current_tok == None or self.current_tok.type != TT_RPA:
+            return None, InvalidSyntaxError(
+                self._position(),
+                "Expected ',' or ')'" if args else "Expected ')'"
+            )
+        self.advance()
+
+        # Correct exit
+        return CallNode(name, args), None
+
     def nlit(self) -> Tuple[NumberNode, Error]:
         """
         Consume a numeric literal
@@ -184,7 +546,61 @@ class Parser:
 
     # Auxiliary methods
 
-    def _bin_op(self, func: Callable, ops: List) -> Tuple[ASTNode, Error]:
+    def _position(self) -> Tuple[int, int]:
+        """
+        Obtain the position of the current token, or the position after the
+        last token if all of them have been consumed
+        """
+        return self.current_tok.pos if self.current_tok \
+            else self.tokens[-1].get_next_position()
+
+    def _is_keyword(self, keyword: str) -> bool:
+        """
+        Check whether the current token is a keyword
+        """
+        return self.current_tok != None and self.current_tok.type == TT_KEY \
+            and self.current_tok.value == keyword
+
+    def _peek(self) -> Token:
+        """
+        Obtain the token after the current one without consuming it
+        """
+        return self.tokens[self.idx + 1] if self.idx + 1 < len(self.tokens) else None
+
+    def _mark_tail_calls(self, body: ASTNode) -> None:
+        """
+        Mark the calls whose value is returned by a function body
+        """
+        if type(body) is CallNode:
+            body.tail = True
+        elif type(body) is CondNode:
+            self._mark_tail_calls(body.if_true)
+            self._mark_tail_calls(body.if_false)
+        elif type(body) is SequenceNode:
+            self._mark_tail_calls(body.items[-1])
+
+    def _clauses(self, clauses: Tuple) -> Tuple[List[ASTNode], Error]:
+        """
+        Consume a series of clauses, each made of a keyword followed by an
+        expression, given as pairs of keyword and error when it is missing
+        """
+        parts = []
+        for keyword, missing in clauses:
+            if not self._is_keyword(keyword):
+                return None, InvalidSyntaxError(self._position(), missing)
+            if self.advance() == None:
+                return None, InvalidSyntaxError(
+                    self.tokens[-1].get_next_position(),
+                    "Expected expression"
+                )
+
+            part, err = self.expr()
+            if err:
+                return None, err
+            parts.append(part)
+        return parts, None
+
+    def _bin_op(self, func: Callable, ops: List, build: Callable = BinOpNode) -> Tuple[ASTNode, Error]:
         """
         Consume a binary operation (left associative)
 
@@ -212,7 +628,7 @@ class Parser:
                 return None, err
             
             # Build binary node
-            left = BinOpNode(op, left, right)
+            left = build(op, left, right)
 
         # Correct exit
         return left, None
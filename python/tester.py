@@ -1,5 +1,6 @@
 import math
 import os
+import sys
 from typing import List
 from lexer import Lexer
 from parser_ import Parser
@@ -8,6 +9,18 @@ from interpreter import Interpreter
 
 TEST_FILE = '../tests.txt'
 
+# With --c, the tests run on the C implementation through the cengine
+# extension module (built from c/pyengine.c)
+USE_C = '--c' in sys.argv
+if USE_C:
+    import cengine
+
+
+def run_c(entry: str):
+    try:
+        return cengine.Session().eval(entry), None
+    except cengine.Error as err:
+        return None, err
 
 def print_test_header(name: str) -> None:
     print(f"\n[Test] {name}")
@@ -45,15 +58,20 @@ for line in lines:
             if expected.startswith('~'):
                 expected = expected[1:].strip()
                 
-            tokens, err = Lexer(entry).tokenize()
-            if not err:
-                ast, err = Parser(tokens).parse()
+            if USE_C:
+                result, err = run_c(entry)
+                value = result
+            else:
+                tokens, err = Lexer(entry).tokenize()
                 if not err:
-                    result, err = Interpreter(ast).interpret()
+                    ast, err = Parser(tokens).parse()
+                    if not err:
+                        result, err = Interpreter(ast).interpret()
+                        value = result.value if not err else None
             
             test_count += 1
-            if (err and 'expected_error' in locals() and expected_error in err.__repr__()) \
-            or (not err and math.isclose(float(result.value), float(expected), rel_tol=1e-6)):
+            if (err and 'expected_error' in locals() and expected_error in str(err)) \
+            or (not err and math.isclose(float(value), float(expected), rel_tol=1e-6)):
                 pass_count += 1
                 print('.', end='')
             else: